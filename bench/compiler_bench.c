@@ -0,0 +1,303 @@
+// 编译器各阶段基准测试
+// 对每个输入文件分别测量词法分析、语法分析、增量解析、名字解析、常量折叠与代码生成的吞吐量和内存峰值，
+// 结果以 JSON 输出，便于在版本之间比较。
+// 用法: compiler_bench [-n 重复次数] [-o 结果文件] <源文件>...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "source.h"
+#include "lexer.h"
+#include "parallel_lexer.h"
+#include "parser.h"
+#include "flat_ast.h"
+#include "syntax_analyzer.h"
+#include "constant_folder.h"
+#include "code_generator.h"
+#include "interner.h"
+#include "type_interner.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// 单个阶段的测量结果
+typedef struct {
+    double seconds;        // 多次重复中最快的一次
+    long long items;       // 处理的标记数 / AST节点数 / IR字节数
+    long peak_rss_kb;      // 该阶段结束时的内存峰值
+} PhaseResult;
+
+static double now_seconds(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return (double)time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// 把内存峰值清零，使每个阶段的峰值互不影响（仅 Linux 支持：写入 5 清零 /proc/self/status 中的 VmHWM）
+static void reset_peak_rss(void) {
+#ifdef __linux__
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (file) {
+        fputs("5", file);
+        fclose(file);
+    }
+#endif
+}
+
+// 上次清零以来的内存峰值（KB）。Linux 上读取可以清零的 VmHWM；getrusage 的 ru_maxrss 不受清零影响，
+// 是整个进程生命周期的峰值，只在其他平台（以及读不到 VmHWM 时）使用
+static long peak_rss_kb(void) {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return (long)(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+#ifdef __linux__
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file) {
+        char line[256];
+        long peak = 0;
+        while (fgets(line, sizeof(line), file)) {
+            if (strncmp(line, "VmHWM:", 6) == 0) {
+                peak = strtol(line + 6, NULL, 10);
+                break;
+            }
+        }
+        fclose(file);
+        if (peak > 0) return peak;
+    }
+#endif
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (long)(usage.ru_maxrss / 1024);  // macOS 以字节为单位
+#else
+    return (long)usage.ru_maxrss;
+#endif
+#endif
+}
+
+// 词法分析：切分出完整的标记数组
+static PhaseResult bench_lexer(const SourceBuffer* source, int iterations) {
+    PhaseResult result = { 0, 0, 0 };
+    reset_peak_rss();
+    for (int i = 0; i < iterations; i++) {
+        double start = now_seconds();
+        TokenArray* tokens = tokenize_parallel(source->data, (int)source->length, 0);
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+        result.items = tokens ? tokens->count : 0;
+        destroy_token_array(tokens);
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+// 语法分析（含词法分析、构建可达函数体与压缩为扁平AST）。语料的 main 调用了每个函数，所有函数体都会被解析：返回最后一次得到的扁平AST，供代码生成阶段使用
+static PhaseResult bench_parser(const SourceBuffer* source, int iterations, FlatAST** last_ast) {
+    PhaseResult result = { 0, 0, 0 };
+    reset_peak_rss();
+    for (int i = 0; i < iterations; i++) {
+        // 先释放上一次的结果，避免两棵AST同时占用内存
+        destroy_flat_ast(*last_ast);
+        double start = now_seconds();
+        Parser* parser = create_parser();
+        parse_source(parser, source->data, (int)source->length);
+        parse_reachable_bodies(parser, find_symbol("main", 4));
+        *last_ast = flatten_ast(get_ast_root(parser));
+        destroy_parser(parser);
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+        // 不计保留的 0 号节点
+        result.items = *last_ast ? (long long)(*last_ast)->count - 1 : 0;
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+// 增量解析：在文件中部某行末尾交替插入、删除一个空格，只计重新解析的时间
+static PhaseResult bench_reparse(const SourceBuffer* source, int iterations) {
+    PhaseResult result = { 0, 0, 0 };
+    int length = (int)source->length;
+    char* edited = (char*)malloc((size_t)length + 1);
+    Parser* parser = create_parser();
+    if (!edited || !parser) {
+        free(edited);
+        destroy_parser(parser);
+        return result;
+    }
+    int position = length / 2;
+    while (position < length && source->data[position] != '\n') position++;
+    memcpy(edited, source->data, (size_t)position);
+    edited[position] = ' ';
+    memcpy(edited + position + 1, source->data + position, (size_t)(length - position));
+
+    parse_source(parser, source->data, length);
+    reset_peak_rss();
+    for (int i = 0; i < iterations * 2; i++) {
+        double start = now_seconds();
+        if (i % 2 == 0) {
+            reparse_source(parser, edited, length + 1, position, position, position + 1);
+        } else {
+            reparse_source(parser, source->data, length, position, position + 1, position);
+        }
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+    }
+    result.items = 1;
+    result.peak_rss_kb = peak_rss_kb();
+    destroy_parser(parser);
+    free(edited);
+    return result;
+}
+
+// 名字解析：以扁平AST节点数计量
+static PhaseResult bench_resolve(FlatAST* ast, int iterations) {
+    PhaseResult result = { 0, 0, 0 };
+    reset_peak_rss();
+    for (int i = 0; i < iterations && ast; i++) {
+        double start = now_seconds();
+        SyntaxAnalyzer* analyzer = create_syntax_analyzer();
+        analyze_syntax(analyzer, ast, NULL, 0);
+        destroy_syntax_analyzer(analyzer);
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+        result.items = (long long)ast->count - 1;
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+// 常量折叠：以折叠前的扁平AST节点数计量（需要名字解析的结果）
+static PhaseResult bench_fold(const FlatAST* ast, int iterations) {
+    PhaseResult result = { 0, 0, 0 };
+    reset_peak_rss();
+    for (int i = 0; i < iterations && ast; i++) {
+        double start = now_seconds();
+        FlatAST* folded = fold_constants(ast);
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+        result.items = (long long)ast->count - 1;
+        destroy_flat_ast(folded);
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+// 代码生成：以生成的 IR 字节数计量
+static PhaseResult bench_codegen(const FlatAST* ast, int iterations) {
+    PhaseResult result = { 0, 0, 0 };
+    reset_peak_rss();
+    for (int i = 0; i < iterations; i++) {
+        double start = now_seconds();
+        CodeGenerator* generator = create_code_generator();
+        generate_code(generator, ast);
+        double seconds = now_seconds() - start;
+        if (i == 0 || seconds < result.seconds) result.seconds = seconds;
+        const char* code = get_generated_code(generator);
+        result.items = code ? (long long)strlen(code) : 0;
+        destroy_code_generator(generator);
+    }
+    result.peak_rss_kb = peak_rss_kb();
+    return result;
+}
+
+static void write_phase(FILE* out, const char* name, const char* unit, const PhaseResult* phase, int last) {
+    double rate = phase->seconds > 0 ? phase->items / phase->seconds : 0;
+    fprintf(out, "      \"%s\": {\"seconds\": %.6f, \"%s\": %lld, \"%s_per_sec\": %.1f, \"peak_rss_kb\": %ld}%s\n",
+            name, phase->seconds, unit, phase->items, unit, rate, phase->peak_rss_kb, last ? "" : ",");
+}
+
+// 文件名去掉目录与扩展名后作为语料名
+static void corpus_name(const char* path, char* name, size_t size) {
+    const char* base = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    snprintf(name, size, "%s", base);
+    char* dot = strrchr(name, '.');
+    if (dot && dot != name) *dot = '\0';
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 5;
+    const char* output_path = NULL;
+    int first_input = 1;
+    while (first_input < argc && argv[first_input][0] == '-' && argv[first_input][1] != '\0') {
+        if (strcmp(argv[first_input], "-n") == 0 && first_input + 1 < argc) {
+            iterations = atoi(argv[first_input + 1]);
+            first_input += 2;
+        } else if (strcmp(argv[first_input], "-o") == 0 && first_input + 1 < argc) {
+            output_path = argv[first_input + 1];
+            first_input += 2;
+        } else {
+            break;
+        }
+    }
+    if (first_input >= argc) {
+        fprintf(stderr, "用法: %s [-n 重复次数] [-o 结果文件] <源文件>...\n", argv[0]);
+        return 1;
+    }
+    if (iterations <= 0) iterations = 1;
+
+    FILE* out = output_path ? fopen(output_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "无法创建文件: %s\n", output_path);
+        return 1;
+    }
+
+    fprintf(out, "{\n  \"iterations\": %d,\n  \"results\": [\n", iterations);
+    for (int i = first_input; i < argc; i++) {
+        SourceBuffer* source = load_source_file(argv[i]);
+        if (!source) {
+            if (out != stdout) fclose(out);
+            return 1;
+        }
+
+        FlatAST* ast = NULL;
+        PhaseResult lex = bench_lexer(source, iterations);
+        PhaseResult parse = bench_parser(source, iterations, &ast);
+        PhaseResult reparse = bench_reparse(source, iterations);
+        PhaseResult resolve = bench_resolve(ast, iterations);
+        PhaseResult fold = bench_fold(ast, iterations);
+        PhaseResult codegen = bench_codegen(ast, iterations);
+
+        char name[256];
+        corpus_name(argv[i], name, sizeof(name));
+        fprintf(out, "    {\n      \"corpus\": \"%s\",\n      \"bytes\": %lu,\n", name, (unsigned long)source->length);
+        write_phase(out, "lex", "tokens", &lex, 0);
+        write_phase(out, "parse", "ast_nodes", &parse, 0);
+        write_phase(out, "reparse", "edits", &reparse, 0);
+        write_phase(out, "resolve", "ast_nodes", &resolve, 0);
+        write_phase(out, "fold", "ast_nodes", &fold, 0);
+        write_phase(out, "codegen", "ir_bytes", &codegen, 1);
+        fprintf(out, "    }%s\n", i + 1 < argc ? "," : "");
+
+        if (out != stdout) {
+            printf("%-12s 词法 %.1f M标记/秒  语法 %.1f K节点/秒  增量 %.3f 毫秒  名字解析 %.1f K节点/秒  常量折叠 %.1f K节点/秒  代码生成 %.1f MB/秒  峰值 %ld KB\n", name,
+                   lex.seconds > 0 ? lex.items / lex.seconds / 1e6 : 0,
+                   parse.seconds > 0 ? parse.items / parse.seconds / 1e3 : 0,
+                   reparse.seconds * 1e3,
+                   resolve.seconds > 0 ? resolve.items / resolve.seconds / 1e3 : 0,
+                   fold.seconds > 0 ? fold.items / fold.seconds / 1e3 : 0,
+                   codegen.seconds > 0 ? codegen.items / codegen.seconds / 1e6 : 0,
+                   parse.peak_rss_kb);
+        }
+
+        destroy_flat_ast(ast);
+        destroy_source_buffer(source);
+        destroy_interner();
+        destroy_type_interner();
+    }
+    fprintf(out, "  ]\n}\n");
+
+    if (out != stdout) fclose(out);
+    return 0;
+}
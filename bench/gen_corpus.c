@@ -0,0 +1,180 @@
+// 基准测试语料生成器
+// 生成指定大小与形态的 SCP 程序，供 compiler_bench 测量各阶段吞吐量。
+// 用法: gen_corpus <形态> <字节数> <输出文件> [随机种子]
+// 形态: functions   大量小函数
+//       expressions 深层嵌套的表达式
+//       strings     长字符串字面量
+//       comments    注释密集的文件
+//       mixed       以上各种形态交错
+// 生成的 main 依次调用每个函数，使懒解析下所有函数体都可达，各阶段都处理整个文件。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    SHAPE_FUNCTIONS,
+    SHAPE_EXPRESSIONS,
+    SHAPE_STRINGS,
+    SHAPE_COMMENTS,
+    SHAPE_MIXED
+} CorpusShape;
+
+static const char* shape_names[] = { "functions", "expressions", "strings", "comments", "mixed" };
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+// 局部变量名（每个函数只声明其中一个）
+static const char* identifiers[] = {
+    "counter", "value", "result", "buffer", "index", "node", "left", "right",
+    "total", "tmp0", "length", "item", "state", "next"
+};
+#define IDENTIFIER_COUNT ((int)(sizeof(identifiers) / sizeof(identifiers[0])))
+
+// 整数运算符：生成的程序只使用已声明的名字，类型一致，运行时也不会除以零
+static const char* operators[] = { "+", "-", "*", "&", "|", "^" };
+#define OPERATOR_COUNT ((int)(sizeof(operators) / sizeof(operators[0])))
+
+// 比较运算符，只出现在 if 条件中
+static const char* comparisons[] = { "<", "<=", "==", "!=" };
+#define COMPARISON_COUNT ((int)(sizeof(comparisons) / sizeof(comparisons[0])))
+
+static const char* words[] = {
+    "the", "quick", "lexer", "scans", "tokens", "while", "parser", "builds", "trees", "of", "nodes"
+};
+#define WORD_COUNT ((int)(sizeof(words) / sizeof(words[0])))
+
+// 随机表达式，depth 控制括号嵌套深度；叶子取 names 中的名字或整数字面量
+static void write_expression(FILE* out, int depth, const char* const* names, int name_count) {
+    if (depth <= 0 || next_random() % 4 == 0) {
+        if (next_random() % 2) {
+            fprintf(out, "%s", names[next_random() % name_count]);
+        } else {
+            fprintf(out, "%u", next_random() % 1000);
+        }
+        return;
+    }
+    fputc('(', out);
+    write_expression(out, depth - 1, names, name_count);
+    fprintf(out, " %s ", operators[next_random() % OPERATOR_COUNT]);
+    write_expression(out, depth - 1, names, name_count);
+    fputc(')', out);
+}
+
+static void write_small_function(FILE* out, int index) {
+    fprintf(out, "fun f%d(a : int, b : int) : int {\n", index);
+    const char* local = identifiers[next_random() % IDENTIFIER_COUNT];
+    fprintf(out, "    var %s : int = a %s b\n", local, operators[next_random() % OPERATOR_COUNT]);
+    fprintf(out, "    if (a %s b) {\n        return a\n    }\n", comparisons[next_random() % COMPARISON_COUNT]);
+    fprintf(out, "    return %s * %u\n}\n\n", local, next_random() % 100);
+}
+
+static void write_expression_function(FILE* out, int index) {
+    const char* names[3] = { "x", "y", identifiers[next_random() % IDENTIFIER_COUNT] };
+    fprintf(out, "fun e%d(x : int, y : int) : int {\n", index);
+    fprintf(out, "    val %s : int = ", names[2]);
+    write_expression(out, 12, names, 2);
+    fprintf(out, "\n    return ");
+    write_expression(out, 8, names, 3);
+    fprintf(out, "\n}\n\n");
+}
+
+static void write_string_function(FILE* out, int index) {
+    fprintf(out, "fun s%d() {\n    val text : str = \"", index);
+    int count = 64 + next_random() % 512;
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "%s%s", words[next_random() % WORD_COUNT], i % 16 == 15 ? "\\n" : " ");
+    }
+    fprintf(out, "\"\n    println(text)\n}\n\n");
+}
+
+static void write_commented_function(FILE* out, int index) {
+    fprintf(out, "/*\n * c%d: ", index);
+    int lines = 4 + next_random() % 12;
+    for (int i = 0; i < lines; i++) {
+        for (int j = 0; j < 10; j++) {
+            fprintf(out, "%s ", words[next_random() % WORD_COUNT]);
+        }
+        fprintf(out, "\n * ");
+    }
+    fprintf(out, "\n */\n");
+    fprintf(out, "fun c%d(a : int) : int {\n", index);
+    fprintf(out, "    // %s %s %s\n", words[next_random() % WORD_COUNT],
+            words[next_random() % WORD_COUNT], words[next_random() % WORD_COUNT]);
+    fprintf(out, "    return a // trailing comment\n}\n\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "用法: %s <functions|expressions|strings|comments|mixed> <字节数> <输出文件> [随机种子]\n", argv[0]);
+        return 1;
+    }
+
+    int shape = -1;
+    for (int i = 0; i <= SHAPE_MIXED; i++) {
+        if (strcmp(argv[1], shape_names[i]) == 0) {
+            shape = i;
+        }
+    }
+    if (shape < 0) {
+        fprintf(stderr, "未知的语料形态: %s\n", argv[1]);
+        return 1;
+    }
+    long target_size = atol(argv[2]);
+    if (argc >= 5) {
+        seed = (unsigned int)strtoul(argv[4], NULL, 10);
+    }
+
+    FILE* out = fopen(argv[3], "wb");
+    if (!out) {
+        fprintf(stderr, "无法创建文件: %s\n", argv[3]);
+        return 1;
+    }
+
+    // 记录每个函数的形态，生成 main 时据此调用
+    char* shapes = NULL;
+    int count = 0;
+    int capacity = 0;
+
+    fprintf(out, "#include \"scp.stdio.h\"\n\n");
+    for (int index = 0; ftell(out) < target_size; index++) {
+        int current = shape == SHAPE_MIXED ? (int)(next_random() % SHAPE_MIXED) : shape;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            char* grown = realloc(shapes, (size_t)capacity);
+            if (!grown) {
+                fprintf(stderr, "内存分配失败\n");
+                free(shapes);
+                fclose(out);
+                return 1;
+            }
+            shapes = grown;
+        }
+        shapes[count++] = (char)current;
+        switch (current) {
+            case SHAPE_FUNCTIONS:   write_small_function(out, index); break;
+            case SHAPE_EXPRESSIONS: write_expression_function(out, index); break;
+            case SHAPE_STRINGS:     write_string_function(out, index); break;
+            default:                write_commented_function(out, index); break;
+        }
+    }
+    fprintf(out, "fun main() {\n    println(\"Hello, scp!\")\n");
+    for (int index = 0; index < count; index++) {
+        switch (shapes[index]) {
+            case SHAPE_FUNCTIONS:   fprintf(out, "    f%d(%d, %d)\n", index, index % 100, index % 7); break;
+            case SHAPE_EXPRESSIONS: fprintf(out, "    e%d(%d, %d)\n", index, index % 100, index % 7); break;
+            case SHAPE_STRINGS:     fprintf(out, "    s%d()\n", index); break;
+            default:                fprintf(out, "    c%d(%d)\n", index, index % 100); break;
+        }
+    }
+    fprintf(out, "}\n");
+
+    free(shapes);
+    fclose(out);
+    return 0;
+}
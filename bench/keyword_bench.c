@@ -0,0 +1,117 @@
+// 关键字识别基准测试
+// 对比"逐个比较关键字"的线性查找与构建时生成的最小完美哈希查找，
+// 并测量整个词法分析器在标识符密集输入上的吞吐量。
+// 用法: keyword_bench [标识符数量]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lexer.h"
+#include "keyword_table.h"
+
+// 线性查找：相当于原先 read_identifier 中的 strcmp 链
+static TokenType lookup_linear(const char* text, int length) {
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (keyword_table[i].length == length && memcmp(keyword_table[i].text, text, length) == 0) {
+            return keyword_table[i].type;
+        }
+    }
+    return TOKEN_IDENTIFIER;
+}
+
+// 完美哈希查找：一次探测加一次 memcmp
+static TokenType lookup_perfect(const char* text, int length) {
+    if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) {
+        return TOKEN_IDENTIFIER;
+    }
+    const KeywordEntry* entry = &keyword_table[keyword_slot(text, length)];
+    if (entry->length == length && memcmp(entry->text, text, length) == 0) {
+        return entry->type;
+    }
+    return TOKEN_IDENTIFIER;
+}
+
+static double elapsed_seconds(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char* argv[]) {
+    int word_count = argc >= 2 ? atoi(argv[1]) : 2000000;
+    if (word_count <= 0) word_count = 2000000;
+
+    // 构造标识符密集的输入：约一半是关键字或类型名，一半是普通标识符
+    static const char* identifiers[] = {
+        "counter", "value", "result", "buffer", "index", "node", "left", "right",
+        "make_list", "helper_fn", "x", "tmp0", "length", "parse_item", "state", "next"
+    };
+    int identifier_count = (int)(sizeof(identifiers) / sizeof(identifiers[0]));
+
+    size_t capacity = (size_t)word_count * 12 + 1;
+    char* source = (char*)malloc(capacity);
+    int* offsets = (int*)malloc(sizeof(int) * word_count);
+    int* lengths = (int*)malloc(sizeof(int) * word_count);
+    if (!source || !offsets || !lengths) {
+        fprintf(stderr, "内存分配错误\n");
+        return 1;
+    }
+
+    size_t position = 0;
+    unsigned int seed = 12345;
+    for (int i = 0; i < word_count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        const char* word;
+        if ((seed >> 16) & 1) {
+            word = keyword_table[(seed >> 17) % KEYWORD_COUNT].text;
+        } else {
+            word = identifiers[(seed >> 17) % identifier_count];
+        }
+        int length = (int)strlen(word);
+        offsets[i] = (int)position;
+        lengths[i] = length;
+        memcpy(source + position, word, length);
+        position += length;
+        source[position++] = (i % 8 == 7) ? '\n' : ' ';
+    }
+    source[position] = '\0';
+
+    // 1. 单独比较两种关键字识别方式
+    long checksum = 0;
+    clock_t start = clock();
+    for (int i = 0; i < word_count; i++) {
+        checksum += lookup_linear(source + offsets[i], lengths[i]);
+    }
+    double linear_time = elapsed_seconds(start);
+
+    long perfect_checksum = 0;
+    start = clock();
+    for (int i = 0; i < word_count; i++) {
+        perfect_checksum += lookup_perfect(source + offsets[i], lengths[i]);
+    }
+    double perfect_time = elapsed_seconds(start);
+
+    if (checksum != perfect_checksum) {
+        fprintf(stderr, "错误：两种查找方式的结果不一致\n");
+        return 1;
+    }
+
+    // 2. 整个词法分析器的吞吐量
+    start = clock();
+    Lexer* lexer = create_lexer(source, (int)position);
+    TokenArray* tokens = tokenize(lexer);
+    double lex_time = elapsed_seconds(start);
+
+    printf("标识符数量:        %d\n", word_count);
+    printf("线性查找:          %.3f s (%.1f M次/秒)\n", linear_time, word_count / linear_time / 1e6);
+    printf("完美哈希查找:      %.3f s (%.1f M次/秒)\n", perfect_time, word_count / perfect_time / 1e6);
+    printf("加速比:            %.2fx\n", linear_time / perfect_time);
+    printf("词法分析:          %.3f s (%d 个标记, %.1f M标记/秒)\n",
+           lex_time, tokens ? tokens->count : 0, (tokens ? tokens->count : 0) / lex_time / 1e6);
+
+    destroy_token_array(tokens);
+    destroy_lexer(lexer);
+    free(source);
+    free(offsets);
+    free(lengths);
+    return 0;
+}
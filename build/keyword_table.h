@@ -0,0 +1,125 @@
+// 关键字最小完美哈希表
+// 由 src/tools/gen_keywords.c 根据 src/main/keywords.def 自动生成，请勿手动修改
+
+#ifndef KEYWORD_TABLE_H
+#define KEYWORD_TABLE_H
+
+#include "token_types.h"
+#include "keyword_hash.h"
+
+#define KEYWORD_COUNT 88
+#define KEYWORD_MIN_LENGTH 2
+#define KEYWORD_MAX_LENGTH 11
+#define KEYWORD_BUCKET_COUNT 45
+
+typedef struct {
+    const char* text;
+    int length;
+    TokenType type;
+} KeywordEntry;
+
+static const uint16_t keyword_displacements[KEYWORD_BUCKET_COUNT] = {
+    1, 0, 0, 1, 0, 1, 2, 8, 6, 12, 7, 6, 5, 1, 6, 8,
+    0, 3, 3, 5, 19, 1, 4, 6, 7, 1, 24, 4, 6, 9, 2, 1,
+    3, 12, 6, 1, 10, 2, 17, 3, 47, 5, 1, 4, 4
+};
+
+static const KeywordEntry keyword_table[KEYWORD_COUNT] = {
+    { "dynamic", 7, TOKEN_KEYWORD_DYNAMIC },
+    { "match", 5, TOKEN_KEYWORD_MATCH },
+    { "i8", 2, TOKEN_TYPE_I8 },
+    { "is", 2, TOKEN_KEYWORD_IS },
+    { "prot", 4, TOKEN_KEYWORD_PROT },
+    { "continue", 8, TOKEN_KEYWORD_CONTINUE },
+    { "u16", 3, TOKEN_TYPE_U16 },
+    { "obj", 3, TOKEN_KEYWORD_OBJ },
+    { "companion", 9, TOKEN_KEYWORD_COMPANION },
+    { "true", 4, TOKEN_KEYWORD_TRUE },
+    { "do", 2, TOKEN_KEYWORD_DO },
+    { "crate", 5, TOKEN_KEYWORD_CRATE },
+    { "annotation", 10, TOKEN_KEYWORD_ANNOTATION },
+    { "slice", 5, TOKEN_TYPE_SLICE },
+    { "yield", 5, TOKEN_KEYWORD_YIELD },
+    { "throw", 5, TOKEN_KEYWORD_THROW },
+    { "i128", 4, TOKEN_TYPE_I128 },
+    { "char", 4, TOKEN_TYPE_CHAR },
+    { "String", 6, TOKEN_TYPE_STRING },
+    { "as", 2, TOKEN_KEYWORD_AS },
+    { "struct", 6, TOKEN_KEYWORD_STRUCT },
+    { "float", 5, TOKEN_TYP_FLO },
+    { "const", 5, TOKEN_KEYWORD_CONST },
+    { "catch", 5, TOKEN_KEYWORD_CATCH },
+    { "f32", 3, TOKEN_TYPE_F32 },
+    { "include", 7, TOKEN_KEYWORD_INCLUDE },
+    { "u128", 4, TOKEN_TYPE_U128 },
+    { "when", 4, TOKEN_KEYWORD_WHEN },
+    { "else", 4, TOKEN_KEYWORD_ELSE },
+    { "i16", 3, TOKEN_TYPE_I16 },
+    { "u64", 3, TOKEN_TYPE_U64 },
+    { "operator", 8, TOKEN_KEYWORD_OPERATOR },
+    { "break", 5, TOKEN_KEYWORD_BREAK },
+    { "async", 5, TOKEN_KEYWORD_ASYNC },
+    { "use", 3, TOKEN_KEYWORD_USE },
+    { "f64", 3, TOKEN_TYPE_F64 },
+    { "i32", 3, TOKEN_TYPE_I32 },
+    { "impl", 4, TOKEN_KEYWORD_IMPL },
+    { "usize", 5, TOKEN_TYPE_USIZE },
+    { "pub", 3, TOKEN_KEYWORD_PUB },
+    { "public", 6, TOKEN_KEYWORD_PUBLIC },
+    { "u32", 3, TOKEN_TYPE_U32 },
+    { "priv", 4, TOKEN_KEYWORD_PRIV },
+    { "str", 3, TOKEN_TYPE_STR },
+    { "lateinit", 8, TOKEN_KEYWORD_LATEINIT },
+    { "override", 8, TOKEN_KEYWORD_OVERRIDE },
+    { "where", 5, TOKEN_KEYWORD_WHERE },
+    { "null", 4, TOKEN_KEYWORD_NULL },
+    { "array", 5, TOKEN_TYPE_ARRAY },
+    { "try", 3, TOKEN_KEYWORD_TRY },
+    { "class", 5, TOKEN_KEYWORD_CLASS },
+    { "for", 3, TOKEN_KEYWORD_FOR },
+    { "inter", 5, TOKEN_KEYWORD_INTER },
+    { "package", 7, TOKEN_KEYWORD_PACKAGE },
+    { "unsafe", 6, TOKEN_KEYWORD_UNSAFE },
+    { "fun", 3, TOKEN_KEYWORD_FUN },
+    { "super", 5, TOKEN_KEYWORD_SUPER },
+    { "var", 3, TOKEN_KEYWORD_VAR },
+    { "data", 4, TOKEN_KEYWORD_DATA },
+    { "type", 4, TOKEN_KEYWORD_TYPE },
+    { "return", 6, TOKEN_KEYWORD_RETURN },
+    { "private", 7, TOKEN_KEYWORD_PRIVATE },
+    { "int", 3, TOKEN_TYPE_INT },
+    { "final", 5, TOKEN_KEYWORD_FINAL },
+    { "crossinline", 11, TOKEN_KEYWORD_CROSSINLINE },
+    { "tuple", 5, TOKEN_TYPE_TUPLE },
+    { "flo", 3, TOKEN_TYP_FLO },
+    { "mod", 3, TOKEN_KEYWORD_MOD },
+    { "open", 4, TOKEN_KEYWORD_OPEN },
+    { "i64", 3, TOKEN_TYPE_I64 },
+    { "false", 5, TOKEN_KEYWORD_FALSE },
+    { "this", 4, TOKEN_KEYWORD_THIS },
+    { "sealed", 6, TOKEN_KEYWORD_SEALED },
+    { "unsized", 7, TOKEN_KEYWORD_UNSIZED },
+    { "finally", 7, TOKEN_KEYWORD_FINALLY },
+    { "enum", 4, TOKEN_KEYWORD_ENUM },
+    { "by", 2, TOKEN_KEYWORD_BY },
+    { "macro", 5, TOKEN_KEYWORD_MACRO },
+    { "if", 2, TOKEN_KEYWORD_IF },
+    { "isize", 5, TOKEN_TYPE_ISIZE },
+    { "while", 5, TOKEN_KEYWORD_WHILE },
+    { "in", 2, TOKEN_KEYWORD_IN },
+    { "actual", 6, TOKEN_KEYWORD_ACTUAL },
+    { "bool", 4, TOKEN_TYPE_BOOL },
+    { "val", 3, TOKEN_KEYWORD_VAL },
+    { "u8", 2, TOKEN_TYPE_U8 },
+    { "await", 5, TOKEN_KEYWORD_AWAIT },
+    { "tailrec", 7, TOKEN_KEYWORD_TAILREC },
+};
+
+// 计算关键字在表中的槽位（调用方需保证长度在 [KEYWORD_MIN_LENGTH, KEYWORD_MAX_LENGTH] 内）
+static inline uint32_t keyword_slot(const char* text, int length) {
+    uint32_t feature = keyword_feature(text, length);
+    uint32_t bucket = keyword_mix(feature, 0) % KEYWORD_BUCKET_COUNT;
+    return keyword_mix(feature, keyword_displacements[bucket]) % KEYWORD_COUNT;
+}
+
+#endif // KEYWORD_TABLE_H
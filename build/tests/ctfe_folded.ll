@@ -0,0 +1,17 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@FACT = constant i64 2432902008176640000
+@.str.1 = private unnamed_addr constant [12 x i8] c"hello, ctfe\00", align 1
+@GREETING = constant i8* getelementptr inbounds ([12 x i8], [12 x i8]* @.str.1, i64 0, i64 0)
+@.str.2 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %t1 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t2 = call i32 (i8*, ...) @printf(i8* %t1, i64 2432902008176640000)
+  %t3 = getelementptr inbounds [12 x i8], [12 x i8]* @.str.1, i64 0, i64 0
+  call void @println(i8* %t3)
+  ret i32 0
+}
@@ -0,0 +1,60 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %total.7 = alloca i64
+  store i64 0, i64* %total.7
+  %t1 = load i64, i64* %total.7
+  %t2 = add i64 %t1, 4045500
+  store i64 %t2, i64* %total.7
+  %t3 = load i64, i64* %total.7
+  %t4 = add i64 %t3, 4045500
+  store i64 %t4, i64* %total.7
+  %t5 = load i64, i64* %total.7
+  %t6 = add i64 %t5, 4045500
+  store i64 %t6, i64* %total.7
+  %t7 = load i64, i64* %total.7
+  %t8 = add i64 %t7, 4045500
+  store i64 %t8, i64* %total.7
+  %t9 = load i64, i64* %total.7
+  %t10 = add i64 %t9, 4045500
+  store i64 %t10, i64* %total.7
+  %t11 = load i64, i64* %total.7
+  %t12 = add i64 %t11, 4045500
+  store i64 %t12, i64* %total.7
+  %t13 = load i64, i64* %total.7
+  %t14 = add i64 %t13, 4045500
+  store i64 %t14, i64* %total.7
+  %t15 = load i64, i64* %total.7
+  %t16 = add i64 %t15, 4045500
+  store i64 %t16, i64* %total.7
+  %t17 = load i64, i64* %total.7
+  %t18 = add i64 %t17, 4045500
+  store i64 %t18, i64* %total.7
+  %t19 = load i64, i64* %total.7
+  %t20 = add i64 %t19, 4045500
+  store i64 %t20, i64* %total.7
+  %t21 = load i64, i64* %total.7
+  %t22 = add i64 %t21, 4045500
+  store i64 %t22, i64* %total.7
+  %t23 = load i64, i64* %total.7
+  %t24 = add i64 %t23, 4045500
+  store i64 %t24, i64* %total.7
+  %t25 = load i64, i64* %total.7
+  %t26 = add i64 %t25, 4045500
+  store i64 %t26, i64* %total.7
+  %t27 = load i64, i64* %total.7
+  %t28 = add i64 %t27, 4045500
+  store i64 %t28, i64* %total.7
+  %t29 = load i64, i64* %total.7
+  %t30 = add i64 %t29, 4045500
+  store i64 %t30, i64* %total.7
+  %t31 = load i64, i64* %total.7
+  %t32 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t33 = call i32 (i8*, ...) @printf(i8* %t32, i64 %t31)
+  ret i32 0
+}
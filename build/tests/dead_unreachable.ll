@@ -0,0 +1,67 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@start = global i64 0
+@.str.1 = private unnamed_addr constant [5 x i8] c"seed\00", align 1
+@.str.2 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i64 @seed(i64 %arg.9) {
+entry:
+  %x.9 = alloca i64
+  store i64 %arg.9, i64* %x.9
+  %t1 = getelementptr inbounds [5 x i8], [5 x i8]* @.str.1, i64 0, i64 0
+  call void @println(i8* %t1)
+  %t2 = load i64, i64* %x.9
+  %t3 = mul i64 %t2, 10
+  ret i64 %t3
+}
+
+define i64 @helper(i64 %arg.18) {
+entry:
+  %x.18 = alloca i64
+  store i64 %arg.18, i64* %x.18
+  %t1 = load i64, i64* %x.18
+  %t2 = add i64 %t1, 1
+  ret i64 %t2
+}
+
+define i64 @used(i64 %arg.25) {
+entry:
+  %x.25 = alloca i64
+  store i64 %arg.25, i64* %x.25
+  %t1 = load i64, i64* %x.25
+  %t2 = call i64 @helper(i64 %t1)
+  %t3 = mul i64 %t2, 2
+  ret i64 %t3
+}
+
+define i64 @exported(i64 %arg.33) {
+entry:
+  %x.33 = alloca i64
+  store i64 %arg.33, i64* %x.33
+  %t1 = load i64, i64* %x.33
+  %t2 = mul i64 %t1, 3
+  ret i64 %t2
+}
+
+define i32 @main() {
+entry:
+  %t1 = load i64, i64* @start
+  %t2 = add i64 %t1, 1
+  store i64 %t2, i64* @start
+  %t3 = load i64, i64* @start
+  %t4 = call i64 @used(i64 %t3)
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 %t4)
+  ret i32 0
+}
+
+define internal void @scp.init() {
+entry:
+  %t1 = call i64 @seed(i64 4)
+  store i64 %t1, i64* @start
+  ret void
+}
+
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @scp.init, i8* null }]
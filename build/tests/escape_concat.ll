@@ -0,0 +1,119 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [5 x i8] c"item\00", align 1
+@prefix = global i8* getelementptr inbounds ([5 x i8], [5 x i8]* @.str.1, i64 0, i64 0)
+@.str.2 = private unnamed_addr constant [3 x i8] c": \00", align 1
+@.str.3 = private unnamed_addr constant [2 x i8] c"-\00", align 1
+@.str.4 = private unnamed_addr constant [3 x i8] c"id\00", align 1
+@.str.5 = private unnamed_addr constant [6 x i8] c"alpha\00", align 1
+@.str.6 = private unnamed_addr constant [5 x i8] c"beta\00", align 1
+@.str.7 = private unnamed_addr constant [2 x i8] c"!\00", align 1
+@.str.8 = private unnamed_addr constant [2 x i8] c"+\00", align 1
+declare i64 @strlen(i8*)
+declare i8* @malloc(i64)
+declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)
+
+define void @show(i8* %arg.8) {
+entry:
+  %name.8 = alloca i8*
+  %label.10 = alloca i8*
+  %concat.12 = alloca [256 x i8]
+  %concat.11 = alloca [256 x i8]
+  store i8* %arg.8, i8** %name.8
+  %t1 = load i8*, i8** @prefix
+  %t2 = getelementptr inbounds [3 x i8], [3 x i8]* @.str.2, i64 0, i64 0
+  %t4 = getelementptr inbounds [256 x i8], [256 x i8]* %concat.12, i64 0, i64 0
+  %t3 = call i8* @scp.concat.into(i8* %t1, i8* %t2, i8* %t4, i64 256)
+  %t5 = load i8*, i8** %name.8
+  %t7 = getelementptr inbounds [256 x i8], [256 x i8]* %concat.11, i64 0, i64 0
+  %t6 = call i8* @scp.concat.into(i8* %t3, i8* %t5, i8* %t7, i64 256)
+  store i8* %t6, i8** %label.10
+  %t8 = load i8*, i8** %label.10
+  call void @println(i8* %t8)
+  ret void
+}
+
+define i8* @make(i8* %arg.19) {
+entry:
+  %name.19 = alloca i8*
+  %concat.23 = alloca [256 x i8]
+  store i8* %arg.19, i8** %name.19
+  %t1 = load i8*, i8** @prefix
+  %t2 = getelementptr inbounds [2 x i8], [2 x i8]* @.str.3, i64 0, i64 0
+  %t4 = getelementptr inbounds [256 x i8], [256 x i8]* %concat.23, i64 0, i64 0
+  %t3 = call i8* @scp.concat.into(i8* %t1, i8* %t2, i8* %t4, i64 256)
+  %t5 = load i8*, i8** %name.19
+  %t6 = call i8* @scp.concat(i8* %t3, i8* %t5)
+  ret i8* %t6
+}
+
+define i32 @main() {
+entry:
+  %made.34 = alloca i8*
+  %i.39 = alloca i64
+  %line.46 = alloca i8*
+  %concat.47 = alloca [256 x i8]
+  %t1 = getelementptr inbounds [3 x i8], [3 x i8]* @.str.4, i64 0, i64 0
+  store i8* %t1, i8** @prefix
+  %t2 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.5, i64 0, i64 0
+  call void @show(i8* %t2)
+  %t3 = getelementptr inbounds [5 x i8], [5 x i8]* @.str.6, i64 0, i64 0
+  %t4 = call i8* @make(i8* %t3)
+  store i8* %t4, i8** %made.34
+  %t5 = load i8*, i8** %made.34
+  call void @println(i8* %t5)
+  store i64 0, i64* %i.39
+  br label %L1
+L1:
+  %t6 = load i64, i64* %i.39
+  %t7 = icmp slt i64 %t6, 2
+  br i1 %t7, label %L2, label %L3
+L2:
+  %t8 = load i8*, i8** %made.34
+  %t9 = getelementptr inbounds [2 x i8], [2 x i8]* @.str.7, i64 0, i64 0
+  %t11 = getelementptr inbounds [256 x i8], [256 x i8]* %concat.47, i64 0, i64 0
+  %t10 = call i8* @scp.concat.into(i8* %t8, i8* %t9, i8* %t11, i64 256)
+  store i8* %t10, i8** %line.46
+  %t12 = load i8*, i8** %line.46
+  call void @println(i8* %t12)
+  %t13 = load i64, i64* %i.39
+  %t14 = add i64 %t13, 1
+  store i64 %t14, i64* %i.39
+  br label %L1
+L3:
+  %t15 = load i8*, i8** %made.34
+  %t16 = getelementptr inbounds [2 x i8], [2 x i8]* @.str.8, i64 0, i64 0
+  %t17 = call i8* @scp.concat(i8* %t15, i8* %t16)
+  store i8* %t17, i8** @prefix
+  %t18 = load i8*, i8** @prefix
+  call void @println(i8* %t18)
+  ret i32 0
+}
+
+define internal i8* @scp.concat(i8* %a, i8* %b) {
+entry:
+  %r = call i8* @scp.concat.into(i8* %a, i8* %b, i8* null, i64 0)
+  ret i8* %r
+}
+
+define internal i8* @scp.concat.into(i8* %a, i8* %b, i8* %buffer, i64 %capacity) {
+entry:
+  %la = call i64 @strlen(i8* %a)
+  %lb = call i64 @strlen(i8* %b)
+  %n = add i64 %la, %lb
+  %size = add i64 %n, 1
+  %fits = icmp ule i64 %size, %capacity
+  br i1 %fits, label %copy, label %heap
+heap:
+  %h = call i8* @malloc(i64 %size)
+  br label %copy
+copy:
+  %r = phi i8* [ %buffer, %entry ], [ %h, %heap ]
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %r, i8* %a, i64 %la, i1 false)
+  %end = getelementptr inbounds i8, i8* %r, i64 %la
+  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %end, i8* %b, i64 %lb, i1 false)
+  %z = getelementptr inbounds i8, i8* %r, i64 %n
+  store i8 0, i8* %z
+  ret i8* %r
+}
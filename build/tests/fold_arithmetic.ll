@@ -0,0 +1,29 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@WIDTH = constant i64 43
+@SMALL = constant i8 100
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+@.str.2 = private unnamed_addr constant [4 x i8] c"%g\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %area.11 = alloca i64
+  %wrapped.13 = alloca i8
+  %shifted.15 = alloca i64
+  %ratio.17 = alloca double
+  store i64 80, i64* %area.11
+  store i8 -56, i8* %wrapped.13
+  store i64 1024, i64* %shifted.15
+  store double 0x400C000000000000, double* %ratio.17
+  %t1 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t2 = call i32 (i8*, ...) @printf(i8* %t1, i64 80)
+  %t3 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t4 = call i32 (i8*, ...) @printf(i8* %t3, i64 -56)
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 1024)
+  %t7 = getelementptr inbounds [4 x i8], [4 x i8]* @.str.2, i64 0, i64 0
+  %t8 = call i32 (i8*, ...) @printf(i8* %t7, double 0x400C000000000000)
+  ret i32 0
+}
@@ -0,0 +1,25 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@LEVEL = constant i8 3
+@LIMIT = constant i32 300
+@HIGH = constant i8 -6
+@.str.1 = private unnamed_addr constant [12 x i8] c"level three\00", align 1
+@.str.2 = private unnamed_addr constant [6 x i8] c"%llu\0A\00", align 1
+@.str.3 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %copy.13 = alloca i8
+  store i8 3, i8* %copy.13
+  %t1 = getelementptr inbounds [12 x i8], [12 x i8]* @.str.1, i64 0, i64 0
+  call void @println(i8* %t1)
+  %t2 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t3 = call i32 (i8*, ...) @printf(i8* %t2, i64 3)
+  %t4 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t5 = call i32 (i8*, ...) @printf(i8* %t4, i64 4)
+  %t6 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.3, i64 0, i64 0
+  %t7 = call i32 (i8*, ...) @printf(i8* %t6, i64 300)
+  ret i32 0
+}
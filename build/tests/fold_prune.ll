@@ -0,0 +1,22 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@DEBUG = constant i1 false
+@VERBOSE = constant i1 true
+@.str.1 = private unnamed_addr constant [8 x i8] c"verbose\00", align 1
+@.str.2 = private unnamed_addr constant [8 x i8] c"checked\00", align 1
+@.str.3 = private unnamed_addr constant [9 x i8] c"fallback\00", align 1
+
+define i32 @main() {
+entry:
+  %name.17 = alloca i8*
+  %t1 = getelementptr inbounds [8 x i8], [8 x i8]* @.str.1, i64 0, i64 0
+  call void @println(i8* %t1)
+  %t2 = getelementptr inbounds [8 x i8], [8 x i8]* @.str.2, i64 0, i64 0
+  call void @println(i8* %t2)
+  %t3 = getelementptr inbounds [9 x i8], [9 x i8]* @.str.3, i64 0, i64 0
+  store i8* %t3, i8** %name.17
+  %t4 = getelementptr inbounds [9 x i8], [9 x i8]* @.str.3, i64 0, i64 0
+  call void @println(i8* %t4)
+  ret i32 0
+}
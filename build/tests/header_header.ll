@@ -0,0 +1,23 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+declare i64 @twice(i64)
+@LIMIT = external global i64
+@hits = external global i64
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %t1 = load i64, i64* @LIMIT
+  %t2 = call i64 @twice(i64 %t1)
+  %t3 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t4 = call i32 (i8*, ...) @printf(i8* %t3, i64 %t2)
+  %t5 = load i64, i64* @hits
+  %t6 = add i64 %t5, 10
+  store i64 %t6, i64* @hits
+  %t7 = load i64, i64* @hits
+  %t8 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t9 = call i32 (i8*, ...) @printf(i8* %t8, i64 %t7)
+  ret i32 0
+}
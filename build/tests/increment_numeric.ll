@@ -0,0 +1,47 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+@.str.2 = private unnamed_addr constant [6 x i8] c"%llu\0A\00", align 1
+@.str.3 = private unnamed_addr constant [4 x i8] c"%g\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %x.7 = alloca i8
+  %f.11 = alloca double
+  %k.15 = alloca i64
+  store i8 -1, i8* %x.7
+  %t1 = load i8, i8* %x.7
+  %t2 = add i8 %t1, 1
+  store i8 %t2, i8* %x.7
+  store double 0x3FF8000000000000, double* %f.11
+  %t3 = load double, double* %f.11
+  %t4 = fadd double %t3, 0x3FF0000000000000
+  store double %t4, double* %f.11
+  store i64 0, i64* %k.15
+  br label %L1
+L1:
+  %t5 = load i64, i64* %k.15
+  %t6 = icmp slt i64 %t5, 2
+  br i1 %t6, label %L2, label %L4
+L2:
+  %t7 = load i64, i64* %k.15
+  %t8 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t9 = call i32 (i8*, ...) @printf(i8* %t8, i64 %t7)
+  br label %L3
+L3:
+  %t10 = load i64, i64* %k.15
+  %t11 = add i64 %t10, 1
+  store i64 %t11, i64* %k.15
+  br label %L1
+L4:
+  %t12 = load i8, i8* %x.7
+  %t13 = zext i8 %t12 to i64
+  %t14 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t15 = call i32 (i8*, ...) @printf(i8* %t14, i64 %t13)
+  %t16 = load double, double* %f.11
+  %t17 = getelementptr inbounds [4 x i8], [4 x i8]* @.str.3, i64 0, i64 0
+  %t18 = call i32 (i8*, ...) @printf(i8* %t17, double %t16)
+  ret i32 0
+}
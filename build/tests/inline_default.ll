@@ -0,0 +1,58 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i64 @mix(i64 %arg.6, i64 %arg.7) {
+entry:
+  %a.6 = alloca i64
+  %b.7 = alloca i64
+  store i64 %arg.6, i64* %a.6
+  store i64 %arg.7, i64* %b.7
+  %t1 = load i64, i64* %a.6
+  %t2 = mul i64 %t1, 3
+  %t3 = load i64, i64* %b.7
+  %t4 = mul i64 %t3, 5
+  %t5 = add i64 %t2, %t4
+  %t6 = load i64, i64* %a.6
+  %t7 = load i64, i64* %b.7
+  %t8 = mul i64 %t6, %t7
+  %t9 = sub i64 %t5, %t8
+  %t10 = add i64 %t9, 7
+  %t11 = load i64, i64* %a.6
+  %t12 = load i64, i64* %b.7
+  %t13 = sub i64 %t11, %t12
+  %t14 = mul i64 %t10, %t13
+  %t15 = load i64, i64* %a.6
+  %t16 = load i64, i64* %b.7
+  %t17 = add i64 %t15, %t16
+  %t18 = load i64, i64* %a.6
+  %t19 = add i64 %t18, 1
+  %t20 = mul i64 %t17, %t19
+  %t21 = add i64 %t14, %t20
+  ret i64 %t21
+}
+
+define i32 @main() {
+entry:
+  %n.37 = alloca i64
+  store i64 6, i64* %n.37
+  %t1 = load i64, i64* %n.37
+  %t2 = add i64 %t1, 1
+  store i64 %t2, i64* %n.37
+  %t3 = load i64, i64* %n.37
+  %t4 = mul i64 %t3, 2
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 %t4)
+  %t7 = load i64, i64* %n.37
+  %t8 = load i64, i64* %n.37
+  %t9 = mul i64 %t7, %t8
+  %t10 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t11 = call i32 (i8*, ...) @printf(i8* %t10, i64 %t9)
+  %t12 = load i64, i64* %n.37
+  %t13 = call i64 @mix(i64 %t12, i64 2)
+  %t14 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t15 = call i32 (i8*, ...) @printf(i8* %t14, i64 %t13)
+  ret i32 0
+}
@@ -0,0 +1,42 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i32 @main() {
+entry:
+  %n.7 = alloca i64
+  store i64 6, i64* %n.7
+  %t1 = load i64, i64* %n.7
+  %t2 = add i64 %t1, 1
+  store i64 %t2, i64* %n.7
+  %t3 = load i64, i64* %n.7
+  %t4 = mul i64 %t3, 2
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 %t4)
+  %t7 = load i64, i64* %n.7
+  %t8 = load i64, i64* %n.7
+  %t9 = mul i64 %t7, %t8
+  %t10 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t11 = call i32 (i8*, ...) @printf(i8* %t10, i64 %t9)
+  %t12 = load i64, i64* %n.7
+  %t13 = mul i64 %t12, 3
+  %t14 = add i64 %t13, 10
+  %t15 = load i64, i64* %n.7
+  %t16 = mul i64 %t15, 2
+  %t17 = sub i64 %t14, %t16
+  %t18 = add i64 %t17, 7
+  %t19 = load i64, i64* %n.7
+  %t20 = sub i64 %t19, 2
+  %t21 = mul i64 %t18, %t20
+  %t22 = load i64, i64* %n.7
+  %t23 = add i64 %t22, 2
+  %t24 = load i64, i64* %n.7
+  %t25 = add i64 %t24, 1
+  %t26 = mul i64 %t23, %t25
+  %t27 = add i64 %t21, %t26
+  %t28 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t29 = call i32 (i8*, ...) @printf(i8* %t28, i64 %t27)
+  ret i32 0
+}
@@ -0,0 +1,94 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+@.str.2 = private unnamed_addr constant [5 x i8] c"true\00", align 1
+@.str.3 = private unnamed_addr constant [6 x i8] c"false\00", align 1
+@.str.4 = private unnamed_addr constant [4 x i8] c"%s\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i64 @sum(i64 %arg.6, i64 %arg.7) {
+entry:
+  %n.6 = alloca i64
+  %acc.7 = alloca i64
+  store i64 %arg.6, i64* %n.6
+  store i64 %arg.7, i64* %acc.7
+  br label %tailrec
+tailrec:
+  %t1 = load i64, i64* %n.6
+  %t2 = icmp eq i64 %t1, 0
+  br i1 %t2, label %L1, label %L2
+L1:
+  %t3 = load i64, i64* %acc.7
+  ret i64 %t3
+L2:
+  %t4 = load i64, i64* %n.6
+  %t5 = sub i64 %t4, 1
+  %t6 = load i64, i64* %acc.7
+  %t7 = load i64, i64* %n.6
+  %t8 = add i64 %t6, %t7
+  store i64 %t5, i64* %n.6
+  store i64 %t8, i64* %acc.7
+  br label %tailrec
+}
+
+define i1 @is_even(i64 %arg.25) {
+entry:
+  %n.25 = alloca i64
+  store i64 %arg.25, i64* %n.25
+  %t1 = load i64, i64* %n.25
+  %t2 = icmp eq i64 %t1, 0
+  br i1 %t2, label %L1, label %L2
+L1:
+  ret i1 true
+L2:
+  %t3 = load i64, i64* %n.25
+  %t4 = sub i64 %t3, 1
+  %t5 = musttail call i1 @is_odd(i64 %t4)
+  ret i1 %t5
+}
+
+define i1 @is_odd(i64 %arg.40) {
+entry:
+  %n.40 = alloca i64
+  store i64 %arg.40, i64* %n.40
+  %t1 = load i64, i64* %n.40
+  %t2 = icmp eq i64 %t1, 0
+  br i1 %t2, label %L1, label %L2
+L1:
+  ret i1 false
+L2:
+  %t3 = load i64, i64* %n.40
+  %t4 = sub i64 %t3, 1
+  %t5 = musttail call i1 @is_even(i64 %t4)
+  ret i1 %t5
+}
+
+define i32 @main() {
+entry:
+  %n.56 = alloca i64
+  store i64 1000000, i64* %n.56
+  %t1 = load i64, i64* %n.56
+  %t2 = add i64 %t1, 0
+  store i64 %t2, i64* %n.56
+  %t3 = load i64, i64* %n.56
+  %t4 = call i64 @sum(i64 %t3, i64 0)
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 %t4)
+  %t7 = load i64, i64* %n.56
+  %t8 = call i1 @is_even(i64 %t7)
+  %t9 = getelementptr inbounds [5 x i8], [5 x i8]* @.str.2, i64 0, i64 0
+  %t10 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.3, i64 0, i64 0
+  %t11 = select i1 %t8, i8* %t9, i8* %t10
+  %t12 = getelementptr inbounds [4 x i8], [4 x i8]* @.str.4, i64 0, i64 0
+  %t13 = call i32 (i8*, ...) @printf(i8* %t12, i8* %t11)
+  %t14 = load i64, i64* %n.56
+  %t15 = add i64 %t14, 1
+  %t16 = call i1 @is_odd(i64 %t15)
+  %t17 = getelementptr inbounds [5 x i8], [5 x i8]* @.str.2, i64 0, i64 0
+  %t18 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.3, i64 0, i64 0
+  %t19 = select i1 %t16, i8* %t17, i8* %t18
+  %t20 = getelementptr inbounds [4 x i8], [4 x i8]* @.str.4, i64 0, i64 0
+  %t21 = call i32 (i8*, ...) @printf(i8* %t20, i8* %t19)
+  ret i32 0
+}
@@ -0,0 +1,32 @@
+; 生成的LLVM IR代码
+
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [6 x i8] c"%llu\0A\00", align 1
+declare i32 @printf(i8*, ...)
+
+define i8 @narrow(i64 %arg.6, i8* %arg.7) {
+entry:
+  %x.6 = alloca i64
+  %pair.7 = alloca i8*
+  %y.9 = alloca i8
+  store i64 %arg.6, i64* %x.6
+  store i8* %arg.7, i8** %pair.7
+  store i8 -56, i8* %y.9
+  %t1 = load i8, i8* %y.9
+  ret i8 %t1
+}
+
+define i32 @main() {
+entry:
+  %n.15 = alloca i8*
+  %limit.17 = alloca i16
+  store i8* null, i8** %n.15
+  store i16 7, i16* %limit.17
+  %t1 = call i8 @narrow(i64 1, i8* null)
+  %t2 = zext i8 %t1 to i64
+  %t3 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t4 = call i32 (i8*, ...) @printf(i8* %t3, i64 %t2)
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.1, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 7)
+  ret i32 0
+}
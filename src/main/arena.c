@@ -0,0 +1,146 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT 16
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+// 内存块结构，数据紧跟在结构体之后
+struct ArenaChunk {
+    ArenaChunk* next;      // 上一个已用满的内存块
+    size_t capacity;       // 数据区容量
+    size_t offset;         // 下一次分配的起始位置
+};
+
+// 已归还的对象，链接信息写在对象自身的内存中（对象至少 16 字节）
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t size;           // 对象大小（对齐后）
+};
+
+#define CHUNK_HEADER_SIZE ((sizeof(ArenaChunk) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+static ArenaChunk* create_chunk(size_t capacity, ArenaChunk* next) {
+    ArenaChunk* chunk = (ArenaChunk*)malloc(CHUNK_HEADER_SIZE + capacity);
+    if (chunk) {
+        chunk->next = next;
+        chunk->capacity = capacity;
+        chunk->offset = 0;
+    }
+    return chunk;
+}
+
+// 创建区域分配器
+Arena* create_arena(size_t chunk_size) {
+    Arena* arena = (Arena*)malloc(sizeof(Arena));
+    if (arena) {
+        arena->head = NULL;
+        arena->chunk_size = chunk_size ? chunk_size : ARENA_DEFAULT_CHUNK_SIZE;
+        arena->used = 0;
+        memset(arena->free_blocks, 0, sizeof(arena->free_blocks));
+        arena->large_blocks = NULL;
+    }
+    return arena;
+}
+
+// 取出一个可以容纳 size 字节的已归还对象，没有时返回 NULL。
+// 同类的对象大小相同；更大的对象取第一个足够大的，多出的部分随之占用
+static void* reuse_block(Arena* arena, size_t size) {
+    size_t size_class = size / ARENA_ALIGNMENT - 1;
+    ArenaBlock** link = size_class < ARENA_SIZE_CLASSES ? &arena->free_blocks[size_class] : &arena->large_blocks;
+    while (*link && (*link)->size < size) {
+        link = &(*link)->next;
+    }
+    ArenaBlock* block = *link;
+    if (block) {
+        *link = block->next;
+        arena->used += block->size;
+    }
+    return block;
+}
+
+// 分配 size 字节（按16字节对齐）
+void* arena_alloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (size > 0) {
+        void* reused = reuse_block(arena, size);
+        if (reused) return reused;
+    }
+
+    ArenaChunk* chunk = arena->head;
+    if (!chunk || chunk->capacity - chunk->offset < size) {
+        // 超大对象单独占用一个内存块，不打断当前块的顺序分配
+        if (size > arena->chunk_size / 4 && chunk) {
+            ArenaChunk* large = create_chunk(size, chunk->next);
+            if (!large) return NULL;
+            chunk->next = large;
+            large->offset = size;
+            arena->used += size;
+            return (char*)large + CHUNK_HEADER_SIZE;
+        }
+        size_t capacity = size > arena->chunk_size ? size : arena->chunk_size;
+        chunk = create_chunk(capacity, arena->head);
+        if (!chunk) return NULL;
+        arena->head = chunk;
+    }
+
+    void* memory = (char*)chunk + CHUNK_HEADER_SIZE + chunk->offset;
+    chunk->offset += size;
+    arena->used += size;
+    return memory;
+}
+
+// 在区域中复制一段字符串并以 '\0' 结尾
+char* arena_strndup(Arena* arena, const char* text, size_t length) {
+    char* copy = (char*)arena_alloc(arena, length + 1);
+    if (copy) {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+// 归还对象：挂到对应大小的链表上，等待 arena_alloc 复用（内存仍属于区域，销毁时一并释放）
+void arena_free(Arena* arena, void* memory, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (!arena || !memory || size == 0) return;
+    size_t size_class = size / ARENA_ALIGNMENT - 1;
+    ArenaBlock** list = size_class < ARENA_SIZE_CLASSES ? &arena->free_blocks[size_class] : &arena->large_blocks;
+    ArenaBlock* block = (ArenaBlock*)memory;
+    block->size = size;
+    block->next = *list;
+    *list = block;
+    arena->used -= size;
+}
+
+// 接管另一个区域分配器的内存块。other 的块挂在当前块之后，arena 仍从自己的当前块继续分配
+void arena_adopt(Arena* arena, Arena* other) {
+    if (!other) return;
+    if (other->head) {
+        ArenaChunk* tail = other->head;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        if (arena->head) {
+            tail->next = arena->head->next;
+            arena->head->next = other->head;
+        } else {
+            arena->head = other->head;
+        }
+        arena->used += other->used;
+    }
+    free(other);
+}
+
+// 销毁区域分配器，一次性释放其中的全部对象
+void destroy_arena(Arena* arena) {
+    if (!arena) return;
+
+    ArenaChunk* chunk = arena->head;
+    while (chunk) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
@@ -0,0 +1,35 @@
+// 区域分配器（Bump Arena）头文件
+// 从大块内存中顺序切分小对象，销毁时一次性归还全部内存。
+// 单个对象可以归还给区域（arena_free），之后同样大小的分配优先复用它。
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct ArenaChunk ArenaChunk;
+typedef struct ArenaBlock ArenaBlock;
+
+// 按大小分类复用的已归还对象：16 字节为一类，共 ARENA_SIZE_CLASSES 类，更大的对象放在同一个链表中
+#define ARENA_SIZE_CLASSES 32
+
+// 区域分配器结构
+typedef struct {
+    ArenaChunk* head;      // 当前正在分配的内存块（链表头）
+    size_t chunk_size;     // 新内存块的默认大小
+    size_t used;           // 已分配的字节数（统计用）
+    ArenaBlock* free_blocks[ARENA_SIZE_CLASSES];  // 已归还的对象，按大小分类
+    ArenaBlock* large_blocks;                      // 已归还的更大的对象
+} Arena;
+
+// 函数原型
+Arena* create_arena(size_t chunk_size);
+void* arena_alloc(Arena* arena, size_t size);
+char* arena_strndup(Arena* arena, const char* text, size_t length);
+// 归还一个由 arena_alloc 分配、大小为 size 的对象
+void arena_free(Arena* arena, void* memory, size_t size);
+// 接管 other 的全部内存块（其中的对象在 arena 销毁前保持有效），然后销毁 other
+void arena_adopt(Arena* arena, Arena* other);
+void destroy_arena(Arena* arena);
+
+#endif // ARENA_H
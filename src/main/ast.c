@@ -2,159 +2,29 @@
 #include <stdlib.h>
 #include <string.h>
 
-// 创建AST节点
-ASTNode* create_ast_node(ASTNodeType type) {
-    ASTNode* node = (ASTNode*)malloc(sizeof(ASTNode));
+// 创建AST节点（所有字段清零，节点由 arena 统一管理，无需单独释放）
+ASTNode* create_ast_node(Arena* arena, ASTNodeType type) {
+    ASTNode* node = (ASTNode*)arena_alloc(arena, sizeof(ASTNode));
     if (node) {
+        memset(node, 0, sizeof(ASTNode));
         node->type = type;
-        node->line = 0;
-        node->column = 0;
-        
-        // 根据节点类型初始化
-        switch (type) {
-            case NODE_PROGRAM:
-                node->program.declarations = NULL;
-                node->program.declaration_count = 0;
-                break;
-            case NODE_FUNCTION:
-                node->function.name = NULL;
-                node->function.parameters = NULL;
-                node->function.param_count = 0;
-                node->function.body = NULL;
-                node->function.return_type = NULL;
-                break;
-            case NODE_FUNCTION_CALL:
-                node->call.name = NULL;
-                node->call.arguments = NULL;
-                node->call.arg_count = 0;
-                break;
-            case NODE_VARIABLE_DECL:
-                node->var_decl.name = NULL;
-                node->var_decl.type = NULL;
-                node->var_decl.initializer = NULL;
-                break;
-            case NODE_VARIABLE:
-                node->variable.name = NULL;
-                break;
-            case NODE_LITERAL:
-                // 字面量值将在创建后设置
-                break;
-            case NODE_BINARY_OP:
-                node->binary_op.left = NULL;
-                node->binary_op.right = NULL;
-                break;
-            case NODE_UNARY_OP:
-                node->unary_op.operand = NULL;
-                break;
-            case NODE_IF_STATEMENT:
-                node->if_stmt.condition = NULL;
-                node->if_stmt.then_branch = NULL;
-                node->if_stmt.else_branch = NULL;
-                break;
-            case NODE_WHILE_STATEMENT:
-                node->while_stmt.condition = NULL;
-                node->while_stmt.body = NULL;
-                break;
-            case NODE_RETURN:
-                node->return_stmt.expression = NULL;
-                break;
-            case NODE_BLOCK:
-                node->block.statements = NULL;
-                node->block.statement_count = 0;
-                break;
-            case NODE_INCLUDE:
-                node->include.filename = NULL;
-                break;
-        }
     }
     return node;
 }
 
-// 销毁AST节点
-void destroy_ast_node(ASTNode* node) {
-    if (!node) return;
-    
-    // 根据节点类型释放资源
-    switch (node->type) {
-        case NODE_PROGRAM:
-            if (node->program.declarations) {
-                for (int i = 0; i < node->program.declaration_count; i++) {
-                    destroy_ast_node(node->program.declarations[i]);
-                }
-                free(node->program.declarations);
-            }
-            break;
-        case NODE_FUNCTION:
-            if (node->function.name) free(node->function.name);
-            if (node->function.return_type) free(node->function.return_type);
-            if (node->function.parameters) {
-                for (int i = 0; i < node->function.param_count; i++) {
-                    destroy_ast_node(node->function.parameters[i]);
-                }
-                free(node->function.parameters);
-            }
-            if (node->function.body) destroy_ast_node(node->function.body);
-            break;
-        case NODE_FUNCTION_CALL:
-            if (node->call.name) free(node->call.name);
-            if (node->call.arguments) {
-                for (int i = 0; i < node->call.arg_count; i++) {
-                    destroy_ast_node(node->call.arguments[i]);
-                }
-                free(node->call.arguments);
-            }
-            break;
-        case NODE_VARIABLE_DECL:
-            if (node->var_decl.name) free(node->var_decl.name);
-            if (node->var_decl.type) free(node->var_decl.type);
-            if (node->var_decl.initializer) destroy_ast_node(node->var_decl.initializer);
-            break;
-        case NODE_VARIABLE:
-            if (node->variable.name) free(node->variable.name);
-            break;
-        case NODE_LITERAL:
-            if (node->literal.type == LITERAL_STRING && node->literal.string_value) {
-                free(node->literal.string_value);
-            }
-            break;
-        case NODE_BINARY_OP:
-            if (node->binary_op.left) destroy_ast_node(node->binary_op.left);
-            if (node->binary_op.right) destroy_ast_node(node->binary_op.right);
-            break;
-        case NODE_UNARY_OP:
-            if (node->unary_op.operand) destroy_ast_node(node->unary_op.operand);
-            break;
-        case NODE_IF_STATEMENT:
-            if (node->if_stmt.condition) destroy_ast_node(node->if_stmt.condition);
-            if (node->if_stmt.then_branch) destroy_ast_node(node->if_stmt.then_branch);
-            if (node->if_stmt.else_branch) destroy_ast_node(node->if_stmt.else_branch);
-            break;
-        case NODE_WHILE_STATEMENT:
-            if (node->while_stmt.condition) destroy_ast_node(node->while_stmt.condition);
-            if (node->while_stmt.body) destroy_ast_node(node->while_stmt.body);
-            break;
-        case NODE_RETURN:
-            if (node->return_stmt.expression) destroy_ast_node(node->return_stmt.expression);
-            break;
-        case NODE_BLOCK:
-            if (node->block.statements) {
-                for (int i = 0; i < node->block.statement_count; i++) {
-                    destroy_ast_node(node->block.statements[i]);
-                }
-                free(node->block.statements);
-            }
-            break;
-        case NODE_INCLUDE:
-            if (node->include.filename) free(node->include.filename);
-            break;
+// 把临时收集的子节点指针复制到 arena 中，紧跟在已分配的节点之后
+ASTNode** copy_ast_nodes(Arena* arena, ASTNode** nodes, int count) {
+    if (count <= 0) return NULL;
+    ASTNode** copy = (ASTNode**)arena_alloc(arena, sizeof(ASTNode*) * count);
+    if (copy) {
+        memcpy(copy, nodes, sizeof(ASTNode*) * count);
     }
-    
-    free(node);
+    return copy;
 }
 
 // 创建整数字面量节点
-ASTNode* create_int_literal(int value) {
-    ASTNode* node = create_ast_node(NODE_LITERAL);
+ASTNode* create_int_literal(Arena* arena, long long value) {
+    ASTNode* node = create_ast_node(arena, NODE_LITERAL);
     if (node) {
         node->literal.type = LITERAL_INT;
         node->literal.int_value = value;
@@ -163,8 +33,8 @@ ASTNode* create_int_literal(int value) {
 }
 
 // 创建浮点数字面量节点
-ASTNode* create_float_literal(float value) {
-    ASTNode* node = create_ast_node(NODE_LITERAL);
+ASTNode* create_float_literal(Arena* arena, double value) {
+    ASTNode* node = create_ast_node(arena, NODE_LITERAL);
     if (node) {
         node->literal.type = LITERAL_FLOAT;
         node->literal.float_value = value;
@@ -172,19 +42,19 @@ ASTNode* create_float_literal(float value) {
     return node;
 }
 
-// 创建字符串字面量节点
-ASTNode* create_string_literal(const char* value) {
-    ASTNode* node = create_ast_node(NODE_LITERAL);
+// 创建字符串字面量节点（value 为引号之间的原始文本，转义序列保持原样）
+ASTNode* create_string_literal(Arena* arena, const char* value, int length) {
+    ASTNode* node = create_ast_node(arena, NODE_LITERAL);
     if (node) {
         node->literal.type = LITERAL_STRING;
-        node->literal.string_value = strdup(value);
+        node->literal.string_value = arena_strndup(arena, value, (size_t)length);
     }
     return node;
 }
 
 // 创建布尔字面量节点
-ASTNode* create_bool_literal(int value) {
-    ASTNode* node = create_ast_node(NODE_LITERAL);
+ASTNode* create_bool_literal(Arena* arena, int value) {
+    ASTNode* node = create_ast_node(arena, NODE_LITERAL);
     if (node) {
         node->literal.type = LITERAL_BOOL;
         node->literal.bool_value = value;
@@ -192,9 +62,18 @@ ASTNode* create_bool_literal(int value) {
     return node;
 }
 
+// 创建null字面量节点
+ASTNode* create_null_literal(Arena* arena) {
+    ASTNode* node = create_ast_node(arena, NODE_LITERAL);
+    if (node) {
+        node->literal.type = LITERAL_NULL;
+    }
+    return node;
+}
+
 // 创建二元运算节点
-ASTNode* create_binary_op(OperatorType op, ASTNode* left, ASTNode* right) {
-    ASTNode* node = create_ast_node(NODE_BINARY_OP);
+ASTNode* create_binary_op(Arena* arena, OperatorType op, ASTNode* left, ASTNode* right) {
+    ASTNode* node = create_ast_node(arena, NODE_BINARY_OP);
     if (node) {
         node->binary_op.op = op;
         node->binary_op.left = left;
@@ -204,8 +83,8 @@ ASTNode* create_binary_op(OperatorType op, ASTNode* left, ASTNode* right) {
 }
 
 // 创建一元运算节点
-ASTNode* create_unary_op(OperatorType op, ASTNode* operand) {
-    ASTNode* node = create_ast_node(NODE_UNARY_OP);
+ASTNode* create_unary_op(Arena* arena, OperatorType op, ASTNode* operand) {
+    ASTNode* node = create_ast_node(arena, NODE_UNARY_OP);
     if (node) {
         node->unary_op.op = op;
         node->unary_op.operand = operand;
@@ -214,99 +93,64 @@ ASTNode* create_unary_op(OperatorType op, ASTNode* operand) {
 }
 
 // 创建变量引用节点
-ASTNode* create_variable(const char* name) {
-    ASTNode* node = create_ast_node(NODE_VARIABLE);
+ASTNode* create_variable(Arena* arena, Symbol name) {
+    ASTNode* node = create_ast_node(arena, NODE_VARIABLE);
     if (node) {
-        node->variable.name = strdup(name);
+        node->variable.name = name;
     }
     return node;
 }
 
 // 创建变量声明节点
-ASTNode* create_variable_decl(const char* name, const char* type, ASTNode* initializer) {
-    ASTNode* node = create_ast_node(NODE_VARIABLE_DECL);
+ASTNode* create_variable_decl(Arena* arena, DeclKind kind, Symbol name, TypeId type, ASTNode* initializer) {
+    ASTNode* node = create_ast_node(arena, NODE_VARIABLE_DECL);
     if (node) {
-        node->var_decl.name = strdup(name);
-        node->var_decl.type = type ? strdup(type) : NULL;
+        node->var_decl.kind = kind;
+        node->var_decl.name = name;
+        node->var_decl.type = type;
         node->var_decl.initializer = initializer;
     }
     return node;
 }
 
 // 创建函数调用节点
-ASTNode* create_function_call(const char* name, ASTNode** arguments, int arg_count) {
-    ASTNode* node = create_ast_node(NODE_FUNCTION_CALL);
+ASTNode* create_function_call(Arena* arena, Symbol name, ASTNode** arguments, int arg_count) {
+    ASTNode* node = create_ast_node(arena, NODE_FUNCTION_CALL);
     if (node) {
-        node->call.name = strdup(name);
-        node->call.arg_count = arg_count;
-        
-        if (arg_count > 0) {
-            node->call.arguments = (ASTNode**)malloc(sizeof(ASTNode*) * arg_count);
-            if (node->call.arguments) {
-                for (int i = 0; i < arg_count; i++) {
-                    node->call.arguments[i] = arguments[i];
-                }
-            } else {
-                node->call.arg_count = 0;
-            }
-        } else {
-            node->call.arguments = NULL;
-        }
+        node->call.name = name;
+        node->call.arguments = copy_ast_nodes(arena, arguments, arg_count);
+        node->call.arg_count = node->call.arguments ? arg_count : 0;
     }
     return node;
 }
 
 // 创建函数定义节点
-ASTNode* create_function(const char* name, ASTNode** parameters, int param_count, 
-                        const char* return_type, ASTNode* body) {
-    ASTNode* node = create_ast_node(NODE_FUNCTION);
+ASTNode* create_function(Arena* arena, Symbol name, ASTNode** parameters, int param_count, 
+                        TypeId return_type, ASTNode* body) {
+    ASTNode* node = create_ast_node(arena, NODE_FUNCTION);
     if (node) {
-        node->function.name = strdup(name);
-        node->function.param_count = param_count;
-        node->function.return_type = return_type ? strdup(return_type) : NULL;
+        node->function.name = name;
+        node->function.return_type = return_type;
         node->function.body = body;
-        
-        if (param_count > 0) {
-            node->function.parameters = (ASTNode**)malloc(sizeof(ASTNode*) * param_count);
-            if (node->function.parameters) {
-                for (int i = 0; i < param_count; i++) {
-                    node->function.parameters[i] = parameters[i];
-                }
-            } else {
-                node->function.param_count = 0;
-            }
-        } else {
-            node->function.parameters = NULL;
-        }
+        node->function.parameters = copy_ast_nodes(arena, parameters, param_count);
+        node->function.param_count = node->function.parameters ? param_count : 0;
     }
     return node;
 }
 
 // 创建代码块节点
-ASTNode* create_block(ASTNode** statements, int statement_count) {
-    ASTNode* node = create_ast_node(NODE_BLOCK);
+ASTNode* create_block(Arena* arena, ASTNode** statements, int statement_count) {
+    ASTNode* node = create_ast_node(arena, NODE_BLOCK);
     if (node) {
-        node->block.statement_count = statement_count;
-        
-        if (statement_count > 0) {
-            node->block.statements = (ASTNode**)malloc(sizeof(ASTNode*) * statement_count);
-            if (node->block.statements) {
-                for (int i = 0; i < statement_count; i++) {
-                    node->block.statements[i] = statements[i];
-                }
-            } else {
-                node->block.statement_count = 0;
-            }
-        } else {
-            node->block.statements = NULL;
-        }
+        node->block.statements = copy_ast_nodes(arena, statements, statement_count);
+        node->block.statement_count = node->block.statements ? statement_count : 0;
     }
     return node;
 }
 
 // 创建if语句节点
-ASTNode* create_if_statement(ASTNode* condition, ASTNode* then_branch, ASTNode* else_branch) {
-    ASTNode* node = create_ast_node(NODE_IF_STATEMENT);
+ASTNode* create_if_statement(Arena* arena, ASTNode* condition, ASTNode* then_branch, ASTNode* else_branch) {
+    ASTNode* node = create_ast_node(arena, NODE_IF_STATEMENT);
     if (node) {
         node->if_stmt.condition = condition;
         node->if_stmt.then_branch = then_branch;
@@ -316,8 +160,8 @@ ASTNode* create_if_statement(ASTNode* condition, ASTNode* then_branch, ASTNode*
 }
 
 // 创建while语句节点
-ASTNode* create_while_statement(ASTNode* condition, ASTNode* body) {
-    ASTNode* node = create_ast_node(NODE_WHILE_STATEMENT);
+ASTNode* create_while_statement(Arena* arena, ASTNode* condition, ASTNode* body) {
+    ASTNode* node = create_ast_node(arena, NODE_WHILE_STATEMENT);
     if (node) {
         node->while_stmt.condition = condition;
         node->while_stmt.body = body;
@@ -325,42 +169,78 @@ ASTNode* create_while_statement(ASTNode* condition, ASTNode* body) {
     return node;
 }
 
+// 创建for语句节点
+ASTNode* create_for_statement(Arena* arena, Symbol variable, ASTNode* iterable, ASTNode* body) {
+    ASTNode* node = create_ast_node(arena, NODE_FOR_STATEMENT);
+    if (node) {
+        node->for_stmt.variable = variable;
+        node->for_stmt.iterable = iterable;
+        node->for_stmt.body = body;
+    }
+    return node;
+}
+
 // 创建return语句节点
-ASTNode* create_return(ASTNode* expression) {
-    ASTNode* node = create_ast_node(NODE_RETURN);
+ASTNode* create_return(Arena* arena, ASTNode* expression) {
+    ASTNode* node = create_ast_node(arena, NODE_RETURN);
     if (node) {
         node->return_stmt.expression = expression;
     }
     return node;
 }
 
-// 创建include指令节点
-ASTNode* create_include(const char* filename) {
-    ASTNode* node = create_ast_node(NODE_INCLUDE);
+// 创建include指令节点（filename 为引号之间的文本，声明稍后加载）
+ASTNode* create_include(Arena* arena, const char* filename, int length) {
+    ASTNode* node = create_ast_node(arena, NODE_INCLUDE);
     if (node) {
-        node->include.filename = strdup(filename);
+        node->include.filename = arena_strndup(arena, filename, (size_t)length);
     }
     return node;
 }
 
 // 创建程序节点
-ASTNode* create_program(ASTNode** declarations, int declaration_count) {
-    ASTNode* node = create_ast_node(NODE_PROGRAM);
+ASTNode* create_program(Arena* arena, ASTNode** declarations, int declaration_count) {
+    ASTNode* node = create_ast_node(arena, NODE_PROGRAM);
     if (node) {
-        node->program.declaration_count = declaration_count;
-        
-        if (declaration_count > 0) {
-            node->program.declarations = (ASTNode**)malloc(sizeof(ASTNode*) * declaration_count);
-            if (node->program.declarations) {
-                for (int i = 0; i < declaration_count; i++) {
-                    node->program.declarations[i] = declarations[i];
-                }
-            } else {
-                node->program.declaration_count = 0;
-            }
-        } else {
-            node->program.declarations = NULL;
-        }
+        node->program.declarations = copy_ast_nodes(arena, declarations, declaration_count);
+        node->program.declaration_count = node->program.declarations ? declaration_count : 0;
     }
     return node;
-}
\ No newline at end of file
+}
+int ast_child_count(const ASTNode* node) {
+    switch (node->type) {
+        case NODE_PROGRAM:        return node->program.declaration_count;
+        case NODE_INCLUDE:        return node->include.declaration_count;
+        case NODE_BLOCK:          return node->block.statement_count;
+        case NODE_FUNCTION:       return node->function.param_count + 1;
+        case NODE_FUNCTION_CALL:  return node->call.arg_count;
+        case NODE_VARIABLE_DECL:  return 1;
+        case NODE_BINARY_OP:      return 2;
+        case NODE_UNARY_OP:       return 1;
+        case NODE_IF_STATEMENT:   return 3;
+        case NODE_WHILE_STATEMENT:return 2;
+        case NODE_FOR_STATEMENT:  return 2;
+        case NODE_RETURN:         return 1;
+        default:                  return 0;
+    }
+}
+
+ASTNode* ast_child(const ASTNode* node, int index) {
+    switch (node->type) {
+        case NODE_PROGRAM:        return node->program.declarations[index];
+        case NODE_INCLUDE:        return node->include.declarations[index];
+        case NODE_BLOCK:          return node->block.statements[index];
+        case NODE_FUNCTION:
+            return index < node->function.param_count ? node->function.parameters[index] : node->function.body;
+        case NODE_FUNCTION_CALL:  return node->call.arguments[index];
+        case NODE_VARIABLE_DECL:  return node->var_decl.initializer;
+        case NODE_BINARY_OP:      return index == 0 ? node->binary_op.left : node->binary_op.right;
+        case NODE_UNARY_OP:       return node->unary_op.operand;
+        case NODE_IF_STATEMENT:
+            return index == 0 ? node->if_stmt.condition : index == 1 ? node->if_stmt.then_branch : node->if_stmt.else_branch;
+        case NODE_WHILE_STATEMENT:return index == 0 ? node->while_stmt.condition : node->while_stmt.body;
+        case NODE_FOR_STATEMENT:  return index == 0 ? node->for_stmt.iterable : node->for_stmt.body;
+        case NODE_RETURN:         return node->return_stmt.expression;
+        default:                  return NULL;
+    }
+}
@@ -4,6 +4,13 @@
 #define AST_H
 
 #include <stdlib.h>
+#include "arena.h"
+#include "interner.h"
+#include "type_interner.h"
+
+// 一次编译中所有AST节点、子节点数组和节点字符串都分配在同一个区域分配器中，
+// 编译结束时随 destroy_arena 一次性释放
+#define AST_ARENA_CHUNK_SIZE (256 * 1024)
 
 // AST节点类型枚举
 typedef enum {
@@ -19,7 +26,10 @@ typedef enum {
     NODE_WHILE_STATEMENT,// while语句
     NODE_RETURN,         // return语句
     NODE_BLOCK,          // 代码块
-    NODE_INCLUDE         // include指令
+    NODE_INCLUDE,        // include指令
+    NODE_FOR_STATEMENT,  // for语句
+    NODE_BREAK,          // break语句
+    NODE_CONTINUE        // continue语句
 } ASTNodeType;
 
 // 字面量类型枚举
@@ -27,7 +37,8 @@ typedef enum {
     LITERAL_INT,         // 整数
     LITERAL_FLOAT,       // 浮点数
     LITERAL_STRING,      // 字符串
-    LITERAL_BOOL         // 布尔值
+    LITERAL_BOOL,        // 布尔值
+    LITERAL_NULL         // null
 } LiteralType;
 
 // 运算符类型枚举
@@ -43,7 +54,41 @@ typedef enum {
     OP_GT,               // >
     OP_GTE,              // >=
     OP_NOT,              // !
-    OP_ASSIGN            // =
+    OP_ASSIGN,           // =
+    OP_MOD,              // %
+    OP_AND,              // &&
+    OP_OR,               // ||
+    OP_BIT_AND,          // &
+    OP_BIT_OR,           // |
+    OP_BIT_XOR,          // ^
+    OP_SHIFT_LEFT,       // <<
+    OP_SHIFT_RIGHT,      // >>
+    OP_RANGE,            // ..
+    OP_RANGE_TO,         // ..<
+    OP_RANGE_INCL,       // ..=
+    OP_ELVIS,            // ?:
+    OP_ADD_ASSIGN,       // +=
+    OP_SUB_ASSIGN,       // -=
+    OP_MUL_ASSIGN,       // *=
+    OP_DIV_ASSIGN,       // /=
+    OP_MOD_ASSIGN,       // %=
+    OP_AND_ASSIGN,       // &=
+    OP_OR_ASSIGN,        // |=
+    OP_XOR_ASSIGN,       // ^=
+    OP_SHIFT_LEFT_ASSIGN,  // <<=
+    OP_SHIFT_RIGHT_ASSIGN, // >>=
+    OP_MEMBER,           // .   （右操作数为成员名变量）
+    OP_SAFE_MEMBER,      // ?.
+    OP_SCOPE,            // ::
+    OP_INDEX,            // []
+    OP_NEG,              // 一元 -
+    OP_PLUS,             // 一元 +
+    OP_BIT_NOT,          // ~
+    OP_PRE_INC,          // 前置 ++
+    OP_PRE_DEC,          // 前置 --
+    OP_POST_INC,         // 后置 ++
+    OP_POST_DEC,         // 后置 --
+    OP_NOT_NULL          // !!
 } OperatorType;
 
 // 前向声明
@@ -53,39 +98,58 @@ typedef struct ASTNode ASTNode;
 typedef struct {
     LiteralType type;    // 字面量类型
     union {
-        int int_value;       // 整数值
-        float float_value;   // 浮点数值
+        long long int_value; // 整数值（超出 i64 范围的无符号值按位保存）
+        double float_value;  // 浮点数值
         char* string_value;  // 字符串值
         int bool_value;      // 布尔值
     };
 } Literal;
 
+// 函数的修饰符（位标志，可以组合）
+typedef enum {
+    MODIFIER_PUBLIC = 1 << 0,    // pub / public：导出的符号，即使没有被调用也要保留
+    MODIFIER_TAILREC = 1 << 1,   // tailrec：递归调用必须位于尾位置，自调用编译为循环
+    MODIFIER_CROSSINLINE = 1 << 2 // crossinline：调用处总是内联展开，不受内联阈值限制
+} FunctionModifier;
+
 // 函数定义结构
 typedef struct {
-    char* name;              // 函数名
+    Symbol name;             // 函数名
     ASTNode** parameters;    // 参数列表
     int param_count;         // 参数数量
-    ASTNode* body;           // 函数体
-    char* return_type;       // 返回类型
+    ASTNode* body;           // 函数体（延迟解析且尚未请求时为 NULL）
+    TypeId return_type;      // 返回类型（未标注时为 TYPE_NONE）
+    unsigned modifiers;      // 修饰符（FunctionModifier 的组合）
+    int body_start;          // 延迟解析的函数体在标记数组中的范围 [body_start, body_end)，
+    int body_end;            // 函数体已构建或没有函数体时两者均为 0
 } FunctionNode;
 
 // 函数调用结构
 typedef struct {
-    char* name;              // 函数名
+    Symbol name;             // 函数名
     ASTNode** arguments;     // 参数列表
     int arg_count;           // 参数数量
 } FunctionCallNode;
 
+// 变量声明的种类（lateinit 按其后的 var/val 归类）
+typedef enum {
+    DECL_VAR,                // var：可以重新赋值
+    DECL_VAL,                // val：只赋值一次
+    DECL_CONST,              // const：编译期常量
+    DECL_PARAMETER           // 函数参数（初始化表达式为默认值）
+} DeclKind;
+
 // 变量声明结构
 typedef struct {
-    char* name;              // 变量名
-    char* type;              // 变量类型
+    Symbol name;             // 变量名
+    TypeId type;             // 变量类型（未标注时为 TYPE_NONE）
     ASTNode* initializer;    // 初始化表达式
+    DeclKind kind;           // 声明种类
 } VariableDeclNode;
 
 // 变量引用结构
 typedef struct {
-    char* name;              // 变量名
+    Symbol name;             // 变量名
 } VariableNode;
 
 // 二元运算结构
@@ -114,6 +178,13 @@ typedef struct {
     ASTNode* body;           // 循环体
 } WhileStatementNode;
 
+// for语句结构
+typedef struct {
+    Symbol variable;         // 循环变量
+    ASTNode* iterable;       // 迭代对象（通常为区间）
+    ASTNode* body;           // 循环体
+} ForStatementNode;
+
 // return语句结构
 typedef struct {
     ASTNode* expression;     // 返回表达式
@@ -128,6 +199,9 @@ typedef struct {
 // include指令结构
 typedef struct {
     char* filename;          // 文件名
+    ASTNode** declarations;  // 头文件及其间接 include 的头文件中的声明（由 parse_includes 加载，
+                             // 每个头文件在程序中只出现一次；函数声明没有函数体）
+    int declaration_count;   // 声明数量
 } IncludeNode;
 
 // 程序结构
@@ -139,11 +213,10 @@ typedef struct {
 // AST节点结构
 struct ASTNode {
     ASTNodeType type;        // 节点类型
-    int line;                // 行号
-    int column;              // 列号
-    char* name;              // 函数名
+    int offset;              // 源代码中的字节偏移（行列号按需由 LineTable 换算）
     ASTNode** children;      // 子节点数组
     int children_count;      // 子节点数量
+    int shift;               // 子孙节点的 offset 都需加上的平移量（增量解析平移整个声明时只改这里）
     union {
         Literal literal;             // 字面量
         FunctionNode function;       // 函数定义
@@ -154,6 +227,7 @@ struct ASTNode {
         UnaryOpNode unary_op;        // 一元运算
         IfStatementNode if_stmt;     // if语句
         WhileStatementNode while_stmt;// while语句
+        ForStatementNode for_stmt;   // for语句
         ReturnNode return_stmt;      // return语句
         BlockNode block;             // 代码块
         IncludeNode include;         // include指令
@@ -162,7 +236,36 @@ struct ASTNode {
 };
 
 // 函数原型
-ASTNode* create_ast_node(ASTNodeType type);
-void destroy_ast_node(ASTNode* node);
+ASTNode* create_ast_node(Arena* arena, ASTNodeType type);
+ASTNode** copy_ast_nodes(Arena* arena, ASTNode** nodes, int count);
+
+ASTNode* create_int_literal(Arena* arena, long long value);
+ASTNode* create_float_literal(Arena* arena, double value);
+ASTNode* create_string_literal(Arena* arena, const char* value, int length);
+ASTNode* create_bool_literal(Arena* arena, int value);
+ASTNode* create_null_literal(Arena* arena);
+ASTNode* create_binary_op(Arena* arena, OperatorType op, ASTNode* left, ASTNode* right);
+ASTNode* create_unary_op(Arena* arena, OperatorType op, ASTNode* operand);
+ASTNode* create_variable(Arena* arena, Symbol name);
+ASTNode* create_variable_decl(Arena* arena, DeclKind kind, Symbol name, TypeId type, ASTNode* initializer);
+ASTNode* create_function_call(Arena* arena, Symbol name, ASTNode** arguments, int arg_count);
+ASTNode* create_function(Arena* arena, Symbol name, ASTNode** parameters, int param_count,
+                         TypeId return_type, ASTNode* body);
+ASTNode* create_block(Arena* arena, ASTNode** statements, int statement_count);
+ASTNode* create_if_statement(Arena* arena, ASTNode* condition, ASTNode* then_branch, ASTNode* else_branch);
+ASTNode* create_while_statement(Arena* arena, ASTNode* condition, ASTNode* body);
+ASTNode* create_for_statement(Arena* arena, Symbol variable, ASTNode* iterable, ASTNode* body);
+ASTNode* create_return(Arena* arena, ASTNode* expression);
+ASTNode* create_include(Arena* arena, const char* filename, int length);
+ASTNode* create_program(Arena* arena, ASTNode** declarations, int declaration_count);
+
+// 子节点的数量与第 index 个子节点（顺序同 flat_child，缺省的子节点为 NULL）
+int ast_child_count(const ASTNode* node);
+ASTNode* ast_child(const ASTNode* node, int index);
+
+// 函数体是否只记录了标记范围而尚未构建（见 get_function_body）
+static inline int function_body_pending(const ASTNode* function) {
+    return function->function.body_end > function->function.body_start;
+}
 
 #endif // AST_H
\ No newline at end of file
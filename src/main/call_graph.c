@@ -0,0 +1,249 @@
+#include "call_graph.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 按编号递增的顺序收集顶层函数与头文件中声明的函数
+static int collect_functions(CallGraph* graph, const FlatAST* ast) {
+    uint32_t capacity = 64;
+    graph->functions = (NodeId*)malloc(sizeof(NodeId) * capacity);
+    if (!graph->functions) return 0;
+    int count = ast->count > FLAT_AST_ROOT ? flat_child_count(ast, FLAT_AST_ROOT) : 0;
+    for (int i = 0; i < count; i++) {
+        NodeId declaration = flat_child(ast, FLAT_AST_ROOT, i);
+        if (declaration == NODE_NONE) continue;
+        int include = flat_kind(ast, declaration) == NODE_INCLUDE;
+        int inner_count = include ? flat_child_count(ast, declaration) : 1;
+        for (int j = 0; j < inner_count; j++) {
+            NodeId function = include ? flat_child(ast, declaration, j) : declaration;
+            if (function == NODE_NONE || flat_kind(ast, function) != NODE_FUNCTION) continue;
+            if (graph->function_count == capacity) {
+                capacity *= 2;
+                NodeId* functions = (NodeId*)realloc(graph->functions, sizeof(NodeId) * capacity);
+                if (!functions) return 0;
+                graph->functions = functions;
+            }
+            graph->functions[graph->function_count++] = function;
+        }
+    }
+    return 1;
+}
+
+int call_graph_index(const CallGraph* graph, NodeId function) {
+    uint32_t low = 0;
+    uint32_t high = graph->function_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (graph->functions[middle] < function) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < graph->function_count && graph->functions[low] == function ? (int)low : -1;
+}
+
+// 节点引用的函数在调用图中的下标，没有引用函数时返回 -1
+static int referenced_function(const CallGraph* graph, const FlatAST* ast, NodeId id) {
+    NodeId declaration = flat_binding(ast, id);
+    if (declaration == NODE_NONE || flat_kind(ast, declaration) != NODE_FUNCTION) return -1;
+    return call_graph_index(graph, declaration);
+}
+
+// Tarjan 算法求强连通分量，用显式栈代替递归。分量按逆拓扑序编号：被调用的分量先于调用者完成
+static int find_components(CallGraph* graph) {
+    uint32_t n = graph->function_count;
+    uint32_t* order = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));     // 访问序号加一，0 表示尚未访问
+    uint32_t* low = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));
+    uint32_t* stack = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));     // 尚未归入分量的函数
+    uint32_t* frames = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));    // 深度优先搜索路径
+    uint32_t* next_edge = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));
+    uint8_t* on_stack = (uint8_t*)calloc(n + 1, sizeof(uint8_t));
+    graph->components = (uint32_t*)malloc(sizeof(uint32_t) * (n + 1));
+    graph->recursive = (uint8_t*)calloc(n + 1, sizeof(uint8_t));
+    int ok = order && low && stack && frames && next_edge && on_stack && graph->components && graph->recursive;
+    if (ok) {
+        memset(order, 0, sizeof(uint32_t) * (n + 1));
+        uint32_t visited = 0;
+        uint32_t stack_count = 0;
+        for (uint32_t root = 0; root < n; root++) {
+            if (order[root]) continue;
+            uint32_t depth = 0;
+            frames[depth++] = root;
+            order[root] = low[root] = ++visited;
+            next_edge[root] = graph->edge_starts[root];
+            stack[stack_count++] = root;
+            on_stack[root] = 1;
+            while (depth > 0) {
+                uint32_t v = frames[depth - 1];
+                if (next_edge[v] < graph->edge_starts[v + 1]) {
+                    uint32_t w = graph->callees[next_edge[v]++];
+                    if (!order[w]) {
+                        order[w] = low[w] = ++visited;
+                        next_edge[w] = graph->edge_starts[w];
+                        stack[stack_count++] = w;
+                        on_stack[w] = 1;
+                        frames[depth++] = w;
+                    } else if (on_stack[w] && order[w] < low[v]) {
+                        low[v] = order[w];
+                    }
+                    continue;
+                }
+                depth--;
+                if (depth > 0 && low[v] < low[frames[depth - 1]]) {
+                    low[frames[depth - 1]] = low[v];
+                }
+                if (low[v] == order[v]) {
+                    // v 是分量的根：栈中 v 以上的函数构成一个分量
+                    uint32_t component = graph->component_count++;
+                    uint32_t first = stack_count;
+                    do {
+                        first--;
+                        on_stack[stack[first]] = 0;
+                        graph->components[stack[first]] = component;
+                    } while (stack[first] != v);
+                    if (stack_count - first > 1) {
+                        for (uint32_t i = first; i < stack_count; i++) graph->recursive[stack[i]] = 1;
+                    }
+                    stack_count = first;
+                }
+            }
+        }
+        for (uint32_t caller = 0; caller < n; caller++) {
+            for (uint32_t edge = graph->edge_starts[caller]; edge < graph->edge_starts[caller + 1]; edge++) {
+                if (graph->callees[edge] == caller) graph->recursive[caller] = 1;
+            }
+        }
+    }
+    free(order);
+    free(low);
+    free(stack);
+    free(frames);
+    free(next_edge);
+    free(on_stack);
+    return ok;
+}
+
+CallGraph* build_call_graph(const FlatAST* ast) {
+    if (!ast) return NULL;
+    CallGraph* graph = (CallGraph*)calloc(1, sizeof(CallGraph));
+    if (!graph) return NULL;
+    if (!collect_functions(graph, ast)) {
+        destroy_call_graph(graph);
+        return NULL;
+    }
+
+    // 每个函数最后一次记录边时的调用者，用于去重
+    uint32_t capacity = 256;
+    uint32_t* last_caller = (uint32_t*)malloc(sizeof(uint32_t) * (graph->function_count + 1));
+    graph->edge_starts = (uint32_t*)malloc(sizeof(uint32_t) * (graph->function_count + 1));
+    graph->callees = (uint32_t*)malloc(sizeof(uint32_t) * capacity);
+    if (!last_caller || !graph->edge_starts || !graph->callees) {
+        free(last_caller);
+        destroy_call_graph(graph);
+        return NULL;
+    }
+    memset(last_caller, 0xff, sizeof(uint32_t) * (graph->function_count + 1));
+
+    // 函数的子树互不重叠，全部函数体合起来只扫描一遍
+    for (uint32_t caller = 0; caller < graph->function_count; caller++) {
+        graph->edge_starts[caller] = graph->edge_count;
+        NodeId function = graph->functions[caller];
+        for (NodeId id = function + 1; id < ast->ends[function]; id++) {
+            int callee = referenced_function(graph, ast, id);
+            if (callee < 0 || last_caller[callee] == caller) continue;
+            last_caller[callee] = caller;
+            if (graph->edge_count == capacity) {
+                capacity *= 2;
+                uint32_t* callees = (uint32_t*)realloc(graph->callees, sizeof(uint32_t) * capacity);
+                if (!callees) {
+                    free(last_caller);
+                    destroy_call_graph(graph);
+                    return NULL;
+                }
+                graph->callees = callees;
+            }
+            graph->callees[graph->edge_count++] = (uint32_t)callee;
+        }
+    }
+    graph->edge_starts[graph->function_count] = graph->edge_count;
+    free(last_caller);
+    if (!find_components(graph)) {
+        destroy_call_graph(graph);
+        return NULL;
+    }
+    return graph;
+}
+
+void destroy_call_graph(CallGraph* graph) {
+    if (!graph) return;
+    free(graph->functions);
+    free(graph->edge_starts);
+    free(graph->callees);
+    free(graph->components);
+    free(graph->recursive);
+    free(graph);
+}
+
+typedef struct {
+    const CallGraph* graph;
+    uint8_t* reached;        // 每个函数是否可达
+    uint32_t* worklist;
+    uint32_t worklist_count;
+} Reachability;
+
+static void reach(Reachability* reachability, int function) {
+    if (function < 0 || reachability->reached[function]) return;
+    reachability->reached[function] = 1;
+    reachability->worklist[reachability->worklist_count++] = (uint32_t)function;
+}
+
+static FlatRewrite drop_unreached(void* context, const FlatAST* ast, NodeId id) {
+    const Reachability* reachability = (const Reachability*)context;
+    FlatRewrite rewrite;
+    memset(&rewrite, 0, sizeof(rewrite));
+    rewrite.action = FLAT_KEEP;
+    if (flat_kind(ast, id) == NODE_FUNCTION) {
+        int index = call_graph_index(reachability->graph, id);
+        if (index >= 0 && !reachability->reached[index]) rewrite.action = FLAT_DROP;
+    }
+    return rewrite;
+}
+
+FlatAST* eliminate_dead_functions(const FlatAST* ast, Symbol entry) {
+    CallGraph* graph = build_call_graph(ast);
+    if (!graph) return NULL;
+    Reachability reachability = { graph, NULL, NULL, 0 };
+    reachability.reached = (uint8_t*)calloc(graph->function_count + 1, sizeof(uint8_t));
+    reachability.worklist = (uint32_t*)malloc(sizeof(uint32_t) * (graph->function_count + 1));
+    FlatAST* live = NULL;
+    if (reachability.reached && reachability.worklist) {
+        // 根只来自源文件的顶层声明，头文件中的函数只能通过调用到达
+        int count = ast->count > FLAT_AST_ROOT ? flat_child_count(ast, FLAT_AST_ROOT) : 0;
+        for (int i = 0; i < count; i++) {
+            NodeId declaration = flat_child(ast, FLAT_AST_ROOT, i);
+            if (declaration == NODE_NONE) continue;
+            ASTNodeType kind = flat_kind(ast, declaration);
+            if (kind == NODE_FUNCTION) {
+                const uint32_t* record = flat_record(ast, declaration);
+                if ((entry != SYMBOL_NONE && record[0] == entry) || (record[4] & MODIFIER_PUBLIC)) {
+                    reach(&reachability, call_graph_index(graph, declaration));
+                }
+            } else if (kind != NODE_INCLUDE) {
+                for (NodeId id = declaration; id < ast->ends[declaration]; id++) {
+                    reach(&reachability, referenced_function(graph, ast, id));
+                }
+            }
+        }
+        while (reachability.worklist_count > 0) {
+            uint32_t caller = reachability.worklist[--reachability.worklist_count];
+            for (uint32_t edge = graph->edge_starts[caller]; edge < graph->edge_starts[caller + 1]; edge++) {
+                reach(&reachability, (int)graph->callees[edge]);
+            }
+        }
+        live = rewrite_flat_ast(ast, drop_unreached, &reachability);
+    }
+    free(reachability.reached);
+    free(reachability.worklist);
+    destroy_call_graph(graph);
+    return live;
+}
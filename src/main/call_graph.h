@@ -0,0 +1,34 @@
+// 调用图头文件
+// 在名字解析之后的扁平AST上构建调用图：顶点是顶层函数（含 include 的头文件中声明的函数），
+// 边是函数体中解析到函数声明的调用（NODE_FUNCTION_CALL）与函数引用（NODE_VARIABLE）。
+// 边按压缩行格式存放：第 i 个函数的被调函数为 callees[edge_starts[i] .. edge_starts[i + 1])。
+// 构建时同时求出强连通分量：同一分量中的函数互相（间接）递归调用。
+
+#ifndef CALL_GRAPH_H
+#define CALL_GRAPH_H
+
+#include "flat_ast.h"
+
+typedef struct {
+    NodeId* functions;       // 函数节点，按编号递增排列
+    uint32_t function_count;
+    uint32_t* edge_starts;   // function_count + 1 项
+    uint32_t* callees;       // 被调函数在 functions 中的下标（同一函数内去重）
+    uint32_t edge_count;
+    uint32_t* components;    // 每个函数所在的强连通分量编号
+    uint8_t* recursive;      // 函数是否位于递归环上（分量中不止一个函数，或者调用自身）
+    uint32_t component_count;
+} CallGraph;
+
+// 函数原型
+// 内存不足时返回 NULL
+CallGraph* build_call_graph(const FlatAST* ast);
+void destroy_call_graph(CallGraph* graph);
+// 函数节点在 functions 中的下标，不是顶层函数时返回 -1
+int call_graph_index(const CallGraph* graph, NodeId function);
+
+// 删除不可达的函数。根是名为 entry 的函数、源文件中导出（pub）的函数，以及顶层变量的初始化表达式
+// （程序启动时执行）中引用的函数。返回新的扁平AST，原AST保持不变；内存不足时返回 NULL
+FlatAST* eliminate_dead_functions(const FlatAST* ast, Symbol entry);
+
+#endif // CALL_GRAPH_H
@@ -1,5 +1,7 @@
 #include "code_generator.h"
 #include "ast.h"
+#include "flat_ast.h"
+#include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
@@ -10,97 +12,1882 @@ struct CodeGenerator {
     char* target_platform;   // 目标平台
     int optimization_level;  // 优化级别
     char* error_message;     // 错误信息
+    const TailCalls* tail_calls; // 尾调用分析的结果（可以为 NULL）
+    const Escapes* escapes;      // 逃逸分析的结果（可以为 NULL）
 };
 
-// 生成简单的LLVM IR代码
-static char* generate_llvm_ir(const ASTNode* root) {
-    char* ir_code = malloc(2048); // 预分配足够大的缓冲区
-    if (!ir_code) return NULL;
-    
-    // 添加基本LLVM IR头信息
-    strcpy(ir_code, "; 生成的LLVM IR代码\n\n");
-    
-    if (!root) {
-        // 如果AST为空，生成默认代码
-        strcat(ir_code, "; 警告: AST为空\n");
-        strcat(ir_code, "define i32 @main() {\n");
-        strcat(ir_code, "  ret i32 0\n");
-        strcat(ir_code, "}\n");
-        return ir_code;
-    }
-    
-    // 处理程序节点
-    if (root->type == NODE_PROGRAM) {
-        // 如果是SCP标准库的Hello World程序，生成相应的LLVM IR
-        strcat(ir_code, "; SCP标准库包含\n");
-        strcat(ir_code, "@.str = private unnamed_addr constant [12 x i8] c\"Hello, scp!\\00\", align 1\n");
-        strcat(ir_code, "declare i32 @puts(i8* nocapture) nounwind\n\n");
-        
-        // 添加声明
-        for (int i = 0; i < root->program.declaration_count; i++) {
-            const ASTNode* decl = root->program.declarations[i];
-            if (decl && decl->type == NODE_FUNCTION) {
-                if (decl->function.name && strcmp(decl->function.name, "main") == 0) {
-                    // 生成main函数
-                    strcat(ir_code, "; 主函数\n");
-                    strcat(ir_code, "define i32 @main() {\n");
-                    strcat(ir_code, "    %call = call i32 @puts(i8* getelementptr inbounds ([12 x i8], [12 x i8]* @.str, i64 0, i64 0))\n");
-                    strcat(ir_code, "    ret i32 0\n");
-                    strcat(ir_code, "}\n");
+// 可增长的文本缓冲区，内存不足时只记录失败，由调用者最后统一检查
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    int failed;
+} Buffer;
+
+static int buffer_reserve(Buffer* buffer, size_t extra) {
+    if (buffer->failed) return 0;
+    if (buffer->length + extra + 1 <= buffer->capacity) return 1;
+    size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+    while (capacity < buffer->length + extra + 1) capacity *= 2;
+    char* data = (char*)realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = 1;
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+static void append_bytes(Buffer* buffer, const char* text, size_t length) {
+    if (!buffer_reserve(buffer, length)) return;
+    memcpy(buffer->data + buffer->length, text, length);
+    buffer->length += length;
+    buffer->data[buffer->length] = '\0';
+}
+
+static void append(Buffer* buffer, const char* text) {
+    append_bytes(buffer, text, strlen(text));
+}
+
+static void vappendf(Buffer* buffer, const char* format, va_list args) {
+    char stack[256];
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(stack, sizeof(stack), format, args);
+    if (length < 0) {
+        buffer->failed = 1;
+    } else if ((size_t)length < sizeof(stack)) {
+        append_bytes(buffer, stack, (size_t)length);
+    } else if (buffer_reserve(buffer, (size_t)length)) {
+        vsnprintf(buffer->data + buffer->length, (size_t)length + 1, format, copy);
+        buffer->length += (size_t)length;
+    }
+    va_end(copy);
+}
+
+static void appendf(Buffer* buffer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vappendf(buffer, format, args);
+    va_end(args);
+}
+
+static void buffer_clear(Buffer* buffer) {
+    buffer->length = 0;
+    if (buffer->data) buffer->data[0] = '\0';
+}
+
+// 值在LLVM中的类型
+typedef enum {
+    VALUE_UNKNOWN,       // 尚未推断
+    VALUE_VOID,
+    VALUE_I1,
+    VALUE_I8,
+    VALUE_I16,
+    VALUE_I32,
+    VALUE_I64,
+    VALUE_I128,
+    VALUE_FLOAT,
+    VALUE_DOUBLE,
+    VALUE_PTR            // 字符串、对象与其他引用类型都按 i8* 处理
+} ValueKind;
+
+typedef struct {
+    uint8_t kind;        // ValueKind
+    uint8_t is_unsigned;
+    uint8_t is_literal;  // 未标注类型的字面量：与另一侧运算时采用另一侧的类型
+} ValueType;
+
+// 表达式的结果：寄存器、常量或 undef
+typedef struct {
+    ValueType type;
+    int constant;        // 编译期常量（整数、浮点数、布尔值、null），转换类型时直接换算
+    long long integer;
+    double real;
+    char text[48];
+} Value;
+
+static ValueType make_type(ValueKind kind, int is_unsigned) {
+    ValueType type = { (uint8_t)kind, (uint8_t)is_unsigned, 0 };
+    return type;
+}
+
+static int is_integer_kind(int kind) {
+    return kind >= VALUE_I1 && kind <= VALUE_I128;
+}
+
+static int is_float_kind(int kind) {
+    return kind == VALUE_FLOAT || kind == VALUE_DOUBLE;
+}
+
+static int integer_bits(int kind) {
+    switch (kind) {
+        case VALUE_I1:   return 1;
+        case VALUE_I8:   return 8;
+        case VALUE_I16:  return 16;
+        case VALUE_I32:  return 32;
+        case VALUE_I64:  return 64;
+        case VALUE_I128: return 128;
+        default:         return 0;
+    }
+}
+
+static const char* type_text(ValueType type) {
+    switch (type.kind) {
+        case VALUE_VOID:   return "void";
+        case VALUE_I1:     return "i1";
+        case VALUE_I8:     return "i8";
+        case VALUE_I16:    return "i16";
+        case VALUE_I32:    return "i32";
+        case VALUE_I128:   return "i128";
+        case VALUE_FLOAT:  return "float";
+        case VALUE_DOUBLE: return "double";
+        case VALUE_PTR:    return "i8*";
+        default:           return "i64";
+    }
+}
+
+static int same_type(ValueType a, ValueType b) {
+    return a.kind == b.kind && a.is_unsigned == b.is_unsigned && a.is_literal == b.is_literal;
+}
+
+// 生成代码时使用的类型：未推断出的类型按 i64 处理
+static ValueType resolved(ValueType type) {
+    if (type.kind == VALUE_UNKNOWN) return make_type(VALUE_I64, 0);
+    type.is_literal = 0;
+    return type;
+}
+
+// SCP类型到LLVM类型。头文件中的C函数按C的约定：int 为 i32，void 为 void
+static ValueType map_type(TypeId type, int c_abi) {
+    switch (type) {
+        case TYPE_NONE:  return make_type(c_abi ? VALUE_VOID : VALUE_UNKNOWN, 0);
+        case TYPE_UNIT:
+        case TYPE_NEVER: return make_type(VALUE_VOID, 0);
+        case TYPE_BOOL:  return make_type(VALUE_I1, 1);
+        case TYPE_CHAR:
+        case TYPE_I8:    return make_type(VALUE_I8, 0);
+        case TYPE_U8:    return make_type(VALUE_I8, 1);
+        case TYPE_I16:   return make_type(VALUE_I16, 0);
+        case TYPE_U16:   return make_type(VALUE_I16, 1);
+        case TYPE_I32:   return make_type(VALUE_I32, 0);
+        case TYPE_U32:   return make_type(VALUE_I32, 1);
+        case TYPE_INT:   return make_type(c_abi ? VALUE_I32 : VALUE_I64, 0);
+        case TYPE_I64:
+        case TYPE_ISIZE: return make_type(VALUE_I64, 0);
+        case TYPE_U64:
+        case TYPE_USIZE: return make_type(VALUE_I64, 1);
+        case TYPE_I128:  return make_type(VALUE_I128, 0);
+        case TYPE_U128:  return make_type(VALUE_I128, 1);
+        case TYPE_F32:   return make_type(VALUE_FLOAT, 0);
+        case TYPE_F64:
+        case TYPE_F128:  // 暂按 double 生成
+        case TYPE_FLO:   return make_type(VALUE_DOUBLE, 0);
+        default:         return make_type(VALUE_PTR, 0);
+    }
+}
+
+// 二元运算两侧的公共类型
+static ValueType unify(ValueType a, ValueType b) {
+    if (a.kind == VALUE_UNKNOWN || b.kind == VALUE_UNKNOWN) return make_type(VALUE_UNKNOWN, 0);
+    if (a.is_literal && !b.is_literal) return b;
+    if (b.is_literal && !a.is_literal) return a;
+    ValueType result;
+    if (a.kind == b.kind) {
+        result = a;
+        result.is_unsigned = a.is_unsigned && b.is_unsigned;
+    } else if (a.kind == VALUE_PTR || b.kind == VALUE_PTR) {
+        result = make_type(VALUE_PTR, 0);
+    } else if (a.kind == VALUE_DOUBLE || b.kind == VALUE_DOUBLE) {
+        result = make_type(VALUE_DOUBLE, 0);
+    } else if (a.kind == VALUE_FLOAT || b.kind == VALUE_FLOAT) {
+        result = make_type(VALUE_FLOAT, 0);
+    } else if (a.kind == VALUE_VOID || b.kind == VALUE_VOID) {
+        result = a.kind == VALUE_VOID ? b : a;
+    } else {
+        result = a.kind > b.kind ? a : b;
+    }
+    result.is_literal = a.is_literal && b.is_literal;
+    return result;
+}
+
+// 节点标志
+#define FLAG_GLOBAL   0x01   // 顶层变量
+#define FLAG_EXTERNAL 0x02   // 头文件中的声明（C函数及其参数）
+
+// 用到的运行时函数
+#define RUNTIME_PRINTF 0x01
+#define RUNTIME_STRCMP 0x02
+#define RUNTIME_CONCAT 0x04
+
+typedef struct {
+    uint32_t break_label;
+    uint32_t continue_label;
+} LoopLabels;
+
+typedef struct {
+    const FlatAST* ast;
+    const TailCalls* tail_calls;
+    const Escapes* escapes;
+    Buffer globals;          // 字符串常量、全局变量与外部函数声明
+    Buffer functions;        // 函数定义
+    Buffer entry;            // 当前函数入口块中的 alloca
+    Buffer body;             // 当前函数的其余指令
+    Buffer name;             // 拼接名字的临时缓冲区
+    Buffer arguments;        // 拼接实参列表的临时缓冲区
+    ValueType* types;        // 每个节点的值类型：函数为返回类型，声明为变量类型
+    uint8_t* flags;
+    uint8_t* symbol_states;  // 函数名与顶层变量名已声明（1）或已定义（2），避免重复声明
+    uint32_t symbol_limit;
+    uint32_t* string_ids;    // 字符串符号对应的常量编号加一
+    uint32_t* string_lengths;// 每个字符串常量的字节数（含结尾的 0）
+    uint32_t string_id_limit;
+    uint32_t string_count;
+    uint32_t runtime;
+    Symbol main_name;
+    Symbol print_name;
+    Symbol println_name;
+
+    // 当前函数
+    NodeId function;
+    ValueType return_type;
+    uint32_t temp_count;
+    uint32_t label_count;
+    char block[24];          // 当前基本块的标签，phi 需要
+    int terminated;          // 当前基本块已经以终结指令结束
+    LoopLabels* loops;
+    int loop_count;
+    int loop_capacity;
+    char* error_message;     // 第一个无法生成的构造（如签名不同的 musttail 尾调用），生成失败
+} Emitter;
+
+// ---------------------------------------------------------------------------
+// 名字
+
+static int is_plain_name(const char* text, int length) {
+    if (length == 0) return 0;
+    for (int i = 0; i < length; i++) {
+        char c = text[i];
+        int letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '.' || c == '$';
+        if (!letter && !(i > 0 && c >= '0' && c <= '9')) return 0;
+    }
+    return 1;
+}
+
+// 把字节序列写成LLVM的引号字符串内容，不可打印字符、引号和反斜杠写成 \XX
+static void append_escaped(Buffer* buffer, const unsigned char* bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+        if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\') {
+            append_bytes(buffer, (const char*)&c, 1);
+        } else {
+            appendf(buffer, "\\%02X", c);
+        }
+    }
+}
+
+// 全局名字：@name，含非标识符字符时写成 @"..."
+static void append_global_name(Buffer* buffer, Symbol name) {
+    const char* text = symbol_name(name);
+    int length = symbol_length(name);
+    if (is_plain_name(text, length)) {
+        append(buffer, "@");
+        append_bytes(buffer, text, (size_t)length);
+    } else {
+        append(buffer, "@\"");
+        append_escaped(buffer, (const unsigned char*)text, (size_t)length);
+        append(buffer, "\"");
+    }
+}
+
+// 变量的存储位置：顶层变量为全局名字，局部变量与参数为 %名字.编号（名字不是普通标识符时用 v）
+static const char* storage_name(Emitter* e, NodeId declaration) {
+    Buffer* buffer = &e->name;
+    buffer_clear(buffer);
+    Symbol name = flat_name(e->ast, declaration);
+    if (e->flags[declaration] & FLAG_GLOBAL) {
+        append_global_name(buffer, name);
+    } else {
+        const char* text = symbol_name(name);
+        int length = symbol_length(name);
+        append(buffer, "%");
+        if (is_plain_name(text, length)) {
+            append_bytes(buffer, text, (size_t)length);
+        } else {
+            append(buffer, "v");
+        }
+        appendf(buffer, ".%u", declaration);
+    }
+    return buffer->failed ? "undef" : buffer->data;
+}
+
+static const char* function_name(Emitter* e, NodeId function) {
+    Buffer* buffer = &e->name;
+    buffer_clear(buffer);
+    append_global_name(buffer, flat_name(e->ast, function));
+    return buffer->failed ? "@undef" : buffer->data;
+}
+
+// ---------------------------------------------------------------------------
+// 类型推断
+
+static ValueType literal_type(const FlatLiteral* literal) {
+    ValueType type;
+    switch (literal->type) {
+        case LITERAL_INT:   type = make_type(VALUE_I64, 0); break;
+        case LITERAL_FLOAT: type = make_type(VALUE_DOUBLE, 0); break;
+        case LITERAL_BOOL:  return make_type(VALUE_I1, 1);
+        case LITERAL_STRING:return make_type(VALUE_PTR, 0);
+        default:            type = make_type(VALUE_PTR, 0); break;
+    }
+    type.is_literal = 1;
+    return type;
+}
+
+// 以类型关键字作为函数名的调用是类型转换，如 i64(x)；不是类型关键字时返回 TYPE_NONE
+static TypeId cast_type(const FlatAST* ast, NodeId call) {
+    Symbol name = flat_name(ast, call);
+    if (flat_record(ast, call)[1] != 1) return TYPE_NONE;
+    TypeId type = intern_type_text(symbol_name(name), symbol_length(name));
+    return type < TYPE_PRIMITIVE_END ? type : TYPE_NONE;
+}
+
+// 变量与参数的类型：标注的类型，否则取初始化表达式的类型，都没有时为 i64
+static ValueType declared_type(Emitter* e, NodeId declaration) {
+    const uint32_t* record = flat_record(e->ast, declaration);
+    ValueType type = map_type(record[1], e->flags[declaration] & FLAG_EXTERNAL);
+    if (type.kind == VALUE_VOID && record[1] == TYPE_NONE) type.kind = VALUE_UNKNOWN;
+    if (type.kind != VALUE_UNKNOWN) return type;
+    if (record[2] != NODE_NONE) {
+        type = e->types[record[2]];
+        if (type.kind == VALUE_VOID) type.kind = VALUE_UNKNOWN;
+        type.is_literal = 0;
+        return type;
+    }
+    return make_type(VALUE_I64, 0);
+}
+
+static ValueType infer_node(Emitter* e, NodeId id, NodeId function) {
+    const FlatAST* ast = e->ast;
+    const uint32_t* record = flat_record(ast, id);
+    ValueType* types = e->types;
+    switch (flat_kind(ast, id)) {
+        case NODE_LITERAL:
+            return literal_type(flat_literal(ast, id));
+        case NODE_VARIABLE: {
+            NodeId declaration = flat_binding(ast, id);
+            if (declaration == NODE_NONE) return make_type(VALUE_UNKNOWN, 0);
+            if (flat_kind(ast, declaration) == NODE_FUNCTION) return make_type(VALUE_PTR, 0);
+            return types[declaration];
+        }
+        case NODE_FUNCTION_CALL: {
+            NodeId callee = flat_binding(ast, id);
+            if (callee != NODE_NONE && flat_kind(ast, callee) == NODE_FUNCTION) return types[callee];
+            TypeId cast = cast_type(ast, id);
+            return cast != TYPE_NONE ? map_type(cast, 0) : make_type(VALUE_UNKNOWN, 0);
+        }
+        case NODE_BINARY_OP: {
+            ValueType left = record[1] != NODE_NONE ? types[record[1]] : make_type(VALUE_UNKNOWN, 0);
+            ValueType right = record[2] != NODE_NONE ? types[record[2]] : make_type(VALUE_UNKNOWN, 0);
+            switch ((OperatorType)record[0]) {
+                case OP_EQ: case OP_NEQ: case OP_LT: case OP_LTE: case OP_GT: case OP_GTE:
+                case OP_AND: case OP_OR:
+                    return make_type(VALUE_I1, 1);
+                case OP_SHIFT_LEFT: case OP_SHIFT_RIGHT:
+                    return left;
+                case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+                case OP_BIT_AND: case OP_BIT_OR: case OP_BIT_XOR: case OP_ELVIS:
+                case OP_RANGE: case OP_RANGE_TO: case OP_RANGE_INCL:
+                    return unify(left, right);
+                case OP_ASSIGN: case OP_ADD_ASSIGN: case OP_SUB_ASSIGN: case OP_MUL_ASSIGN:
+                case OP_DIV_ASSIGN: case OP_MOD_ASSIGN: case OP_AND_ASSIGN: case OP_OR_ASSIGN:
+                case OP_XOR_ASSIGN: case OP_SHIFT_LEFT_ASSIGN: case OP_SHIFT_RIGHT_ASSIGN:
+                    return left;
+                default:
+                    return make_type(VALUE_UNKNOWN, 0);
+            }
+        }
+        case NODE_UNARY_OP:
+            if (record[0] == OP_NOT) return make_type(VALUE_I1, 1);
+            return record[1] != NODE_NONE ? types[record[1]] : make_type(VALUE_UNKNOWN, 0);
+        case NODE_VARIABLE_DECL:
+            return declared_type(e, id);
+        case NODE_FOR_STATEMENT: {
+            NodeId iterable = record[1];
+            if (iterable != NODE_NONE && flat_kind(ast, iterable) == NODE_BINARY_OP) {
+                ValueType type = types[iterable];
+                type.is_literal = 0;
+                return type;
+            }
+            return make_type(VALUE_I64, 0);
+        }
+        case NODE_RETURN:
+            // 未标注返回类型的函数取各个 return 表达式类型的公共类型
+            if (function != NODE_NONE && record[0] != NODE_NONE && flat_record(ast, function)[1] == TYPE_NONE &&
+                function != NODE_NONE && flat_name(ast, function) != e->main_name) {
+                ValueType value = types[record[0]];
+                value.is_literal = 0;
+                if (value.kind != VALUE_UNKNOWN && value.kind != VALUE_VOID) {
+                    ValueType current = types[function];
+                    types[function] = current.kind == VALUE_UNKNOWN ? value : unify(current, value);
                 }
             }
+            return make_type(VALUE_VOID, 0);
+        default:
+            return types[id];
+    }
+}
+
+// 后序扫描若干轮，直到类型不再变化（函数的返回类型与前向引用需要多轮）
+static void infer_types(Emitter* e) {
+    const FlatAST* ast = e->ast;
+    NodeId* stack = (NodeId*)malloc(sizeof(NodeId) * (ast->count + 1));
+    if (!stack) {
+        e->globals.failed = 1;
+        return;
+    }
+    for (int round = 0; round < 8; round++) {
+        int changed = 0;
+        uint32_t depth = 0;
+        NodeId function = NODE_NONE;
+        for (NodeId id = FLAT_AST_ROOT; id <= ast->count; id++) {
+            while (depth > 0 && (id == ast->count || id >= ast->ends[stack[depth - 1]])) {
+                NodeId done = stack[--depth];
+                ASTNodeType kind = flat_kind(ast, done);
+                if (kind == NODE_FUNCTION || kind == NODE_INCLUDE || kind == NODE_PROGRAM) continue;
+                ValueType type = infer_node(e, done, function);
+                if (!same_type(type, e->types[done])) {
+                    e->types[done] = type;
+                    changed = 1;
+                }
+            }
+            if (id == ast->count) break;
+            if (flat_kind(ast, id) == NODE_FUNCTION) function = id;
+            stack[depth++] = id;
         }
-    } else if (root->type == NODE_FUNCTION) {
-        // 单个函数节点作为根节点的情况
-        if (root->function.name && strcmp(root->function.name, "main") == 0) {
-            strcat(ir_code, "; 主函数\n");
-            strcat(ir_code, "@.str = private unnamed_addr constant [12 x i8] c\"Hello, scp!\\00\", align 1\n");
-            strcat(ir_code, "declare i32 @puts(i8* nocapture) nounwind\n\n");
-            strcat(ir_code, "define i32 @main() {\n");
-            strcat(ir_code, "    %call = call i32 @puts(i8* getelementptr inbounds ([12 x i8], [12 x i8]* @.str, i64 0, i64 0))\n");
-            strcat(ir_code, "    ret i32 0\n");
-            strcat(ir_code, "}\n");
+        if (!changed && round > 0) break;
+    }
+    free(stack);
+
+    // 没有推断出返回类型的函数：有带值的 return 时为 i64，否则不返回值
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_FUNCTION || e->types[id].kind != VALUE_UNKNOWN) continue;
+        e->types[id] = make_type(VALUE_VOID, 0);
+        for (NodeId inner = id + 1; inner < ast->ends[id]; inner++) {
+            if (flat_kind(ast, inner) == NODE_RETURN && flat_record(ast, inner)[0] != NODE_NONE) {
+                e->types[id] = make_type(VALUE_I64, 0);
+                break;
+            }
         }
+    }
+}
+
+// 函数与参数的初始类型，以及节点标志
+static void prepare_declarations(Emitter* e) {
+    const FlatAST* ast = e->ast;
+    int count = flat_child_count(ast, FLAT_AST_ROOT);
+    for (int i = 0; i < count; i++) {
+        NodeId declaration = flat_child(ast, FLAT_AST_ROOT, i);
+        if (declaration == NODE_NONE) continue;
+        ASTNodeType kind = flat_kind(ast, declaration);
+        if (kind == NODE_INCLUDE) {
+            for (NodeId id = declaration; id < ast->ends[declaration]; id++) e->flags[id] |= FLAG_EXTERNAL;
+            // 头文件中的变量是定义在别处的全局变量
+            int inner_count = flat_child_count(ast, declaration);
+            for (int j = 0; j < inner_count; j++) {
+                NodeId inner = flat_child(ast, declaration, j);
+                if (inner != NODE_NONE && flat_kind(ast, inner) == NODE_VARIABLE_DECL) e->flags[inner] |= FLAG_GLOBAL;
+            }
+        } else if (kind == NODE_VARIABLE_DECL) {
+            e->flags[declaration] |= FLAG_GLOBAL;
+            Symbol name = flat_name(ast, declaration);
+            if (name < e->symbol_limit) e->symbol_states[name] = 2;
+        }
+    }
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_FUNCTION) continue;
+        const uint32_t* record = flat_record(ast, id);
+        if (record[0] == e->main_name && !(e->flags[id] & FLAG_EXTERNAL)) {
+            e->types[id] = make_type(VALUE_I32, 0);
+        } else {
+            e->types[id] = map_type(record[1], e->flags[id] & FLAG_EXTERNAL);
+        }
+        Symbol name = record[0];
+        if (name < e->symbol_limit) {
+            uint8_t state = record[2] != NODE_NONE ? 2 : 1;
+            if (state > e->symbol_states[name]) e->symbol_states[name] = state;
+        }
+    }
+}
+
+// 变量的存储类型
+static ValueType storage_type(Emitter* e, NodeId declaration) {
+    ValueType type = resolved(e->types[declaration]);
+    if (type.kind == VALUE_VOID) type = make_type(VALUE_I64, 0);
+    return type;
+}
+
+static ValueType return_type(Emitter* e, NodeId function) {
+    return resolved(e->types[function]);
+}
+
+// ---------------------------------------------------------------------------
+// 基本块与指令
+
+static void start_block(Emitter* e, const char* label) {
+    appendf(&e->body, "%s:\n", label);
+    snprintf(e->block, sizeof(e->block), "%s", label);
+    e->terminated = 0;
+}
+
+static uint32_t new_label(Emitter* e) {
+    return ++e->label_count;
+}
+
+static void label_text(char* out, size_t size, uint32_t label) {
+    snprintf(out, size, "L%u", label);
+}
+
+// 终结指令之后的代码不可达，放进一个新的基本块
+static void ensure_block(Emitter* e) {
+    if (!e->terminated) return;
+    char label[24];
+    label_text(label, sizeof(label), new_label(e));
+    start_block(e, label);
+}
+
+static void instruction(Emitter* e, const char* format, ...) {
+    ensure_block(e);
+    append(&e->body, "  ");
+    va_list args;
+    va_start(args, format);
+    vappendf(&e->body, format, args);
+    va_end(args);
+    append(&e->body, "\n");
+}
+
+static void comment(Emitter* e, const char* text) {
+    appendf(&e->body, "  ; %s\n", text);
+}
+
+static void branch(Emitter* e, const char* label) {
+    instruction(e, "br label %%%s", label);
+    e->terminated = 1;
+}
+
+static void branch_to(Emitter* e, uint32_t label) {
+    char text[24];
+    label_text(text, sizeof(text), label);
+    branch(e, text);
+}
+
+static void conditional_branch(Emitter* e, const char* condition, uint32_t then_label, uint32_t else_label) {
+    instruction(e, "br i1 %s, label %%L%u, label %%L%u", condition, then_label, else_label);
+    e->terminated = 1;
+}
+
+// 进入标签为 label 的基本块，当前基本块没有结束时直接落入
+static void enter_label(Emitter* e, uint32_t label) {
+    char text[24];
+    label_text(text, sizeof(text), label);
+    if (!e->terminated) branch(e, text);
+    start_block(e, text);
+}
+
+static Value new_value(Emitter* e, ValueType type) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = type;
+    snprintf(value.text, sizeof(value.text), "%%t%u", ++e->temp_count);
+    return value;
+}
+
+// 记录第一个无法生成代码的原因，generate_code 因此失败
+static void report_error(Emitter* e, const char* format, ...) {
+    if (e->error_message) return;
+    char buffer[320];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    e->error_message = strdup(buffer);
+}
+
+static Value undef_value(ValueType type) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = resolved(type);
+    if (value.type.kind == VALUE_VOID) value.type = make_type(VALUE_I64, 0);
+    snprintf(value.text, sizeof(value.text), "undef");
+    return value;
+}
+
+static Value void_value(void) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = make_type(VALUE_VOID, 0);
+    return value;
+}
+
+// 整数常量：按位宽截断，无符号类型零扩展、有符号类型符号扩展
+static Value integer_constant(ValueType type, long long integer) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = type;
+    value.constant = 1;
+    int bits = integer_bits(type.kind);
+    if (bits == 1) {
+        integer = integer != 0;
+        snprintf(value.text, sizeof(value.text), "%s", integer ? "true" : "false");
     } else {
-        strcat(ir_code, "; 不支持的根节点类型\n");
+        // 非整数类型的位宽为 0，不做截断
+        if (bits > 0 && bits < 64) {
+            unsigned long long mask = (1ULL << bits) - 1;
+            unsigned long long bitsValue = (unsigned long long)integer & mask;
+            long long text_value = (long long)bitsValue;
+            if (bitsValue >> (bits - 1)) text_value = (long long)(bitsValue | ~mask);
+            integer = type.is_unsigned ? (long long)bitsValue : text_value;
+            snprintf(value.text, sizeof(value.text), "%lld", text_value);
+        } else if (bits == 128 && type.is_unsigned && integer < 0) {
+            snprintf(value.text, sizeof(value.text), "%llu", (unsigned long long)integer);
+        } else {
+            snprintf(value.text, sizeof(value.text), "%lld", integer);
+        }
     }
-    
-    // 如果没有生成任何代码，添加默认main函数
-    if (strlen(ir_code) < 30) {
-        strcat(ir_code, "define i32 @main() {\n");
-        strcat(ir_code, "  ret i32 0\n");
-        strcat(ir_code, "}\n");
+    value.integer = integer;
+    value.real = type.is_unsigned ? (double)(unsigned long long)integer : (double)integer;
+    return value;
+}
+
+// 浮点常量写成 double 的十六进制位模式；float 先舍入到单精度
+static Value real_constant(ValueType type, double real) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = type;
+    value.constant = 1;
+    if (type.kind == VALUE_FLOAT) real = (double)(float)real;
+    value.real = real;
+    value.integer = (long long)real;
+    unsigned long long bits;
+    memcpy(&bits, &real, sizeof(bits));
+    snprintf(value.text, sizeof(value.text), "0x%016llX", bits);
+    return value;
+}
+
+static Value null_constant(void) {
+    Value value;
+    memset(&value, 0, sizeof(value));
+    value.type = make_type(VALUE_PTR, 0);
+    value.constant = 1;
+    snprintf(value.text, sizeof(value.text), "null");
+    return value;
+}
+
+static Value zero_value(ValueType type) {
+    type = resolved(type);
+    if (type.kind == VALUE_PTR) return null_constant();
+    if (is_float_kind(type.kind)) return real_constant(type, 0.0);
+    if (type.kind == VALUE_VOID) return void_value();
+    return integer_constant(type, 0);
+}
+
+// 转换为指定类型：常量在编译期换算，其他值生成转换指令
+static Value convert(Emitter* e, Value value, ValueType to) {
+    to = resolved(to);
+    ValueType from = value.type;
+    if (to.kind == VALUE_VOID) return value;
+    if (from.kind == VALUE_VOID) return zero_value(to);
+    if (from.kind == to.kind) {
+        if (value.constant && is_integer_kind(to.kind)) return integer_constant(to, value.integer);
+        value.type = to;
+        return value;
+    }
+    if (value.constant && !(to.kind == VALUE_PTR && from.kind != VALUE_PTR && value.integer != 0)) {
+        if (to.kind == VALUE_PTR) return null_constant();
+        if (from.kind == VALUE_PTR) return zero_value(to);
+        if (is_float_kind(to.kind)) return real_constant(to, value.real);
+        if (to.kind == VALUE_I1) return integer_constant(to, is_float_kind(from.kind) ? value.real != 0.0 : value.integer != 0);
+        if (is_float_kind(from.kind)) {
+            double real = value.real;
+            if (!(real > -9.3e18 && real < 1.8e19)) real = 0.0;
+            long long integer = real >= 9.2e18 ? (long long)(unsigned long long)real : (long long)real;
+            return integer_constant(to, integer);
+        }
+        return integer_constant(to, value.integer);
+    }
+
+    const char* source = type_text(from);
+    const char* target = type_text(to);
+    const char* opcode = NULL;
+    if (to.kind == VALUE_I1) {
+        Value result = new_value(e, to);
+        if (from.kind == VALUE_PTR) {
+            instruction(e, "%s = icmp ne i8* %s, null", result.text, value.text);
+        } else if (is_float_kind(from.kind)) {
+            instruction(e, "%s = fcmp une %s %s, 0.0", result.text, source, value.text);
+        } else {
+            instruction(e, "%s = icmp ne %s %s, 0", result.text, source, value.text);
+        }
+        return result;
+    }
+    if (is_integer_kind(from.kind) && is_integer_kind(to.kind)) {
+        int from_bits = integer_bits(from.kind);
+        int to_bits = integer_bits(to.kind);
+        opcode = to_bits < from_bits ? "trunc" : (from.is_unsigned || from.kind == VALUE_I1 ? "zext" : "sext");
+    } else if (is_integer_kind(from.kind) && is_float_kind(to.kind)) {
+        opcode = from.is_unsigned ? "uitofp" : "sitofp";
+    } else if (is_float_kind(from.kind) && is_integer_kind(to.kind)) {
+        opcode = to.is_unsigned ? "fptoui" : "fptosi";
+    } else if (is_float_kind(from.kind) && is_float_kind(to.kind)) {
+        opcode = to.kind == VALUE_DOUBLE ? "fpext" : "fptrunc";
+    } else if (from.kind == VALUE_PTR && is_integer_kind(to.kind)) {
+        opcode = "ptrtoint";
+    } else if (is_integer_kind(from.kind) && to.kind == VALUE_PTR) {
+        opcode = "inttoptr";
+    } else {
+        return undef_value(to);
+    }
+    Value result = new_value(e, to);
+    instruction(e, "%s = %s %s %s to %s", result.text, opcode, source, value.text, target);
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// 字符串常量
+
+// 处理转义序列，返回新分配的字节序列
+static unsigned char* unescape(const char* text, int length, size_t* out_length) {
+    unsigned char* bytes = (unsigned char*)malloc((size_t)length + 1);
+    if (!bytes) return NULL;
+    size_t count = 0;
+    for (int i = 0; i < length; i++) {
+        char c = text[i];
+        if (c != '\\' || i + 1 >= length) {
+            bytes[count++] = (unsigned char)c;
+            continue;
+        }
+        char next = text[++i];
+        switch (next) {
+            case 'n':  bytes[count++] = '\n'; break;
+            case 't':  bytes[count++] = '\t'; break;
+            case 'r':  bytes[count++] = '\r'; break;
+            case '0':  bytes[count++] = '\0'; break;
+            case 'x': {
+                int digits = 0;
+                unsigned value = 0;
+                while (digits < 2 && i + 1 < length) {
+                    char h = text[i + 1];
+                    int digit = h >= '0' && h <= '9' ? h - '0' : h >= 'a' && h <= 'f' ? h - 'a' + 10 :
+                                h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+                    if (digit < 0) break;
+                    value = value * 16 + (unsigned)digit;
+                    i++;
+                    digits++;
+                }
+                bytes[count++] = digits ? (unsigned char)value : 'x';
+                break;
+            }
+            default:   bytes[count++] = (unsigned char)next; break;
+        }
+    }
+    *out_length = count;
+    return bytes;
+}
+
+// 字符串常量的编号（相同文本只生成一次），失败时返回 0
+static uint32_t string_constant(Emitter* e, Symbol text) {
+    if (text >= e->string_id_limit) {
+        uint32_t limit = e->string_id_limit ? e->string_id_limit : 64;
+        while (limit <= text) limit *= 2;
+        uint32_t* ids = (uint32_t*)realloc(e->string_ids, sizeof(uint32_t) * limit);
+        if (!ids) {
+            e->globals.failed = 1;
+            return 0;
+        }
+        memset(ids + e->string_id_limit, 0, sizeof(uint32_t) * (limit - e->string_id_limit));
+        e->string_ids = ids;
+        e->string_id_limit = limit;
+    }
+    if (e->string_ids[text]) return e->string_ids[text];
+
+    size_t length = 0;
+    unsigned char* bytes = unescape(symbol_name(text), symbol_length(text), &length);
+    uint32_t* lengths = (uint32_t*)realloc(e->string_lengths, sizeof(uint32_t) * (e->string_count + 1));
+    if (!bytes || !lengths) {
+        free(bytes);
+        if (lengths) e->string_lengths = lengths;
+        e->globals.failed = 1;
+        return 0;
+    }
+    e->string_lengths = lengths;
+    uint32_t id = ++e->string_count;
+    e->string_lengths[id - 1] = (uint32_t)length + 1;
+    appendf(&e->globals, "@.str.%u = private unnamed_addr constant [%u x i8] c\"", id, (unsigned)length + 1);
+    append_escaped(&e->globals, bytes, length);
+    append(&e->globals, "\\00\", align 1\n");
+    free(bytes);
+    e->string_ids[text] = id;
+    return id;
+}
+
+// 指向字符串常量首字节的常量表达式
+static void string_pointer(Emitter* e, uint32_t id, char* out, size_t size) {
+    uint32_t length = id ? e->string_lengths[id - 1] : 1;
+    snprintf(out, size, "getelementptr inbounds ([%u x i8], [%u x i8]* @.str.%u, i64 0, i64 0)", length, length, id);
+}
+
+static Value string_value(Emitter* e, Symbol text) {
+    uint32_t id = string_constant(e, text);
+    if (!id) return null_constant();
+    uint32_t length = e->string_lengths[id - 1];
+    Value value = new_value(e, make_type(VALUE_PTR, 0));
+    instruction(e, "%s = getelementptr inbounds [%u x i8], [%u x i8]* @.str.%u, i64 0, i64 0",
+                value.text, length, length, id);
+    return value;
+}
+
+static Value literal_value(Emitter* e, const FlatLiteral* literal) {
+    switch (literal->type) {
+        case LITERAL_INT: {
+            Value value = integer_constant(make_type(VALUE_I64, 0), literal->int_value);
+            value.type.is_literal = 1;
+            return value;
+        }
+        case LITERAL_FLOAT: {
+            Value value = real_constant(make_type(VALUE_DOUBLE, 0), literal->float_value);
+            value.type.is_literal = 1;
+            return value;
+        }
+        case LITERAL_BOOL:   return integer_constant(make_type(VALUE_I1, 1), literal->bool_value);
+        case LITERAL_STRING: return string_value(e, literal->string_value);
+        default:             return null_constant();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 表达式
+
+static Value emit_expression(Emitter* e, NodeId id);
+static void emit_statement(Emitter* e, NodeId id);
+
+static Value load_variable(Emitter* e, NodeId declaration) {
+    ValueType type = storage_type(e, declaration);
+    Value value = new_value(e, type);
+    const char* name = storage_name(e, declaration);
+    instruction(e, "%s = load %s, %s* %s", value.text, type_text(type), type_text(type), name);
+    return value;
+}
+
+static void store_variable(Emitter* e, NodeId declaration, Value value) {
+    ValueType type = storage_type(e, declaration);
+    value = convert(e, value, type);
+    const char* name = storage_name(e, declaration);
+    instruction(e, "store %s %s, %s* %s", type_text(type), value.text, type_text(type), name);
+}
+
+static void allocate_variable(Emitter* e, NodeId declaration) {
+    const char* name = storage_name(e, declaration);
+    appendf(&e->entry, "  %s = alloca %s\n", name, type_text(storage_type(e, declaration)));
+}
+
+// 赋值目标所指向的变量，不是变量时返回 NODE_NONE
+static NodeId assigned_variable(Emitter* e, NodeId target) {
+    if (target == NODE_NONE || flat_kind(e->ast, target) != NODE_VARIABLE) return NODE_NONE;
+    NodeId declaration = flat_binding(e->ast, target);
+    if (declaration == NODE_NONE || flat_kind(e->ast, declaration) == NODE_FUNCTION) return NODE_NONE;
+    return declaration;
+}
+
+// 函数的指针类型，如 i64 (i64, i8*)*
+static void append_function_type(Emitter* e, Buffer* buffer, NodeId function) {
+    const uint32_t* record = flat_record(e->ast, function);
+    appendf(buffer, "%s (", type_text(return_type(e, function)));
+    for (uint32_t i = 0; i < record[3]; i++) {
+        appendf(buffer, "%s%s", i ? ", " : "", type_text(storage_type(e, record[5 + i])));
     }
-    
-    return ir_code;
+    append(buffer, ")*");
+}
+
+static Value function_reference(Emitter* e, NodeId function) {
+    Buffer* buffer = &e->arguments;
+    buffer_clear(buffer);
+    append_function_type(e, buffer, function);
+    append(buffer, " ");
+    append_global_name(buffer, flat_name(e->ast, function));
+    Value value = new_value(e, make_type(VALUE_PTR, 0));
+    instruction(e, "%s = bitcast %s to i8*", value.text, buffer->failed ? "i8* null" : buffer->data);
+    return value;
+}
+
+// 字符串拼接。结果不逃逸的拼接点在入口块中保留固定大小的缓冲区，放得下时结果直接写入缓冲区
+static Value concat_strings(Emitter* e, NodeId site, Value left, Value right) {
+    e->runtime |= RUNTIME_CONCAT;
+    Value value = new_value(e, make_type(VALUE_PTR, 0));
+    if (!stack_allocated(e->escapes, site)) {
+        instruction(e, "%s = call i8* @scp.concat(i8* %s, i8* %s)", value.text, left.text, right.text);
+        return value;
+    }
+    appendf(&e->entry, "  %%concat.%u = alloca [%d x i8]\n", site, STACK_STRING_CAPACITY);
+    Value buffer = new_value(e, make_type(VALUE_PTR, 0));
+    instruction(e, "%s = getelementptr inbounds [%d x i8], [%d x i8]* %%concat.%u, i64 0, i64 0",
+                buffer.text, STACK_STRING_CAPACITY, STACK_STRING_CAPACITY, site);
+    instruction(e, "%s = call i8* @scp.concat.into(i8* %s, i8* %s, i8* %s, i64 %d)",
+                value.text, left.text, right.text, buffer.text, STACK_STRING_CAPACITY);
+    return value;
+}
+
+// 算术与位运算，两个操作数已经转换为 type；site 为字符串拼接所在的节点（没有时为 NODE_NONE）
+static Value arithmetic(Emitter* e, NodeId site, OperatorType op, ValueType type, Value left, Value right) {
+    const char* opcode = NULL;
+    if (type.kind == VALUE_PTR) {
+        if (op == OP_ADD) return concat_strings(e, site, left, right);
+    } else if (is_float_kind(type.kind)) {
+        switch (op) {
+            case OP_ADD: opcode = "fadd"; break;
+            case OP_SUB: opcode = "fsub"; break;
+            case OP_MUL: opcode = "fmul"; break;
+            case OP_DIV: opcode = "fdiv"; break;
+            case OP_MOD: opcode = "frem"; break;
+            default: break;
+        }
+    } else {
+        int is_unsigned = type.is_unsigned;
+        switch (op) {
+            case OP_ADD:         opcode = "add"; break;
+            case OP_SUB:         opcode = "sub"; break;
+            case OP_MUL:         opcode = "mul"; break;
+            case OP_DIV:         opcode = is_unsigned ? "udiv" : "sdiv"; break;
+            case OP_MOD:         opcode = is_unsigned ? "urem" : "srem"; break;
+            case OP_BIT_AND:     opcode = "and"; break;
+            case OP_BIT_OR:      opcode = "or"; break;
+            case OP_BIT_XOR:     opcode = "xor"; break;
+            case OP_SHIFT_LEFT:  opcode = "shl"; break;
+            case OP_SHIFT_RIGHT: opcode = is_unsigned ? "lshr" : "ashr"; break;
+            default: break;
+        }
+    }
+    if (!opcode) {
+        comment(e, "暂不支持的运算");
+        return undef_value(type);
+    }
+    Value value = new_value(e, type);
+    instruction(e, "%s = %s %s %s, %s", value.text, opcode, type_text(type), left.text, right.text);
+    return value;
+}
+
+static Value emit_comparison(Emitter* e, OperatorType op, NodeId left_id, NodeId right_id) {
+    ValueType type = resolved(unify(e->types[left_id], e->types[right_id]));
+    if (type.kind == VALUE_VOID) type = make_type(VALUE_I64, 0);
+    Value left = convert(e, emit_expression(e, left_id), type);
+    Value right = convert(e, emit_expression(e, right_id), type);
+    Value value = new_value(e, make_type(VALUE_I1, 1));
+    static const char* const signed_predicates[] = { "eq", "ne", "slt", "sle", "sgt", "sge" };
+    static const char* const unsigned_predicates[] = { "eq", "ne", "ult", "ule", "ugt", "uge" };
+    static const char* const float_predicates[] = { "oeq", "une", "olt", "ole", "ogt", "oge" };
+    int index = (int)op - (int)OP_EQ;
+    if (type.kind == VALUE_PTR && !left.constant && !right.constant) {
+        // 两侧都不是 null 的字符串按内容比较
+        e->runtime |= RUNTIME_STRCMP;
+        Value order = new_value(e, make_type(VALUE_I32, 0));
+        instruction(e, "%s = call i32 @strcmp(i8* %s, i8* %s)", order.text, left.text, right.text);
+        instruction(e, "%s = icmp %s i32 %s, 0", value.text, signed_predicates[index], order.text);
+    } else if (is_float_kind(type.kind)) {
+        instruction(e, "%s = fcmp %s %s %s, %s", value.text, float_predicates[index], type_text(type), left.text, right.text);
+    } else {
+        const char* predicate = type.is_unsigned || type.kind == VALUE_PTR ? unsigned_predicates[index] : signed_predicates[index];
+        instruction(e, "%s = icmp %s %s %s, %s", value.text, predicate, type_text(type), left.text, right.text);
+    }
+    return value;
+}
+
+// && 与 ||：右操作数只在需要时求值，结果由 phi 合并
+static Value emit_logical(Emitter* e, OperatorType op, NodeId left_id, NodeId right_id) {
+    Value left = convert(e, emit_expression(e, left_id), make_type(VALUE_I1, 1));
+    ensure_block(e);
+    char left_block[24];
+    snprintf(left_block, sizeof(left_block), "%s", e->block);
+    uint32_t right_label = new_label(e);
+    uint32_t end_label = new_label(e);
+    if (op == OP_AND) {
+        conditional_branch(e, left.text, right_label, end_label);
+    } else {
+        conditional_branch(e, left.text, end_label, right_label);
+    }
+    enter_label(e, right_label);
+    Value right = convert(e, emit_expression(e, right_id), make_type(VALUE_I1, 1));
+    ensure_block(e);
+    char right_block[24];
+    snprintf(right_block, sizeof(right_block), "%s", e->block);
+    branch_to(e, end_label);
+    enter_label(e, end_label);
+    Value value = new_value(e, make_type(VALUE_I1, 1));
+    instruction(e, "%s = phi i1 [ %s, %%%s ], [ %s, %%%s ]", value.text, op == OP_AND ? "false" : "true",
+                left_block, right.text, right_block);
+    return value;
+}
+
+// a ?: b：a 不为 null 时取 a，否则求值 b
+static Value emit_elvis(Emitter* e, NodeId id, NodeId left_id, NodeId right_id) {
+    ValueType type = resolved(e->types[id]);
+    if (type.kind == VALUE_VOID) type = make_type(VALUE_I64, 0);
+    Value left = convert(e, emit_expression(e, left_id), type);
+    if (type.kind != VALUE_PTR) return left;
+    Value present = new_value(e, make_type(VALUE_I1, 1));
+    instruction(e, "%s = icmp ne i8* %s, null", present.text, left.text);
+    char left_block[24];
+    snprintf(left_block, sizeof(left_block), "%s", e->block);
+    uint32_t right_label = new_label(e);
+    uint32_t end_label = new_label(e);
+    conditional_branch(e, present.text, end_label, right_label);
+    enter_label(e, right_label);
+    Value right = convert(e, emit_expression(e, right_id), type);
+    ensure_block(e);
+    char right_block[24];
+    snprintf(right_block, sizeof(right_block), "%s", e->block);
+    branch_to(e, end_label);
+    enter_label(e, end_label);
+    Value value = new_value(e, type);
+    instruction(e, "%s = phi i8* [ %s, %%%s ], [ %s, %%%s ]", value.text, left.text, left_block, right.text, right_block);
+    return value;
+}
+
+static OperatorType compound_operator(OperatorType op) {
+    switch (op) {
+        case OP_ADD_ASSIGN:         return OP_ADD;
+        case OP_SUB_ASSIGN:         return OP_SUB;
+        case OP_MUL_ASSIGN:         return OP_MUL;
+        case OP_DIV_ASSIGN:         return OP_DIV;
+        case OP_MOD_ASSIGN:         return OP_MOD;
+        case OP_AND_ASSIGN:         return OP_BIT_AND;
+        case OP_OR_ASSIGN:          return OP_BIT_OR;
+        case OP_XOR_ASSIGN:         return OP_BIT_XOR;
+        case OP_SHIFT_LEFT_ASSIGN:  return OP_SHIFT_LEFT;
+        case OP_SHIFT_RIGHT_ASSIGN: return OP_SHIFT_RIGHT;
+        default:                    return op;
+    }
+}
+
+static Value emit_binary(Emitter* e, NodeId id) {
+    const uint32_t* record = flat_record(e->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    NodeId left_id = record[1];
+    NodeId right_id = record[2];
+    if (left_id == NODE_NONE || right_id == NODE_NONE) return undef_value(e->types[id]);
+    switch (op) {
+        case OP_AND:
+        case OP_OR:
+            return emit_logical(e, op, left_id, right_id);
+        case OP_ELVIS:
+            return emit_elvis(e, id, left_id, right_id);
+        case OP_EQ: case OP_NEQ: case OP_LT: case OP_LTE: case OP_GT: case OP_GTE:
+            return emit_comparison(e, op, left_id, right_id);
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD:
+        case OP_BIT_AND: case OP_BIT_OR: case OP_BIT_XOR: case OP_SHIFT_LEFT: case OP_SHIFT_RIGHT: {
+            ValueType type = resolved(e->types[id]);
+            if (type.kind == VALUE_VOID) type = make_type(VALUE_I64, 0);
+            Value left = convert(e, emit_expression(e, left_id), type);
+            Value right = convert(e, emit_expression(e, right_id), type);
+            return arithmetic(e, id, op, type, left, right);
+        }
+        case OP_ASSIGN: {
+            Value value = emit_expression(e, right_id);
+            NodeId declaration = assigned_variable(e, left_id);
+            if (declaration == NODE_NONE) {
+                comment(e, "暂不支持的赋值目标");
+                return value;
+            }
+            value = convert(e, value, storage_type(e, declaration));
+            store_variable(e, declaration, value);
+            return value;
+        }
+        case OP_ADD_ASSIGN: case OP_SUB_ASSIGN: case OP_MUL_ASSIGN: case OP_DIV_ASSIGN: case OP_MOD_ASSIGN:
+        case OP_AND_ASSIGN: case OP_OR_ASSIGN: case OP_XOR_ASSIGN:
+        case OP_SHIFT_LEFT_ASSIGN: case OP_SHIFT_RIGHT_ASSIGN: {
+            NodeId declaration = assigned_variable(e, left_id);
+            if (declaration == NODE_NONE) {
+                comment(e, "暂不支持的赋值目标");
+                return emit_expression(e, right_id);
+            }
+            ValueType type = storage_type(e, declaration);
+            Value old_value = load_variable(e, declaration);
+            Value right = convert(e, emit_expression(e, right_id), type);
+            Value value = arithmetic(e, id, compound_operator(op), type, old_value, right);
+            store_variable(e, declaration, value);
+            return value;
+        }
+        default:
+            comment(e, "暂不支持的表达式");
+            return undef_value(e->types[id]);
+    }
+}
+
+static Value emit_unary(Emitter* e, NodeId id) {
+    const uint32_t* record = flat_record(e->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    NodeId operand = record[1];
+    if (operand == NODE_NONE) return undef_value(e->types[id]);
+    switch (op) {
+        case OP_PRE_INC: case OP_PRE_DEC: case OP_POST_INC: case OP_POST_DEC: {
+            // 语义分析已拒绝非变量的操作数与标注为非数值类型的变量，这里还要检查推断出的类型
+            NodeId declaration = assigned_variable(e, operand);
+            ValueType type = declaration != NODE_NONE ? storage_type(e, declaration) : make_type(VALUE_VOID, 0);
+            if (declaration == NODE_NONE || type.kind == VALUE_I1 ||
+                (!is_integer_kind(type.kind) && !is_float_kind(type.kind))) {
+                Symbol name = flat_kind(e->ast, operand) == NODE_VARIABLE ? flat_name(e->ast, operand) : SYMBOL_NONE;
+                report_error(e, "自增自减的操作数必须是数值类型的变量: %.*s",
+                             name != SYMBOL_NONE ? symbol_length(name) : 0, name != SYMBOL_NONE ? symbol_name(name) : "");
+                return undef_value(e->types[id]);
+            }
+            Value old_value = load_variable(e, declaration);
+            Value one = is_float_kind(type.kind) ? real_constant(type, 1.0) : integer_constant(type, 1);
+            int increment = op == OP_PRE_INC || op == OP_POST_INC;
+            Value value = arithmetic(e, NODE_NONE, increment ? OP_ADD : OP_SUB, type, old_value, one);
+            store_variable(e, declaration, value);
+            return op == OP_PRE_INC || op == OP_PRE_DEC ? value : old_value;
+        }
+        case OP_NOT: {
+            Value value = convert(e, emit_expression(e, operand), make_type(VALUE_I1, 1));
+            if (value.constant) return integer_constant(value.type, !value.integer);
+            Value result = new_value(e, value.type);
+            instruction(e, "%s = xor i1 %s, true", result.text, value.text);
+            return result;
+        }
+        case OP_NEG:
+        case OP_BIT_NOT: {
+            Value value = emit_expression(e, operand);
+            ValueType type = resolved(value.type);
+            if (value.type.kind == VALUE_VOID || value.type.kind == VALUE_PTR) return undef_value(make_type(VALUE_I64, 0));
+            if (value.constant && op == OP_NEG) {
+                Value result = is_float_kind(type.kind) ? real_constant(type, -value.real) : integer_constant(type, -(unsigned long long)value.integer);
+                result.type.is_literal = value.type.is_literal;
+                return result;
+            }
+            Value result = new_value(e, type);
+            if (op == OP_NEG && is_float_kind(type.kind)) {
+                instruction(e, "%s = fneg %s %s", result.text, type_text(type), value.text);
+            } else if (op == OP_NEG) {
+                instruction(e, "%s = sub %s 0, %s", result.text, type_text(type), value.text);
+            } else if (is_integer_kind(type.kind)) {
+                instruction(e, "%s = xor %s %s, -1", result.text, type_text(type), value.text);
+            } else {
+                return undef_value(type);
+            }
+            return result;
+        }
+        default:
+            // 一元 + 与 !!（非空断言）不改变值
+            return emit_expression(e, operand);
+    }
+}
+
+// 调用的实参：转换为形参类型，缺少的实参取形参的字面量默认值，多余的实参只求值
+static Value* emit_arguments(Emitter* e, NodeId call, NodeId callee) {
+    const uint32_t* record = flat_record(e->ast, call);
+    const uint32_t* callee_record = flat_record(e->ast, callee);
+    uint32_t argument_count = record[1];
+    uint32_t parameter_count = callee_record[3];
+    Value* values = (Value*)malloc(sizeof(Value) * (parameter_count + 1));
+    if (!values) {
+        e->body.failed = 1;
+        return NULL;
+    }
+    for (uint32_t i = 0; i < argument_count; i++) {
+        Value value = emit_expression(e, record[2 + i]);
+        if (i < parameter_count) values[i] = convert(e, value, storage_type(e, callee_record[5 + i]));
+    }
+    for (uint32_t i = argument_count; i < parameter_count; i++) {
+        NodeId parameter = callee_record[5 + i];
+        NodeId initializer = flat_record(e->ast, parameter)[2];
+        Value value = initializer != NODE_NONE && flat_kind(e->ast, initializer) == NODE_LITERAL
+                          ? literal_value(e, flat_literal(e->ast, initializer))
+                          : zero_value(storage_type(e, parameter));
+        values[i] = convert(e, value, storage_type(e, parameter));
+    }
+    return values;
+}
+
+// print/println 的实参不是字符串时改用 printf 按类型格式化
+static Value emit_print(Emitter* e, NodeId call, int newline) {
+    Value value = emit_expression(e, flat_record(e->ast, call)[2]);
+    ValueType type = resolved(value.type);
+    const char* format;
+    char argument[96];
+    if (type.kind == VALUE_I1) {
+        Value yes = string_value(e, intern_cstr("true"));
+        Value no = string_value(e, intern_cstr("false"));
+        Value text = new_value(e, make_type(VALUE_PTR, 0));
+        instruction(e, "%s = select i1 %s, i8* %s, i8* %s", text.text, value.text, yes.text, no.text);
+        format = newline ? "%s\\n" : "%s";
+        snprintf(argument, sizeof(argument), "i8* %s", text.text);
+    } else if (is_float_kind(type.kind)) {
+        value = convert(e, value, make_type(VALUE_DOUBLE, 0));
+        format = newline ? "%g\\n" : "%g";
+        snprintf(argument, sizeof(argument), "double %s", value.text);
+    } else {
+        int is_unsigned = type.is_unsigned;
+        value = convert(e, value, make_type(VALUE_I64, is_unsigned));
+        format = is_unsigned ? (newline ? "%llu\\n" : "%llu") : (newline ? "%lld\\n" : "%lld");
+        snprintf(argument, sizeof(argument), "i64 %s", value.text);
+    }
+    Value pointer = string_value(e, intern_cstr(format));
+    e->runtime |= RUNTIME_PRINTF;
+    Value result = new_value(e, make_type(VALUE_I32, 0));
+    instruction(e, "%s = call i32 (i8*, ...) @printf(i8* %s, %s)", result.text, pointer.text, argument);
+    return void_value();
+}
+
+// prefix 为调用指令前的尾调用标记（""、"tail " 或 "musttail "）
+static Value emit_call(Emitter* e, NodeId id, const char* prefix) {
+    const FlatAST* ast = e->ast;
+    const uint32_t* record = flat_record(ast, id);
+    NodeId callee = flat_binding(ast, id);
+    if (callee == NODE_NONE || flat_kind(ast, callee) != NODE_FUNCTION) {
+        TypeId cast = cast_type(ast, id);
+        if (cast != TYPE_NONE && cast != TYPE_UNIT && cast != TYPE_NEVER) {
+            return convert(e, emit_expression(e, record[2]), map_type(cast, 0));
+        }
+        for (uint32_t i = 0; i < record[1]; i++) emit_expression(e, record[2 + i]);
+        comment(e, "未解析的调用");
+        return undef_value(e->types[id]);
+    }
+
+    Symbol name = flat_name(ast, callee);
+    if ((e->flags[callee] & FLAG_EXTERNAL) && (name == e->print_name || name == e->println_name) &&
+        record[1] == 1 && resolved(e->types[record[2]]).kind != VALUE_PTR) {
+        return emit_print(e, id, name == e->println_name);
+    }
+
+    const uint32_t* callee_record = flat_record(ast, callee);
+    uint32_t parameter_count = callee_record[3];
+    Value* values = emit_arguments(e, id, callee);
+    if (!values) return undef_value(e->types[id]);
+    Buffer* arguments = &e->arguments;
+    buffer_clear(arguments);
+    for (uint32_t i = 0; i < parameter_count; i++) {
+        appendf(arguments, "%s%s %s", i ? ", " : "", type_text(storage_type(e, callee_record[5 + i])), values[i].text);
+    }
+    free(values);
+    ValueType type = return_type(e, callee);
+    const char* argument_text = arguments->failed || !arguments->data ? "" : arguments->data;
+    const char* callee_name = function_name(e, callee);
+    if (type.kind == VALUE_VOID) {
+        instruction(e, "%scall void %s(%s)", prefix, callee_name, argument_text);
+        return void_value();
+    }
+    Value value = new_value(e, type);
+    instruction(e, "%s = %scall %s %s(%s)", value.text, prefix, type_text(type), callee_name, argument_text);
+    return value;
+}
+
+static Value emit_expression(Emitter* e, NodeId id) {
+    if (id == NODE_NONE) return undef_value(make_type(VALUE_I64, 0));
+    const FlatAST* ast = e->ast;
+    switch (flat_kind(ast, id)) {
+        case NODE_LITERAL:
+            return literal_value(e, flat_literal(ast, id));
+        case NODE_VARIABLE: {
+            NodeId declaration = flat_binding(ast, id);
+            if (declaration == NODE_NONE) {
+                comment(e, "未解析的名字");
+                return undef_value(e->types[id]);
+            }
+            if (flat_kind(ast, declaration) == NODE_FUNCTION) return function_reference(e, declaration);
+            return load_variable(e, declaration);
+        }
+        case NODE_FUNCTION_CALL:
+            return emit_call(e, id, "");
+        case NODE_BINARY_OP:
+            return emit_binary(e, id);
+        case NODE_UNARY_OP:
+            return emit_unary(e, id);
+        default:
+            // 语句出现在表达式位置
+            emit_statement(e, id);
+            return void_value();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 尾调用
+
+// 调用者与被调函数的LLVM签名完全相同时才能生成 musttail
+static int same_signature(Emitter* e, NodeId caller, NodeId callee) {
+    if (caller == NODE_NONE) return 0;
+    const uint32_t* caller_record = flat_record(e->ast, caller);
+    const uint32_t* callee_record = flat_record(e->ast, callee);
+    if (caller_record[0] == e->main_name || callee_record[0] == e->main_name) return 0;
+    if (caller_record[3] != callee_record[3]) return 0;
+    if (strcmp(type_text(return_type(e, caller)), type_text(return_type(e, callee))) != 0) return 0;
+    for (uint32_t i = 0; i < caller_record[3]; i++) {
+        if (strcmp(type_text(storage_type(e, caller_record[5 + i])), type_text(storage_type(e, callee_record[5 + i]))) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 同一递归环中签名不同的尾调用无法生成 musttail，退化为普通调用会使调用栈随递归深度增长
+static void report_tail_call_error(Emitter* e, NodeId call) {
+    Symbol caller = flat_name(e->ast, e->function);
+    Symbol callee = flat_name(e->ast, flat_binding(e->ast, call));
+    report_error(e, "tailrec 函数 %.*s 对 %.*s 的尾调用无法生成 musttail：两个函数的签名不同",
+                 symbol_length(caller), symbol_name(caller), symbol_length(callee), symbol_name(callee));
+}
+
+// 自调用改写为循环：先求出全部实参，再写回形参，最后跳回函数入口
+static void emit_loop_call(Emitter* e, NodeId call) {
+    NodeId function = e->function;
+    Value* values = emit_arguments(e, call, function);
+    if (!values) return;
+    const uint32_t* record = flat_record(e->ast, function);
+    for (uint32_t i = 0; i < record[3]; i++) store_variable(e, record[5 + i], values[i]);
+    free(values);
+    branch(e, "tailrec");
+}
+
+// 尾位置上对同一递归环中其他函数的调用：生成 musttail 调用并立即返回。签名不同时报告错误，返回 0
+static int emit_musttail_call(Emitter* e, NodeId call) {
+    NodeId callee = flat_binding(e->ast, call);
+    if (!same_signature(e, e->function, callee)) {
+        report_tail_call_error(e, call);
+        return 0;
+    }
+    Value value = emit_call(e, call, "musttail ");
+    if (value.type.kind == VALUE_VOID) {
+        instruction(e, "ret void");
+    } else {
+        instruction(e, "ret %s %s", type_text(value.type), value.text);
+    }
+    e->terminated = 1;
+    return 1;
+}
+
+static const char* call_prefix(Emitter* e, NodeId call) {
+    return tail_call_kind(e->tail_calls, call) == TAIL_CALL_MUSTTAIL ? "tail " : "";
+}
+
+// ---------------------------------------------------------------------------
+// 语句
+
+static void emit_default_return(Emitter* e) {
+    if (e->return_type.kind == VALUE_VOID) {
+        instruction(e, "ret void");
+    } else {
+        Value zero = zero_value(e->return_type);
+        instruction(e, "ret %s %s", type_text(e->return_type), zero.text);
+    }
+    e->terminated = 1;
+}
+
+static void emit_return(Emitter* e, NodeId id) {
+    NodeId expression = flat_record(e->ast, id)[0];
+    if (expression != NODE_NONE && flat_kind(e->ast, expression) == NODE_FUNCTION_CALL) {
+        TailCallKind kind = tail_call_kind(e->tail_calls, expression);
+        if (kind == TAIL_CALL_LOOP) {
+            emit_loop_call(e, expression);
+            return;
+        }
+        if (kind == TAIL_CALL_MUSTTAIL && emit_musttail_call(e, expression)) return;
+    }
+    if (expression == NODE_NONE) {
+        emit_default_return(e);
+        return;
+    }
+    Value value = expression != NODE_NONE && flat_kind(e->ast, expression) == NODE_FUNCTION_CALL
+                      ? emit_call(e, expression, call_prefix(e, expression))
+                      : emit_expression(e, expression);
+    if (e->return_type.kind == VALUE_VOID) {
+        instruction(e, "ret void");
+    } else {
+        value = convert(e, value, e->return_type);
+        instruction(e, "ret %s %s", type_text(e->return_type), value.text);
+    }
+    e->terminated = 1;
+}
+
+static void push_loop(Emitter* e, uint32_t break_label, uint32_t continue_label) {
+    if (e->loop_count == e->loop_capacity) {
+        int capacity = e->loop_capacity ? e->loop_capacity * 2 : 8;
+        LoopLabels* loops = (LoopLabels*)realloc(e->loops, sizeof(LoopLabels) * (size_t)capacity);
+        if (!loops) {
+            e->body.failed = 1;
+            return;
+        }
+        e->loops = loops;
+        e->loop_capacity = capacity;
+    }
+    e->loops[e->loop_count].break_label = break_label;
+    e->loops[e->loop_count].continue_label = continue_label;
+    e->loop_count++;
+}
+
+static void pop_loop(Emitter* e) {
+    if (e->loop_count > 0) e->loop_count--;
+}
+
+static void emit_if(Emitter* e, NodeId id) {
+    const uint32_t* record = flat_record(e->ast, id);
+    NodeId then_branch = record[1];
+    NodeId else_branch = record[2];
+    Value condition = convert(e, emit_expression(e, record[0]), make_type(VALUE_I1, 1));
+    uint32_t then_label = new_label(e);
+    uint32_t else_label = else_branch != NODE_NONE ? new_label(e) : 0;
+    uint32_t end_label = new_label(e);
+    conditional_branch(e, condition.text, then_label, else_branch != NODE_NONE ? else_label : end_label);
+    enter_label(e, then_label);
+    if (then_branch != NODE_NONE) emit_statement(e, then_branch);
+    if (!e->terminated) branch_to(e, end_label);
+    if (else_branch != NODE_NONE) {
+        enter_label(e, else_label);
+        emit_statement(e, else_branch);
+        if (!e->terminated) branch_to(e, end_label);
+    }
+    enter_label(e, end_label);
+}
+
+static void emit_while(Emitter* e, NodeId id) {
+    const uint32_t* record = flat_record(e->ast, id);
+    uint32_t condition_label = new_label(e);
+    uint32_t body_label = new_label(e);
+    uint32_t end_label = new_label(e);
+    enter_label(e, condition_label);
+    Value condition = convert(e, emit_expression(e, record[0]), make_type(VALUE_I1, 1));
+    conditional_branch(e, condition.text, body_label, end_label);
+    enter_label(e, body_label);
+    push_loop(e, end_label, condition_label);
+    if (record[1] != NODE_NONE) emit_statement(e, record[1]);
+    pop_loop(e);
+    if (!e->terminated) branch_to(e, condition_label);
+    enter_label(e, end_label);
+}
+
+// for 只支持区间：.. 与 ..< 为半开区间，..= 为闭区间，上界只求值一次
+static void emit_for(Emitter* e, NodeId id) {
+    const FlatAST* ast = e->ast;
+    const uint32_t* record = flat_record(ast, id);
+    NodeId iterable = record[1];
+    ValueType type = storage_type(e, id);
+    if (iterable == NODE_NONE || flat_kind(ast, iterable) != NODE_BINARY_OP || type.kind == VALUE_PTR ||
+        type.kind == VALUE_I1) {
+        comment(e, "暂不支持的迭代对象");
+        return;
+    }
+    const uint32_t* range = flat_record(ast, iterable);
+    OperatorType op = (OperatorType)range[0];
+    if (op != OP_RANGE && op != OP_RANGE_TO && op != OP_RANGE_INCL) {
+        comment(e, "暂不支持的迭代对象");
+        return;
+    }
+    allocate_variable(e, id);
+    store_variable(e, id, emit_expression(e, range[1]));
+    Value limit = convert(e, emit_expression(e, range[2]), type);
+
+    uint32_t condition_label = new_label(e);
+    uint32_t body_label = new_label(e);
+    uint32_t step_label = new_label(e);
+    uint32_t end_label = new_label(e);
+    enter_label(e, condition_label);
+    Value current = load_variable(e, id);
+    Value condition = new_value(e, make_type(VALUE_I1, 1));
+    int inclusive = op == OP_RANGE_INCL;
+    if (is_float_kind(type.kind)) {
+        instruction(e, "%s = fcmp %s %s %s, %s", condition.text, inclusive ? "ole" : "olt", type_text(type),
+                    current.text, limit.text);
+    } else {
+        const char* predicate = type.is_unsigned ? (inclusive ? "ule" : "ult") : (inclusive ? "sle" : "slt");
+        instruction(e, "%s = icmp %s %s %s, %s", condition.text, predicate, type_text(type), current.text, limit.text);
+    }
+    conditional_branch(e, condition.text, body_label, end_label);
+    enter_label(e, body_label);
+    push_loop(e, end_label, step_label);
+    if (record[2] != NODE_NONE) emit_statement(e, record[2]);
+    pop_loop(e);
+    enter_label(e, step_label);
+    Value old_value = load_variable(e, id);
+    Value one = is_float_kind(type.kind) ? real_constant(type, 1.0) : integer_constant(type, 1);
+    store_variable(e, id, arithmetic(e, NODE_NONE, OP_ADD, type, old_value, one));
+    branch_to(e, condition_label);
+    enter_label(e, end_label);
+}
+
+static void emit_statement(Emitter* e, NodeId id) {
+    if (id == NODE_NONE) return;
+    const FlatAST* ast = e->ast;
+    const uint32_t* record = flat_record(ast, id);
+    switch (flat_kind(ast, id)) {
+        case NODE_BLOCK:
+            for (uint32_t i = 1; i <= record[0]; i++) emit_statement(e, record[i]);
+            break;
+        case NODE_VARIABLE_DECL: {
+            allocate_variable(e, id);
+            Value value = record[2] != NODE_NONE ? emit_expression(e, record[2]) : zero_value(storage_type(e, id));
+            store_variable(e, id, value);
+            break;
+        }
+        case NODE_IF_STATEMENT:
+            emit_if(e, id);
+            break;
+        case NODE_WHILE_STATEMENT:
+            emit_while(e, id);
+            break;
+        case NODE_FOR_STATEMENT:
+            emit_for(e, id);
+            break;
+        case NODE_RETURN:
+            emit_return(e, id);
+            break;
+        case NODE_BREAK:
+        case NODE_CONTINUE:
+            if (e->loop_count > 0) {
+                const LoopLabels* loop = &e->loops[e->loop_count - 1];
+                branch_to(e, flat_kind(ast, id) == NODE_BREAK ? loop->break_label : loop->continue_label);
+            }
+            break;
+        case NODE_FUNCTION_CALL: {
+            // 不返回值的函数中尾位置上的调用语句
+            TailCallKind kind = tail_call_kind(e->tail_calls, id);
+            if (kind == TAIL_CALL_LOOP) {
+                emit_loop_call(e, id);
+            } else if (kind != TAIL_CALL_MUSTTAIL || !emit_musttail_call(e, id)) {
+                emit_call(e, id, call_prefix(e, id));
+            }
+            break;
+        }
+        case NODE_FUNCTION:
+        case NODE_INCLUDE:
+        case NODE_PROGRAM:
+            break;
+        default:
+            emit_expression(e, id);
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 函数与模块
+
+static void begin_function(Emitter* e, NodeId function, ValueType type) {
+    e->function = function;
+    e->return_type = type;
+    e->temp_count = 0;
+    e->label_count = 0;
+    e->loop_count = 0;
+    e->terminated = 0;
+    snprintf(e->block, sizeof(e->block), "entry");
+    buffer_clear(&e->entry);
+    buffer_clear(&e->body);
+}
+
+static void end_function(Emitter* e) {
+    if (!e->terminated) emit_default_return(e);
+    append(&e->functions, "entry:\n");
+    if (e->entry.data) append_bytes(&e->functions, e->entry.data, e->entry.length);
+    if (e->body.data) append_bytes(&e->functions, e->body.data, e->body.length);
+    append(&e->functions, "}\n");
+    if (e->entry.failed || e->body.failed) e->functions.failed = 1;
+}
+
+static int has_loop_calls(Emitter* e, NodeId function) {
+    for (NodeId id = function + 1; id < e->ast->ends[function]; id++) {
+        if (tail_call_kind(e->tail_calls, id) == TAIL_CALL_LOOP) return 1;
+    }
+    return 0;
+}
+
+static void emit_function(Emitter* e, NodeId function) {
+    const uint32_t* record = flat_record(e->ast, function);
+    ValueType type = return_type(e, function);
+    begin_function(e, function, type);
+    Buffer* out = &e->functions;
+    appendf(out, "\ndefine %s ", type_text(type));
+    append_global_name(out, record[0]);
+    append(out, "(");
+    for (uint32_t i = 0; i < record[3]; i++) {
+        NodeId parameter = record[5 + i];
+        appendf(out, "%s%s %%arg.%u", i ? ", " : "", type_text(storage_type(e, parameter)), parameter);
+    }
+    append(out, ") {\n");
+    for (uint32_t i = 0; i < record[3]; i++) {
+        NodeId parameter = record[5 + i];
+        allocate_variable(e, parameter);
+        char incoming[32];
+        snprintf(incoming, sizeof(incoming), "%%arg.%u", parameter);
+        Value value;
+        memset(&value, 0, sizeof(value));
+        value.type = storage_type(e, parameter);
+        snprintf(value.text, sizeof(value.text), "%s", incoming);
+        store_variable(e, parameter, value);
+    }
+    if (has_loop_calls(e, function)) {
+        // 尾位置上的自调用写回形参后跳回这里
+        branch(e, "tailrec");
+        start_block(e, "tailrec");
+    }
+    emit_statement(e, record[2]);
+    end_function(e);
+}
+
+static void declare_function(Emitter* e, NodeId function) {
+    Symbol name = flat_name(e->ast, function);
+    if (name < e->symbol_limit) {
+        if (e->symbol_states[name] & 0x80) return;
+        e->symbol_states[name] |= 0x80;
+        if ((e->symbol_states[name] & 0x7f) == 2) return;   // 同名函数已有定义
+    }
+    const uint32_t* record = flat_record(e->ast, function);
+    appendf(&e->globals, "declare %s ", type_text(return_type(e, function)));
+    append_global_name(&e->globals, name);
+    append(&e->globals, "(");
+    for (uint32_t i = 0; i < record[3]; i++) {
+        appendf(&e->globals, "%s%s", i ? ", " : "", type_text(storage_type(e, record[5 + i])));
+    }
+    append(&e->globals, ")\n");
+}
+
+// 头文件中声明的变量：外部全局变量，同名的变量已声明或已在源文件中定义时跳过
+static void declare_global(Emitter* e, NodeId declaration) {
+    Symbol name = flat_name(e->ast, declaration);
+    if (name < e->symbol_limit) {
+        if (e->symbol_states[name] & 0x80) return;
+        e->symbol_states[name] |= 0x80;
+        if ((e->symbol_states[name] & 0x7f) == 2) return;
+    }
+    append_global_name(&e->globals, name);
+    appendf(&e->globals, " = external global %s\n", type_text(storage_type(e, declaration)));
+}
+
+// 顶层变量：字面量初始化的生成常量初值，其余在 @scp.init 中于程序启动时初始化。返回是否需要运行时初始化
+static int emit_global(Emitter* e, NodeId declaration) {
+    const uint32_t* record = flat_record(e->ast, declaration);
+    ValueType type = storage_type(e, declaration);
+    NodeId initializer = record[2];
+    int writable = record[3] == DECL_VAR;
+    char initial[256];
+    int runtime = 0;
+    Value zero = zero_value(type);
+    snprintf(initial, sizeof(initial), "%s", zero.text);
+    if (initializer != NODE_NONE) {
+        if (flat_kind(e->ast, initializer) == NODE_LITERAL) {
+            const FlatLiteral* literal = flat_literal(e->ast, initializer);
+            if (literal->type == LITERAL_STRING) {
+                if (type.kind == VALUE_PTR) {
+                    string_pointer(e, string_constant(e, literal->string_value), initial, sizeof(initial));
+                } else {
+                    runtime = 1;
+                }
+            } else if (type.kind == VALUE_PTR && literal->type != LITERAL_NULL) {
+                runtime = 1;
+            } else {
+                Value value = convert(e, literal_value(e, literal), type);
+                snprintf(initial, sizeof(initial), "%s", value.text);
+            }
+        } else {
+            runtime = 1;
+        }
+    }
+    append_global_name(&e->globals, record[0]);
+    appendf(&e->globals, " = %s %s %s\n", writable || runtime ? "global" : "constant", type_text(type), initial);
+    return runtime;
+}
+
+static void emit_global_initializers(Emitter* e, NodeId* globals, uint32_t count) {
+    begin_function(e, NODE_NONE, make_type(VALUE_VOID, 0));
+    append(&e->functions, "\ndefine internal void @scp.init() {\n");
+    for (uint32_t i = 0; i < count; i++) {
+        store_variable(e, globals[i], emit_expression(e, flat_record(e->ast, globals[i])[2]));
+    }
+    end_function(e);
+    append(&e->functions, "\n@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] "
+                          "[{ i32, void ()*, i8* } { i32 65535, void ()* @scp.init, i8* null }]\n");
+}
+
+// 运行时函数的声明；程序自己声明了同名函数时不再重复
+static void declare_runtime(Emitter* e, const char* name, const char* declaration) {
+    Symbol symbol = find_symbol(name, (int)strlen(name));
+    if (symbol != SYMBOL_NONE && symbol < e->symbol_limit && (e->symbol_states[symbol] & 0x80)) return;
+    if (symbol != SYMBOL_NONE && symbol < e->symbol_limit && (e->symbol_states[symbol] & 0x7f) == 2) return;
+    append(&e->globals, declaration);
+}
+
+static void emit_runtime(Emitter* e) {
+    if (e->runtime & RUNTIME_PRINTF) declare_runtime(e, "printf", "declare i32 @printf(i8*, ...)\n");
+    if (e->runtime & RUNTIME_STRCMP) declare_runtime(e, "strcmp", "declare i32 @strcmp(i8*, i8*)\n");
+    if (e->runtime & RUNTIME_CONCAT) {
+        declare_runtime(e, "strlen", "declare i64 @strlen(i8*)\n");
+        declare_runtime(e, "malloc", "declare i8* @malloc(i64)\n");
+        append(&e->globals, "declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)\n");
+        // 字符串拼接：结果写入调用者提供的缓冲区，放不下（或没有缓冲区）时分配在堆上
+        append(&e->functions,
+               "\ndefine internal i8* @scp.concat(i8* %a, i8* %b) {\n"
+               "entry:\n"
+               "  %r = call i8* @scp.concat.into(i8* %a, i8* %b, i8* null, i64 0)\n"
+               "  ret i8* %r\n"
+               "}\n"
+               "\ndefine internal i8* @scp.concat.into(i8* %a, i8* %b, i8* %buffer, i64 %capacity) {\n"
+               "entry:\n"
+               "  %la = call i64 @strlen(i8* %a)\n"
+               "  %lb = call i64 @strlen(i8* %b)\n"
+               "  %n = add i64 %la, %lb\n"
+               "  %size = add i64 %n, 1\n"
+               "  %fits = icmp ule i64 %size, %capacity\n"
+               "  br i1 %fits, label %copy, label %heap\n"
+               "heap:\n"
+               "  %h = call i8* @malloc(i64 %size)\n"
+               "  br label %copy\n"
+               "copy:\n"
+               "  %r = phi i8* [ %buffer, %entry ], [ %h, %heap ]\n"
+               "  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %r, i8* %a, i64 %la, i1 false)\n"
+               "  %end = getelementptr inbounds i8, i8* %r, i64 %la\n"
+               "  call void @llvm.memcpy.p0i8.p0i8.i64(i8* %end, i8* %b, i64 %lb, i1 false)\n"
+               "  %z = getelementptr inbounds i8, i8* %r, i64 %n\n"
+               "  store i8 0, i8* %z\n"
+               "  ret i8* %r\n"
+               "}\n");
+    }
+}
+
+static void emit_module(Emitter* e) {
+    const FlatAST* ast = e->ast;
+    prepare_declarations(e);
+    infer_types(e);
+
+    NodeId* globals = (NodeId*)malloc(sizeof(NodeId) * (ast->count + 1));
+    if (!globals) {
+        e->globals.failed = 1;
+        return;
+    }
+    uint32_t global_count = 0;
+    int count = flat_child_count(ast, FLAT_AST_ROOT);
+    for (int i = 0; i < count; i++) {
+        NodeId declaration = flat_child(ast, FLAT_AST_ROOT, i);
+        if (declaration == NODE_NONE) continue;
+        switch (flat_kind(ast, declaration)) {
+            case NODE_INCLUDE: {
+                int inner_count = flat_child_count(ast, declaration);
+                for (int j = 0; j < inner_count; j++) {
+                    NodeId inner = flat_child(ast, declaration, j);
+                    if (inner == NODE_NONE) continue;
+                    if (flat_kind(ast, inner) == NODE_FUNCTION) {
+                        declare_function(e, inner);
+                    } else if (flat_kind(ast, inner) == NODE_VARIABLE_DECL) {
+                        declare_global(e, inner);
+                    }
+                }
+                break;
+            }
+            case NODE_FUNCTION:
+                if (flat_record(ast, declaration)[2] != NODE_NONE) {
+                    emit_function(e, declaration);
+                } else {
+                    declare_function(e, declaration);
+                }
+                break;
+            case NODE_VARIABLE_DECL:
+                if (emit_global(e, declaration)) globals[global_count++] = declaration;
+                break;
+            default:
+                break;
+        }
+    }
+    if (global_count > 0) emit_global_initializers(e, globals, global_count);
+    free(globals);
+    emit_runtime(e);
+}
+
+// 生成LLVM IR代码
+// 无法生成时返回 NULL，原因写入 *error（内存不足时为 NULL）
+static char* generate_llvm_ir(const FlatAST* ast, const TailCalls* tail_calls, const Escapes* escapes, char** error) {
+    Buffer output;
+    memset(&output, 0, sizeof(output));
+    append(&output, "; 生成的LLVM IR代码\n\n");
+    if (!ast || ast->count <= FLAT_AST_ROOT) {
+        // 如果AST为空，生成默认代码
+        append(&output, "; 警告: AST为空\ndefine i32 @main() {\n  ret i32 0\n}\n");
+        return output.failed ? (free(output.data), NULL) : output.data;
+    }
+
+    Emitter e;
+    memset(&e, 0, sizeof(e));
+    e.ast = ast;
+    e.tail_calls = tail_calls;
+    e.escapes = escapes;
+    e.main_name = find_symbol("main", 4);
+    e.print_name = find_symbol("print", 5);
+    e.println_name = find_symbol("println", 7);
+    e.symbol_limit = (uint32_t)symbol_count() + 1;
+    e.types = (ValueType*)calloc(ast->count, sizeof(ValueType));
+    e.flags = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    e.symbol_states = (uint8_t*)calloc(e.symbol_limit, sizeof(uint8_t));
+    if (e.types && e.flags && e.symbol_states) {
+        emit_module(&e);
+    } else {
+        output.failed = 1;
+    }
+
+    int failed = output.failed || e.globals.failed || e.functions.failed || e.name.failed || e.arguments.failed ||
+                 e.error_message;
+    *error = e.error_message;
+    if (!failed) {
+        if (e.globals.data) append_bytes(&output, e.globals.data, e.globals.length);
+        if (e.functions.data) append_bytes(&output, e.functions.data, e.functions.length);
+    }
+    free(e.globals.data);
+    free(e.functions.data);
+    free(e.entry.data);
+    free(e.body.data);
+    free(e.name.data);
+    free(e.arguments.data);
+    free(e.types);
+    free(e.flags);
+    free(e.symbol_states);
+    free(e.string_ids);
+    free(e.string_lengths);
+    free(e.loops);
+    if (failed || output.failed) {
+        free(output.data);
+        return NULL;
+    }
+    return output.data;
 }
 
 // 实现AST到目标代码的转换
-void generate_code(CodeGenerator* generator, const ASTNode* syntax_tree) {
+void generate_code(CodeGenerator* generator, const FlatAST* syntax_tree) {
     if (!generator) {
         return;
     }
-    
+
     // 释放之前的输出代码（如果有）
     if (generator->output_code) {
         free(generator->output_code);
     }
-    
+
     // 如果语法树为空，生成一个简单的占位符代码
     if (!syntax_tree) {
         generator->output_code = strdup("; 警告: 语法树为空，生成占位符代码\n\ndefine i32 @main() {\n  ret i32 0\n}\n");
         return;
     }
-    
+
     // 生成LLVM IR代码
-    generator->output_code = generate_llvm_ir(syntax_tree);
-    
+    char* error = NULL;
+    generator->output_code = generate_llvm_ir(syntax_tree, generator->tail_calls, generator->escapes, &error);
+
     // 如果生成失败，设置错误信息
+    free(generator->error_message);
+    generator->error_message = NULL;
     if (!generator->output_code) {
-        generator->error_message = strdup("代码生成失败：内存分配错误");
+        generator->error_message = error ? error : strdup("代码生成失败：内存分配错误");
     }
 }
 
+void set_tail_calls(CodeGenerator* generator, const TailCalls* tail_calls) {
+    if (generator) generator->tail_calls = tail_calls;
+}
+
+void set_escapes(CodeGenerator* generator, const Escapes* escapes) {
+    if (generator) generator->escapes = escapes;
+}
+
 CodeGenerator* create_code_generator() {
     CodeGenerator* generator = (CodeGenerator*)malloc(sizeof(CodeGenerator));
     if (generator) {
@@ -108,6 +1895,8 @@ CodeGenerator* create_code_generator() {
         generator->target_platform = strdup("x86_64"); // 默认目标平台
         generator->optimization_level = 0;             // 默认优化级别
         generator->error_message = NULL;
+        generator->tail_calls = NULL;
+        generator->escapes = NULL;
     }
     return generator;
 }
@@ -130,4 +1919,8 @@ void destroy_code_generator(CodeGenerator* generator) {
 // 返回生成的代码
 const char* get_generated_code(CodeGenerator* generator) {
     return generator ? generator->output_code : NULL;
-}
\ No newline at end of file
+}
+
+const char* get_code_generator_error_message(CodeGenerator* generator) {
+    return generator ? generator->error_message : NULL;
+}
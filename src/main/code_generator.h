@@ -3,7 +3,9 @@
 #ifndef CODE_GENERATOR_H
 #define CODE_GENERATOR_H
 
-#include "ast.h"
+#include "flat_ast.h"
+#include "tail_call.h"
+#include "escape_analysis.h"
 
 // Define the CodeGenerator structure
 typedef struct CodeGenerator CodeGenerator;
@@ -12,8 +14,14 @@ typedef struct CodeGenerator CodeGenerator;
 
 // Function prototypes
 CodeGenerator* create_code_generator();
-void generate_code(CodeGenerator* generator, const ASTNode* ast_root);
+void generate_code(CodeGenerator* generator, const FlatAST* ast);
+// 尾调用分析的结果：tailrec 函数的自调用生成循环，环内其他尾调用生成 musttail。生成代码时必须仍然有效
+void set_tail_calls(CodeGenerator* generator, const TailCalls* tail_calls);
+// 逃逸分析的结果：不逃逸的字符串拼接写入栈上的缓冲区。生成代码时必须仍然有效
+void set_escapes(CodeGenerator* generator, const Escapes* escapes);
 const char* get_generated_code(CodeGenerator* generator);
+// 生成失败的原因（如 tailrec 函数之间签名不同的尾调用），成功时返回 NULL
+const char* get_code_generator_error_message(CodeGenerator* generator);
 void destroy_code_generator(CodeGenerator* generator);
 
 #endif // CODE_GENERATOR_H
\ No newline at end of file
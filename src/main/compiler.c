@@ -1,34 +1,21 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "lexer.h"
+#include "source.h"
 #include "parser.h"
 #include "ast.h"
+#include "flat_ast.h"
+#include "syntax_analyzer.h"
+#include "inliner.h"
+#include "constant_folder.h"
+#include "call_graph.h"
+#include "tail_call.h"
+#include "escape_analysis.h"
 #include "code_generator.h"
-
-// 读取文件内容
-char* read_file(const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "无法打开文件: %s\n", filename);
-        return NULL;
-    }
-    
-    // 获取文件大小
-    fseek(file, 0, SEEK_END);
-    long size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    // 分配内存并读取文件内容
-    char* buffer = (char*)malloc(size + 1);
-    if (buffer) {
-        size_t read_size = fread(buffer, 1, size, file);
-        buffer[read_size] = '\0';
-    }
-    
-    fclose(file);
-    return buffer;
-}
+#include "interner.h"
+#include "type_interner.h"
+#include "include_graph.h"
 
 // 保存生成的代码到文件
 void save_to_file(const char* filename, const char* content) {
@@ -42,53 +29,239 @@ void save_to_file(const char* filename, const char* content) {
     fclose(file);
 }
 
+// 标准库头文件所在的目录：编译器位于 bin/ 下，标准库头文件位于 src/lib/ 下
+static void library_directory(const char* program, char* path, size_t size) {
+    int directory_length = 0;
+    for (int i = 0; program[i]; i++) {
+        if (program[i] == '/' || program[i] == '\\') {
+            directory_length = i + 1;
+        }
+    }
+    snprintf(path, size, "%.*s../src/lib", directory_length, program);
+}
+
+// 读取形如 --name=N 的非负整数选项，名字不匹配时返回 0，数值无效时返回 -1
+static int integer_option(const char* argument, const char* name, int* value) {
+    size_t length = strlen(name);
+    if (strncmp(argument, name, length) != 0 || argument[length] != '=') return 0;
+    char* end = NULL;
+    long parsed = strtol(argument + length + 1, &end, 10);
+    if (end == argument + length + 1 || *end != '\0' || parsed < 0 || parsed > INT_MAX) return -1;
+    *value = (int)parsed;
+    return 1;
+}
+
+// 取出以 "--" 开头的选项，其余参数依次前移；选项无效时返回 0
+static int parse_options(int* argc, char* argv[], InlineOptions* inline_options, InterpreterLimits* limits) {
+    int kept = 1;
+    for (int i = 1; i < *argc; i++) {
+        const char* argument = argv[i];
+        if (strncmp(argument, "--", 2) != 0) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+        int value = 0;
+        int matched = integer_option(argument, "--inline-threshold", &inline_options->threshold);
+        if (matched == 0) matched = integer_option(argument, "--inline-growth", &inline_options->growth_percent);
+        if (matched == 0 && (matched = integer_option(argument, "--ctfe-steps", &value)) > 0) {
+            limits->max_steps = (uint64_t)value;
+        }
+        if (matched == 0 && (matched = integer_option(argument, "--ctfe-memory", &value)) > 0) {
+            limits->max_memory = (size_t)value * 1024;
+        }
+        if (matched <= 0) {
+            fprintf(stderr, matched < 0 ? "无效的选项值: %s\n" : "未知选项: %s\n", argument);
+            return 0;
+        }
+    }
+    *argc = kept;
+    argv[kept] = NULL;
+    return 1;
+}
+
 int main(int argc, char* argv[]) {
 
     #ifdef _WIN32
     system("chcp 65001 > nul");
     #endif
 
-    if (argc < 2) {
-        printf("用法: %s <源文件> [输出文件]\n", argv[0]);
+    InlineOptions inline_options;
+    default_inline_options(&inline_options);
+    InterpreterLimits limits;
+    default_interpreter_limits(&limits);
+    if (!parse_options(&argc, argv, &inline_options, &limits)) {
         return 1;
     }
     
-    // 读取源文件
-    char* source = read_file(argv[1]);
-    if (!source) {
+    if (argc < 2) {
+        printf("用法: %s [选项] <源文件|-> [输出文件]\n", argv[0]);
+        printf("选项:\n");
+        printf("  --inline-threshold=N  自动内联函数体不超过 N 个节点的小函数（默认 %d，0 表示只内联 crossinline 函数）\n",
+               INLINE_DEFAULT_THRESHOLD);
+        printf("  --inline-growth=N     内联使AST增长不超过 N%%（默认 %d，0 表示关闭内联）\n", INLINE_DEFAULT_GROWTH);
+        printf("  --ctfe-steps=N        const 初始值在编译期最多执行 N 步（默认 %d）\n", INTERPRETER_DEFAULT_STEPS);
+        printf("  --ctfe-memory=N       编译期求值最多使用 N KiB 内存（默认 %d）\n", INTERPRETER_DEFAULT_MEMORY / 1024);
         return 1;
     }
     
+    // 标准输入以流式方式边读边解析，读入的字节另存一份，解析后交给之后的各遍报告行列号；
+    // 源文件则内存映射，之后各阶段都借用这一份缓冲区
+    int from_stdin = strcmp(argv[1], "-") == 0;
+    SourceBuffer* source = NULL;
+    if (!from_stdin) {
+        source = load_source_file(argv[1]);
+        if (!source) {
+            return 1;
+        }
+    }
+    
     // 设置输出文件名
     char* output_file = NULL;
     if (argc >= 3) {
         output_file = argv[2];
+    } else if (from_stdin) {
+        // 从标准输入读取时没有源文件名可用
+        output_file = (char*)malloc(sizeof("stdin.ll"));
+        strcpy(output_file, "stdin.ll");
     } else {
         // 默认输出文件名为源文件+.ll (LLVM IR)
         output_file = (char*)malloc(strlen(argv[1]) + 4);
         sprintf(output_file, "%s.ll", argv[1]);
     }
     
-    // 创建词法分析器
-    Lexer* lexer = create_lexer(source);
+    // 各阶段的结果，出错时统一在 cleanup 处释放
+    int status = 1;
+    FlatAST* ast = NULL;
+    TailCalls* tail_calls = NULL;
+    CodeGenerator* generator = NULL;
+    Escapes* escapes = NULL;
     
     // 创建语法分析器
     Parser* parser = create_parser();
     
     // 解析源代码
-    parse_source(parser, source);
+    if (from_stdin) {
+        set_keep_stream_input(parser, 1);
+        parse_stream(parser, stdin);
+    } else {
+        parse_source(parser, source->data, (int)source->length);
+    }
+    
+    // 加载 include 的头文件（优先使用预编译头）
+    char library[4096];
+    library_directory(argv[0], library, sizeof(library));
+    const char* include_dirs[] = { library };
+    parse_includes(parser, from_stdin ? NULL : argv[1], include_dirs, 1);
     
-    // 获取AST根节点
-    ASTNode* ast_root = get_ast_root(parser);
+    // 只构建从 main 可达的函数体，其余函数体只记录了标记范围
+    parse_reachable_bodies(parser, find_symbol("main", 4));
+    
+    if (from_stdin) {
+        int length = 0;
+        char* input = take_stream_input(parser, &length);
+        source = input ? adopt_source_memory(input, (size_t)length, "stdin") : NULL;
+    }
+    
+    // 语法错误时不再生成代码
+    const char* parse_error = get_parser_error_message(parser);
+    if (parse_error) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], parse_error);
+        destroy_parser(parser);
+        goto cleanup;
+    }
+    
+    // 把AST压缩为扁平形式，之后的各遍只使用扁平AST，指针形式的AST随解析器一起释放
+    ast = flatten_ast(get_ast_root(parser));
+    destroy_parser(parser);
+    
+    // 名字解析：变量引用与函数调用指向的声明记录在扁平AST中
+    SyntaxAnalyzer* analyzer = create_syntax_analyzer();
+    int name_errors = analyze_syntax(analyzer, ast, source ? source->data : NULL, source ? (int)source->length : 0);
+    if (name_errors > 0) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], get_analyzer_error_message(analyzer));
+        if (analyzer->error_count > 1) {
+            fprintf(stderr, "共 %d 个错误\n", analyzer->error_count);
+        }
+    }
+    destroy_syntax_analyzer(analyzer);
+    if (name_errors > 0) {
+        goto cleanup;
+    }
+    
+    // tailrec 函数中的递归调用必须位于尾位置。在内联、常量折叠与死函数删除之前检查，
+    // 结果不取决于调用能否在编译期求值、函数是否被调用
+    TailCalls* checked = analyze_tail_calls(ast, source ? source->data : NULL, source ? (int)source->length : 0);
+    int tail_errors = checked ? checked->error_count : 0;
+    if (tail_errors > 0) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], checked->error_message);
+        if (tail_errors > 1) {
+            fprintf(stderr, "共 %d 个错误\n", tail_errors);
+        }
+    }
+    destroy_tail_calls(checked);
+    if (tail_errors > 0) {
+        goto cleanup;
+    }
+    
+    // 内联展开小函数与 crossinline 函数，之后的常量折叠与死函数删除可以看穿这些调用
+    FlatAST* inlined = inline_functions(ast, &inline_options);
+    if (inlined) {
+        destroy_flat_ast(ast);
+        ast = inlined;
+    }
+    
+    // 常量折叠与编译期求值：内存不足时保留未折叠的AST继续编译
+    int const_errors = 0;
+    char* const_error = NULL;
+    FlatAST* folded = fold_constants_checked(ast, &limits, source ? source->data : NULL,
+                                             source ? (int)source->length : 0, &const_errors, &const_error);
+    if (folded) {
+        destroy_flat_ast(ast);
+        ast = folded;
+    }
+    if (const_errors > 0) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], const_error ? const_error : "const 初始值无法在编译期求值");
+        if (const_errors > 1) {
+            fprintf(stderr, "共 %d 个错误\n", const_errors);
+        }
+        free(const_error);
+        goto cleanup;
+    }
+    
+    // 只保留从 main 与导出函数出发可达的函数，其余函数不进入代码生成
+    FlatAST* live = eliminate_dead_functions(ast, find_symbol("main", 4));
+    if (live) {
+        destroy_flat_ast(ast);
+        ast = live;
+    }
+    
+    // 在最终的AST上重新标记尾调用，交给代码生成器
+    tail_calls = analyze_tail_calls(ast, source ? source->data : NULL, source ? (int)source->length : 0);
+    if (tail_calls && tail_calls->error_count > 0) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], tail_calls->error_message);
+        if (tail_calls->error_count > 1) {
+            fprintf(stderr, "共 %d 个错误\n", tail_calls->error_count);
+        }
+        goto cleanup;
+    }
     
     // 创建代码生成器
-    CodeGenerator* generator = create_code_generator();
+    generator = create_code_generator();
+    set_tail_calls(generator, tail_calls);
+    // 不逃逸的字符串拼接写入栈上的缓冲区（分析失败时全部分配在堆上）
+    escapes = analyze_escapes(ast, tail_calls);
+    set_escapes(generator, escapes);
     
     // 生成代码
-    generate_code(generator, ast_root);
+    generate_code(generator, ast);
     
     // 获取生成的代码并保存到文件
     const char* generated_code = get_generated_code(generator);
+    const char* generate_error = get_code_generator_error_message(generator);
+    if (!generated_code && generate_error) {
+        fprintf(stderr, "%s: %s\n", from_stdin ? "stdin" : argv[1], generate_error);
+        goto cleanup;
+    }
     if (generated_code) {
         save_to_file(output_file, generated_code);
     } else {
@@ -96,16 +269,22 @@ int main(int argc, char* argv[]) {
     }
     
     printf("编译完成，输出文件: %s\n", output_file);
+    status = 0;
     
+cleanup:
     // 清理资源
-    destroy_lexer(lexer);
-    destroy_parser(parser);
     destroy_code_generator(generator);
-    free(source);
+    destroy_escapes(escapes);
+    destroy_tail_calls(tail_calls);
+    destroy_flat_ast(ast);
+    destroy_source_buffer(source);
+    destroy_header_cache();
+    destroy_interner();
+    destroy_type_interner();
     
     if (argc < 3) {
         free(output_file);
     }
     
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -0,0 +1,518 @@
+#include "constant_folder.h"
+#include "line_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 传播轮数的上限：全局的 val 可以在声明之前被引用，每轮只能求出前一轮已知的值所依赖的部分
+#define MAX_FOLD_ROUNDS 16
+
+// 不在 const 初始值中的调用每次只用步数上限的 1/CALL_STEP_DIVISOR，合计不超过一个步数上限，
+// 求值失败的调用保留到运行时
+#define CALL_STEP_DIVISOR 100
+
+// 节点在 const 初始值中的角色
+#define ROLE_CONST_INITIALIZER 0x01   // 位于 const 初始值之内：使用完整的步数上限
+#define ROLE_TYPED_INITIALIZER 0x02   // 标注了类型的声明的初始值：字面量由声明的类型决定
+
+// 记忆的调用结果，键为（函数, 实参值）
+typedef struct {
+    NodeId function;         // NODE_NONE 表示空槽
+    uint32_t arguments;      // 实参值在 call_arguments 中的起点
+    uint32_t argument_count;
+    uint32_t hash;
+    InterpretStatus status;
+    uint64_t steps;          // 执行时的步数上限：超出步数的失败在上限更大时可以重试
+    ConstantValue value;
+} CallResult;
+
+typedef struct {
+    const FlatAST* ast;
+    ConstantValue* values;   // 每个节点的值
+    uint8_t* written;        // 被赋值或自增自减过的声明
+    NodeId* stack;           // 后序遍历用的栈
+    uint8_t* roles;          // 初始值中节点的角色
+    uint8_t* failures;       // 编译期执行失败的调用（InterpretStatus），之后的轮次不再重试
+    Interpreter* interpreter;
+    uint64_t max_steps;
+    uint64_t call_budget;    // 不在 const 初始值中的调用剩余的步数
+    CallResult* calls;       // 开放定址的记忆表，容量为 2 的幂；内存不足时为 NULL，不再记忆
+    uint32_t call_capacity;
+    uint32_t call_count;
+    ConstantValue* call_arguments;
+    uint32_t argument_count;
+    uint32_t argument_capacity;
+    int forward_reference;   // 本轮有引用指向尚未求值的后方声明
+    uint32_t discovered;     // 本轮新求得的值的数量
+} Folder;
+
+static int fold_binary(const Folder* folder, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(folder->ast, id);
+    if (record[1] == NODE_NONE || record[2] == NODE_NONE) return 0;
+    return fold_binary_values((OperatorType)record[0], &folder->values[record[1]], &folder->values[record[2]], result);
+}
+
+static int fold_unary(const Folder* folder, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(folder->ast, id);
+    if (record[1] == NODE_NONE) return 0;
+    return fold_unary_value((OperatorType)record[0], &folder->values[record[1]], result);
+}
+
+// 只有声明之后不再被修改的 val 与 const 才能传播
+static int is_constant_declaration(const Folder* folder, NodeId id) {
+    if (flat_kind(folder->ast, id) != NODE_VARIABLE_DECL || folder->written[id]) return 0;
+    DeclKind kind = (DeclKind)flat_record(folder->ast, id)[3];
+    return kind == DECL_VAL || kind == DECL_CONST;
+}
+
+// 调用源文件中有函数体的函数、实参都已知且之前没有执行失败时在编译期执行
+static int is_interpretable_call(const Folder* folder, NodeId id) {
+    const FlatAST* ast = folder->ast;
+    NodeId function = flat_binding(ast, id);
+    if (!folder->interpreter || folder->failures[id] || function == NODE_NONE) return 0;
+    if (flat_kind(ast, function) != NODE_FUNCTION || flat_record(ast, function)[2] == NODE_NONE) return 0;
+    const uint32_t* record = flat_record(ast, id);
+    for (uint32_t i = 0; i < record[1]; i++) {
+        if (!folder->values[record[2 + i]].known) return 0;
+    }
+    return 1;
+}
+
+static uint32_t hash_value(uint32_t hash, const ConstantValue* value) {
+    uint64_t bits = 0;
+    switch (value->literal.type) {
+        case LITERAL_INT:    bits = (uint64_t)value->literal.int_value; break;
+        case LITERAL_FLOAT:  memcpy(&bits, &value->literal.float_value, sizeof(bits)); break;
+        case LITERAL_STRING: bits = value->literal.string_value; break;
+        case LITERAL_BOOL:   bits = (uint64_t)value->literal.bool_value; break;
+        default:             break;
+    }
+    uint64_t words[3] = { (uint64_t)value->literal.type, (uint64_t)value->type, bits };
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 8; j++) {
+            hash = (hash ^ (uint8_t)(words[i] >> (8 * j))) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// 两个值的类型与数值的位模式都相同（浮点数按位比较，-0.0 与 0.0 不同）
+static int same_value(const ConstantValue* a, const ConstantValue* b) {
+    if (a->literal.type != b->literal.type || a->type != b->type) return 0;
+    switch (a->literal.type) {
+        case LITERAL_INT:    return a->literal.int_value == b->literal.int_value;
+        case LITERAL_FLOAT:  return memcmp(&a->literal.float_value, &b->literal.float_value, sizeof(double)) == 0;
+        case LITERAL_STRING: return a->literal.string_value == b->literal.string_value;
+        case LITERAL_BOOL:   return a->literal.bool_value == b->literal.bool_value;
+        default:             return 1;
+    }
+}
+
+static uint32_t hash_call(const Folder* folder, NodeId id) {
+    const uint32_t* record = flat_record(folder->ast, id);
+    uint32_t hash = (2166136261u ^ flat_binding(folder->ast, id)) * 16777619u;
+    for (uint32_t i = 0; i < record[1]; i++) hash = hash_value(hash, &folder->values[record[2 + i]]);
+    return hash;
+}
+
+static int same_call(const Folder* folder, const CallResult* entry, NodeId id, uint32_t hash) {
+    const uint32_t* record = flat_record(folder->ast, id);
+    if (entry->hash != hash || entry->function != flat_binding(folder->ast, id) || entry->argument_count != record[1]) {
+        return 0;
+    }
+    for (uint32_t i = 0; i < record[1]; i++) {
+        if (!same_value(&folder->call_arguments[entry->arguments + i], &folder->values[record[2 + i]])) return 0;
+    }
+    return 1;
+}
+
+// 记忆表扩容到 capacity（2 的幂）；失败时释放记忆表，之后不再记忆
+static void grow_calls(Folder* folder, uint32_t capacity) {
+    CallResult* calls = (CallResult*)calloc(capacity, sizeof(CallResult));
+    if (!calls) {
+        free(folder->calls);
+        folder->calls = NULL;
+        return;
+    }
+    for (uint32_t i = 0; folder->calls && i < folder->call_capacity; i++) {
+        const CallResult* entry = &folder->calls[i];
+        if (entry->function == NODE_NONE) continue;
+        uint32_t slot = entry->hash & (capacity - 1);
+        while (calls[slot].function != NODE_NONE) slot = (slot + 1) & (capacity - 1);
+        calls[slot] = *entry;
+    }
+    free(folder->calls);
+    folder->calls = calls;
+    folder->call_capacity = capacity;
+}
+
+// 调用在记忆表中的槽位：已记忆时为该结果，否则为可以插入的空槽。记忆表不可用时返回 NULL
+static CallResult* find_call(Folder* folder, NodeId id, uint32_t hash) {
+    if ((folder->call_count + 1) * 2 > folder->call_capacity) {
+        grow_calls(folder, folder->call_capacity ? folder->call_capacity * 2 : 64);
+    }
+    if (!folder->calls) return NULL;
+    uint32_t mask = folder->call_capacity - 1;
+    for (uint32_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        CallResult* entry = &folder->calls[slot];
+        if (entry->function == NODE_NONE || same_call(folder, entry, id, hash)) return entry;
+    }
+}
+
+// 把执行结果记入空槽（实参值另存一份），实参表扩容失败时不记忆
+static void remember_call(Folder* folder, CallResult* entry, NodeId id, uint32_t hash) {
+    const uint32_t* record = flat_record(folder->ast, id);
+    if (folder->argument_count + record[1] > folder->argument_capacity) {
+        uint32_t capacity = folder->argument_capacity ? folder->argument_capacity : 256;
+        while (capacity < folder->argument_count + record[1]) capacity *= 2;
+        ConstantValue* arguments = (ConstantValue*)realloc(folder->call_arguments, sizeof(ConstantValue) * capacity);
+        if (!arguments) return;
+        folder->call_arguments = arguments;
+        folder->argument_capacity = capacity;
+    }
+    entry->function = flat_binding(folder->ast, id);
+    entry->arguments = folder->argument_count;
+    entry->argument_count = record[1];
+    entry->hash = hash;
+    for (uint32_t i = 0; i < record[1]; i++) {
+        folder->call_arguments[folder->argument_count++] = folder->values[record[2 + i]];
+    }
+    folder->call_count++;
+}
+
+// 在编译期执行调用，成功时返回 1。同一函数以相同实参的调用直接取记忆的结果；
+// 不在 const 初始值中的调用共享整个折叠过程的步数预算，预算用完后保留到运行时
+static int interpret_call(Folder* folder, NodeId id, ConstantValue* value) {
+    int required = folder->roles[id] & ROLE_CONST_INITIALIZER;
+    uint64_t steps = required ? folder->max_steps : folder->max_steps / CALL_STEP_DIVISOR;
+    if (!required && steps > folder->call_budget) steps = folder->call_budget;
+    uint32_t hash = hash_call(folder, id);
+    CallResult* entry = find_call(folder, id, hash);
+    if (entry && entry->function != NODE_NONE) {
+        if (entry->status == INTERPRET_OK) {
+            *value = entry->value;
+            return 1;
+        }
+        if (entry->status != INTERPRET_STEP_LIMIT || entry->steps >= steps) {
+            folder->failures[id] = (uint8_t)entry->status;
+            return 0;
+        }
+    }
+    if (steps == 0) {
+        folder->failures[id] = (uint8_t)INTERPRET_STEP_LIMIT;
+        return 0;
+    }
+    InterpretStatus status = interpret(folder->interpreter, id, steps, value);
+    if (!required) folder->call_budget -= interpreted_steps(folder->interpreter);
+    if (status == INTERPRET_PENDING) {
+        // 依赖的顶层常量可能在下一轮求出，不记忆
+        folder->forward_reference = 1;
+        return 0;
+    }
+    if (entry && entry->function == NODE_NONE) remember_call(folder, entry, id, hash);
+    if (entry && entry->function != NODE_NONE) {
+        entry->status = status;
+        entry->steps = steps;
+        entry->value = *value;
+    }
+    if (status != INTERPRET_OK) folder->failures[id] = (uint8_t)status;
+    return status == INTERPRET_OK;
+}
+
+static void evaluate(Folder* folder, NodeId id) {
+    const FlatAST* ast = folder->ast;
+    if (folder->values[id].known) return;
+    ConstantValue value;
+    memset(&value, 0, sizeof(value));
+    int known = 0;
+    switch (flat_kind(ast, id)) {
+        case NODE_LITERAL:
+            value.literal = *flat_literal(ast, id);
+            known = 1;
+            break;
+        case NODE_VARIABLE: {
+            NodeId declaration = flat_binding(ast, id);
+            if (declaration == NODE_NONE || !is_constant_declaration(folder, declaration)) break;
+            if (folder->values[declaration].known) {
+                value = folder->values[declaration];
+                known = 1;
+            } else if (declaration > id) {
+                folder->forward_reference = 1;
+            }
+            break;
+        }
+        case NODE_VARIABLE_DECL: {
+            const uint32_t* record = flat_record(ast, id);
+            if (record[2] != NODE_NONE && folder->values[record[2]].known && is_constant_declaration(folder, id)) {
+                known = convert_value(&folder->values[record[2]], record[1], &value);
+            }
+            break;
+        }
+        case NODE_BINARY_OP:
+            known = fold_binary(folder, id, &value);
+            break;
+        case NODE_UNARY_OP:
+            known = fold_unary(folder, id, &value);
+            break;
+        case NODE_FUNCTION_CALL: {
+            TypeId type = cast_target(ast, id);
+            NodeId argument = flat_record(ast, id)[2];
+            if (type != TYPE_NONE) {
+                if (argument != NODE_NONE && folder->values[argument].known) {
+                    known = cast_value(&folder->values[argument], type, &value);
+                }
+            } else if (is_interpretable_call(folder, id)) {
+                known = interpret_call(folder, id, &value);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if (known) {
+        value.known = 1;
+        folder->values[id] = value;
+        folder->discovered++;
+    }
+}
+
+// 后序求值：按编号顺序扫描，子树结束时出栈求值，子节点与前面的声明总是先于父节点和后面的引用
+static void evaluate_all(Folder* folder) {
+    const FlatAST* ast = folder->ast;
+    uint32_t depth = 0;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        while (depth > 0 && id >= ast->ends[folder->stack[depth - 1]]) {
+            evaluate(folder, folder->stack[--depth]);
+        }
+        folder->stack[depth++] = id;
+    }
+    while (depth > 0) {
+        evaluate(folder, folder->stack[--depth]);
+    }
+}
+
+static int is_assignment(OperatorType op) {
+    return op == OP_ASSIGN || (op >= OP_ADD_ASSIGN && op <= OP_SHIFT_RIGHT_ASSIGN);
+}
+
+static void mark_written(Folder* folder, NodeId target) {
+    if (target == NODE_NONE || flat_kind(folder->ast, target) != NODE_VARIABLE) return;
+    NodeId declaration = flat_binding(folder->ast, target);
+    if (declaration != NODE_NONE) folder->written[declaration] = 1;
+}
+
+// 找出所有被赋值或自增自减的变量
+static void find_writes(Folder* folder) {
+    const FlatAST* ast = folder->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        ASTNodeType kind = flat_kind(ast, id);
+        if (kind == NODE_BINARY_OP && is_assignment((OperatorType)flat_record(ast, id)[0])) {
+            mark_written(folder, flat_record(ast, id)[1]);
+        } else if (kind == NODE_UNARY_OP) {
+            OperatorType op = (OperatorType)flat_record(ast, id)[0];
+            if (op >= OP_PRE_INC && op <= OP_POST_DEC) mark_written(folder, flat_record(ast, id)[1]);
+        }
+    }
+}
+
+// 字面量表示的值的类型：未标注类型的字面量在代码生成中按 i64 与 f64 处理
+static int is_literal_type(TypeId type) {
+    return type == TYPE_NONE || type == TYPE_INT || type == TYPE_I64 || type == TYPE_ISIZE || type == TYPE_F64 ||
+           type == TYPE_FLO;
+}
+
+// 未标注类型、初始值已知但不能用字面量表示的声明（如 val seed = hash(...) 得到 u64）：
+// 在副本中补上类型，初始值即可以字面量代替，顶层常量成为只读数据。没有这样的声明时返回 NULL
+static FlatAST* annotate_declarations(Folder* folder) {
+    const FlatAST* ast = folder->ast;
+    FlatAST* annotated = NULL;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_VARIABLE_DECL || !folder->values[id].known) continue;
+        const uint32_t* record = flat_record(ast, id);
+        TypeId type = folder->values[id].type;
+        if (record[1] != TYPE_NONE || record[2] == NODE_NONE || is_literal_type(type)) continue;
+        if (!annotated && !(annotated = copy_flat_ast(ast))) return NULL;
+        set_flat_declared_type(annotated, id, type);
+        folder->roles[record[2]] |= ROLE_TYPED_INITIALIZER;
+    }
+    return annotated;
+}
+
+// 标记初始值中的节点：const 初始值的整棵子树，以及标注了类型的声明的初始值
+static void mark_initializers(Folder* folder) {
+    const FlatAST* ast = folder->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_VARIABLE_DECL) continue;
+        const uint32_t* record = flat_record(ast, id);
+        NodeId initializer = record[2];
+        if (initializer == NODE_NONE) continue;
+        if (record[1] != TYPE_NONE) folder->roles[initializer] |= ROLE_TYPED_INITIALIZER;
+        if ((DeclKind)record[3] != DECL_CONST) continue;
+        for (NodeId node = initializer; node < ast->ends[initializer]; node++) {
+            folder->roles[node] |= ROLE_CONST_INITIALIZER;
+        }
+    }
+}
+
+// const 声明的初始值必须在编译期求出；只报告第一个错误的文本，其余只计数
+static void check_constants(const Folder* folder, const char* source, int length, int* error_count,
+                            char** error_message) {
+    const FlatAST* ast = folder->ast;
+    LineTable* lines = NULL;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_VARIABLE_DECL || folder->values[id].known) continue;
+        const uint32_t* record = flat_record(ast, id);
+        if ((DeclKind)record[3] != DECL_CONST) continue;
+        if ((*error_count)++ > 0 || !error_message) continue;
+
+        // 原因取初始值中第一个执行失败的调用
+        const char* reason = record[2] == NODE_NONE ? "缺少初始值" : "初始值不是编译期常量";
+        for (NodeId node = record[2]; record[2] != NODE_NONE && node < ast->ends[record[2]]; node++) {
+            if (folder->failures[node]) {
+                reason = interpret_status_message((InterpretStatus)folder->failures[node]);
+                break;
+            }
+        }
+        char buffer[384];
+        Symbol name = record[0];
+        if (source) lines = create_line_table(source, length);
+        if (lines) {
+            int line, column;
+            line_table_lookup(lines, ast->offsets[id], &line, &column);
+            snprintf(buffer, sizeof(buffer), "%d:%d: const 初始值无法在编译期求值: %.*s（%s）",
+                     line, column, symbol_length(name), symbol_name(name), reason);
+        } else {
+            snprintf(buffer, sizeof(buffer), "const 初始值无法在编译期求值: %.*s（%s）",
+                     symbol_length(name), symbol_name(name), reason);
+        }
+        *error_message = strdup(buffer);
+    }
+    destroy_line_table(lines);
+}
+
+static FlatRewrite keep_node(void) {
+    FlatRewrite rewrite;
+    memset(&rewrite, 0, sizeof(rewrite));
+    rewrite.action = FLAT_KEEP;
+    return rewrite;
+}
+
+static FlatRewrite replace_node(NodeId node) {
+    FlatRewrite rewrite = keep_node();
+    rewrite.action = node != NODE_NONE ? FLAT_REPLACE : FLAT_DROP;
+    rewrite.node = node;
+    return rewrite;
+}
+
+static FlatRewrite decide(void* context, const FlatAST* ast, NodeId id) {
+    const Folder* folder = (const Folder*)context;
+    ASTNodeType kind = flat_kind(ast, id);
+    if (kind == NODE_LITERAL) return keep_node();
+    // 值是 i64、f64、bool 或字符串时以字面量代替；其他宽度的整数（如 const X: u8 = 3 的引用）
+    // 以转换调用 u8(3) 代替，保留类型。其余类型（如 f32）的字面量会丢失类型，只在标注了类型的声明的
+    // 初始值中代替，其余位置保留原表达式，只折叠其中的子表达式
+    if ((kind == NODE_BINARY_OP || kind == NODE_UNARY_OP || kind == NODE_VARIABLE || kind == NODE_FUNCTION_CALL) &&
+        folder->values[id].known) {
+        const ConstantValue* value = &folder->values[id];
+        FlatRewrite rewrite = keep_node();
+        rewrite.action = FLAT_LITERAL;
+        rewrite.literal = value->literal;
+        if (is_literal_type(value->type) || (folder->roles[id] & ROLE_TYPED_INITIALIZER)) return rewrite;
+        int is_signed;
+        int width = value->literal.type == LITERAL_INT ? integer_width(value->type, &is_signed) : 0;
+        if (width > 0) {
+            // 已经是整数字面量的转换时原样保留
+            if (kind == NODE_FUNCTION_CALL && cast_target(ast, id) == value->type &&
+                flat_kind(ast, flat_child(ast, id, 0)) == NODE_LITERAL) {
+                return keep_node();
+            }
+            const char* name = type_name(value->type);
+            rewrite.literal.int_value = wrap_integer((unsigned long long)value->literal.int_value, width, is_signed);
+            rewrite.cast = intern(name, (int)strlen(name));
+            return rewrite;
+        }
+    }
+    const uint32_t* record = flat_record(ast, id);
+    switch (kind) {
+        case NODE_BINARY_OP: {
+            // 左操作数已知而右操作数未知：true && x、false || x 即 x，null ?: x 即 x
+            const ConstantValue* left = record[1] != NODE_NONE ? &folder->values[record[1]] : NULL;
+            if (!left || !left->known) break;
+            OperatorType op = (OperatorType)record[0];
+            if ((op == OP_AND || op == OP_OR) && is_known_bool(left) && left->literal.bool_value == (op == OP_AND)) {
+                return replace_node(record[2]);
+            }
+            if (op == OP_ELVIS) {
+                return replace_node(left->literal.type == LITERAL_NULL ? record[2] : record[1]);
+            }
+            break;
+        }
+        case NODE_IF_STATEMENT:
+            if (record[0] != NODE_NONE && is_known_bool(&folder->values[record[0]])) {
+                return replace_node(folder->values[record[0]].literal.bool_value ? record[1] : record[2]);
+            }
+            break;
+        case NODE_WHILE_STATEMENT:
+            if (record[0] != NODE_NONE && is_known_bool(&folder->values[record[0]]) && !folder->values[record[0]].literal.bool_value) {
+                return replace_node(NODE_NONE);
+            }
+            break;
+        default:
+            break;
+    }
+    return keep_node();
+}
+
+FlatAST* fold_constants(const FlatAST* ast) {
+    return fold_constants_checked(ast, NULL, NULL, 0, NULL, NULL);
+}
+
+FlatAST* fold_constants_checked(const FlatAST* ast, const InterpreterLimits* limits, const char* source, int length,
+                                int* error_count, char** error_message) {
+    if (error_count) *error_count = 0;
+    if (error_message) *error_message = NULL;
+    if (!ast) return NULL;
+    InterpreterLimits defaults;
+    if (!limits) {
+        default_interpreter_limits(&defaults);
+        limits = &defaults;
+    }
+    Folder folder;
+    memset(&folder, 0, sizeof(folder));
+    folder.ast = ast;
+    folder.max_steps = limits->max_steps;
+    folder.call_budget = limits->max_steps;
+    folder.values = (ConstantValue*)calloc(ast->count, sizeof(ConstantValue));
+    folder.written = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    folder.stack = (NodeId*)malloc(sizeof(NodeId) * ast->count);
+    folder.roles = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    folder.failures = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    FlatAST* folded = NULL;
+    if (folder.values && folder.written && folder.stack && folder.roles && folder.failures) {
+        find_writes(&folder);
+        mark_initializers(&folder);
+        // 解释器不可用（内存不足）时只做普通的折叠
+        folder.interpreter = create_interpreter(ast, folder.values, folder.written, limits);
+        int round = 0;
+        do {
+            folder.forward_reference = 0;
+            folder.discovered = 0;
+            evaluate_all(&folder);
+        } while (folder.forward_reference && folder.discovered > 0 && ++round < MAX_FOLD_ROUNDS);
+        FlatAST* annotated = annotate_declarations(&folder);
+        folded = rewrite_flat_ast(annotated ? annotated : ast, decide, &folder);
+        destroy_flat_ast(annotated);
+        if (folded && folder.interpreter && error_count) {
+            check_constants(&folder, source, length, error_count, error_message);
+        }
+    }
+    destroy_interpreter(folder.interpreter);
+    free(folder.values);
+    free(folder.written);
+    free(folder.stack);
+    free(folder.roles);
+    free(folder.failures);
+    free(folder.calls);
+    free(folder.call_arguments);
+    return folded;
+}
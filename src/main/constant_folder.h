@@ -0,0 +1,23 @@
+// 常量折叠头文件
+// 在名字解析之后、代码生成之前运行：对字面量上的二元与一元运算求值，把未被重新赋值的 val 与 const
+// 的常量初始值传播到引用处，并删去条件在编译期已知的 if 分支与 while 循环。
+// 整数运算按声明类型的位宽回绕（未标注类型的整数字面量按 64 位有符号数处理），
+// 除以零、移位量越界以及结果不是有限值的浮点运算保留到运行时。
+// 实参都已知的函数调用与 const 初始值由编译期解释器（interpreter.h）执行，结果以字面量代替：
+// const 初始值使用完整的步数上限；其他调用每次只用其中的 1%，且整个折叠过程合计不超过一个步数上限，
+// 失败的调用保留到运行时。结果按（函数, 实参值）记忆，相同实参的调用只执行一次；
+// const 初始值无法在编译期求出时报告错误。
+
+#ifndef CONSTANT_FOLDER_H
+#define CONSTANT_FOLDER_H
+
+#include "interpreter.h"
+
+// 返回折叠后的新扁平AST，原AST保持不变（由调用者释放）。内存不足时返回 NULL，此时可以继续使用原AST
+FlatAST* fold_constants(const FlatAST* ast);
+// 同上，按 limits 执行编译期求值（为 NULL 时使用默认值）。无法求值的 const 声明的数量写入 error_count，
+// 第一条错误信息写入 error_message（由调用者释放）；source 用于报告行列号，可以为 NULL
+FlatAST* fold_constants_checked(const FlatAST* ast, const InterpreterLimits* limits, const char* source, int length,
+                                int* error_count, char** error_message);
+
+#endif // CONSTANT_FOLDER_H
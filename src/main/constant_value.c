@@ -0,0 +1,333 @@
+#include "constant_value.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 整数类型的位宽与符号；不按整数折叠的类型（含 i128、u128）返回 0
+int integer_width(TypeId type, int* is_signed) {
+    *is_signed = 1;
+    switch (type) {
+        case TYPE_NONE:
+        case TYPE_INT:
+        case TYPE_I64:
+        case TYPE_ISIZE: return 64;
+        case TYPE_I8:    return 8;
+        case TYPE_I16:   return 16;
+        case TYPE_I32:   return 32;
+        case TYPE_U8:    *is_signed = 0; return 8;
+        case TYPE_U16:   *is_signed = 0; return 16;
+        case TYPE_U32:   *is_signed = 0; return 32;
+        case TYPE_U64:
+        case TYPE_USIZE: *is_signed = 0; return 64;
+        default:         return 0;
+    }
+}
+
+// 浮点类型的位宽；f128 不折叠
+int float_width(TypeId type) {
+    switch (type) {
+        case TYPE_NONE:
+        case TYPE_FLO:
+        case TYPE_F64: return 64;
+        case TYPE_F32: return 32;
+        default:       return 0;
+    }
+}
+
+// 截断到 width 位：有符号数做符号扩展，无符号数做零扩展
+long long wrap_integer(unsigned long long bits, int width, int is_signed) {
+    if (width < 64) {
+        unsigned long long mask = (1ULL << width) - 1;
+        bits &= mask;
+        if (is_signed && (bits >> (width - 1))) bits |= ~mask;
+    }
+    return (long long)bits;
+}
+
+// 两个操作数的公共类型：未标注类型的字面量取另一侧的类型，两侧标注不同时不折叠
+static int unify_types(TypeId left, TypeId right, TypeId* type) {
+    if (left == right || right == TYPE_NONE) {
+        *type = left;
+    } else if (left == TYPE_NONE) {
+        *type = right;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+static void set_bool(ConstantValue* result, int value) {
+    result->literal.type = LITERAL_BOOL;
+    result->literal.bool_value = value != 0;
+    result->type = TYPE_NONE;
+}
+
+static int is_comparison(OperatorType op) {
+    return op == OP_EQ || op == OP_NEQ || op == OP_LT || op == OP_LTE || op == OP_GT || op == OP_GTE;
+}
+
+static int compare(OperatorType op, int order) {
+    switch (op) {
+        case OP_EQ:  return order == 0;
+        case OP_NEQ: return order != 0;
+        case OP_LT:  return order < 0;
+        case OP_LTE: return order <= 0;
+        case OP_GT:  return order > 0;
+        default:     return order >= 0;
+    }
+}
+
+static int fold_integer(OperatorType op, long long a, long long b, TypeId type, ConstantValue* result) {
+    int is_signed;
+    int width = integer_width(type, &is_signed);
+    if (width == 0) return 0;
+    unsigned long long x = (unsigned long long)a;
+    unsigned long long y = (unsigned long long)b;
+    if (is_comparison(op)) {
+        int order = is_signed ? (a > b) - (a < b) : (x > y) - (x < y);
+        set_bool(result, compare(op, order));
+        return 1;
+    }
+    unsigned long long bits;
+    switch (op) {
+        case OP_ADD:     bits = x + y; break;
+        case OP_SUB:     bits = x - y; break;
+        case OP_MUL:     bits = x * y; break;
+        case OP_BIT_AND: bits = x & y; break;
+        case OP_BIT_OR:  bits = x | y; break;
+        case OP_BIT_XOR: bits = x ^ y; break;
+        case OP_DIV:
+            if (b == 0) return 0;
+            if (!is_signed) bits = x / y;
+            else bits = (a == LLONG_MIN && b == -1) ? x : (unsigned long long)(a / b);
+            break;
+        case OP_MOD:
+            if (b == 0) return 0;
+            if (!is_signed) bits = x % y;
+            else bits = b == -1 ? 0 : (unsigned long long)(a % b);
+            break;
+        case OP_SHIFT_LEFT:
+            if (b < 0 || b >= width) return 0;
+            bits = x << b;
+            break;
+        case OP_SHIFT_RIGHT:
+            if (b < 0 || b >= width) return 0;
+            // 有符号数算术右移，无符号数逻辑右移
+            if (!is_signed) bits = x >> b;
+            else bits = a < 0 ? ~(~x >> b) : x >> b;
+            break;
+        default:
+            return 0;
+    }
+    result->literal.type = LITERAL_INT;
+    result->literal.int_value = wrap_integer(bits, width, is_signed);
+    result->type = type;
+    return 1;
+}
+
+static int fold_float(OperatorType op, double a, double b, TypeId type, ConstantValue* result) {
+    int width = float_width(type);
+    if (width == 0) return 0;
+    if (is_comparison(op)) {
+        // NaN 与任何值都不相等也不可比较
+        int value;
+        switch (op) {
+            case OP_EQ:  value = a == b; break;
+            case OP_NEQ: value = a != b; break;
+            case OP_LT:  value = a < b; break;
+            case OP_LTE: value = a <= b; break;
+            case OP_GT:  value = a > b; break;
+            default:     value = a >= b; break;
+        }
+        set_bool(result, value);
+        return 1;
+    }
+    double value;
+    switch (op) {
+        case OP_ADD: value = a + b; break;
+        case OP_SUB: value = a - b; break;
+        case OP_MUL: value = a * b; break;
+        case OP_DIV: value = a / b; break;
+        default:     return 0;
+    }
+    if (width == 32) value = (double)(float)value;
+    if (!isfinite(value)) return 0;
+    result->literal.type = LITERAL_FLOAT;
+    result->literal.float_value = value;
+    result->type = type;
+    return 1;
+}
+
+// 字符串拼接的结果驻留为新的符号
+static int concatenate(Symbol left, Symbol right, ConstantValue* result) {
+    if (left == SYMBOL_NONE || right == SYMBOL_NONE) return 0;
+    int left_length = symbol_length(left);
+    int right_length = symbol_length(right);
+    char* text = (char*)malloc((size_t)left_length + (size_t)right_length + 1);
+    if (!text) return 0;
+    memcpy(text, symbol_name(left), (size_t)left_length);
+    memcpy(text + left_length, symbol_name(right), (size_t)right_length);
+    Symbol symbol = intern(text, left_length + right_length);
+    free(text);
+    if (symbol == SYMBOL_NONE) return 0;
+    result->literal.type = LITERAL_STRING;
+    result->literal.string_value = symbol;
+    result->type = TYPE_NONE;
+    return 1;
+}
+
+int fold_binary_values(OperatorType op, const ConstantValue* left, const ConstantValue* right, ConstantValue* result) {
+    if (!left->known) return 0;
+
+    // 短路运算只需要左操作数
+    if (op == OP_AND || op == OP_OR) {
+        if (!is_known_bool(left)) return 0;
+        if (left->literal.bool_value == (op == OP_OR)) {
+            *result = *left;
+            return 1;
+        }
+        if (!is_known_bool(right)) return 0;
+        *result = *right;
+        return 1;
+    }
+    if (op == OP_ELVIS) {
+        const ConstantValue* chosen = left->literal.type == LITERAL_NULL ? right : left;
+        if (!chosen->known) return 0;
+        *result = *chosen;
+        return 1;
+    }
+    if (!right->known) return 0;
+
+    LiteralType left_type = left->literal.type;
+    LiteralType right_type = right->literal.type;
+    if (left_type == LITERAL_INT && right_type == LITERAL_INT) {
+        TypeId type;
+        // 移位的结果类型只取决于左操作数
+        if (op == OP_SHIFT_LEFT || op == OP_SHIFT_RIGHT) type = left->type;
+        else if (!unify_types(left->type, right->type, &type)) return 0;
+        return fold_integer(op, left->literal.int_value, right->literal.int_value, type, result);
+    }
+    if (left_type == LITERAL_FLOAT && right_type == LITERAL_FLOAT) {
+        TypeId type;
+        if (!unify_types(left->type, right->type, &type)) return 0;
+        return fold_float(op, left->literal.float_value, right->literal.float_value, type, result);
+    }
+    if (left_type == LITERAL_STRING && right_type == LITERAL_STRING) {
+        if (op == OP_ADD) return concatenate(left->literal.string_value, right->literal.string_value, result);
+        // 驻留的字符串文本相同当且仅当符号相同
+        if (op != OP_EQ && op != OP_NEQ) return 0;
+        set_bool(result, (left->literal.string_value == right->literal.string_value) == (op == OP_EQ));
+        return 1;
+    }
+    if (left_type == LITERAL_BOOL && right_type == LITERAL_BOOL) {
+        if (op != OP_EQ && op != OP_NEQ) return 0;
+        set_bool(result, (left->literal.bool_value == right->literal.bool_value) == (op == OP_EQ));
+        return 1;
+    }
+    if (left_type == LITERAL_NULL || right_type == LITERAL_NULL) {
+        if (op != OP_EQ && op != OP_NEQ) return 0;
+        set_bool(result, (left_type == right_type) == (op == OP_EQ));
+        return 1;
+    }
+    return 0;
+}
+
+int fold_unary_value(OperatorType op, const ConstantValue* operand, ConstantValue* result) {
+    if (!operand->known) return 0;
+    *result = *operand;
+    switch (operand->literal.type) {
+        case LITERAL_INT: {
+            int is_signed;
+            int width = integer_width(operand->type, &is_signed);
+            if (width == 0) return 0;
+            unsigned long long bits = (unsigned long long)operand->literal.int_value;
+            if (op == OP_NEG) bits = 0 - bits;
+            else if (op == OP_BIT_NOT) bits = ~bits;
+            else if (op != OP_PLUS) return 0;
+            result->literal.int_value = wrap_integer(bits, width, is_signed);
+            return 1;
+        }
+        case LITERAL_FLOAT:
+            if (float_width(operand->type) == 0) return 0;
+            if (op == OP_NEG) result->literal.float_value = -operand->literal.float_value;
+            else if (op != OP_PLUS) return 0;
+            return 1;
+        case LITERAL_BOOL:
+            if (op != OP_NOT) return 0;
+            result->literal.bool_value = !operand->literal.bool_value;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// 把初始值转换为声明的类型；类型不相容时不传播
+int convert_value(const ConstantValue* value, TypeId type, ConstantValue* result) {
+    *result = *value;
+    if (type == TYPE_NONE) return 1;
+    switch (value->literal.type) {
+        case LITERAL_INT: {
+            int is_signed;
+            int width = integer_width(type, &is_signed);
+            if (width == 0) return 0;
+            result->literal.int_value = wrap_integer((unsigned long long)value->literal.int_value, width, is_signed);
+            result->type = type;
+            return 1;
+        }
+        case LITERAL_FLOAT: {
+            int width = float_width(type);
+            if (width == 0) return 0;
+            if (width == 32) result->literal.float_value = (double)(float)value->literal.float_value;
+            result->type = type;
+            return isfinite(result->literal.float_value);
+        }
+        case LITERAL_BOOL:
+            return type == TYPE_BOOL;
+        case LITERAL_STRING:
+            return type == TYPE_STR || type == TYPE_STRING;
+        case LITERAL_NULL:
+            return type == TYPE_NULL || type_kind(type) == TYPE_KIND_NULLABLE;
+    }
+    return 0;
+}
+
+// 类型转换调用 T(x)：整数与浮点数之间互相转换，浮点数取整后超出目标类型范围时不折叠
+int cast_value(const ConstantValue* value, TypeId type, ConstantValue* result) {
+    int is_signed;
+    int width = integer_width(type, &is_signed);
+    if (width > 0 && value->literal.type == LITERAL_FLOAT) {
+        // 转换本身向零取整；绝对值达到 2^52 的浮点数没有小数部分，直接比较边界即可
+        double real = value->literal.float_value;
+        int in_range = is_signed ? real >= -9223372036854775808.0 && real < 9223372036854775808.0
+                                 : real > -1.0 && real < 18446744073709551616.0;
+        if (!in_range) return 0;
+        long long bits = is_signed ? (long long)real : (long long)(unsigned long long)real;
+        if (wrap_integer((unsigned long long)bits, width, is_signed) != bits) return 0;
+        *result = *value;
+        result->literal.type = LITERAL_INT;
+        result->literal.int_value = bits;
+        result->type = type;
+        return 1;
+    }
+    int bits = float_width(type);
+    if (bits > 0 && type != TYPE_NONE && value->literal.type == LITERAL_INT) {
+        int source_signed;
+        if (integer_width(value->type, &source_signed) == 0) return 0;
+        long long integer = value->literal.int_value;
+        double real = source_signed ? (double)integer : (double)(unsigned long long)integer;
+        *result = *value;
+        result->literal.type = LITERAL_FLOAT;
+        result->literal.float_value = bits == 32 ? (double)(float)real : real;
+        result->type = type;
+        return 1;
+    }
+    return convert_value(value, type, result);
+}
+
+TypeId cast_target(const FlatAST* ast, NodeId id) {
+    const uint32_t* record = flat_record(ast, id);
+    if (flat_binding(ast, id) != NODE_NONE || record[1] != 1) return TYPE_NONE;
+    TypeId type = intern_type_text(symbol_name(record[0]), symbol_length(record[0]));
+    return type < TYPE_PRIMITIVE_END ? type : TYPE_NONE;
+}
@@ -0,0 +1,37 @@
+// 编译期常量值头文件
+// 常量折叠与编译期解释器共用的值表示和运算。整数运算按类型的位宽回绕（未标注类型的整数按 64 位
+// 有符号数处理），除以零、移位量越界以及结果不是有限值的浮点运算不求值，留到运行时。
+
+#ifndef CONSTANT_VALUE_H
+#define CONSTANT_VALUE_H
+
+#include "flat_ast.h"
+
+// 编译期的值
+typedef struct {
+    FlatLiteral literal;
+    TypeId type;             // 整数与浮点数的类型（TYPE_NONE 为未标注类型的字面量）
+    uint8_t known;
+} ConstantValue;
+
+// 函数原型
+// 整数类型的位宽与符号，不按整数求值的类型返回 0；浮点类型的位宽，f128 返回 0
+int integer_width(TypeId type, int* is_signed);
+int float_width(TypeId type);
+long long wrap_integer(unsigned long long bits, int width, int is_signed);
+
+// 运算求值，无法在编译期求值时返回 0。&&、|| 与 ?: 在左操作数决定结果时不需要右操作数
+int fold_binary_values(OperatorType op, const ConstantValue* left, const ConstantValue* right, ConstantValue* result);
+int fold_unary_value(OperatorType op, const ConstantValue* operand, ConstantValue* result);
+// 把值转换为声明的类型（隐式转换，不改变数值的种类）；类型不相容时返回 0
+int convert_value(const ConstantValue* value, TypeId type, ConstantValue* result);
+// 类型转换调用 T(x)：另外支持整数与浮点数之间的转换
+int cast_value(const ConstantValue* value, TypeId type, ConstantValue* result);
+// 以基本类型名作为函数名、只有一个实参的未绑定调用是类型转换，返回目标类型；否则返回 TYPE_NONE
+TypeId cast_target(const FlatAST* ast, NodeId id);
+
+static inline int is_known_bool(const ConstantValue* value) {
+    return value->known && value->literal.type == LITERAL_BOOL;
+}
+
+#endif // CONSTANT_VALUE_H
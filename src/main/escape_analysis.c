@@ -0,0 +1,355 @@
+#include "escape_analysis.h"
+#include "call_graph.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 值的流动：from（拼接点或局部变量声明）的值存入 to（局部变量声明或形参）
+typedef struct {
+    NodeId from;
+    NodeId to;
+    int local;               // 同一函数内的流动；传给形参的值在被调函数返回后即失效，不影响作用域
+} Flow;
+
+typedef struct {
+    const FlatAST* ast;
+    const TailCalls* tail_calls;
+    NodeId* parents;
+    NodeId* functions;       // 节点所在的函数，顶层节点为 NODE_NONE
+    NodeId* loops;           // 节点所在的最内层循环（循环体属于该循环，条件与迭代对象属于外层）
+    uint32_t* depths;        // 循环语句的嵌套深度，从 1 开始
+    uint8_t* conditions;     // 节点位于 while 条件中，每轮迭代都会执行
+    uint8_t* escaped;
+    NodeId* scopes;          // 值流入的局部变量所在的最内层公共循环
+    Flow* flows;
+    uint32_t flow_count;
+    uint32_t flow_capacity;
+    int failed;
+} Analysis;
+
+static void add_flow(Analysis* analysis, NodeId from, NodeId to, int local) {
+    if (analysis->flow_count == analysis->flow_capacity) {
+        uint32_t capacity = analysis->flow_capacity ? analysis->flow_capacity * 2 : 64;
+        Flow* flows = (Flow*)realloc(analysis->flows, sizeof(Flow) * capacity);
+        if (!flows) {
+            analysis->failed = 1;
+            return;
+        }
+        analysis->flows = flows;
+        analysis->flow_capacity = capacity;
+    }
+    Flow* flow = &analysis->flows[analysis->flow_count++];
+    flow->from = from;
+    flow->to = to;
+    flow->local = local;
+}
+
+// 前序扫描：父节点先于子节点，所在的函数与循环自上而下传递
+static void locate_nodes(Analysis* analysis) {
+    const FlatAST* ast = analysis->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        int count = flat_child_count(ast, id);
+        for (int i = 0; i < count; i++) {
+            NodeId child = flat_child(ast, id, i);
+            if (child != NODE_NONE && child < ast->count) analysis->parents[child] = id;
+        }
+        NodeId parent = analysis->parents[id];
+        if (parent != NODE_NONE) {
+            const uint32_t* record = flat_record(ast, parent);
+            analysis->functions[id] = flat_kind(ast, parent) == NODE_FUNCTION ? parent : analysis->functions[parent];
+            analysis->loops[id] = analysis->loops[parent];
+            analysis->conditions[id] = analysis->conditions[parent];
+            if (flat_kind(ast, parent) == NODE_WHILE_STATEMENT) {
+                if (id == record[1]) analysis->loops[id] = parent;
+                if (id == record[0]) analysis->conditions[id] = 1;
+            } else if (flat_kind(ast, parent) == NODE_FOR_STATEMENT && id == record[2]) {
+                analysis->loops[id] = parent;
+            }
+        }
+        ASTNodeType kind = flat_kind(ast, id);
+        if (kind == NODE_WHILE_STATEMENT || kind == NODE_FOR_STATEMENT) {
+            NodeId outer = analysis->loops[id];
+            analysis->depths[id] = (outer != NODE_NONE ? analysis->depths[outer] : 0) + 1;
+        }
+    }
+}
+
+// 两个循环的最内层公共循环，NODE_NONE 表示函数体本身
+static NodeId common_loop(const Analysis* analysis, NodeId a, NodeId b) {
+    uint32_t depth_a = a != NODE_NONE ? analysis->depths[a] : 0;
+    uint32_t depth_b = b != NODE_NONE ? analysis->depths[b] : 0;
+    while (depth_a > depth_b) {
+        a = analysis->loops[a];
+        depth_a--;
+    }
+    while (depth_b > depth_a) {
+        b = analysis->loops[b];
+        depth_b--;
+    }
+    while (a != b) {
+        a = analysis->loops[a];
+        b = analysis->loops[b];
+    }
+    return a;
+}
+
+// 函数中的局部变量（含形参）
+static int is_local(const Analysis* analysis, NodeId declaration) {
+    return declaration != NODE_NONE && flat_kind(analysis->ast, declaration) == NODE_VARIABLE_DECL &&
+           analysis->functions[declaration] != NODE_NONE;
+}
+
+// 赋值目标所指向的局部变量，其他目标返回 NODE_NONE
+static NodeId assigned_local(const Analysis* analysis, NodeId target) {
+    if (target == NODE_NONE || flat_kind(analysis->ast, target) != NODE_VARIABLE) return NODE_NONE;
+    NodeId declaration = flat_binding(analysis->ast, target);
+    return is_local(analysis, declaration) ? declaration : NODE_NONE;
+}
+
+// 把 source 的值存入赋值目标 target
+static void store_to(Analysis* analysis, NodeId source, NodeId target) {
+    NodeId declaration = assigned_local(analysis, target);
+    if (declaration != NODE_NONE) {
+        add_flow(analysis, source, declaration, 1);
+    } else {
+        analysis->escaped[source] = 1;
+    }
+}
+
+// 表达式 value 的值来自 source，沿父节点找出它的去向
+static void follow(Analysis* analysis, NodeId value, NodeId source) {
+    const FlatAST* ast = analysis->ast;
+    NodeId current = value;
+    for (;;) {
+        NodeId parent = analysis->parents[current];
+        if (parent == NODE_NONE) {
+            analysis->escaped[source] = 1;
+            return;
+        }
+        const uint32_t* record = flat_record(ast, parent);
+        switch (flat_kind(ast, parent)) {
+            case NODE_BLOCK:
+            case NODE_IF_STATEMENT:
+            case NODE_WHILE_STATEMENT:
+            case NODE_FOR_STATEMENT:
+                // 表达式语句、条件与迭代对象：当场消耗
+                return;
+            case NODE_VARIABLE_DECL:
+                if (is_local(analysis, parent)) {
+                    add_flow(analysis, source, parent, 1);
+                } else {
+                    analysis->escaped[source] = 1;
+                }
+                return;
+            case NODE_UNARY_OP:
+                if ((OperatorType)record[0] != OP_NOT_NULL) return;
+                current = parent;
+                continue;
+            case NODE_BINARY_OP:
+                switch ((OperatorType)record[0]) {
+                    case OP_ELVIS:
+                        current = parent;
+                        continue;
+                    case OP_ASSIGN:
+                        if (current == record[1]) return;
+                        store_to(analysis, source, record[1]);
+                        current = parent;
+                        continue;
+                    case OP_MEMBER: case OP_SAFE_MEMBER: case OP_SCOPE: case OP_INDEX:
+                        analysis->escaped[source] = 1;
+                        return;
+                    default:
+                        // 运算、比较与复合赋值都只读取操作数
+                        return;
+                }
+            case NODE_FUNCTION_CALL: {
+                NodeId callee = flat_binding(ast, parent);
+                if (callee == NODE_NONE || flat_kind(ast, callee) != NODE_FUNCTION) {
+                    // 类型转换与未解析的调用：结果可能就是实参本身
+                    current = parent;
+                    continue;
+                }
+                if (tail_call_kind(analysis->tail_calls, parent) != TAIL_CALL_NONE) {
+                    analysis->escaped[source] = 1;
+                    return;
+                }
+                const uint32_t* callee_record = flat_record(ast, callee);
+                if (callee_record[2] == NODE_NONE) return;
+                uint32_t index = 0;
+                while (index < record[1] && record[2 + index] != current) index++;
+                if (index < callee_record[3]) {
+                    add_flow(analysis, source, callee_record[5 + index], 0);
+                } else {
+                    analysis->escaped[source] = 1;
+                }
+                return;
+            }
+            default:
+                analysis->escaped[source] = 1;
+                return;
+        }
+    }
+}
+
+// 拼接点是否可能产生字符串：+ 与 +=（类型由代码生成器判断）
+static int is_concat_site(const FlatAST* ast, NodeId id) {
+    if (flat_kind(ast, id) != NODE_BINARY_OP) return 0;
+    OperatorType op = (OperatorType)flat_record(ast, id)[0];
+    return op == OP_ADD || op == OP_ADD_ASSIGN;
+}
+
+// 收集函数体中的值流动
+static void collect_flows(Analysis* analysis) {
+    const FlatAST* ast = analysis->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count && !analysis->failed; id++) {
+        if (analysis->functions[id] == NODE_NONE) continue;
+        switch (flat_kind(ast, id)) {
+            case NODE_BINARY_OP:
+                if (!is_concat_site(ast, id)) break;
+                if ((OperatorType)flat_record(ast, id)[0] == OP_ADD_ASSIGN) {
+                    store_to(analysis, id, flat_record(ast, id)[1]);
+                }
+                follow(analysis, id, id);
+                break;
+            case NODE_VARIABLE: {
+                NodeId declaration = flat_binding(ast, id);
+                if (is_local(analysis, declaration)) follow(analysis, id, declaration);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// 逃逸沿流动反向传播：存入逃逸变量的值同样逃逸
+static int propagate_escapes(Analysis* analysis) {
+    uint32_t count = analysis->ast->count;
+    uint32_t* starts = (uint32_t*)calloc(count + 1, sizeof(uint32_t));
+    NodeId* sources = (NodeId*)malloc(sizeof(NodeId) * (analysis->flow_count + 1));
+    NodeId* worklist = (NodeId*)malloc(sizeof(NodeId) * (count + 1));
+    if (!starts || !sources || !worklist) {
+        free(starts);
+        free(sources);
+        free(worklist);
+        return 0;
+    }
+    // 按流入的目标分组
+    for (uint32_t i = 0; i < analysis->flow_count; i++) starts[analysis->flows[i].to + 1]++;
+    for (uint32_t i = 0; i < count; i++) starts[i + 1] += starts[i];
+    for (uint32_t i = 0; i < analysis->flow_count; i++) {
+        sources[starts[analysis->flows[i].to]++] = analysis->flows[i].from;
+    }
+    for (uint32_t i = count; i > 0; i--) starts[i] = starts[i - 1];
+    starts[0] = 0;
+
+    uint32_t top = 0;
+    for (NodeId id = 0; id < count; id++) {
+        if (analysis->escaped[id]) worklist[top++] = id;
+    }
+    while (top > 0) {
+        NodeId target = worklist[--top];
+        for (uint32_t i = starts[target]; i < starts[target + 1]; i++) {
+            NodeId source = sources[i];
+            if (analysis->escaped[source]) continue;
+            analysis->escaped[source] = 1;
+            worklist[top++] = source;
+        }
+    }
+    free(starts);
+    free(sources);
+    free(worklist);
+    return 1;
+}
+
+// 作用域沿同一函数内的流动反向合并，直到不再变化（循环嵌套很浅，很快收敛）
+static void propagate_scopes(Analysis* analysis) {
+    for (NodeId id = 0; id < analysis->ast->count; id++) analysis->scopes[id] = analysis->loops[id];
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (uint32_t i = 0; i < analysis->flow_count; i++) {
+            const Flow* flow = &analysis->flows[i];
+            if (!flow->local) continue;
+            NodeId scope = common_loop(analysis, analysis->scopes[flow->from], analysis->scopes[flow->to]);
+            if (scope != analysis->scopes[flow->from]) {
+                analysis->scopes[flow->from] = scope;
+                changed = 1;
+            }
+        }
+    }
+}
+
+static void free_analysis(Analysis* analysis) {
+    free(analysis->parents);
+    free(analysis->functions);
+    free(analysis->loops);
+    free(analysis->depths);
+    free(analysis->conditions);
+    free(analysis->escaped);
+    free(analysis->scopes);
+    free(analysis->flows);
+}
+
+Escapes* analyze_escapes(const FlatAST* ast, const TailCalls* tail_calls) {
+    if (!ast) return NULL;
+    Escapes* escapes = (Escapes*)calloc(1, sizeof(Escapes));
+    if (!escapes) return NULL;
+    escapes->count = ast->count;
+    escapes->stack = (uint8_t*)calloc(ast->count + 1, sizeof(uint8_t));
+    if (!escapes->stack) {
+        free(escapes);
+        return NULL;
+    }
+    if (ast->count <= FLAT_AST_ROOT) return escapes;
+
+    Analysis analysis;
+    memset(&analysis, 0, sizeof(analysis));
+    analysis.ast = ast;
+    analysis.tail_calls = tail_calls;
+    analysis.parents = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    analysis.functions = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    analysis.loops = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    analysis.depths = (uint32_t*)calloc(ast->count, sizeof(uint32_t));
+    analysis.conditions = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    analysis.escaped = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    analysis.scopes = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    CallGraph* graph = build_call_graph(ast);
+    if (!analysis.parents || !analysis.functions || !analysis.loops || !analysis.depths ||
+        !analysis.conditions || !analysis.escaped || !analysis.scopes || !graph) {
+        free_analysis(&analysis);
+        destroy_call_graph(graph);
+        destroy_escapes(escapes);
+        return NULL;
+    }
+
+    locate_nodes(&analysis);
+    collect_flows(&analysis);
+    if (analysis.failed || !propagate_escapes(&analysis)) {
+        free_analysis(&analysis);
+        destroy_call_graph(graph);
+        destroy_escapes(escapes);
+        return NULL;
+    }
+    propagate_scopes(&analysis);
+
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        NodeId function = analysis.functions[id];
+        if (function == NODE_NONE || !is_concat_site(ast, id)) continue;
+        // 形参的默认值在每个调用处生成，不属于函数自己的栈帧
+        NodeId body = flat_record(ast, function)[2];
+        if (body == NODE_NONE || id < body || id >= ast->ends[body]) continue;
+        if (analysis.escaped[id] || analysis.conditions[id] || analysis.scopes[id] != analysis.loops[id]) continue;
+        int index = call_graph_index(graph, function);
+        if (index < 0 || graph->recursive[index]) continue;
+        escapes->stack[id] = 1;
+    }
+    free_analysis(&analysis);
+    destroy_call_graph(graph);
+    return escapes;
+}
+
+void destroy_escapes(Escapes* escapes) {
+    if (!escapes) return;
+    free(escapes->stack);
+    free(escapes);
+}
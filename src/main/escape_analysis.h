@@ -0,0 +1,35 @@
+// 逃逸分析头文件
+// 找出结果不会逃出所在函数的字符串拼接（+ 与 +=）。代码生成器在栈帧中为每个这样的拼接点保留
+// 固定大小的缓冲区，结果放得下时直接写入缓冲区，放不下时才回退到堆上分配。
+// 值的去向沿父节点判断：
+//   作为拼接与比较的操作数、条件或表达式语句，以及外部 C 函数的实参时被当场消耗
+//   （假定 C 函数不保留字符串参数的指针）；
+//   存入局部变量后随该变量继续流动，传给源文件中的函数时随对应的形参流动；
+//   被返回、存入顶层变量或其他赋值目标、作为尾调用的实参时逃逸，无法判断的位置一律视为逃逸。
+// 同一拼接点再次执行时会覆盖它的缓冲区，因此还要求：拼接点不在 while 条件中；位于循环体中时，
+// 结果流入的局部变量都声明在同一层循环体内（下一轮迭代前已经失效）；递归环上的函数不使用缓冲区。
+
+#ifndef ESCAPE_ANALYSIS_H
+#define ESCAPE_ANALYSIS_H
+
+#include "flat_ast.h"
+#include "tail_call.h"
+
+// 每个拼接点在栈帧中保留的字节数（含结尾的 0）
+#define STACK_STRING_CAPACITY 256
+
+typedef struct {
+    uint8_t* stack;      // 每个节点：拼接结果可以写入栈上的缓冲区（只对 + 与 += 有意义）
+    uint32_t count;      // 节点数量
+} Escapes;
+
+// 函数原型
+// tail_calls 可以为 NULL。内存不足时返回 NULL
+Escapes* analyze_escapes(const FlatAST* ast, const TailCalls* tail_calls);
+void destroy_escapes(Escapes* escapes);
+
+static inline int stack_allocated(const Escapes* escapes, NodeId id) {
+    return escapes && id < escapes->count && escapes->stack[id];
+}
+
+#endif // ESCAPE_ANALYSIS_H
@@ -0,0 +1,674 @@
+#include "flat_ast.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FLAT_AST_INITIAL_CAPACITY 256
+
+// 追加一个节点，返回其编号（负载与子树终点稍后填写）
+static NodeId add_node(FlatAST* ast, ASTNodeType kind, int offset) {
+    if (ast->count == ast->capacity) {
+        uint32_t capacity = ast->capacity * 2;
+        uint8_t* kinds = (uint8_t*)realloc(ast->kinds, sizeof(uint8_t) * capacity);
+        if (kinds) ast->kinds = kinds;
+        int32_t* offsets = (int32_t*)realloc(ast->offsets, sizeof(int32_t) * capacity);
+        if (offsets) ast->offsets = offsets;
+        uint32_t* ends = (uint32_t*)realloc(ast->ends, sizeof(uint32_t) * capacity);
+        if (ends) ast->ends = ends;
+        uint32_t* data = (uint32_t*)realloc(ast->data, sizeof(uint32_t) * capacity);
+        if (data) ast->data = data;
+        if (!kinds || !offsets || !ends || !data) return NODE_NONE;
+        ast->capacity = capacity;
+    }
+    NodeId id = ast->count++;
+    ast->kinds[id] = (uint8_t)kind;
+    ast->offsets[id] = offset;
+    ast->ends[id] = id + 1;
+    ast->data[id] = 0;
+    return id;
+}
+
+// 在 extra 中预留 length 个槽位，返回起点
+static uint32_t reserve_extra(FlatAST* ast, uint32_t length) {
+    if (ast->extra_count + length > ast->extra_capacity) {
+        uint32_t capacity = ast->extra_capacity;
+        while (capacity < ast->extra_count + length) capacity *= 2;
+        uint32_t* extra = (uint32_t*)realloc(ast->extra, sizeof(uint32_t) * capacity);
+        if (!extra) return UINT32_MAX;
+        ast->extra = extra;
+        ast->extra_capacity = capacity;
+    }
+    uint32_t start = ast->extra_count;
+    memset(ast->extra + start, 0, sizeof(uint32_t) * length);
+    ast->extra_count += length;
+    return start;
+}
+
+static uint32_t push_literal(FlatAST* ast, const FlatLiteral* literal) {
+    if (ast->literal_count == ast->literal_capacity) {
+        uint32_t capacity = ast->literal_capacity ? ast->literal_capacity * 2 : 64;
+        FlatLiteral* literals = (FlatLiteral*)realloc(ast->literals, sizeof(FlatLiteral) * capacity);
+        if (!literals) return 0;
+        ast->literals = literals;
+        ast->literal_capacity = capacity;
+    }
+    ast->literals[ast->literal_count] = *literal;
+    return ast->literal_count++;
+}
+
+static uint32_t add_literal(FlatAST* ast, const Literal* literal) {
+    FlatLiteral entry;
+    entry.type = literal->type;
+    switch (literal->type) {
+        case LITERAL_INT:    entry.int_value = literal->int_value; break;
+        case LITERAL_FLOAT:  entry.float_value = literal->float_value; break;
+        case LITERAL_STRING: entry.string_value = literal->string_value ? intern_cstr(literal->string_value) : SYMBOL_NONE; break;
+        case LITERAL_BOOL:   entry.bool_value = literal->bool_value; break;
+        case LITERAL_NULL:   entry.int_value = 0; break;
+    }
+    return push_literal(ast, &entry);
+}
+
+static Symbol intern_optional(const char* text) {
+    return text ? intern_cstr(text) : SYMBOL_NONE;
+}
+
+// 待展开的节点，其编号应回填到的 extra 槽位（根节点为 UINT32_MAX），以及祖先节点累计的偏移平移量
+typedef struct {
+    const ASTNode* node;
+    uint32_t slot;
+    int shift;
+} FlattenItem;
+
+typedef struct {
+    FlattenItem* items;
+    int count;
+    int capacity;
+    int shift;             // 正在压栈的子节点所继承的平移量
+} FlattenStack;
+
+static int push_item(FlattenStack* stack, const ASTNode* node, uint32_t slot) {
+    if (!node) return 1;
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? stack->capacity * 2 : 256;
+        FlattenItem* items = (FlattenItem*)realloc(stack->items, sizeof(FlattenItem) * capacity);
+        if (!items) return 0;
+        stack->items = items;
+        stack->capacity = capacity;
+    }
+    stack->items[stack->count].node = node;
+    stack->items[stack->count].slot = slot;
+    stack->items[stack->count].shift = stack->shift;
+    stack->count++;
+    return 1;
+}
+
+// 为节点分配编号、填写负载并预留记录，子节点按逆序压栈，出栈时即为前序。
+// 子节点的编号在其出栈时回填到记录中；extra 可能随时扩容，因此只保存槽位下标，不保存指针
+static int flatten_one(FlatAST* ast, FlattenStack* stack, const ASTNode* node, uint32_t slot, int shift) {
+    NodeId id = add_node(ast, node->type, node->offset + shift);
+    if (id == NODE_NONE) return 0;
+    if (slot != UINT32_MAX) ast->extra[slot] = id;
+    stack->shift = shift + node->shift;
+
+    uint32_t record = 0;
+    int ok = 1;
+    switch (node->type) {
+        case NODE_VARIABLE:
+            ast->data[id] = node->variable.name;
+            return 1;
+        case NODE_LITERAL:
+            ast->data[id] = add_literal(ast, &node->literal);
+            return 1;
+        case NODE_PROGRAM:
+        case NODE_BLOCK: {
+            int count = node->type == NODE_PROGRAM ? node->program.declaration_count : node->block.statement_count;
+            ASTNode** children = node->type == NODE_PROGRAM ? node->program.declarations : node->block.statements;
+            record = reserve_extra(ast, 1 + count);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = (uint32_t)count;
+            for (int i = count - 1; i >= 0 && ok; i--) {
+                ok = push_item(stack, children[i], record + 1 + i);
+            }
+            break;
+        }
+        case NODE_INCLUDE: {
+            int count = node->include.declaration_count;
+            record = reserve_extra(ast, 2 + count);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = intern_optional(node->include.filename);
+            ast->extra[record + 1] = (uint32_t)count;
+            for (int i = count - 1; i >= 0 && ok; i--) {
+                ok = push_item(stack, node->include.declarations[i], record + 2 + i);
+            }
+            break;
+        }
+        case NODE_FUNCTION: {
+            int count = node->function.param_count;
+            record = reserve_extra(ast, 5 + count);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->function.name;
+            ast->extra[record + 1] = node->function.return_type;
+            ast->extra[record + 3] = (uint32_t)count;
+            ast->extra[record + 4] = node->function.modifiers;
+            // 参数在前，函数体在后
+            ok = push_item(stack, node->function.body, record + 2);
+            for (int i = count - 1; i >= 0 && ok; i--) {
+                ok = push_item(stack, node->function.parameters[i], record + 5 + i);
+            }
+            break;
+        }
+        case NODE_FUNCTION_CALL: {
+            int count = node->call.arg_count;
+            record = reserve_extra(ast, 2 + count);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->call.name;
+            ast->extra[record + 1] = (uint32_t)count;
+            for (int i = count - 1; i >= 0 && ok; i--) {
+                ok = push_item(stack, node->call.arguments[i], record + 2 + i);
+            }
+            break;
+        }
+        case NODE_VARIABLE_DECL:
+            record = reserve_extra(ast, 4);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->var_decl.name;
+            ast->extra[record + 1] = node->var_decl.type;
+            ast->extra[record + 3] = node->var_decl.kind;
+            ok = push_item(stack, node->var_decl.initializer, record + 2);
+            break;
+        case NODE_BINARY_OP:
+            record = reserve_extra(ast, 3);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->binary_op.op;
+            ok = push_item(stack, node->binary_op.right, record + 2) &&
+                 push_item(stack, node->binary_op.left, record + 1);
+            break;
+        case NODE_UNARY_OP:
+            record = reserve_extra(ast, 2);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->unary_op.op;
+            ok = push_item(stack, node->unary_op.operand, record + 1);
+            break;
+        case NODE_IF_STATEMENT:
+            record = reserve_extra(ast, 3);
+            if (record == UINT32_MAX) break;
+            ok = push_item(stack, node->if_stmt.else_branch, record + 2) &&
+                 push_item(stack, node->if_stmt.then_branch, record + 1) &&
+                 push_item(stack, node->if_stmt.condition, record);
+            break;
+        case NODE_WHILE_STATEMENT:
+            record = reserve_extra(ast, 2);
+            if (record == UINT32_MAX) break;
+            ok = push_item(stack, node->while_stmt.body, record + 1) &&
+                 push_item(stack, node->while_stmt.condition, record);
+            break;
+        case NODE_FOR_STATEMENT:
+            record = reserve_extra(ast, 3);
+            if (record == UINT32_MAX) break;
+            ast->extra[record] = node->for_stmt.variable;
+            ok = push_item(stack, node->for_stmt.body, record + 2) &&
+                 push_item(stack, node->for_stmt.iterable, record + 1);
+            break;
+        case NODE_RETURN:
+            record = reserve_extra(ast, 1);
+            if (record == UINT32_MAX) break;
+            ok = push_item(stack, node->return_stmt.expression, record);
+            break;
+        case NODE_BREAK:
+        case NODE_CONTINUE:
+            break;
+    }
+    ast->data[id] = record == UINT32_MAX ? 0 : record;
+    return ok;
+}
+
+// 子节点的编号都大于父节点，逆序扫描一遍即可得到每棵子树的终点
+static void compute_ends(FlatAST* ast) {
+    for (NodeId id = ast->count; id-- > 1;) {
+        uint32_t end = id + 1;
+        int count = flat_child_count(ast, id);
+        for (int i = 0; i < count; i++) {
+            NodeId child = flat_child(ast, id, i);
+            if (child != NODE_NONE && ast->ends[child] > end) end = ast->ends[child];
+        }
+        ast->ends[id] = end;
+    }
+}
+
+// 前序展开整棵树。用显式栈代替递归，深层嵌套的表达式不会耗尽调用栈
+static void flatten_tree(FlatAST* ast, const ASTNode* root) {
+    FlattenStack stack = { NULL, 0, 0, 0 };
+    if (push_item(&stack, root, UINT32_MAX)) {
+        while (stack.count > 0) {
+            FlattenItem item = stack.items[--stack.count];
+            if (!flatten_one(ast, &stack, item.node, item.slot, item.shift)) break;
+        }
+    }
+    free(stack.items);
+    compute_ends(ast);
+}
+
+// 创建只有保留的 0 号节点的扁平AST
+static FlatAST* create_flat_ast(uint32_t capacity, uint32_t extra_capacity) {
+    FlatAST* ast = (FlatAST*)calloc(1, sizeof(FlatAST));
+    if (!ast) return NULL;
+
+    ast->capacity = capacity;
+    ast->kinds = (uint8_t*)malloc(sizeof(uint8_t) * ast->capacity);
+    ast->offsets = (int32_t*)malloc(sizeof(int32_t) * ast->capacity);
+    ast->ends = (uint32_t*)malloc(sizeof(uint32_t) * ast->capacity);
+    ast->data = (uint32_t*)malloc(sizeof(uint32_t) * ast->capacity);
+    ast->extra_capacity = extra_capacity;
+    ast->extra = (uint32_t*)malloc(sizeof(uint32_t) * ast->extra_capacity);
+    if (!ast->kinds || !ast->offsets || !ast->ends || !ast->data || !ast->extra) {
+        destroy_flat_ast(ast);
+        return NULL;
+    }
+
+    // 0 号节点保留给 NODE_NONE
+    ast->kinds[0] = NODE_PROGRAM;
+    ast->offsets[0] = 0;
+    ast->ends[0] = 1;
+    ast->data[0] = 0;
+    ast->count = 1;
+    return ast;
+}
+
+// 把指针形式的AST转换为扁平AST
+FlatAST* flatten_ast(const ASTNode* root) {
+    FlatAST* ast = create_flat_ast(FLAT_AST_INITIAL_CAPACITY, FLAT_AST_INITIAL_CAPACITY);
+    if (!ast) return NULL;
+    flatten_tree(ast, root);
+    return ast;
+}
+
+void destroy_flat_ast(FlatAST* ast) {
+    if (!ast) return;
+    free(ast->kinds);
+    free(ast->offsets);
+    free(ast->ends);
+    free(ast->data);
+    free(ast->extra);
+    free(ast->literals);
+    free(ast->bindings);
+    free(ast);
+}
+
+size_t flat_ast_memory(const FlatAST* ast) {
+    if (!ast) return 0;
+    return (size_t)ast->count * (sizeof(uint8_t) + sizeof(int32_t) + sizeof(uint32_t) * 2)
+         + (size_t)ast->extra_count * sizeof(uint32_t)
+         + (size_t)ast->literal_count * sizeof(FlatLiteral)
+         + (ast->bindings ? (size_t)ast->count * sizeof(NodeId) : 0);
+}
+
+Symbol flat_name(const FlatAST* ast, NodeId id) {
+    switch (flat_kind(ast, id)) {
+        case NODE_FUNCTION:
+        case NODE_FUNCTION_CALL:
+        case NODE_VARIABLE_DECL:
+        case NODE_INCLUDE:
+            return flat_record(ast, id)[0];
+        case NODE_FOR_STATEMENT:
+            return flat_record(ast, id)[0];
+        case NODE_VARIABLE:
+            return ast->data[id];
+        default:
+            return SYMBOL_NONE;
+    }
+}
+
+int flat_child_count(const FlatAST* ast, NodeId id) {
+    const uint32_t* record = flat_record(ast, id);
+    switch (flat_kind(ast, id)) {
+        case NODE_PROGRAM:
+        case NODE_BLOCK:          return (int)record[0];
+        case NODE_INCLUDE:        return (int)record[1];
+        case NODE_FUNCTION:       return (int)record[3] + 1;
+        case NODE_FUNCTION_CALL:  return (int)record[1];
+        case NODE_VARIABLE_DECL:  return 1;
+        case NODE_BINARY_OP:      return 2;
+        case NODE_UNARY_OP:       return 1;
+        case NODE_IF_STATEMENT:   return 3;
+        case NODE_WHILE_STATEMENT:return 2;
+        case NODE_FOR_STATEMENT:  return 2;
+        case NODE_RETURN:         return 1;
+        default:                  return 0;
+    }
+}
+
+// 第 index 个子节点在记录中的位置，叶子节点返回 -1
+static int child_slot(const FlatAST* ast, NodeId id, int index) {
+    const uint32_t* record = flat_record(ast, id);
+    switch (flat_kind(ast, id)) {
+        case NODE_PROGRAM:
+        case NODE_BLOCK:          return 1 + index;
+        case NODE_INCLUDE:        return 2 + index;
+        case NODE_FUNCTION:       return index < (int)record[3] ? 5 + index : 2;
+        case NODE_FUNCTION_CALL:  return 2 + index;
+        case NODE_VARIABLE_DECL:  return 2;
+        case NODE_BINARY_OP:      return 1 + index;
+        case NODE_UNARY_OP:       return 1;
+        case NODE_IF_STATEMENT:
+        case NODE_WHILE_STATEMENT:
+        case NODE_RETURN:         return index;
+        case NODE_FOR_STATEMENT:  return 1 + index;
+        default:                  return -1;
+    }
+}
+
+NodeId flat_child(const FlatAST* ast, NodeId id, int index) {
+    int slot = child_slot(ast, id, index);
+    return slot >= 0 ? flat_record(ast, id)[slot] : NODE_NONE;
+}
+
+// 记录的长度（字数）
+static uint32_t record_length(const FlatAST* ast, NodeId id) {
+    const uint32_t* record = flat_record(ast, id);
+    switch (flat_kind(ast, id)) {
+        case NODE_PROGRAM:
+        case NODE_BLOCK:          return 1 + record[0];
+        case NODE_INCLUDE:        return 2 + record[1];
+        case NODE_FUNCTION:       return 5 + record[3];
+        case NODE_FUNCTION_CALL:  return 2 + record[1];
+        case NODE_VARIABLE_DECL:  return 4;
+        case NODE_BINARY_OP:      return 3;
+        case NODE_UNARY_OP:       return 2;
+        case NODE_IF_STATEMENT:   return 3;
+        case NODE_WHILE_STATEMENT:return 2;
+        case NODE_FOR_STATEMENT:  return 3;
+        case NODE_RETURN:         return 1;
+        default:                  return 0;
+    }
+}
+
+// 改写时待复制的原节点，以及新编号应回填到的 extra 槽位（根节点为 UINT32_MAX）
+typedef struct {
+    NodeId node;
+    uint32_t slot;
+} RewriteItem;
+
+typedef struct {
+    const FlatAST* source;
+    FlatAST* target;
+    RewriteItem* items;
+    int item_count;
+    int item_capacity;
+    NodeId* origins;       // 新节点对应的原节点（以字面量代替的子树为 NODE_NONE），用于换算绑定
+    uint32_t origin_capacity;
+} Rewriter;
+
+static int push_rewrite_item(Rewriter* rewriter, NodeId node, uint32_t slot) {
+    if (node == NODE_NONE) return 1;
+    if (rewriter->item_count == rewriter->item_capacity) {
+        int capacity = rewriter->item_capacity ? rewriter->item_capacity * 2 : 256;
+        RewriteItem* items = (RewriteItem*)realloc(rewriter->items, sizeof(RewriteItem) * capacity);
+        if (!items) return 0;
+        rewriter->items = items;
+        rewriter->item_capacity = capacity;
+    }
+    rewriter->items[rewriter->item_count].node = node;
+    rewriter->items[rewriter->item_count].slot = slot;
+    rewriter->item_count++;
+    return 1;
+}
+
+// 追加一个新节点并记录其来源
+static NodeId add_rewritten_node(Rewriter* rewriter, ASTNodeType kind, int offset, NodeId origin) {
+    FlatAST* target = rewriter->target;
+    if (target->count == rewriter->origin_capacity) {
+        uint32_t capacity = rewriter->origin_capacity * 2;
+        NodeId* origins = (NodeId*)realloc(rewriter->origins, sizeof(NodeId) * capacity);
+        if (!origins) return NODE_NONE;
+        rewriter->origins = origins;
+        rewriter->origin_capacity = capacity;
+    }
+    NodeId id = add_node(target, kind, offset);
+    if (id != NODE_NONE) rewriter->origins[id] = origin;
+    return id;
+}
+
+// 按回调的决定复制一个节点，子节点按逆序压栈
+static int rewrite_one(Rewriter* rewriter, FlatRewriteFunction rewrite, void* context, RewriteItem item) {
+    const FlatAST* source = rewriter->source;
+    FlatAST* target = rewriter->target;
+    NodeId old = item.node;
+    FlatRewrite decision = rewrite(context, source, old);
+    while (decision.action == FLAT_REPLACE) {
+        old = decision.node;
+        if (old == NODE_NONE) return 1;
+        decision = rewrite(context, source, old);
+    }
+    if (decision.action == FLAT_DROP) return 1;
+
+    NodeId id;
+    if (decision.action == FLAT_LITERAL) {
+        uint32_t record = UINT32_MAX;
+        if (decision.cast != SYMBOL_NONE) {
+            // 转换调用 [名字, 1, 字面量]，字面量紧随其后
+            NodeId call = add_rewritten_node(rewriter, NODE_FUNCTION_CALL, source->offsets[old], NODE_NONE);
+            if (call == NODE_NONE || (record = reserve_extra(target, 3)) == UINT32_MAX) return 0;
+            target->extra[record] = decision.cast;
+            target->extra[record + 1] = 1;
+            target->data[call] = record;
+            if (item.slot != UINT32_MAX) target->extra[item.slot] = call;
+        }
+        id = add_rewritten_node(rewriter, NODE_LITERAL, source->offsets[old], NODE_NONE);
+        if (id == NODE_NONE) return 0;
+        target->data[id] = push_literal(target, &decision.literal);
+        if (record != UINT32_MAX) {
+            target->extra[record + 2] = id;
+            return 1;
+        }
+    } else {
+        ASTNodeType kind = flat_kind(source, old);
+        id = add_rewritten_node(rewriter, kind, source->offsets[old], old);
+        if (id == NODE_NONE) return 0;
+        switch (kind) {
+            case NODE_VARIABLE:
+                target->data[id] = source->data[old];
+                break;
+            case NODE_LITERAL:
+                target->data[id] = push_literal(target, flat_literal(source, old));
+                break;
+            case NODE_BREAK:
+            case NODE_CONTINUE:
+                break;
+            default: {
+                uint32_t length = record_length(source, old);
+                uint32_t record = reserve_extra(target, length);
+                if (record == UINT32_MAX) return 0;
+                // 名字、类型、数量等字段原样复制，子节点槽位在子节点出栈时回填
+                memcpy(target->extra + record, flat_record(source, old), sizeof(uint32_t) * length);
+                target->data[id] = record;
+                int count = flat_child_count(source, old);
+                for (int i = 0; i < count; i++) {
+                    target->extra[record + child_slot(source, old, i)] = NODE_NONE;
+                }
+                for (int i = count - 1; i >= 0; i--) {
+                    if (!push_rewrite_item(rewriter, flat_child(source, old, i), record + child_slot(source, old, i))) {
+                        return 0;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    if (item.slot != UINT32_MAX) target->extra[item.slot] = id;
+    return 1;
+}
+
+// 去掉声明、语句与实参列表中被删除的元素
+static void compact_lists(FlatAST* ast) {
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        uint32_t count_slot;
+        switch (flat_kind(ast, id)) {
+            case NODE_PROGRAM:
+            case NODE_BLOCK:         count_slot = 0; break;
+            case NODE_INCLUDE:
+            case NODE_FUNCTION_CALL: count_slot = 1; break;
+            default:                 continue;
+        }
+        uint32_t* record = &ast->extra[ast->data[id]];
+        uint32_t* items = record + count_slot + 1;
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < record[count_slot]; i++) {
+            if (items[i] != NODE_NONE) items[kept++] = items[i];
+        }
+        record[count_slot] = kept;
+    }
+}
+
+FlatAST* rewrite_flat_ast(const FlatAST* ast, FlatRewriteFunction rewrite, void* context) {
+    if (!ast || !rewrite) return NULL;
+    Rewriter rewriter = { ast, NULL, NULL, 0, 0, NULL, 0 };
+    rewriter.target = create_flat_ast(ast->count, ast->extra_count > 0 ? ast->extra_count : 1);
+    rewriter.origin_capacity = ast->count;
+    rewriter.origins = (NodeId*)malloc(sizeof(NodeId) * rewriter.origin_capacity);
+    FlatAST* target = rewriter.target;
+    int ok = target && rewriter.origins;
+    if (ok) {
+        rewriter.origins[0] = NODE_NONE;
+        if (ast->count > FLAT_AST_ROOT) ok = push_rewrite_item(&rewriter, FLAT_AST_ROOT, UINT32_MAX);
+        while (ok && rewriter.item_count > 0) {
+            RewriteItem item = rewriter.items[--rewriter.item_count];
+            ok = rewrite_one(&rewriter, rewrite, context, item);
+        }
+    }
+    if (ok) {
+        compact_lists(target);
+        compute_ends(target);
+    }
+
+    // 绑定先映射为原编号，再通过原编号到新编号的映射换算
+    if (ok && ast->bindings) {
+        NodeId* renumber = (NodeId*)calloc(ast->count, sizeof(NodeId));
+        target->bindings = (NodeId*)calloc(target->count, sizeof(NodeId));
+        ok = renumber && target->bindings;
+        if (ok) {
+            for (NodeId id = FLAT_AST_ROOT; id < target->count; id++) {
+                if (rewriter.origins[id] != NODE_NONE) renumber[rewriter.origins[id]] = id;
+            }
+            for (NodeId id = FLAT_AST_ROOT; id < target->count; id++) {
+                NodeId origin = rewriter.origins[id];
+                if (origin != NODE_NONE && ast->bindings[origin] != NODE_NONE) {
+                    target->bindings[id] = renumber[ast->bindings[origin]];
+                }
+            }
+        }
+        free(renumber);
+    }
+
+    free(rewriter.items);
+    free(rewriter.origins);
+    if (!ok) {
+        destroy_flat_ast(target);
+        return NULL;
+    }
+    return target;
+}
+
+FlatAST* copy_flat_ast(const FlatAST* ast) {
+    if (!ast) return NULL;
+    FlatAST* copy = create_flat_ast(ast->count, ast->extra_count > 0 ? ast->extra_count : 1);
+    if (!copy) return NULL;
+    memcpy(copy->kinds, ast->kinds, sizeof(uint8_t) * ast->count);
+    memcpy(copy->offsets, ast->offsets, sizeof(int32_t) * ast->count);
+    memcpy(copy->ends, ast->ends, sizeof(uint32_t) * ast->count);
+    memcpy(copy->data, ast->data, sizeof(uint32_t) * ast->count);
+    memcpy(copy->extra, ast->extra, sizeof(uint32_t) * ast->extra_count);
+    copy->count = ast->count;
+    copy->extra_count = ast->extra_count;
+    if (ast->literal_count > 0) {
+        copy->literals = (FlatLiteral*)malloc(sizeof(FlatLiteral) * ast->literal_count);
+        if (!copy->literals) {
+            destroy_flat_ast(copy);
+            return NULL;
+        }
+        memcpy(copy->literals, ast->literals, sizeof(FlatLiteral) * ast->literal_count);
+        copy->literal_count = copy->literal_capacity = ast->literal_count;
+    }
+    if (ast->bindings) {
+        // 绑定数组与节点数组保持同样的容量，追加节点时一起增长
+        copy->bindings = (NodeId*)malloc(sizeof(NodeId) * copy->capacity);
+        if (!copy->bindings) {
+            destroy_flat_ast(copy);
+            return NULL;
+        }
+        memcpy(copy->bindings, ast->bindings, sizeof(NodeId) * ast->count);
+    }
+    return copy;
+}
+
+// 追加节点，并让绑定数组跟上节点数组的容量
+static NodeId append_node(FlatAST* ast, ASTNodeType kind, int offset, NodeId binding) {
+    uint32_t capacity = ast->capacity;
+    NodeId id = add_node(ast, kind, offset);
+    if (id == NODE_NONE) return NODE_NONE;
+    if (ast->bindings && ast->capacity != capacity) {
+        NodeId* bindings = (NodeId*)realloc(ast->bindings, sizeof(NodeId) * ast->capacity);
+        if (!bindings) {
+            ast->count--;
+            return NODE_NONE;
+        }
+        ast->bindings = bindings;
+    }
+    if (ast->bindings) ast->bindings[id] = binding;
+    return id;
+}
+
+NodeId append_flat_copy(FlatAST* ast, NodeId original, int offset) {
+    ASTNodeType kind = flat_kind(ast, original);
+    NodeId id = append_node(ast, kind, offset, flat_binding(ast, original));
+    if (id == NODE_NONE) return NODE_NONE;
+    switch (kind) {
+        case NODE_VARIABLE:
+        case NODE_BREAK:
+        case NODE_CONTINUE:
+            ast->data[id] = ast->data[original];
+            break;
+        case NODE_LITERAL: {
+            FlatLiteral literal = *flat_literal(ast, original);
+            ast->data[id] = push_literal(ast, &literal);
+            break;
+        }
+        default: {
+            // 先记下记录的位置：预留空间可能移动 extra
+            uint32_t source = ast->data[original];
+            uint32_t length = record_length(ast, original);
+            uint32_t record = reserve_extra(ast, length);
+            if (record == UINT32_MAX) {
+                ast->count--;
+                return NODE_NONE;
+            }
+            memmove(ast->extra + record, ast->extra + source, sizeof(uint32_t) * length);
+            ast->data[id] = record;
+            break;
+        }
+    }
+    return id;
+}
+
+NodeId append_flat_call(FlatAST* ast, Symbol name, int offset, NodeId argument) {
+    NodeId id = append_node(ast, NODE_FUNCTION_CALL, offset, NODE_NONE);
+    if (id == NODE_NONE) return NODE_NONE;
+    uint32_t record = reserve_extra(ast, 3);
+    if (record == UINT32_MAX) {
+        ast->count--;
+        return NODE_NONE;
+    }
+    ast->extra[record] = name;
+    ast->extra[record + 1] = 1;
+    ast->extra[record + 2] = argument;
+    ast->data[id] = record;
+    return id;
+}
+
+void set_flat_child(FlatAST* ast, NodeId id, int index, NodeId child) {
+    int slot = child_slot(ast, id, index);
+    if (slot >= 0) ast->extra[ast->data[id] + slot] = child;
+}
+
+void set_flat_declared_type(FlatAST* ast, NodeId declaration, TypeId type) {
+    if (flat_kind(ast, declaration) == NODE_VARIABLE_DECL) ast->extra[ast->data[declaration] + 1] = type;
+}
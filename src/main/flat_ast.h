@@ -0,0 +1,131 @@
+// 扁平AST头文件
+// 把指针形式的AST压缩为按前序排列的并行数组：节点类型、源代码偏移、子树终点和负载各占一个数组，
+// 节点之间以32位编号互相引用。节点按源代码顺序连续存放，分析遍只需线性扫描数组。
+// 语法分析器仍构建指针形式的AST（ast.h），解析完成后由 flatten_ast 一次性转换。
+
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ast.h"
+
+// 节点编号，0 表示"无节点"，根节点编号为 1
+typedef uint32_t NodeId;
+
+#define NODE_NONE ((NodeId)0)
+#define FLAT_AST_ROOT ((NodeId)1)
+
+// 字面量（字符串驻留为符号）
+typedef struct {
+    LiteralType type;
+    union {
+        long long int_value;
+        double float_value;
+        Symbol string_value;
+        int bool_value;
+    };
+} FlatLiteral;
+
+// 各类节点的负载（data[id]）含义：
+//   NODE_VARIABLE     变量名符号
+//   NODE_LITERAL      literals 中的下标
+//   NODE_BREAK/NODE_CONTINUE 无负载
+//   其余节点          extra 中记录的起点，记录格式如下（子节点均为 NodeId，类型均为 TypeId）：
+//   NODE_PROGRAM      [数量, 声明...]
+//   NODE_BLOCK        [数量, 语句...]
+//   NODE_INCLUDE      [文件名符号, 数量, 头文件中的声明...]
+//   NODE_FUNCTION     [名字, 返回类型, 函数体, 数量, 修饰符, 参数...]（函数体未解析时为 NODE_NONE）
+//   NODE_FUNCTION_CALL[名字, 数量, 实参...]
+//   NODE_VARIABLE_DECL[名字, 类型, 初始化表达式, 声明种类（DeclKind）]
+//   NODE_BINARY_OP    [运算符, 左, 右]
+//   NODE_UNARY_OP     [运算符, 操作数]
+//   NODE_IF_STATEMENT [条件, then, else]
+//   NODE_WHILE_STATEMENT [条件, 循环体]
+//   NODE_FOR_STATEMENT[循环变量, 迭代对象, 循环体]
+//   NODE_RETURN       [表达式]
+typedef struct {
+    uint8_t* kinds;        // 节点类型（ASTNodeType）
+    int32_t* offsets;      // 源代码中的字节偏移
+    uint32_t* ends;        // 子树之后的第一个节点编号，跳过子树只需 id = ends[id]
+    uint32_t* data;        // 负载
+    uint32_t count;        // 节点数量（含保留的 0 号）
+    uint32_t capacity;
+
+    uint32_t* extra;       // 变长记录
+    uint32_t extra_count;
+    uint32_t extra_capacity;
+
+    FlatLiteral* literals; // 字面量表
+    uint32_t literal_count;
+    uint32_t literal_capacity;
+
+    NodeId* bindings;      // 名字解析的结果（语义分析之前为 NULL），见 flat_binding
+} FlatAST;
+
+// 函数原型
+FlatAST* flatten_ast(const ASTNode* root);
+void destroy_flat_ast(FlatAST* ast);
+// 扁平AST占用的字节数
+size_t flat_ast_memory(const FlatAST* ast);
+
+// 节点访问
+static inline ASTNodeType flat_kind(const FlatAST* ast, NodeId id) {
+    return (ASTNodeType)ast->kinds[id];
+}
+
+static inline const uint32_t* flat_record(const FlatAST* ast, NodeId id) {
+    return &ast->extra[ast->data[id]];
+}
+
+static inline const FlatLiteral* flat_literal(const FlatAST* ast, NodeId id) {
+    return &ast->literals[ast->data[id]];
+}
+
+// 节点名称（函数、调用、变量声明、变量引用、for循环变量、include的文件名），其他节点返回 SYMBOL_NONE
+Symbol flat_name(const FlatAST* ast, NodeId id);
+// 子节点的数量与第 index 个子节点（按前序排列的顺序，缺省的子节点为 NODE_NONE）
+int flat_child_count(const FlatAST* ast, NodeId id);
+NodeId flat_child(const FlatAST* ast, NodeId id, int index);
+
+// 改写扁平AST：按前序复制节点，由回调决定每个节点是保留、替换还是删除
+typedef enum {
+    FLAT_KEEP,           // 复制该节点，子节点继续交给回调
+    FLAT_REPLACE,        // 以原AST中的另一棵子树 node 代替（该子树同样交给回调）
+    FLAT_LITERAL,        // 以字面量 literal 代替整棵子树；cast 不为 SYMBOL_NONE 时代之以转换调用，如 u8(3)
+    FLAT_DROP            // 删除整棵子树：在声明、语句与实参列表中直接去掉，在其他位置留空（NODE_NONE）
+} FlatRewriteAction;
+
+typedef struct {
+    FlatRewriteAction action;
+    NodeId node;
+    FlatLiteral literal;
+    Symbol cast;         // 字面量外包的类型转换（类型名符号）
+} FlatRewrite;
+
+typedef FlatRewrite (*FlatRewriteFunction)(void* context, const FlatAST* ast, NodeId id);
+
+// 按 rewrite 的决定构建一棵新的扁平AST，原AST保持不变。名字解析的结果随节点复制并换算为新的编号，
+// 指向已删除声明的绑定变为 NODE_NONE。内存不足时返回 NULL
+FlatAST* rewrite_flat_ast(const FlatAST* ast, FlatRewriteFunction rewrite, void* context);
+
+// 在扁平AST末尾追加节点，用于改写前构造原AST中没有的子树（如内联展开的函数体）。
+// 追加的节点不在前序排列中，只能经由父节点的记录访问；整棵AST须再经 rewrite_flat_ast 重新排列，
+// 之后才能交给按编号扫描的各遍。内存不足时返回 NULL 或 NODE_NONE
+FlatAST* copy_flat_ast(const FlatAST* ast);
+// 复制单个节点：类型、偏移、记录（子节点槽位保持原值）、字面量与绑定
+NodeId append_flat_copy(FlatAST* ast, NodeId original, int offset);
+// 只有一个实参的未绑定调用，用于类型转换，如 i64(x)
+NodeId append_flat_call(FlatAST* ast, Symbol name, int offset, NodeId argument);
+// 修改第 index 个子节点
+void set_flat_child(FlatAST* ast, NodeId id, int index, NodeId child);
+// 修改变量声明标注的类型
+void set_flat_declared_type(FlatAST* ast, NodeId declaration, TypeId type);
+
+// 变量引用与函数调用所指向的声明节点（NODE_FUNCTION、NODE_VARIABLE_DECL 或 NODE_FOR_STATEMENT），
+// 由语义分析填写；未解析的名字（成员名、this 等）及其他节点返回 NODE_NONE
+static inline NodeId flat_binding(const FlatAST* ast, NodeId id) {
+    return ast->bindings ? ast->bindings[id] : NODE_NONE;
+}
+
+#endif // FLAT_AST_H
@@ -0,0 +1,436 @@
+#include "include_graph.h"
+#include "pch.h"
+#include "source.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define HEADER_CACHE_INITIAL_SLOTS 64   // 哈希槽初始数量（2的幂）
+#define INCLUDE_PATH_MAX 4096
+
+// 进程内缓存的头文件
+typedef struct {
+    char* path;            // 规范化路径
+    uint64_t hash;         // 路径的哈希
+    FileStamp stamp;       // 加载时的文件标识
+    PchImage image;        // 头文件的声明与 include 列表
+    int loaded;            // image 是否有效
+} CachedHeader;
+
+// 头文件缓存：按规范化路径开放寻址，条目下标在进程内保持不变
+typedef struct {
+    CachedHeader* entries;
+    int count;
+    int capacity;
+    int* slots;            // 条目下标加一，0 表示空槽
+    int slot_mask;
+} HeaderCache;
+
+static HeaderCache cache;
+
+// 图中的头文件
+typedef struct {
+    int entry;             // 缓存条目下标
+    int* includes;         // 直接 include 的头文件编号
+    int include_count;
+    int include_capacity;
+    char* error;           // 加载头文件或查找其 include 时的第一个错误
+    int expanded;          // 是否已在本翻译单元中展开
+} GraphHeader;
+
+struct IncludeGraph {
+    const char* const* include_dirs;
+    int dir_count;
+    GraphHeader* headers;
+    int count;
+    int capacity;
+    int* header_of_entry;  // 缓存条目下标 -> 图中编号加一
+    int entry_capacity;
+    int resolved;          // 编号小于它的头文件都已加载，其 include 也已加入图中
+};
+
+// 查找或创建缓存条目，失败时返回 -1
+static int cache_entry(const char* path) {
+    size_t length = strlen(path);
+    uint64_t hash = hash_bytes(path, length);
+    if (cache.count * 2 >= cache.slot_mask) {
+        int slot_count = cache.slots ? (cache.slot_mask + 1) * 2 : HEADER_CACHE_INITIAL_SLOTS;
+        int* slots = (int*)calloc((size_t)slot_count, sizeof(int));
+        if (!slots) {
+            return -1;
+        }
+        for (int i = 0; i < cache.count; i++) {
+            int slot = (int)(cache.entries[i].hash & (uint64_t)(slot_count - 1));
+            while (slots[slot]) {
+                slot = (slot + 1) & (slot_count - 1);
+            }
+            slots[slot] = i + 1;
+        }
+        free(cache.slots);
+        cache.slots = slots;
+        cache.slot_mask = slot_count - 1;
+    }
+
+    int slot = (int)(hash & (uint64_t)cache.slot_mask);
+    while (cache.slots[slot]) {
+        CachedHeader* entry = &cache.entries[cache.slots[slot] - 1];
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) {
+            return cache.slots[slot] - 1;
+        }
+        slot = (slot + 1) & cache.slot_mask;
+    }
+
+    if (cache.count == cache.capacity) {
+        int capacity = cache.capacity ? cache.capacity * 2 : 16;
+        CachedHeader* entries = (CachedHeader*)realloc(cache.entries, sizeof(CachedHeader) * capacity);
+        if (!entries) {
+            return -1;
+        }
+        cache.entries = entries;
+        cache.capacity = capacity;
+    }
+    CachedHeader* entry = &cache.entries[cache.count];
+    memset(entry, 0, sizeof(CachedHeader));
+    entry->path = strdup(path);
+    if (!entry->path) {
+        return -1;
+    }
+    entry->hash = hash;
+    cache.slots[slot] = ++cache.count;
+    return cache.count - 1;
+}
+
+void destroy_header_cache(void) {
+    for (int i = 0; i < cache.count; i++) {
+        if (cache.entries[i].loaded) {
+            release_pch_image(&cache.entries[i].image);
+        }
+        free(cache.entries[i].path);
+    }
+    free(cache.entries);
+    free(cache.slots);
+    memset(&cache, 0, sizeof(cache));
+}
+
+IncludeGraph* create_include_graph(const char* const* include_dirs, int dir_count) {
+    IncludeGraph* graph = (IncludeGraph*)calloc(1, sizeof(IncludeGraph));
+    if (graph) {
+        graph->include_dirs = include_dirs;
+        graph->dir_count = dir_count;
+    }
+    return graph;
+}
+
+void destroy_include_graph(IncludeGraph* graph) {
+    if (!graph) {
+        return;
+    }
+    for (int i = 0; i < graph->count; i++) {
+        free(graph->headers[i].includes);
+        free(graph->headers[i].error);
+    }
+    free(graph->headers);
+    free(graph->header_of_entry);
+    free(graph);
+}
+
+static char* memory_error(void) {
+    return strdup("内存分配错误：无法加载头文件");
+}
+
+// 头文件的路径：先在 from 所在目录中查找，再依次查找 include_dirs，找到时返回 1
+static int find_include(const IncludeGraph* graph, const char* from, const char* filename, char* path) {
+    int directory_length = 0;
+    for (int i = 0; from && from[i]; i++) {
+        if (from[i] == '/' || from[i] == '\\') {
+            directory_length = i + 1;
+        }
+    }
+    snprintf(path, INCLUDE_PATH_MAX, "%.*s%s", directory_length, from ? from : "", filename);
+    if (source_file_exists(path)) {
+        return 1;
+    }
+    for (int i = 0; i < graph->dir_count; i++) {
+        snprintf(path, INCLUDE_PATH_MAX, "%s/%s", graph->include_dirs[i], filename);
+        if (source_file_exists(path)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 缓存条目在图中的编号，第一次出现时加入图中；失败时返回 -1
+static int graph_header(IncludeGraph* graph, int entry) {
+    if (entry >= graph->entry_capacity) {
+        int capacity = cache.capacity;
+        int* header_of_entry = (int*)realloc(graph->header_of_entry, sizeof(int) * capacity);
+        if (!header_of_entry) {
+            return -1;
+        }
+        memset(header_of_entry + graph->entry_capacity, 0, sizeof(int) * (capacity - graph->entry_capacity));
+        graph->header_of_entry = header_of_entry;
+        graph->entry_capacity = capacity;
+    }
+    if (graph->header_of_entry[entry]) {
+        return graph->header_of_entry[entry] - 1;
+    }
+    if (graph->count == graph->capacity) {
+        int capacity = graph->capacity ? graph->capacity * 2 : 16;
+        GraphHeader* headers = (GraphHeader*)realloc(graph->headers, sizeof(GraphHeader) * capacity);
+        if (!headers) {
+            return -1;
+        }
+        graph->headers = headers;
+        graph->capacity = capacity;
+    }
+    GraphHeader* header = &graph->headers[graph->count];
+    memset(header, 0, sizeof(GraphHeader));
+    header->entry = entry;
+    graph->header_of_entry[entry] = ++graph->count;
+    return graph->count - 1;
+}
+
+int add_include(IncludeGraph* graph, const char* from, const char* filename, char** error) {
+    *error = NULL;
+    char path[INCLUDE_PATH_MAX];
+    if (!find_include(graph, from, filename, path)) {
+        char message[INCLUDE_PATH_MAX + 64];
+        snprintf(message, sizeof(message), "找不到头文件: %s", filename);
+        *error = strdup(message);
+        return -1;
+    }
+    char* canonical = canonical_source_path(path);
+    int entry = cache_entry(canonical ? canonical : path);
+    free(canonical);
+    int header = entry >= 0 ? graph_header(graph, entry) : -1;
+    if (header < 0) {
+        *error = memory_error();
+    }
+    return header;
+}
+
+// 把 child 记为 parent 直接 include 的头文件
+static int add_edge(GraphHeader* parent, int child) {
+    if (parent->include_count == parent->include_capacity) {
+        int capacity = parent->include_capacity ? parent->include_capacity * 2 : 4;
+        int* includes = (int*)realloc(parent->includes, sizeof(int) * capacity);
+        if (!includes) {
+            return 0;
+        }
+        parent->includes = includes;
+        parent->include_capacity = capacity;
+    }
+    parent->includes[parent->include_count++] = child;
+    return 1;
+}
+
+// 工作线程按步长领取加载任务
+typedef struct {
+    HeaderLoad* loads;
+    int count;
+    int start;
+    int step;
+} LoadWorker;
+
+static void load_worker(void* argument) {
+    LoadWorker* worker = (LoadWorker*)argument;
+    for (int i = worker->start; i < worker->count; i += worker->step) {
+        load_header_worker(&worker->loads[i]);
+    }
+}
+
+// 并行执行加载任务：第一个工作者在当前线程运行（线程创建失败时也在当前线程完成）
+static void run_loads(HeaderLoad* loads, int count, int thread_count) {
+    if (count == 0) {
+        return;
+    }
+    int worker_count = thread_count < count ? thread_count : count;
+    LoadWorker* workers = (LoadWorker*)malloc(sizeof(LoadWorker) * (size_t)worker_count);
+    Thread** threads = (Thread**)calloc((size_t)worker_count, sizeof(Thread*));
+    if (!workers || !threads) {
+        worker_count = 1;
+    }
+    LoadWorker serial = { loads, count, 0, 1 };
+    for (int i = 0; i < worker_count && workers; i++) {
+        workers[i].loads = loads;
+        workers[i].count = count;
+        workers[i].start = i;
+        workers[i].step = worker_count;
+    }
+    for (int i = 1; i < worker_count; i++) {
+        threads[i] = create_thread(load_worker, &workers[i]);
+        if (!threads[i]) {
+            load_worker(&workers[i]);
+        }
+    }
+    load_worker(workers && threads ? &workers[0] : &serial);
+    for (int i = 1; i < worker_count; i++) {
+        join_thread(threads[i]);
+    }
+    free(workers);
+    free(threads);
+}
+
+// 加载 [first, last) 中缓存缺失或已过期的头文件
+static void load_level(IncludeGraph* graph, int first, int last, int thread_count) {
+    HeaderLoad* loads = (HeaderLoad*)calloc((size_t)(last - first), sizeof(HeaderLoad));
+    int* owners = (int*)malloc(sizeof(int) * (size_t)(last - first));
+    if (!loads || !owners) {
+        for (int i = first; i < last; i++) {
+            graph->headers[i].error = memory_error();
+        }
+        free(loads);
+        free(owners);
+        return;
+    }
+    int count = 0;
+    for (int i = first; i < last; i++) {
+        CachedHeader* entry = &cache.entries[graph->headers[i].entry];
+        FileStamp stamp;
+        if (!source_file_stamp(entry->path, &stamp)) {
+            char message[INCLUDE_PATH_MAX + 64];
+            snprintf(message, sizeof(message), "无法读取头文件: %s", entry->path);
+            graph->headers[i].error = strdup(message);
+            continue;
+        }
+        if (entry->loaded && entry->stamp.size == stamp.size && entry->stamp.modified == stamp.modified) {
+            continue;
+        }
+        entry->stamp = stamp;
+        loads[count].path = entry->path;
+        owners[count++] = i;
+    }
+
+    run_loads(loads, count, thread_count);
+
+    // 驻留符号、生成预编译头需要在主线程中按顺序完成
+    for (int i = 0; i < count; i++) {
+        CachedHeader* entry = &cache.entries[graph->headers[owners[i]].entry];
+        if (entry->loaded) {
+            release_pch_image(&entry->image);
+            entry->loaded = 0;
+        }
+        PchImage image;
+        if (finish_header_load(&loads[i], &image)) {
+            entry->image = image;
+            entry->loaded = 1;
+        } else {
+            graph->headers[owners[i]].error = loads[i].error ? loads[i].error : memory_error();
+            loads[i].error = NULL;
+        }
+        destroy_header_load(&loads[i]);
+    }
+    free(loads);
+    free(owners);
+}
+
+void resolve_include_graph(IncludeGraph* graph, int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = cpu_count();
+    }
+    while (graph->resolved < graph->count) {
+        int first = graph->resolved;
+        int last = graph->count;
+        load_level(graph, first, last, thread_count);
+
+        // 下一层：本层头文件 include 的、图中还没有的头文件
+        for (int i = first; i < last; i++) {
+            CachedHeader* entry = &cache.entries[graph->headers[i].entry];
+            if (!entry->loaded) {
+                continue;
+            }
+            int include_count = pch_include_count(&entry->image);
+            for (int j = 0; j < include_count; j++) {
+                char* error = NULL;
+                int child = add_include(graph, entry->path, pch_include(&entry->image, j), &error);
+                GraphHeader* header = &graph->headers[i];
+                if (child >= 0 && !add_edge(header, child)) {
+                    error = memory_error();
+                }
+                if (error && !header->error) {
+                    char message[INCLUDE_PATH_MAX * 2 + 64];
+                    snprintf(message, sizeof(message), "%s（由 %s 包含）", error, entry->path);
+                    header->error = strdup(message);
+                }
+                free(error);
+            }
+        }
+        graph->resolved = last;
+    }
+}
+
+int expand_include(IncludeGraph* graph, int header, Arena* arena, int offset,
+                   ASTNode*** declarations, int* count, char** error) {
+    *declarations = NULL;
+    *count = 0;
+    *error = NULL;
+    if (graph->headers[header].expanded) {
+        return 1;
+    }
+
+    // 显式栈上的深度优先遍历：头文件在它 include 的头文件全部展开之后才加入 order
+    int* order = (int*)malloc(sizeof(int) * (size_t)graph->count);
+    int* stack = (int*)malloc(sizeof(int) * (size_t)graph->count);
+    int* next = (int*)malloc(sizeof(int) * (size_t)graph->count);
+    if (!order || !stack || !next) {
+        free(order);
+        free(stack);
+        free(next);
+        *error = memory_error();
+        return 0;
+    }
+    int order_count = 0;
+    int depth = 0;
+    int total = 0;
+    graph->headers[header].expanded = 1;
+    stack[depth] = header;
+    next[depth++] = 0;
+    while (depth > 0) {
+        GraphHeader* top = &graph->headers[stack[depth - 1]];
+        if (top->error && !*error) {
+            *error = strdup(top->error);
+        }
+        if (next[depth - 1] < top->include_count) {
+            int child = top->includes[next[depth - 1]++];
+            if (!graph->headers[child].expanded) {
+                graph->headers[child].expanded = 1;
+                stack[depth] = child;
+                next[depth++] = 0;
+            }
+            continue;
+        }
+        CachedHeader* entry = &cache.entries[top->entry];
+        if (entry->loaded) {
+            order[order_count++] = stack[depth - 1];
+            total += pch_declaration_count(&entry->image);
+        }
+        depth--;
+    }
+
+    ASTNode** nodes = NULL;
+    if (!*error && total > 0) {
+        nodes = (ASTNode**)arena_alloc(arena, sizeof(ASTNode*) * (size_t)total);
+        int filled = 0;
+        for (int i = 0; i < order_count && nodes; i++) {
+            const PchImage* image = &cache.entries[graph->headers[order[i]].entry].image;
+            if (!instantiate_pch(image, arena, offset, nodes + filled)) {
+                nodes = NULL;
+                break;
+            }
+            filled += pch_declaration_count(image);
+        }
+        if (!nodes) {
+            *error = memory_error();
+        }
+    }
+    free(order);
+    free(stack);
+    free(next);
+    if (*error) {
+        return 0;
+    }
+    *declarations = nodes;
+    *count = total;
+    return 1;
+}
@@ -0,0 +1,33 @@
+// include 图头文件
+// 翻译单元直接或间接 include 的头文件构成一张有向无环图，每个头文件（按规范化路径区分）
+// 在图中只出现一次，环在再次遇到同一头文件处截断，效果与 include 保护或 #pragma once 相同。
+// 图按层展开：同一层中互不依赖的头文件由工作线程并行读取、校验预编译头并切分标记，
+// 驻留符号、生成预编译头等步骤在主线程中完成。
+// 加载结果保存在进程内的头文件缓存中，同一进程中的后续翻译单元只需检查文件的大小与修改时间。
+
+#ifndef INCLUDE_GRAPH_H
+#define INCLUDE_GRAPH_H
+
+#include "arena.h"
+#include "ast.h"
+
+typedef struct IncludeGraph IncludeGraph;
+
+// 函数原型
+IncludeGraph* create_include_graph(const char* const* include_dirs, int dir_count);
+// 添加 from 中的一条 include 指令（from 为 NULL 时相对于当前目录查找），返回头文件在图中的编号。
+// 找不到头文件时返回 -1，并通过 error 返回错误信息（调用者释放）
+int add_include(IncludeGraph* graph, const char* from, const char* filename, char** error);
+// 逐层展开并加载图中的全部头文件，thread_count 为 0 时使用全部处理器核心
+void resolve_include_graph(IncludeGraph* graph, int thread_count);
+// 取出头文件 header 及其间接 include 的头文件中的声明，被 include 的头文件在前；
+// 已经展开过的头文件跳过。节点分配在 arena 中，偏移统一为 offset。
+// 失败时返回 0，并通过 error 返回错误信息（调用者释放）
+int expand_include(IncludeGraph* graph, int header, Arena* arena, int offset,
+                   ASTNode*** declarations, int* count, char** error);
+void destroy_include_graph(IncludeGraph* graph);
+
+// 释放进程内的头文件缓存
+void destroy_header_cache(void);
+
+#endif // INCLUDE_GRAPH_H
@@ -0,0 +1,463 @@
+#include "inliner.h"
+#include "call_graph.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 被引用多次的无副作用实参最多包含的节点数
+#define MAX_DUPLICATED_ARGUMENT 4
+
+// 节点标志
+#define FLAG_STATEMENT 0x01  // 代码块中的语句
+#define FLAG_GLOBAL    0x02  // 顶层变量
+#define FLAG_EXTERNAL  0x04  // 头文件中的声明
+
+// 可以展开的函数（按调用图中的下标）
+typedef struct {
+    NodeId expression;       // 展开的表达式，NODE_NONE 表示不能展开
+    uint8_t is_value;        // 表达式是 return 的值；否则是表达式语句，只在语句位置展开
+    uint8_t allowed;         // 满足代价模型
+    uint8_t has_effects;     // 表达式中有调用、赋值或自增自减
+    uint8_t reads_globals;   // 表达式读取顶层变量
+    uint32_t cost;           // 表达式的节点数
+} Candidate;
+
+typedef struct {
+    const FlatAST* ast;
+    FlatAST* extended;       // ast 的副本，展开的表达式追加在末尾
+    const CallGraph* graph;
+    const InlineOptions* options;
+    Candidate* candidates;
+    uint8_t* flags;
+    NodeId* replacements;    // 被展开的调用 -> 追加的表达式
+    NodeId* map;             // 复制表达式时原节点到新节点的映射
+    uint32_t map_capacity;
+    long long budget;        // 还可以新增的节点数
+    uint32_t inlined;
+    int failed;
+} Inliner;
+
+typedef enum {
+    ARGUMENT_SIMPLE,         // 字面量、局部变量或函数名：可以重复求值，也可以推迟求值
+    ARGUMENT_PURE,           // 没有副作用的表达式
+    ARGUMENT_IMPURE          // 含有调用、赋值或自增自减
+} ArgumentKind;
+
+static int is_assignment(OperatorType op) {
+    return op == OP_ASSIGN || (op >= OP_ADD_ASSIGN && op <= OP_SHIFT_RIGHT_ASSIGN);
+}
+
+static int is_increment(OperatorType op) {
+    return op >= OP_PRE_INC && op <= OP_POST_DEC;
+}
+
+// 能够按值转换的基本类型（数值与布尔值）
+static int is_scalar_type(TypeId type) {
+    return (type >= TYPE_BOOL && type <= TYPE_F128) || type == TYPE_INT || type == TYPE_FLO;
+}
+
+// 以基本类型名作为函数名的未绑定调用是类型转换，没有副作用
+static int is_cast_call(const FlatAST* ast, NodeId id) {
+    const uint32_t* record = flat_record(ast, id);
+    if (flat_binding(ast, id) != NODE_NONE || record[1] != 1) return 0;
+    TypeId type = intern_type_text(symbol_name(record[0]), symbol_length(record[0]));
+    return type != TYPE_NONE && type < TYPE_PRIMITIVE_END;
+}
+
+// 节点本身是否有副作用（不含子节点）
+static int has_effect(const FlatAST* ast, NodeId id) {
+    switch (flat_kind(ast, id)) {
+        case NODE_FUNCTION_CALL:
+            return !is_cast_call(ast, id);
+        case NODE_BINARY_OP:
+            return is_assignment((OperatorType)flat_record(ast, id)[0]);
+        case NODE_UNARY_OP:
+            return is_increment((OperatorType)flat_record(ast, id)[0]);
+        case NODE_LITERAL:
+        case NODE_VARIABLE:
+            return 0;
+        default:
+            return 1;   // 表达式中不应出现语句
+    }
+}
+
+static int reads_global(const Inliner* inliner, NodeId id) {
+    if (flat_kind(inliner->ast, id) != NODE_VARIABLE) return 0;
+    NodeId declaration = flat_binding(inliner->ast, id);
+    return declaration != NODE_NONE && (inliner->flags[declaration] & FLAG_GLOBAL);
+}
+
+// 声明是函数 function 的第几个形参，不是时返回 -1
+static int parameter_index(const FlatAST* ast, NodeId function, NodeId declaration) {
+    if (declaration <= function || declaration >= ast->ends[function]) return -1;
+    const uint32_t* record = flat_record(ast, function);
+    for (uint32_t i = 0; i < record[3]; i++) {
+        if (record[5 + i] == declaration) return (int)i;
+    }
+    return -1;
+}
+
+static void mark_nodes(Inliner* inliner) {
+    const FlatAST* ast = inliner->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_BLOCK) continue;
+        const uint32_t* record = flat_record(ast, id);
+        for (uint32_t i = 1; i <= record[0]; i++) {
+            if (record[i] != NODE_NONE) inliner->flags[record[i]] |= FLAG_STATEMENT;
+        }
+    }
+    int count = ast->count > FLAT_AST_ROOT ? flat_child_count(ast, FLAT_AST_ROOT) : 0;
+    for (int i = 0; i < count; i++) {
+        NodeId declaration = flat_child(ast, FLAT_AST_ROOT, i);
+        if (declaration == NODE_NONE) continue;
+        if (flat_kind(ast, declaration) == NODE_VARIABLE_DECL) {
+            inliner->flags[declaration] |= FLAG_GLOBAL;
+        } else if (flat_kind(ast, declaration) == NODE_INCLUDE) {
+            for (NodeId id = declaration; id < ast->ends[declaration]; id++) inliner->flags[id] |= FLAG_EXTERNAL;
+        }
+    }
+}
+
+// 函数体只含一个表达式、不修改形参、不在递归环上的函数才能展开
+static void find_candidate(Inliner* inliner, uint32_t index) {
+    const FlatAST* ast = inliner->ast;
+    Candidate* candidate = &inliner->candidates[index];
+    NodeId function = inliner->graph->functions[index];
+    const uint32_t* record = flat_record(ast, function);
+    Symbol main_name = find_symbol("main", 4);
+    if (record[2] == NODE_NONE || inliner->graph->recursive[index] || (main_name != SYMBOL_NONE && record[0] == main_name)) {
+        return;
+    }
+    NodeId body = record[2];
+    if (flat_kind(ast, body) != NODE_BLOCK || flat_record(ast, body)[0] != 1) return;
+    NodeId statement = flat_record(ast, body)[1];
+    NodeId expression = NODE_NONE;
+    int is_value = 0;
+    switch (flat_kind(ast, statement)) {
+        case NODE_RETURN:
+            expression = flat_record(ast, statement)[0];
+            is_value = 1;
+            break;
+        case NODE_FUNCTION_CALL:
+        case NODE_BINARY_OP:
+        case NODE_UNARY_OP:
+            expression = statement;
+            break;
+        default:
+            break;
+    }
+    if (expression == NODE_NONE) return;
+
+    int calls_source = 0;
+    for (NodeId id = expression; id < ast->ends[expression]; id++) {
+        ASTNodeType kind = flat_kind(ast, id);
+        if (has_effect(ast, id)) candidate->has_effects = 1;
+        if (reads_global(inliner, id)) candidate->reads_globals = 1;
+        if (kind == NODE_FUNCTION_CALL) {
+            NodeId callee = flat_binding(ast, id);
+            if (callee != NODE_NONE && !(inliner->flags[callee] & FLAG_EXTERNAL)) calls_source = 1;
+        } else if (kind == NODE_VARIABLE) {
+            // 只能引用形参，不能引用函数中的其他局部声明
+            NodeId declaration = flat_binding(ast, id);
+            if (declaration > function && declaration < ast->ends[function] &&
+                parameter_index(ast, function, declaration) < 0) {
+                return;
+            }
+        } else if (kind != NODE_LITERAL && kind != NODE_BINARY_OP && kind != NODE_UNARY_OP) {
+            return;
+        }
+        // 形参被赋值时不能直接替换为实参
+        NodeId target = NODE_NONE;
+        if (kind == NODE_BINARY_OP && is_assignment((OperatorType)flat_record(ast, id)[0])) {
+            target = flat_record(ast, id)[1];
+        } else if (kind == NODE_UNARY_OP && is_increment((OperatorType)flat_record(ast, id)[0])) {
+            target = flat_record(ast, id)[1];
+        }
+        if (target != NODE_NONE && flat_kind(ast, target) == NODE_VARIABLE &&
+            parameter_index(ast, function, flat_binding(ast, target)) >= 0) {
+            return;
+        }
+    }
+    candidate->expression = expression;
+    candidate->is_value = (uint8_t)is_value;
+    candidate->cost = ast->ends[expression] - expression;
+    int threshold = inliner->options->threshold;
+    candidate->allowed = (record[4] & MODIFIER_CROSSINLINE) ||
+                         (threshold > 0 && candidate->cost <= (uint32_t)threshold && !calls_source);
+}
+
+static ArgumentKind classify_argument(const Inliner* inliner, NodeId argument, int* global) {
+    const FlatAST* ast = inliner->ast;
+    *global = 0;
+    ASTNodeType kind = flat_kind(ast, argument);
+    if (kind == NODE_LITERAL) return ARGUMENT_SIMPLE;
+    if (kind == NODE_VARIABLE && flat_binding(ast, argument) != NODE_NONE) {
+        *global = reads_global(inliner, argument);
+        return ARGUMENT_SIMPLE;
+    }
+    ArgumentKind result = ARGUMENT_PURE;
+    for (NodeId id = argument; id < ast->ends[argument]; id++) {
+        if (has_effect(ast, id) || (flat_kind(ast, id) == NODE_VARIABLE && flat_binding(ast, id) == NODE_NONE)) {
+            result = ARGUMENT_IMPURE;
+        }
+        if (reads_global(inliner, id)) *global = 1;
+    }
+    return result;
+}
+
+// 有副作用的实参在展开后推迟到形参被引用时求值：函数体的其他副作用必须都是这次引用的祖先（在其后发生），
+// 且这次引用不能位于 &&、||、?: 只在部分情况下求值的右侧
+static int impure_use_allowed(const FlatAST* ast, NodeId expression, NodeId use) {
+    for (NodeId id = expression; id < ast->ends[expression]; id++) {
+        int ancestor = id < use && use < ast->ends[id];
+        if (has_effect(ast, id) && !ancestor && id != use) return 0;
+        if (ancestor && flat_kind(ast, id) == NODE_BINARY_OP) {
+            const uint32_t* record = flat_record(ast, id);
+            OperatorType op = (OperatorType)record[0];
+            NodeId right = record[2];
+            if ((op == OP_AND || op == OP_OR || op == OP_ELVIS) && right != NODE_NONE &&
+                right <= use && use < ast->ends[right]) {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static Symbol type_symbol(TypeId type) {
+    const char* name = type_name(type);
+    return intern(name, (int)strlen(name));
+}
+
+// 实参是否已经是形参的类型，不需要再包一层转换
+static int matches_type(const FlatAST* ast, NodeId argument, TypeId type) {
+    ASTNodeType kind = flat_kind(ast, argument);
+    if (kind == NODE_LITERAL) {
+        LiteralType literal = flat_literal(ast, argument)->type;
+        return (literal == LITERAL_INT && (type == TYPE_INT || type == TYPE_I64 || type == TYPE_ISIZE)) ||
+               (literal == LITERAL_FLOAT && (type == TYPE_F64 || type == TYPE_FLO)) ||
+               (literal == LITERAL_BOOL && type == TYPE_BOOL);
+    }
+    if (kind == NODE_VARIABLE) {
+        NodeId declaration = flat_binding(ast, argument);
+        return declaration != NODE_NONE && flat_kind(ast, declaration) == NODE_VARIABLE_DECL &&
+               flat_record(ast, declaration)[1] == type;
+    }
+    return 0;
+}
+
+// 在副本末尾构造展开的表达式，返回其根节点
+static NodeId expand(Inliner* inliner, NodeId call, NodeId callee, const Candidate* candidate, const NodeId* arguments) {
+    const FlatAST* ast = inliner->ast;
+    FlatAST* extended = inliner->extended;
+    const uint32_t* callee_record = flat_record(ast, callee);
+    uint32_t parameter_count = callee_record[3];
+    int offset = ast->offsets[call];
+    NodeId expression = candidate->expression;
+    uint32_t cost = candidate->cost;
+    if (cost + parameter_count > inliner->map_capacity) {
+        uint32_t capacity = (cost + parameter_count) * 2;
+        NodeId* map = (NodeId*)realloc(inliner->map, sizeof(NodeId) * capacity);
+        if (!map) return NODE_NONE;
+        inliner->map = map;
+        inliner->map_capacity = capacity;
+    }
+    NodeId* map = inliner->map;
+    NodeId* values = map + cost;    // 每个形参替换成的节点，首次引用时构造
+
+    for (uint32_t i = 0; i < parameter_count; i++) values[i] = NODE_NONE;
+    for (NodeId id = expression; id < ast->ends[expression]; id++) {
+        int parameter = flat_kind(ast, id) == NODE_VARIABLE ? parameter_index(ast, callee, flat_binding(ast, id)) : -1;
+        if (parameter < 0) {
+            map[id - expression] = append_flat_copy(extended, id, offset);
+            if (map[id - expression] == NODE_NONE) return NODE_NONE;
+            continue;
+        }
+        if (values[parameter] == NODE_NONE) {
+            NodeId argument = arguments[parameter];
+            TypeId type = flat_record(ast, callee_record[5 + parameter])[1];
+            values[parameter] = argument;
+            if (is_scalar_type(type) && !matches_type(ast, argument, type)) {
+                values[parameter] = append_flat_call(extended, type_symbol(type), offset, argument);
+                if (values[parameter] == NODE_NONE) return NODE_NONE;
+            }
+        }
+        map[id - expression] = values[parameter];
+    }
+    // 子节点换成新编号：形参引用是叶子节点，不需要处理
+    for (NodeId id = expression; id < ast->ends[expression]; id++) {
+        if (flat_kind(ast, id) == NODE_VARIABLE || flat_kind(ast, id) == NODE_LITERAL) continue;
+        int count = flat_child_count(ast, id);
+        for (int i = 0; i < count; i++) {
+            NodeId child = flat_child(ast, id, i);
+            set_flat_child(extended, map[id - expression], i, child != NODE_NONE ? map[child - expression] : NODE_NONE);
+        }
+    }
+    NodeId root = map[0];
+    TypeId return_type = callee_record[1];
+    if (candidate->is_value && is_scalar_type(return_type) && !(inliner->flags[call] & FLAG_STATEMENT)) {
+        root = append_flat_call(extended, type_symbol(return_type), offset, root);
+    }
+    return root;
+}
+
+// 检查一个调用能否展开，能则构造展开的表达式
+static void try_inline(Inliner* inliner, NodeId call) {
+    const FlatAST* ast = inliner->ast;
+    NodeId callee = flat_binding(ast, call);
+    if (callee == NODE_NONE || flat_kind(ast, callee) != NODE_FUNCTION) return;
+    int index = call_graph_index(inliner->graph, callee);
+    if (index < 0) return;
+    const Candidate* candidate = &inliner->candidates[index];
+    if (candidate->expression == NODE_NONE || !candidate->allowed) return;
+    if (!candidate->is_value && !(inliner->flags[call] & FLAG_STATEMENT)) return;
+
+    const uint32_t* record = flat_record(ast, call);
+    const uint32_t* callee_record = flat_record(ast, callee);
+    uint32_t argument_count = record[1];
+    uint32_t parameter_count = callee_record[3];
+    if (argument_count > parameter_count || parameter_count > 64) return;
+    NodeId arguments[64];
+    uint32_t uses[64];
+    NodeId last_use[64];
+    for (uint32_t i = 0; i < parameter_count; i++) {
+        if (i < argument_count) {
+            arguments[i] = record[2 + i];
+        } else {
+            // 缺少的实参取字面量默认值
+            NodeId initializer = flat_record(ast, callee_record[5 + i])[2];
+            if (initializer == NODE_NONE || flat_kind(ast, initializer) != NODE_LITERAL) return;
+            arguments[i] = initializer;
+        }
+        if (arguments[i] == NODE_NONE) return;
+        uses[i] = 0;
+        last_use[i] = NODE_NONE;
+    }
+    NodeId expression = candidate->expression;
+    for (NodeId id = expression; id < ast->ends[expression]; id++) {
+        if (flat_kind(ast, id) != NODE_VARIABLE) continue;
+        int parameter = parameter_index(ast, callee, flat_binding(ast, id));
+        if (parameter >= 0) {
+            uses[parameter]++;
+            last_use[parameter] = id;
+        }
+    }
+
+    long long added = (long long)candidate->cost - 1;
+    ArgumentKind kinds[64];
+    int globals[64];
+    int impure = -1;
+    for (uint32_t i = 0; i < parameter_count; i++) {
+        kinds[i] = classify_argument(inliner, arguments[i], &globals[i]);
+        uint32_t size = ast->ends[arguments[i]] - arguments[i];
+        // 函数体中的副作用可能改变实参读取的顶层变量
+        if (globals[i] && candidate->has_effects) return;
+        if (kinds[i] == ARGUMENT_PURE && uses[i] > 1 && size > MAX_DUPLICATED_ARGUMENT) return;
+        if (kinds[i] == ARGUMENT_IMPURE) {
+            if (uses[i] != 1 || impure >= 0) return;
+            impure = (int)i;
+        }
+        if (uses[i] > 1) added += (long long)(uses[i] - 1) * size;
+        if (is_scalar_type(flat_record(ast, callee_record[5 + i])[1])) added++;
+    }
+    if (impure >= 0) {
+        // 其余实参推迟求值也不受它的副作用影响
+        if (candidate->reads_globals) return;
+        for (uint32_t i = 0; i < parameter_count; i++) {
+            if ((int)i != impure && (kinds[i] != ARGUMENT_SIMPLE || globals[i])) return;
+        }
+        if (!impure_use_allowed(ast, expression, last_use[impure])) return;
+    }
+    if (added > inliner->budget) return;
+
+    NodeId root = expand(inliner, call, callee, candidate, arguments);
+    if (root == NODE_NONE) {
+        inliner->failed = 1;
+        return;
+    }
+    inliner->replacements[call] = root;
+    inliner->budget -= added;
+    inliner->inlined++;
+}
+
+static FlatRewrite expand_call(void* context, const FlatAST* ast, NodeId id) {
+    const Inliner* inliner = (const Inliner*)context;
+    (void)ast;
+    FlatRewrite rewrite;
+    memset(&rewrite, 0, sizeof(rewrite));
+    rewrite.action = FLAT_KEEP;
+    if (id < inliner->ast->count && inliner->replacements[id] != NODE_NONE) {
+        rewrite.action = FLAT_REPLACE;
+        rewrite.node = inliner->replacements[id];
+    }
+    return rewrite;
+}
+
+// 展开一轮：*inlined 为展开的调用数。没有可展开的调用时返回 NULL 且 *inlined 为 0
+static FlatAST* inline_round(const FlatAST* ast, const InlineOptions* options, long long* budget, uint32_t* inlined) {
+    Inliner inliner;
+    memset(&inliner, 0, sizeof(inliner));
+    inliner.ast = ast;
+    inliner.options = options;
+    inliner.budget = *budget;
+    *inlined = 0;
+    CallGraph* graph = build_call_graph(ast);
+    inliner.graph = graph;
+    inliner.candidates = graph ? (Candidate*)calloc(graph->function_count + 1, sizeof(Candidate)) : NULL;
+    inliner.flags = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    inliner.replacements = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    inliner.extended = copy_flat_ast(ast);
+    FlatAST* result = NULL;
+    if (graph && inliner.candidates && inliner.flags && inliner.replacements && inliner.extended) {
+        mark_nodes(&inliner);
+        for (uint32_t i = 0; i < graph->function_count; i++) find_candidate(&inliner, i);
+        for (NodeId id = FLAT_AST_ROOT; id < ast->count && !inliner.failed; id++) {
+            if (flat_kind(ast, id) == NODE_FUNCTION_CALL) try_inline(&inliner, id);
+        }
+        if (!inliner.failed && inliner.inlined > 0) {
+            result = rewrite_flat_ast(inliner.extended, expand_call, &inliner);
+            if (!result) inliner.failed = 1;
+        }
+    } else {
+        inliner.failed = 1;
+    }
+    *budget = inliner.budget;
+    *inlined = inliner.failed ? UINT32_MAX : inliner.inlined;
+    destroy_call_graph(graph);
+    destroy_flat_ast(inliner.extended);
+    free(inliner.candidates);
+    free(inliner.flags);
+    free(inliner.replacements);
+    free(inliner.map);
+    return result;
+}
+
+void default_inline_options(InlineOptions* options) {
+    options->threshold = INLINE_DEFAULT_THRESHOLD;
+    options->growth_percent = INLINE_DEFAULT_GROWTH;
+    options->max_rounds = INLINE_DEFAULT_ROUNDS;
+}
+
+FlatAST* inline_functions(const FlatAST* ast, const InlineOptions* options) {
+    if (!ast) return NULL;
+    InlineOptions defaults;
+    if (!options) {
+        default_inline_options(&defaults);
+        options = &defaults;
+    }
+    long long budget = options->growth_percent > 0 ? (long long)ast->count * options->growth_percent / 100 : -1;
+    const FlatAST* current = ast;
+    FlatAST* owned = NULL;
+    for (int round = 0; round < options->max_rounds && budget >= 0; round++) {
+        uint32_t inlined;
+        FlatAST* next = inline_round(current, options, &budget, &inlined);
+        if (inlined == UINT32_MAX) {
+            destroy_flat_ast(owned);
+            return NULL;
+        }
+        if (!next) break;
+        destroy_flat_ast(owned);
+        owned = next;
+        current = next;
+    }
+    return owned ? owned : copy_flat_ast(ast);
+}
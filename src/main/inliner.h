@@ -0,0 +1,32 @@
+// 内联展开头文件
+// 在名字解析之后、常量折叠之前，把小函数的调用直接展开为函数体的表达式，使常量折叠与死函数删除
+// 能够看穿这些调用。可以展开的函数体只含一个表达式："-> 表达式"、只有一条带值 return 的代码块，
+// 或只有一条表达式语句的代码块（只在语句位置展开）。
+// 形参的引用直接替换为实参（标注了基本类型的形参与返回值包一层类型转换），不引入临时变量，因此：
+//   被引用多次的实参只能是字面量、变量或很小的无副作用表达式；
+//   有副作用的实参最多一个且只被引用一次，函数体中的其他副作用都必须在它求值之后发生。
+// 代价模型按节点数计算：函数体表达式不超过 threshold 个节点、且不调用源文件中其他函数的函数自动展开，
+// crossinline 函数总是展开；递归环上的函数从不展开；展开新增的节点总数不超过原节点数的 growth_percent%。
+// 展开出的调用在下一轮继续展开，最多 max_rounds 轮。
+
+#ifndef INLINER_H
+#define INLINER_H
+
+#include "flat_ast.h"
+
+#define INLINE_DEFAULT_THRESHOLD 12
+#define INLINE_DEFAULT_GROWTH 50
+#define INLINE_DEFAULT_ROUNDS 3
+
+typedef struct {
+    int threshold;         // 自动展开的函数体表达式的最大节点数，0 表示只展开 crossinline 函数
+    int growth_percent;    // AST 增长的上限（占原节点数的百分比），0 表示不展开任何调用
+    int max_rounds;        // 嵌套展开的最大轮数
+} InlineOptions;
+
+// 函数原型
+void default_inline_options(InlineOptions* options);
+// 返回新的扁平AST，原AST保持不变；options 为 NULL 时使用默认值。内存不足时返回 NULL
+FlatAST* inline_functions(const FlatAST* ast, const InlineOptions* options);
+
+#endif // INLINER_H
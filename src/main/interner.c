@@ -0,0 +1,156 @@
+#include "interner.h"
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERNER_INITIAL_CAPACITY 1024     // 哈希表初始槽数（2的幂）
+#define INTERNER_ARENA_CHUNK_SIZE (256 * 1024)
+
+// 符号条目
+typedef struct {
+    const char* text;      // 驻留的文本（位于区域分配器中）
+    uint32_t length;       // 文本长度
+    uint32_t hash;         // 缓存的哈希值，扩容时无需重新计算
+} SymbolEntry;
+
+// 驻留表结构：开放寻址哈希表 + 按编号排列的条目数组 + 存放文本的区域分配器
+typedef struct {
+    Symbol* slots;         // 哈希槽，存放符号编号（0 表示空槽）
+    uint32_t slot_mask;    // 槽数 - 1
+    SymbolEntry* entries;  // 条目数组，下标即符号编号（0 号保留）
+    uint32_t count;        // 条目数量（包含保留的 0 号）
+    uint32_t capacity;     // 条目数组容量
+    Arena* strings;        // 文本存储
+} StringInterner;
+
+static StringInterner* interner = NULL;
+
+// FNV-1a 哈希
+static uint32_t hash_text(const char* text, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static StringInterner* get_interner(void) {
+    if (interner) return interner;
+
+    interner = (StringInterner*)malloc(sizeof(StringInterner));
+    if (!interner) return NULL;
+    interner->slots = (Symbol*)calloc(INTERNER_INITIAL_CAPACITY, sizeof(Symbol));
+    interner->slot_mask = INTERNER_INITIAL_CAPACITY - 1;
+    interner->capacity = INTERNER_INITIAL_CAPACITY / 2;
+    interner->entries = (SymbolEntry*)malloc(sizeof(SymbolEntry) * interner->capacity);
+    interner->count = 1;
+    interner->strings = create_arena(INTERNER_ARENA_CHUNK_SIZE);
+    if (!interner->slots || !interner->entries || !interner->strings) {
+        destroy_interner();
+        return NULL;
+    }
+
+    // 0 号符号保留给 SYMBOL_NONE
+    interner->entries[0].text = "";
+    interner->entries[0].length = 0;
+    interner->entries[0].hash = 0;
+    return interner;
+}
+
+// 槽数翻倍并重新放置所有符号
+static int grow_slots(StringInterner* table) {
+    uint32_t new_size = (table->slot_mask + 1) * 2;
+    Symbol* slots = (Symbol*)calloc(new_size, sizeof(Symbol));
+    if (!slots) return 0;
+
+    uint32_t mask = new_size - 1;
+    for (uint32_t id = 1; id < table->count; id++) {
+        uint32_t index = table->entries[id].hash & mask;
+        while (slots[index]) index = (index + 1) & mask;
+        slots[index] = id;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slot_mask = mask;
+    return 1;
+}
+
+// 线性探测查找：返回符号所在或应插入的槽位
+static uint32_t probe(const StringInterner* table, const char* text, int length, uint32_t hash) {
+    uint32_t index = hash & table->slot_mask;
+    for (;;) {
+        Symbol id = table->slots[index];
+        if (id == SYMBOL_NONE) return index;
+        const SymbolEntry* entry = &table->entries[id];
+        if (entry->hash == hash && entry->length == (uint32_t)length &&
+            memcmp(entry->text, text, length) == 0) {
+            return index;
+        }
+        index = (index + 1) & table->slot_mask;
+    }
+}
+
+Symbol intern(const char* text, int length) {
+    StringInterner* table = get_interner();
+    if (!table) return SYMBOL_NONE;
+
+    uint32_t hash = hash_text(text, length);
+    uint32_t index = probe(table, text, length, hash);
+    if (table->slots[index]) return table->slots[index];
+
+    // 保持装载因子不超过 1/2
+    if ((table->count + 1) * 2 > table->slot_mask + 1) {
+        if (!grow_slots(table)) return SYMBOL_NONE;
+        index = probe(table, text, length, hash);
+    }
+    if (table->count == table->capacity) {
+        uint32_t capacity = table->capacity * 2;
+        SymbolEntry* entries = (SymbolEntry*)realloc(table->entries, sizeof(SymbolEntry) * capacity);
+        if (!entries) return SYMBOL_NONE;
+        table->entries = entries;
+        table->capacity = capacity;
+    }
+
+    const char* copy = arena_strndup(table->strings, text, (size_t)length);
+    if (!copy) return SYMBOL_NONE;
+
+    Symbol id = table->count++;
+    table->entries[id].text = copy;
+    table->entries[id].length = (uint32_t)length;
+    table->entries[id].hash = hash;
+    table->slots[index] = id;
+    return id;
+}
+
+Symbol intern_cstr(const char* text) {
+    return intern(text, (int)strlen(text));
+}
+
+Symbol find_symbol(const char* text, int length) {
+    if (!interner) return SYMBOL_NONE;
+    return interner->slots[probe(interner, text, length, hash_text(text, length))];
+}
+
+const char* symbol_name(Symbol symbol) {
+    if (!interner || symbol >= interner->count) return "";
+    return interner->entries[symbol].text;
+}
+
+int symbol_length(Symbol symbol) {
+    if (!interner || symbol >= interner->count) return 0;
+    return (int)interner->entries[symbol].length;
+}
+
+int symbol_count(void) {
+    return interner ? (int)interner->count - 1 : 0;
+}
+
+void destroy_interner(void) {
+    if (!interner) return;
+    free(interner->slots);
+    free(interner->entries);
+    destroy_arena(interner->strings);
+    free(interner);
+    interner = NULL;
+}
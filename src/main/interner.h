@@ -0,0 +1,32 @@
+// 字符串驻留表头文件
+// 整个进程共享一张驻留表：每个不同的名字只存储一次，并对应一个32位符号编号。
+// 词法分析阶段即把标识符转换为符号，之后语法分析、语义分析和代码生成都以整数比较名字。
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <stdint.h>
+
+// 符号编号，0 表示"无符号"
+typedef uint32_t Symbol;
+
+#define SYMBOL_NONE ((Symbol)0)
+
+// 驻留一段文本并返回其符号（相同文本总是返回相同符号）
+Symbol intern(const char* text, int length);
+// 驻留以 '\0' 结尾的字符串
+Symbol intern_cstr(const char* text);
+// 仅查找而不插入，未驻留时返回 SYMBOL_NONE
+Symbol find_symbol(const char* text, int length);
+
+// 获取符号对应的文本（以 '\0' 结尾）与长度
+const char* symbol_name(Symbol symbol);
+int symbol_length(Symbol symbol);
+
+// 已驻留的符号数量
+int symbol_count(void);
+
+// 释放驻留表（之后再次调用 intern 会重新创建）
+void destroy_interner(void);
+
+#endif // INTERNER_H
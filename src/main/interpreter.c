@@ -0,0 +1,578 @@
+#include "interpreter.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 局部变量（参数、变量声明与 for 循环变量），按声明节点查找
+typedef struct {
+    NodeId declaration;      // NODE_NONE 表示尚未绑定的实参
+    TypeId type;             // 声明的类型（未标注时为 TYPE_NONE）
+    ConstantValue value;
+} Slot;
+
+// 语句执行后的控制流
+typedef enum {
+    FLOW_NORMAL,
+    FLOW_BREAK,
+    FLOW_CONTINUE,
+    FLOW_RETURN
+} Flow;
+
+struct Interpreter {
+    const FlatAST* ast;
+    const ConstantValue* constants;
+    const uint8_t* written;
+    InterpreterLimits limits;
+    uint8_t* globals;        // 顶层变量声明
+    Slot* slots;             // 所有调用的局部变量，当前函数的从 frame 开始
+    uint32_t slot_count;
+    uint32_t slot_capacity;
+    uint32_t frame;
+    uint32_t depth;
+    uint64_t steps;          // 剩余的步数
+    uint64_t budget;         // 本次求值的步数上限
+    size_t string_bytes;     // 本次求值新建的字符串的字节数
+    ConstantValue returned;  // return 的值（不带值时 known 为 0）
+    InterpretStatus status;  // 第一个失败的原因
+};
+
+// 复合赋值对应的运算符，顺序与 OP_ADD_ASSIGN 到 OP_SHIFT_RIGHT_ASSIGN 一致
+static const OperatorType compound_operators[] = {
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_BIT_AND, OP_BIT_OR, OP_BIT_XOR, OP_SHIFT_LEFT, OP_SHIFT_RIGHT
+};
+
+static int evaluate(Interpreter* in, NodeId id, ConstantValue* result);
+static int execute(Interpreter* in, NodeId id, Flow* flow);
+
+// 记录第一个失败原因，返回 0 以便直接 return fail(...)
+static int fail(Interpreter* in, InterpretStatus status) {
+    if (in->status == INTERPRET_OK) in->status = status;
+    return 0;
+}
+
+static int step(Interpreter* in) {
+    if (in->steps == 0) return fail(in, INTERPRET_STEP_LIMIT);
+    in->steps--;
+    return 1;
+}
+
+static int within_memory(const Interpreter* in, uint32_t slots) {
+    return (size_t)slots * sizeof(Slot) + in->string_bytes <= in->limits.max_memory;
+}
+
+// 解释器只处理数值、布尔值与字符串；其他标注的类型（String、对象、可空类型等）不求值
+static int is_supported_type(TypeId type) {
+    int is_signed;
+    return type == TYPE_NONE || type == TYPE_BOOL || type == TYPE_STR || integer_width(type, &is_signed) > 0 ||
+           float_width(type) > 0;
+}
+
+// 赋给声明了类型的变量、参数或返回值：整数可以隐式转换为浮点数
+static int coerce(Interpreter* in, const ConstantValue* value, TypeId type, ConstantValue* result) {
+    if (!is_supported_type(type)) return fail(in, INTERPRET_UNSUPPORTED);
+    int converted = value->literal.type == LITERAL_INT && type != TYPE_NONE && float_width(type) > 0
+                        ? cast_value(value, type, result)
+                        : convert_value(value, type, result);
+    return converted ? 1 : fail(in, INTERPRET_UNSUPPORTED);
+}
+
+// 变量中的值不再是字面量：与代码生成一致，未标注类型的整数与浮点数按 i64 与 f64 存放
+static void settle_type(ConstantValue* value) {
+    if (value->type != TYPE_NONE) return;
+    if (value->literal.type == LITERAL_INT) value->type = TYPE_I64;
+    else if (value->literal.type == LITERAL_FLOAT) value->type = TYPE_F64;
+}
+
+static Slot* find_slot(Interpreter* in, NodeId declaration) {
+    for (uint32_t i = in->slot_count; i-- > in->frame;) {
+        if (in->slots[i].declaration == declaration) return &in->slots[i];
+    }
+    return NULL;
+}
+
+static int push_slot(Interpreter* in, NodeId declaration, TypeId type, const ConstantValue* value) {
+    if (!within_memory(in, in->slot_count + 1)) return fail(in, INTERPRET_MEMORY_LIMIT);
+    if (in->slot_count == in->slot_capacity) {
+        uint32_t capacity = in->slot_capacity ? in->slot_capacity * 2 : 64;
+        Slot* slots = (Slot*)realloc(in->slots, sizeof(Slot) * capacity);
+        if (!slots) return fail(in, INTERPRET_MEMORY_LIMIT);
+        in->slots = slots;
+        in->slot_capacity = capacity;
+    }
+    Slot* slot = &in->slots[in->slot_count++];
+    slot->declaration = declaration;
+    slot->type = type;
+    slot->value = *value;
+    settle_type(&slot->value);
+    return 1;
+}
+
+// 未初始化的变量取类型的零值；类型未知时保持未知，读取时失败
+static void zero_value(TypeId type, ConstantValue* result) {
+    int is_signed;
+    memset(result, 0, sizeof(*result));
+    if (integer_width(type, &is_signed) > 0 && type != TYPE_NONE) {
+        result->literal.type = LITERAL_INT;
+    } else if (float_width(type) > 0 && type != TYPE_NONE) {
+        result->literal.type = LITERAL_FLOAT;
+    } else if (type == TYPE_BOOL) {
+        result->literal.type = LITERAL_BOOL;
+    } else {
+        return;
+    }
+    result->type = type;
+    result->known = 1;
+}
+
+// 写入局部变量：未标注类型的浮点变量接受整数
+static int store(Interpreter* in, Slot* slot, const ConstantValue* value) {
+    ConstantValue stored;
+    if (slot->type != TYPE_NONE) {
+        if (!coerce(in, value, slot->type, &stored)) return 0;
+    } else if (slot->value.known && slot->value.literal.type == LITERAL_FLOAT && value->literal.type == LITERAL_INT) {
+        if (!cast_value(value, slot->value.type, &stored)) return fail(in, INTERPRET_UNSUPPORTED);
+    } else {
+        stored = *value;
+    }
+    settle_type(&stored);
+    slot->value = stored;
+    return 1;
+}
+
+// 只有未被赋值过的顶层 val 与 const 可以读取，值由常量折叠求出
+static int read_global(Interpreter* in, NodeId declaration, ConstantValue* result) {
+    const FlatAST* ast = in->ast;
+    if (!in->globals[declaration]) return fail(in, INTERPRET_UNSUPPORTED);
+    DeclKind kind = (DeclKind)flat_record(ast, declaration)[3];
+    if (in->written[declaration] || (kind != DECL_VAL && kind != DECL_CONST)) return fail(in, INTERPRET_IMPURE);
+    if (!in->constants[declaration].known) return fail(in, INTERPRET_PENDING);
+    *result = in->constants[declaration];
+    return 1;
+}
+
+static int read_variable(Interpreter* in, NodeId id, ConstantValue* result) {
+    NodeId declaration = flat_binding(in->ast, id);
+    if (declaration == NODE_NONE) return fail(in, INTERPRET_UNSUPPORTED);
+    Slot* slot = find_slot(in, declaration);
+    if (!slot) return read_global(in, declaration, result);
+    if (!slot->value.known) return fail(in, INTERPRET_UNSUPPORTED);
+    *result = slot->value;
+    return 1;
+}
+
+// 赋值的目标只能是当前函数的局部变量
+static Slot* target_slot(Interpreter* in, NodeId target) {
+    if (target == NODE_NONE || flat_kind(in->ast, target) != NODE_VARIABLE) {
+        fail(in, INTERPRET_UNSUPPORTED);
+        return NULL;
+    }
+    NodeId declaration = flat_binding(in->ast, target);
+    Slot* slot = declaration != NODE_NONE ? find_slot(in, declaration) : NULL;
+    if (!slot) fail(in, declaration != NODE_NONE && in->globals[declaration] ? INTERPRET_IMPURE : INTERPRET_UNSUPPORTED);
+    return slot;
+}
+
+// 与代码生成一致，未标注类型的整数字面量与浮点数运算时取浮点数的类型
+static int promote_literal(const ConstantValue* literal, const ConstantValue* other, ConstantValue* promoted) {
+    if (literal->literal.type != LITERAL_INT || literal->type != TYPE_NONE) return 0;
+    if (!other->known || other->literal.type != LITERAL_FLOAT) return 0;
+    return cast_value(literal, other->type != TYPE_NONE ? other->type : TYPE_F64, promoted);
+}
+
+static int apply_binary(Interpreter* in, OperatorType op, const ConstantValue* left, const ConstantValue* right,
+                        ConstantValue* result) {
+    ConstantValue promoted;
+    if (promote_literal(left, right, &promoted)) left = &promoted;
+    else if (promote_literal(right, left, &promoted)) right = &promoted;
+    if (!fold_binary_values(op, left, right, result)) return fail(in, INTERPRET_UNSUPPORTED);
+    result->known = 1;
+    // 拼接出的字符串驻留后不会释放，计入内存上限
+    if (result->literal.type == LITERAL_STRING && op == OP_ADD) {
+        in->string_bytes += (size_t)symbol_length(result->literal.string_value) + 1;
+        if (!within_memory(in, in->slot_count)) return fail(in, INTERPRET_MEMORY_LIMIT);
+    }
+    return 1;
+}
+
+static int assign(Interpreter* in, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(in->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    ConstantValue value;
+    if (!evaluate(in, record[2], &value)) return 0;
+    Slot* slot = target_slot(in, record[1]);
+    if (!slot) return 0;
+    if (op != OP_ASSIGN) {
+        ConstantValue current = slot->value;
+        ConstantValue combined;
+        if (!current.known) return fail(in, INTERPRET_UNSUPPORTED);
+        if (!apply_binary(in, compound_operators[op - OP_ADD_ASSIGN], &current, &value, &combined)) return 0;
+        value = combined;
+    }
+    if (!store(in, slot, &value)) return 0;
+    *result = slot->value;
+    return 1;
+}
+
+static int increment(Interpreter* in, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(in->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    Slot* slot = target_slot(in, record[1]);
+    if (!slot) return 0;
+    ConstantValue old_value = slot->value;
+    if (!old_value.known) return fail(in, INTERPRET_UNSUPPORTED);
+    ConstantValue one;
+    memset(&one, 0, sizeof(one));
+    one.known = 1;
+    if (old_value.literal.type == LITERAL_FLOAT) {
+        one.literal.type = LITERAL_FLOAT;
+        one.literal.float_value = 1.0;
+    } else {
+        one.literal.type = LITERAL_INT;
+        one.literal.int_value = 1;
+    }
+    ConstantValue new_value;
+    OperatorType arithmetic = (op == OP_PRE_INC || op == OP_POST_INC) ? OP_ADD : OP_SUB;
+    if (!apply_binary(in, arithmetic, &old_value, &one, &new_value)) return 0;
+    if (!store(in, slot, &new_value)) return 0;
+    *result = (op == OP_PRE_INC || op == OP_PRE_DEC) ? slot->value : old_value;
+    return 1;
+}
+
+static int evaluate_binary(Interpreter* in, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(in->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    if (op == OP_ASSIGN || (op >= OP_ADD_ASSIGN && op <= OP_SHIFT_RIGHT_ASSIGN)) return assign(in, id, result);
+    if (op >= OP_RANGE && op <= OP_RANGE_INCL) return fail(in, INTERPRET_UNSUPPORTED);
+    if (op >= OP_MEMBER && op <= OP_INDEX) return fail(in, INTERPRET_UNSUPPORTED);
+
+    ConstantValue left;
+    if (!evaluate(in, record[1], &left)) return 0;
+    // 短路运算：右操作数只在需要时求值
+    ConstantValue right;
+    memset(&right, 0, sizeof(right));
+    int need_right = 1;
+    if (op == OP_AND || op == OP_OR) {
+        need_right = !(left.literal.type == LITERAL_BOOL && left.literal.bool_value == (op == OP_OR));
+    } else if (op == OP_ELVIS) {
+        need_right = left.literal.type == LITERAL_NULL;
+    }
+    if (need_right && !evaluate(in, record[2], &right)) return 0;
+    return apply_binary(in, op, &left, &right, result);
+}
+
+static int evaluate_unary(Interpreter* in, NodeId id, ConstantValue* result) {
+    const uint32_t* record = flat_record(in->ast, id);
+    OperatorType op = (OperatorType)record[0];
+    if (op >= OP_PRE_INC && op <= OP_POST_DEC) return increment(in, id, result);
+    ConstantValue operand;
+    if (!evaluate(in, record[1], &operand)) return 0;
+    if (op == OP_NOT_NULL) {
+        if (operand.literal.type == LITERAL_NULL) return fail(in, INTERPRET_UNSUPPORTED);
+        *result = operand;
+        return 1;
+    }
+    if (!fold_unary_value(op, &operand, result)) return fail(in, INTERPRET_UNSUPPORTED);
+    result->known = 1;
+    return 1;
+}
+
+// 调用源文件中的函数：实参在调用者的上下文中求值，缺省的实参取参数的默认值。
+// 函数不返回值时 result->known 为 0
+static int call_function(Interpreter* in, NodeId call, NodeId function, ConstantValue* result) {
+    const FlatAST* ast = in->ast;
+    const uint32_t* record = flat_record(ast, function);
+    const uint32_t* call_record = flat_record(ast, call);
+    uint32_t parameter_count = record[3];
+    uint32_t argument_count = call_record[1];
+    if (argument_count > parameter_count) return fail(in, INTERPRET_UNSUPPORTED);
+    if (in->depth >= in->limits.max_depth) return fail(in, INTERPRET_DEPTH_LIMIT);
+
+    // 先把实参全部求值到未绑定的槽位，再绑定到参数，实参中的名字不会看到被调函数的参数
+    uint32_t base = in->slot_count;
+    for (uint32_t i = 0; i < argument_count; i++) {
+        NodeId parameter = record[5 + i];
+        TypeId type = flat_record(ast, parameter)[1];
+        ConstantValue value;
+        if (!evaluate(in, call_record[2 + i], &value) || !coerce(in, &value, type, &value)) return 0;
+        if (!push_slot(in, NODE_NONE, type, &value)) return 0;
+    }
+    uint32_t saved_frame = in->frame;
+    in->frame = base;
+    in->depth++;
+    for (uint32_t i = 0; i < argument_count; i++) {
+        in->slots[base + i].declaration = record[5 + i];
+    }
+    int ok = 1;
+    for (uint32_t i = argument_count; ok && i < parameter_count; i++) {
+        const uint32_t* parameter = flat_record(ast, record[5 + i]);
+        ConstantValue value;
+        ok = parameter[2] != NODE_NONE ? evaluate(in, parameter[2], &value) && coerce(in, &value, parameter[1], &value)
+                                       : fail(in, INTERPRET_UNSUPPORTED);
+        ok = ok && push_slot(in, record[5 + i], parameter[1], &value);
+    }
+
+    Flow flow = FLOW_NORMAL;
+    in->returned.known = 0;
+    ok = ok && execute(in, record[2], &flow);
+    ConstantValue returned = in->returned;
+    in->depth--;
+    in->frame = saved_frame;
+    in->slot_count = base;
+    if (!ok) return 0;
+
+    memset(result, 0, sizeof(*result));
+    if (flow != FLOW_RETURN || !returned.known) return 1;
+    TypeId return_type = record[1];
+    if (return_type == TYPE_UNIT) return 1;
+    return coerce(in, &returned, return_type, result);
+}
+
+static int evaluate_call(Interpreter* in, NodeId id, ConstantValue* result) {
+    const FlatAST* ast = in->ast;
+    TypeId cast = cast_target(ast, id);
+    if (cast != TYPE_NONE) {
+        ConstantValue argument;
+        if (!evaluate(in, flat_record(ast, id)[2], &argument)) return 0;
+        return cast_value(&argument, cast, result) ? 1 : fail(in, INTERPRET_UNSUPPORTED);
+    }
+    // 头文件中声明的外部函数没有函数体
+    NodeId function = flat_binding(ast, id);
+    if (function == NODE_NONE || flat_kind(ast, function) != NODE_FUNCTION || flat_record(ast, function)[2] == NODE_NONE) {
+        return fail(in, INTERPRET_IMPURE);
+    }
+    return call_function(in, id, function, result);
+}
+
+static int evaluate(Interpreter* in, NodeId id, ConstantValue* result) {
+    if (id == NODE_NONE) return fail(in, INTERPRET_UNSUPPORTED);
+    if (!step(in)) return 0;
+    if (in->constants[id].known) {
+        *result = in->constants[id];
+        return 1;
+    }
+    switch (flat_kind(in->ast, id)) {
+        case NODE_LITERAL:
+            memset(result, 0, sizeof(*result));
+            result->literal = *flat_literal(in->ast, id);
+            result->known = 1;
+            return 1;
+        case NODE_VARIABLE:
+            return read_variable(in, id, result);
+        case NODE_BINARY_OP:
+            return evaluate_binary(in, id, result);
+        case NODE_UNARY_OP:
+            return evaluate_unary(in, id, result);
+        case NODE_FUNCTION_CALL:
+            if (!evaluate_call(in, id, result)) return 0;
+            // 不返回值的函数不能用作表达式
+            return result->known ? 1 : fail(in, INTERPRET_UNSUPPORTED);
+        default:
+            return fail(in, INTERPRET_UNSUPPORTED);
+    }
+}
+
+static int condition(Interpreter* in, NodeId id, int* value) {
+    ConstantValue result;
+    if (!evaluate(in, id, &result)) return 0;
+    if (result.literal.type != LITERAL_BOOL) return fail(in, INTERPRET_UNSUPPORTED);
+    *value = result.literal.bool_value;
+    return 1;
+}
+
+// 循环体执行后的控制流：break 结束循环，return 向外传递
+static int leave_loop(Flow* flow) {
+    if (*flow == FLOW_CONTINUE) *flow = FLOW_NORMAL;
+    if (*flow == FLOW_BREAK) {
+        *flow = FLOW_NORMAL;
+        return 1;
+    }
+    return *flow == FLOW_RETURN;
+}
+
+static int execute_while(Interpreter* in, NodeId id, Flow* flow) {
+    const uint32_t* record = flat_record(in->ast, id);
+    for (;;) {
+        int running;
+        if (!condition(in, record[0], &running)) return 0;
+        if (!running) return 1;
+        if (record[1] != NODE_NONE && !execute(in, record[1], flow)) return 0;
+        if (leave_loop(flow)) return 1;
+        if (!step(in)) return 0;
+    }
+}
+
+// 与代码生成一致：.. 与 ..< 为半开区间，..= 为闭区间，上界只求值一次
+static int execute_for(Interpreter* in, NodeId id, Flow* flow) {
+    const FlatAST* ast = in->ast;
+    const uint32_t* record = flat_record(ast, id);
+    NodeId iterable = record[1];
+    if (iterable == NODE_NONE || flat_kind(ast, iterable) != NODE_BINARY_OP) return fail(in, INTERPRET_UNSUPPORTED);
+    const uint32_t* range = flat_record(ast, iterable);
+    OperatorType op = (OperatorType)range[0];
+    if (op != OP_RANGE && op != OP_RANGE_TO && op != OP_RANGE_INCL) return fail(in, INTERPRET_UNSUPPORTED);
+    ConstantValue current, limit;
+    if (!evaluate(in, range[1], &current) || !evaluate(in, range[2], &limit)) return 0;
+    if (current.literal.type != LITERAL_INT && current.literal.type != LITERAL_FLOAT) {
+        return fail(in, INTERPRET_UNSUPPORTED);
+    }
+    ConstantValue one;
+    memset(&one, 0, sizeof(one));
+    one.known = 1;
+    one.literal.type = current.literal.type;
+    if (one.literal.type == LITERAL_FLOAT) one.literal.float_value = 1.0;
+    else one.literal.int_value = 1;
+
+    // 循环变量的类型取两端中标注了类型的一端
+    if (current.type == TYPE_NONE) current.type = limit.type;
+    uint32_t index = in->slot_count;
+    if (!push_slot(in, id, TYPE_NONE, &current)) return 0;
+    OperatorType compare = op == OP_RANGE_INCL ? OP_LTE : OP_LT;
+    for (;;) {
+        ConstantValue running;
+        if (!apply_binary(in, compare, &in->slots[index].value, &limit, &running)) return 0;
+        if (running.literal.type != LITERAL_BOOL) return fail(in, INTERPRET_UNSUPPORTED);
+        if (!running.literal.bool_value) break;
+        if (record[2] != NODE_NONE && !execute(in, record[2], flow)) return 0;
+        in->slot_count = index + 1;
+        if (leave_loop(flow)) break;
+        if (!step(in)) return 0;
+        ConstantValue next;
+        if (!apply_binary(in, OP_ADD, &in->slots[index].value, &one, &next)) return 0;
+        in->slots[index].value = next;
+    }
+    in->slot_count = index;
+    return 1;
+}
+
+static int execute(Interpreter* in, NodeId id, Flow* flow) {
+    const FlatAST* ast = in->ast;
+    if (!step(in)) return 0;
+    ASTNodeType kind = flat_kind(ast, id);
+    // 变量、字面量与 break、continue 没有记录
+    const uint32_t* record = kind != NODE_VARIABLE && kind != NODE_LITERAL && kind != NODE_BREAK &&
+                                     kind != NODE_CONTINUE ? flat_record(ast, id) : NULL;
+    switch (kind) {
+        case NODE_BLOCK: {
+            // 代码块结束时释放其中声明的变量
+            uint32_t mark = in->slot_count;
+            for (uint32_t i = 1; i <= record[0] && *flow == FLOW_NORMAL; i++) {
+                if (!execute(in, record[i], flow)) return 0;
+            }
+            in->slot_count = mark;
+            return 1;
+        }
+        case NODE_VARIABLE_DECL: {
+            ConstantValue value;
+            if (!is_supported_type(record[1])) return fail(in, INTERPRET_UNSUPPORTED);
+            if (record[2] == NODE_NONE) {
+                zero_value(record[1], &value);
+            } else if (!evaluate(in, record[2], &value) || !coerce(in, &value, record[1], &value)) {
+                return 0;
+            }
+            return push_slot(in, id, record[1], &value);
+        }
+        case NODE_IF_STATEMENT: {
+            int taken;
+            if (!condition(in, record[0], &taken)) return 0;
+            NodeId branch = taken ? record[1] : record[2];
+            return branch == NODE_NONE || execute(in, branch, flow);
+        }
+        case NODE_WHILE_STATEMENT:
+            return execute_while(in, id, flow);
+        case NODE_FOR_STATEMENT:
+            return execute_for(in, id, flow);
+        case NODE_RETURN:
+            memset(&in->returned, 0, sizeof(in->returned));
+            if (record[0] != NODE_NONE && !evaluate(in, record[0], &in->returned)) return 0;
+            *flow = FLOW_RETURN;
+            return 1;
+        case NODE_BREAK:
+            *flow = FLOW_BREAK;
+            return 1;
+        case NODE_CONTINUE:
+            *flow = FLOW_CONTINUE;
+            return 1;
+        case NODE_FUNCTION_CALL: {
+            // 语句位置的调用可以不返回值
+            ConstantValue ignored;
+            return in->constants[id].known || evaluate_call(in, id, &ignored);
+        }
+        case NODE_VARIABLE:
+        case NODE_LITERAL:
+        case NODE_BINARY_OP:
+        case NODE_UNARY_OP: {
+            ConstantValue ignored;
+            return evaluate(in, id, &ignored);
+        }
+        default:
+            return fail(in, INTERPRET_UNSUPPORTED);
+    }
+}
+
+void default_interpreter_limits(InterpreterLimits* limits) {
+    limits->max_steps = INTERPRETER_DEFAULT_STEPS;
+    limits->max_memory = INTERPRETER_DEFAULT_MEMORY;
+    limits->max_depth = INTERPRETER_DEFAULT_DEPTH;
+}
+
+Interpreter* create_interpreter(const FlatAST* ast, const ConstantValue* constants, const uint8_t* written,
+                                const InterpreterLimits* limits) {
+    if (!ast || !constants || !written) return NULL;
+    Interpreter* in = (Interpreter*)calloc(1, sizeof(Interpreter));
+    if (!in) return NULL;
+    in->ast = ast;
+    in->constants = constants;
+    in->written = written;
+    if (limits) in->limits = *limits;
+    else default_interpreter_limits(&in->limits);
+    in->globals = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    if (!in->globals) {
+        free(in);
+        return NULL;
+    }
+    const uint32_t* program = flat_record(ast, FLAT_AST_ROOT);
+    for (uint32_t i = 1; i <= program[0]; i++) {
+        if (flat_kind(ast, program[i]) == NODE_VARIABLE_DECL) in->globals[program[i]] = 1;
+    }
+    return in;
+}
+
+void destroy_interpreter(Interpreter* interpreter) {
+    if (!interpreter) return;
+    free(interpreter->globals);
+    free(interpreter->slots);
+    free(interpreter);
+}
+
+InterpretStatus interpret(Interpreter* interpreter, NodeId expression, uint64_t max_steps, ConstantValue* result) {
+    Interpreter* in = interpreter;
+    in->slot_count = 0;
+    in->frame = 0;
+    in->depth = 0;
+    in->steps = max_steps < in->limits.max_steps ? max_steps : in->limits.max_steps;
+    in->budget = in->steps;
+    in->string_bytes = 0;
+    in->status = INTERPRET_OK;
+    if (!evaluate(in, expression, result)) {
+        // 没有记录原因的失败来自不支持的节点
+        return in->status != INTERPRET_OK ? in->status : INTERPRET_UNSUPPORTED;
+    }
+    result->known = 1;
+    return INTERPRET_OK;
+}
+
+uint64_t interpreted_steps(const Interpreter* interpreter) {
+    return interpreter->budget - interpreter->steps;
+}
+
+const char* interpret_status_message(InterpretStatus status) {
+    switch (status) {
+        case INTERPRET_OK:           return "成功";
+        case INTERPRET_PENDING:      return "依赖的顶层常量无法在编译期求值";
+        case INTERPRET_UNSUPPORTED:  return "依赖运行时的值或编译期不支持的运算";
+        case INTERPRET_IMPURE:       return "调用了外部函数或读写了可变的顶层变量";
+        case INTERPRET_STEP_LIMIT:   return "超出编译期求值的步数上限";
+        case INTERPRET_MEMORY_LIMIT: return "超出编译期求值的内存上限";
+        case INTERPRET_DEPTH_LIMIT:  return "超出编译期求值的调用深度上限";
+    }
+    return "未知错误";
+}
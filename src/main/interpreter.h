@@ -0,0 +1,48 @@
+// 编译期解释器头文件
+// 常量折叠用它在编译期执行 const 初始值以及实参都已知的函数调用，结果作为字面量写回AST，
+// 顶层常量因此成为只读数据，程序启动时不再计算。解释器直接遍历扁平AST，在沙箱中运行：
+//   只能调用源文件中有函数体的函数与基本类型的转换，调用外部函数、读写可变的顶层变量即失败；
+//   只支持整数、浮点数、布尔值与字符串，运算规则与常量折叠相同（constant_value.h）；
+//   执行的步数、局部变量与新建字符串占用的内存以及调用深度都有上限，超出即放弃，不影响编译结果。
+
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "constant_value.h"
+
+#define INTERPRETER_DEFAULT_STEPS 1000000
+#define INTERPRETER_DEFAULT_MEMORY (16 * 1024 * 1024)
+#define INTERPRETER_DEFAULT_DEPTH 256
+
+typedef struct {
+    uint64_t max_steps;      // 一次求值最多访问的节点数
+    size_t max_memory;       // 局部变量与新建字符串最多占用的字节数
+    uint32_t max_depth;      // 函数调用的最大嵌套深度
+} InterpreterLimits;
+
+typedef enum {
+    INTERPRET_OK,
+    INTERPRET_PENDING,       // 依赖尚未求出值的顶层常量，常量折叠的下一轮可以重试
+    INTERPRET_UNSUPPORTED,   // 依赖运行时的值，或使用了编译期不求值的运算（如除以零、成员访问）
+    INTERPRET_IMPURE,        // 调用了外部函数，或读写了可变的顶层变量
+    INTERPRET_STEP_LIMIT,
+    INTERPRET_MEMORY_LIMIT,
+    INTERPRET_DEPTH_LIMIT
+} InterpretStatus;
+
+typedef struct Interpreter Interpreter;
+
+// 函数原型
+void default_interpreter_limits(InterpreterLimits* limits);
+// constants 为常量折叠已求出的各节点的值（与调用上下文无关，解释器直接取用），
+// written 标记被赋值过的声明；两者都归调用者所有，解释期间可以继续增加已知的值。内存不足时返回 NULL
+Interpreter* create_interpreter(const FlatAST* ast, const ConstantValue* constants, const uint8_t* written,
+                                const InterpreterLimits* limits);
+void destroy_interpreter(Interpreter* interpreter);
+// 在没有局部变量的上下文中求值表达式，最多执行 max_steps 步（不超过 limits 中的上限）
+InterpretStatus interpret(Interpreter* interpreter, NodeId expression, uint64_t max_steps, ConstantValue* result);
+// 上一次 interpret 实际执行的步数
+uint64_t interpreted_steps(const Interpreter* interpreter);
+const char* interpret_status_message(InterpretStatus status);
+
+#endif // INTERPRETER_H
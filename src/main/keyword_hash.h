@@ -0,0 +1,27 @@
+// 关键字完美哈希所用的哈希函数
+// 构建时的生成器 (src/tools/gen_keywords.c) 与运行时的词法分析器共用这里的定义，
+// 以保证两边计算出的槽位完全一致。
+
+#ifndef KEYWORD_HASH_H
+#define KEYWORD_HASH_H
+
+#include <stdint.h>
+
+// 由长度、首字符、中间字符与末字符组成的32位特征值
+static inline uint32_t keyword_feature(const char* text, int length) {
+    return (uint32_t)length
+         | ((uint32_t)(unsigned char)text[0] << 8)
+         | ((uint32_t)(unsigned char)text[length / 2] << 16)
+         | ((uint32_t)(unsigned char)text[length - 1] << 24);
+}
+
+// 带种子的整数混合函数
+static inline uint32_t keyword_mix(uint32_t feature, uint32_t seed) {
+    uint32_t h = (feature ^ (seed * 0x85EBCA6Bu)) * 0x9E3779B1u;
+    h ^= h >> 15;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 13;
+    return h;
+}
+
+#endif // KEYWORD_HASH_H
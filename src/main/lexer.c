@@ -1,447 +1,600 @@
 #include "lexer.h"
+#include "keyword_table.h"
+#include "simd_scan.h"
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <stdio.h>
 
-// 定义词法分析器结构
-struct Lexer {
-    char* source;          // 源代码
-    int position;          // 当前位置
-    int line;              // 当前行号
-    int column;            // 当前列号
-    char current_char;     // 当前字符
-    Token current_token;   // 当前标记
-    char* error_message;   // 错误信息
-};
+// 初始化两种模式共用的字段
+static void init_lexer(Lexer* lexer) {
+    lexer->position = 0;
+    lexer->lines = NULL;
+    lexer->error = LEXER_ERROR_NONE;
+    lexer->error_message = NULL;
+    lexer->scan = select_scan_ops();
+    lexer->token_start = -1;
+    lexer->intern_identifiers = 1;
+    lexer->newline_seen = 0;
+    lexer->error_seen = 0;
+    
+    lexer->stream = NULL;
+    lexer->window = NULL;
+    lexer->window_size = 0;
+    lexer->base = 0;
+    lexer->stream_eof = 1;
+    lexer->base_lines = 0;
+    lexer->base_line_start = 0;
+    lexer->scratch = NULL;
+    lexer->scratch_length = 0;
+    lexer->scratch_capacity = 0;
+    lexer->keep_input = 0;
+    lexer->input = NULL;
+    lexer->input_length = 0;
+    lexer->input_capacity = 0;
+    
+    // 初始化当前标记
+    lexer->current_token.type = TOKEN_UNKNOWN;
+    lexer->current_token.offset = 0;
+    lexer->current_token.length = 0;
+    lexer->current_token.symbol = SYMBOL_NONE;
+    lexer->current_token.flags = 0;
+}
 
 // 创建词法分析器
-Lexer* create_lexer(const char* source) {
+// 词法分析器只借用 [source, source + length) 这段内存，调用方需保证其生命周期覆盖词法分析器
+Lexer* create_lexer(const char* source, int length) {
     Lexer* lexer = (Lexer*)malloc(sizeof(Lexer));
     if (lexer) {
-        lexer->source = strdup(source);
-        lexer->position = 0;
-        lexer->line = 1;
-        lexer->column = 1;
-        lexer->current_char = lexer->source[0];
-        lexer->error_message = NULL;
-        
-        // 初始化当前标记
-        lexer->current_token.type = TOKEN_UNKNOWN;
-        lexer->current_token.value = NULL;
-        lexer->current_token.line = 1;
-        lexer->current_token.column = 1;
+        init_lexer(lexer);
+        lexer->source = source;
+        lexer->length = length;
+        lexer->current_char = length > 0 ? source[0] : '\0';
     }
     return lexer;
 }
 
-// 前进到下一个字符
-static void advance(Lexer* lexer) {
-    if (lexer->current_char == '\n') {
-        lexer->line++;
-        lexer->column = 1;
-    } else {
-        lexer->column++;
+static int refill(Lexer* lexer);
+
+// 把非流式词法分析器移动到 offset 处，从那里继续切分标记
+void seek_lexer(Lexer* lexer, int offset) {
+    if (lexer->stream) return;
+    lexer->position = offset < lexer->length ? offset : lexer->length;
+    lexer->current_char = lexer->position < lexer->length ? lexer->source[lexer->position] : '\0';
+}
+
+// 创建流式词法分析器
+// 输入通过固定大小的窗口分批读入，内存占用与输入总大小无关
+Lexer* create_stream_lexer(FILE* stream, int window_size) {
+    Lexer* lexer = (Lexer*)malloc(sizeof(Lexer));
+    if (!lexer) return NULL;
+    
+    init_lexer(lexer);
+    // 窗口至少要容纳最长的运算符前瞻
+    lexer->window_size = window_size >= 16 ? window_size : LEXER_DEFAULT_WINDOW_SIZE;
+    lexer->window = (char*)malloc(lexer->window_size);
+    if (!lexer->window) {
+        free(lexer);
+        return NULL;
     }
+    lexer->stream = stream;
+    lexer->stream_eof = 0;
+    lexer->source = lexer->window;
+    lexer->length = 0;
+    lexer->current_char = '\0';
+    refill(lexer);
+    return lexer;
+}
 
+// 前进到下一个字符（行列号不再随之维护，需要时由行起始偏移表计算）
+static void advance(Lexer* lexer) {
     lexer->position++;
-    if (lexer->position < (int)strlen(lexer->source)) { // 强制转换 strlen 返回值为 int
+    if (lexer->position < lexer->length) {
         lexer->current_char = lexer->source[lexer->position];
     } else {
         lexer->current_char = '\0'; // EOF
     }
 }
 
+// 一次前进 count 个字符
+static void advance_by(Lexer* lexer, int count) {
+    lexer->position += count;
+    lexer->current_char = lexer->position < lexer->length ? lexer->source[lexer->position] : '\0';
+}
+
+// 剩余未扫描的字节数
+static size_t remaining(Lexer* lexer) {
+    return (size_t)(lexer->length - lexer->position);
+}
+
+// 把一段文本追加到跨窗口标记的拼接缓冲区
+static int append_scratch(Lexer* lexer, const char* text, int length) {
+    if (lexer->scratch_length + length > lexer->scratch_capacity) {
+        int capacity = lexer->scratch_capacity ? lexer->scratch_capacity : 256;
+        while (capacity < lexer->scratch_length + length) capacity *= 2;
+        char* scratch = (char*)realloc(lexer->scratch, capacity);
+        if (!scratch) {
+            lexer->error = LEXER_ERROR_MEMORY;
+            return 0;
+        }
+        lexer->scratch = scratch;
+        lexer->scratch_capacity = capacity;
+    }
+    memcpy(lexer->scratch + lexer->scratch_length, text, length);
+    lexer->scratch_length += length;
+    return 1;
+}
+
+// 另存即将滑出窗口的字节，内存不足时放弃另存
+static void save_input(Lexer* lexer, const char* bytes, int length) {
+    if (lexer->input_length < 0) return;
+    if (lexer->input_length + length > lexer->input_capacity || !lexer->input) {
+        int capacity = lexer->input_capacity ? lexer->input_capacity : lexer->window_size;
+        while (capacity < lexer->input_length + length) capacity *= 2;
+        char* input = (char*)realloc(lexer->input, capacity);
+        if (!input) {
+            free(lexer->input);
+            lexer->input = NULL;
+            lexer->input_length = -1;
+            return;
+        }
+        lexer->input = input;
+        lexer->input_capacity = capacity;
+    }
+    memcpy(lexer->input + lexer->input_length, bytes, length);
+    lexer->input_length += length;
+}
+
+// 补充输入（仅流式模式）：丢弃当前位置之前的内容，把剩余字节移到窗口开头后继续读取。
+// 正在读取的标记若会被丢弃，先把已读部分转存到拼接缓冲区。返回是否读到了新内容。
+static int refill(Lexer* lexer) {
+    if (!lexer->stream || lexer->stream_eof) return 0;
+    
+    int keep_from = lexer->position;
+    if (lexer->token_start >= 0) {
+        append_scratch(lexer, lexer->source + lexer->token_start, keep_from - lexer->token_start);
+        lexer->token_start = 0;
+    }
+    
+    // 记录被丢弃部分中的换行信息，供 get_position 使用
+    size_t last_newline = 0;
+    size_t newlines = lexer->scan->count_newlines(lexer->window, (size_t)keep_from, &last_newline);
+    if (newlines) {
+        lexer->base_lines += (int)newlines;
+        lexer->base_line_start = lexer->base + (int)last_newline + 1;
+    }
+    
+    int kept = lexer->length - keep_from;
+    if (kept == lexer->window_size) return 0;
+    if (lexer->keep_input) {
+        save_input(lexer, lexer->window, keep_from);
+    }
+    memmove(lexer->window, lexer->window + keep_from, kept);
+    lexer->base += keep_from;
+    lexer->position = 0;
+    lexer->length = kept;
+    
+    size_t read_size = fread(lexer->window + kept, 1, lexer->window_size - kept, lexer->stream);
+    if (read_size == 0) {
+        lexer->stream_eof = 1;
+    }
+    lexer->length += (int)read_size;
+    lexer->current_char = lexer->length > 0 ? lexer->source[0] : '\0';
+    return read_size > 0;
+}
+
+// 确保从当前位置起至少有 count 个字节可读（输入不足时尽量补充）
+static void ensure_lookahead(Lexer* lexer, int count) {
+    while (lexer->length - lexer->position < count && refill(lexer)) {
+    }
+}
+
 // 查看下一个字符
 static char peek(Lexer* lexer) {
-    if (lexer->position + 1 < (int)strlen(lexer->source)) {
+    ensure_lookahead(lexer, 2);
+    if (lexer->position + 1 < lexer->length) {
         return lexer->source[lexer->position + 1];
     }
     return '\0';  // 如果已经到达末尾，返回 EOF
 }
 
-// 跳过空白字符
-static void skip_whitespace(Lexer* lexer) {
-    while (lexer->current_char != '\0' && isspace(lexer->current_char)) {
-        advance(lexer);
+// 开始读取一个需要保留文本的标记
+static void begin_token(Lexer* lexer) {
+    lexer->token_start = lexer->position;
+    lexer->scratch_length = 0;
+}
+
+// 结束当前标记，返回其完整文本：未跨越窗口时直接指向源代码，否则指向拼接缓冲区。
+// 返回的指针在读取下一个标记之前有效
+static const char* finish_token(Lexer* lexer, int* length) {
+    const char* text = lexer->source + lexer->token_start;
+    *length = lexer->position - lexer->token_start;
+    if (lexer->scratch_length > 0) {
+        append_scratch(lexer, text, *length);
+        text = lexer->scratch;
+        *length = lexer->scratch_length;
+    }
+    lexer->token_start = -1;
+    return text;
+}
+
+// 当前标记的起点在整个输入中的偏移
+static int token_offset(Lexer* lexer) {
+    return lexer->base + lexer->position;
+}
+
+// 记录词法错误并标记当前标记，只保留第一个错误的信息。位置由 offset 换算，
+// 已知行列号时（line > 0）直接使用：流式模式下 offset 可能已滑出窗口
+static void lexer_error(Lexer* lexer, LexerErrorType type, int offset, int line, int column, const char* message) {
+    lexer->error_seen = 1;
+    if (lexer->error_message) {
+        return;
+    }
+    if (line <= 0) {
+        get_offset_position(lexer, offset, &line, &column);
     }
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%d:%d: %s", line, column, message);
+    lexer->error = type;
+    lexer->error_message = strdup(buffer);
+}
+
+// 在构建时生成的最小完美哈希表中查找关键字，未命中时返回 TOKEN_IDENTIFIER
+static TokenType lookup_keyword(const char* text, int length) {
+    if (length < KEYWORD_MIN_LENGTH || length > KEYWORD_MAX_LENGTH) {
+        return TOKEN_IDENTIFIER;
+    }
+    const KeywordEntry* entry = &keyword_table[keyword_slot(text, length)];
+    if (entry->length == length && memcmp(entry->text, text, length) == 0) {
+        return entry->type;
+    }
+    return TOKEN_IDENTIFIER;
+}
+
+// 跳过空白字符，并记录其中是否有换行（语法分析器据此判断表达式能否跨行延续）
+static void skip_whitespace(Lexer* lexer) {
+    do {
+        size_t span = lexer->scan->span_whitespace(lexer->source + lexer->position, remaining(lexer));
+        if (span > 0 && !lexer->newline_seen && memchr(lexer->source + lexer->position, '\n', span)) {
+            lexer->newline_seen = 1;
+        }
+        advance_by(lexer, (int)span);
+    } while (lexer->position == lexer->length && refill(lexer));
 }
 
 // 跳过注释
 static void skip_comment(Lexer* lexer) {
-    // 单行注释
-    if (lexer->current_char == '/' && lexer->source[lexer->position + 1] == '/') {
-        while (lexer->current_char != '\0' && lexer->current_char != '\n') {
-            advance(lexer);
-        }
+    // 单行注释：直接定位到行尾
+    if (lexer->current_char == '/' && peek(lexer) == '/') {
+        do {
+            advance_by(lexer, (int)lexer->scan->find_newline(lexer->source + lexer->position, remaining(lexer)));
+        } while (lexer->position == lexer->length && refill(lexer));
     }
     // 多行注释
-    else if (lexer->current_char == '/' && lexer->source[lexer->position + 1] == '*') {
+    else if (lexer->current_char == '/' && peek(lexer) == '*') {
+        int start = token_offset(lexer);
+        int line = 0;
+        int column = 0;
         advance(lexer); // 跳过 '/'
         advance(lexer); // 跳过 '*'
         
-        while (lexer->current_char != '\0') {
-            if (lexer->current_char == '*' && lexer->source[lexer->position + 1] == '/') {
-                advance(lexer); // 跳过 '*'
-                advance(lexer); // 跳过 '/'
+        for (;;) {
+            size_t available = remaining(lexer);
+            size_t end = lexer->scan->find_comment_end(lexer->source + lexer->position, available);
+            if (end < available) {
+                advance_by(lexer, (int)end + 2); // 跳过 "*/"
+                break;
+            }
+            // 流式模式下注释的起点即将滑出窗口，先换算出它的行列号以备报告未闭合
+            if (lexer->stream && line == 0) {
+                get_offset_position(lexer, start, &line, &column);
+            }
+            // 窗口内没有找到结束标记：保留最后一个字节（可能是 '*'）后继续读取
+            if (available > 0) {
+                advance_by(lexer, (int)available - 1);
+            }
+            if (!refill(lexer)) {
+                advance_by(lexer, (int)remaining(lexer));
+                lexer_error(lexer, LEXER_ERROR_UNTERMINATED_COMMENT, start, line, column, "未闭合的块注释");
                 break;
             }
-            advance(lexer);
         }
     }
 }
 
 // 读取标识符或关键字
 static Token read_identifier(Lexer* lexer) {
-    int start_position = lexer->position;
-    int start_line = lexer->line;
-    int start_column = lexer->column;
+    Token token;
+    token.offset = token_offset(lexer);
     
-    while (lexer->current_char != '\0' && (isalnum(lexer->current_char) || lexer->current_char == '_')) {
-        advance(lexer);
-    }
+    begin_token(lexer);
+    do {
+        advance_by(lexer, (int)lexer->scan->span_identifier(lexer->source + lexer->position, remaining(lexer)));
+    } while (lexer->position == lexer->length && refill(lexer));
     
-    int length = lexer->position - start_position;
-    char* value = (char*)malloc(length + 1);
-    strncpy(value, lexer->source + start_position, length);
-    value[length] = '\0';
-    
-    // 检查是否为关键字
-    TokenType type = TOKEN_IDENTIFIER;
-    if (strcmp(value, "fun") == 0) {
-        type = TOKEN_KEYWORD_FUN;
-    } else if (strcmp(value, "if") == 0) {
-        type = TOKEN_KEYWORD_IF;
-    } else if (strcmp(value, "else") == 0) {
-        type = TOKEN_KEYWORD_ELSE;
-    } else if (strcmp(value, "while") == 0) {
-        type = TOKEN_KEYWORD_WHILE;
-    } else if (strcmp(value, "return") == 0) {
-        type = TOKEN_KEYWORD_RETURN;
-    } else if (strcmp(value, "include") == 0) {
-        type = TOKEN_KEYWORD_INCLUDE;
-    } else if (strcmp(value, "enum") == 0) {
-        type = TOKEN_KEYWORD_ENUM;
-    }
-    
-    // 检查是否为类型
-    else if (strcmp(value, "int") == 0) {
-        type = TOKEN_TYPE_INT;
-    } else if (strcmp(value, "str") == 0) {
-        type = TOKEN_TYPE_STR;
-    } else if (strcmp(value, "bool") == 0) {
-        type = TOKEN_TYPE_BOOL;
-    } else if (strcmp(value, "i8") == 0) {
-        type = TOKEN_TYPE_I8;
-    } else if (strcmp(value, "i16") == 0) {
-        type = TOKEN_TYPE_I16;
-    } else if (strcmp(value, "i32") == 0) {
-        type = TOKEN_TYPE_I32;
-    } else if (strcmp(value, "i64") == 0) {
-        type = TOKEN_TYPE_I64;
-    } else if (strcmp(value, "u8") == 0) {
-        type = TOKEN_TYPE_U8;
-    } else if (strcmp(value, "u16") == 0) {
-        type = TOKEN_TYPE_U16;
-    } else if (strcmp(value, "u32") == 0) {
-        type = TOKEN_TYPE_U32;
-    } else if (strcmp(value, "u64") == 0) {
-        type = TOKEN_TYPE_U64;
-    }
+    int length;
+    const char* text = finish_token(lexer, &length);
     
-    Token token;
-    token.type = type;
-    token.value = value;
-    token.line = start_line;
-    token.column = start_column;
+    // 检查是否为关键字或类型名：一次哈希探测加一次 memcmp
+    token.type = lookup_keyword(text, length);
+    token.length = length;
+    // 普通标识符在词法分析阶段即驻留为符号
+    token.symbol = token.type == TOKEN_IDENTIFIER && lexer->intern_identifiers ? intern(text, length) : SYMBOL_NONE;
     
     return token;
 }
 
+// 跳过连续的数字
+static void skip_digits(Lexer* lexer) {
+    do {
+        while (lexer->position < lexer->length && isdigit((unsigned char)lexer->current_char)) {
+            advance(lexer);
+        }
+    } while (lexer->position == lexer->length && refill(lexer));
+}
+
 // 读取数字
 static Token read_number(Lexer* lexer) {
-    int start_position = lexer->position;
-    int start_line = lexer->line;
-    int start_column = lexer->column;
+    Token token;
+    token.offset = token_offset(lexer);
     
-    while (lexer->current_char != '\0' && isdigit(lexer->current_char)) {
-        advance(lexer);
-    }
+    begin_token(lexer);
+    skip_digits(lexer);
     
-    // 处理小数点
-    if (lexer->current_char == '.') {
+    // 处理小数点（"1..10" 中的点属于区间运算符）
+    if (lexer->current_char == '.' && peek(lexer) != '.') {
         advance(lexer);
-        while (lexer->current_char != '\0' && isdigit(lexer->current_char)) {
-            advance(lexer);
-        }
+        skip_digits(lexer);
     }
     
-    int length = lexer->position - start_position;
-    char* value = (char*)malloc(length + 1);
-    strncpy(value, lexer->source + start_position, length);
-    value[length] = '\0';
+    int length;
+    const char* text = finish_token(lexer, &length);
     
-    Token token;
     token.type = TOKEN_NUMBER;
-    token.value = value;
-    token.line = start_line;
-    token.column = start_column;
+    token.length = length;
+    // 流式模式下窗口会被复用，字面量文本需驻留
+    token.symbol = lexer->stream ? intern(text, length) : SYMBOL_NONE;
     
     return token;
 }
 
 // 读取字符串
 static Token read_string(Lexer* lexer) {
-    int start_line = lexer->line;
-    int start_column = lexer->column;
     
     advance(lexer); // 跳过开始的引号
+    ensure_lookahead(lexer, 1);
     
-    int start_position = lexer->position;
-    while (lexer->current_char != '\0' && lexer->current_char != '"') {
+    Token token;
+    token.offset = token_offset(lexer);
+    
+    int line = 0;
+    int column = 0;
+    begin_token(lexer);
+    for (;;) {
+        // 成批跳过普通字符，停在引号、反斜杠或末尾
+        advance_by(lexer, (int)lexer->scan->find_string_special(lexer->source + lexer->position, remaining(lexer)));
+        if (lexer->position == lexer->length) {
+            // 流式模式下起始引号可能随补充输入滑出窗口，先记下它的行列号
+            if (lexer->stream && line == 0) {
+                get_offset_position(lexer, token.offset - 1, &line, &column);
+            }
+            if (refill(lexer)) continue;
+            break;
+        }
+        if (lexer->current_char != '\\') break;
         // 处理转义字符
-        if (lexer->current_char == '\\') {
+        advance(lexer);
+        if (lexer->position == lexer->length) {
+            refill(lexer);
+        }
+        if (lexer->position < lexer->length) {
             advance(lexer);
         }
-        advance(lexer);
     }
     
-    int length = lexer->position - start_position;
-    char* value = (char*)malloc(length + 1);
-    strncpy(value, lexer->source + start_position, length);
-    value[length] = '\0';
+    int length;
+    const char* text = finish_token(lexer, &length);
+    
+    token.type = TOKEN_STRING;
+    token.length = length;
+    token.symbol = lexer->stream ? intern(text, length) : SYMBOL_NONE;
+    
+    // 字符串的值以 '\0' 结尾，内容中的 '\0' 字节会截断它
+    const char* nul = (const char*)memchr(text, '\0', (size_t)length);
+    if (nul) {
+        lexer_error(lexer, LEXER_ERROR_INVALID_CHAR, token.offset + (int)(nul - text), 0, 0, "未知字符: 0x00");
+    }
     
     if (lexer->current_char == '"') {
         advance(lexer); // 跳过结束的引号
     } else {
-        // 错误：未闭合的字符串
-        if (lexer->error_message) {
-            free(lexer->error_message);
-        }
-        lexer->error_message = strdup("未闭合的字符串");
+        lexer_error(lexer, LEXER_ERROR_UNTERMINATED_STRING, token.offset - 1, line, column, "未闭合的字符串");
     }
     
-    Token token;
-    token.type = TOKEN_STRING;
-    token.value = value;
-    token.line = start_line;
-    token.column = start_column;
-    
     return token;
 }
 
-// 获取下一个标记
-Token get_next_token(Lexer* lexer) {
-    // 释放之前的标记值
-    if (lexer->current_token.value) {
-        free(lexer->current_token.value);
-        lexer->current_token.value = NULL;
+// 若当前字符为 c 则消费它并返回 1
+static int accept(Lexer* lexer, char c) {
+    if (lexer->current_char == c) {
+        advance(lexer);
+        return 1;
     }
+    return 0;
+}
+
+// 读取运算符或标点符号（最多3个字符，调用前已保证前瞻足够）
+static TokenType read_operator(Lexer* lexer) {
+    char current = lexer->current_char;
+    advance(lexer);
     
+    switch (current) {
+        case '+':
+            if (accept(lexer, '+')) return TOKEN_INCREMENT;
+            if (accept(lexer, '=')) return TOKEN_PLUS_ASSIGN;
+            return TOKEN_PLUS;
+        case '-':
+            if (accept(lexer, '-')) return TOKEN_DECREMENT;
+            if (accept(lexer, '=')) return TOKEN_MINUS_ASSIGN;
+            if (accept(lexer, '>')) return TOKEN_ARROW;
+            return TOKEN_MINUS;
+        case '*':
+            if (accept(lexer, '=')) return TOKEN_MULTIPLY_ASSIGN;
+            return TOKEN_MULTIPLY;
+        case '/':
+            if (accept(lexer, '=')) return TOKEN_DIVIDE_ASSIGN;
+            return TOKEN_DIVIDE;
+        case '%':
+            if (accept(lexer, '=')) return TOKEN_MOD_ASSIGN;
+            return TOKEN_MOD;
+        case '=':
+            if (accept(lexer, '=')) return TOKEN_EQUAL;
+            if (accept(lexer, '>')) return TOKEN_ARROW_MATCH;
+            return TOKEN_ASSIGN;
+        case '!':
+            if (accept(lexer, '=')) return TOKEN_NOT_EQUAL;
+            if (accept(lexer, '!')) return TOKEN_NOTNULL;
+            return TOKEN_NOT;
+        case '<':
+            if (accept(lexer, '<')) {
+                if (accept(lexer, '=')) return TOKEN_SHIFT_LEFT_ASSIGN;
+                return TOKEN_SHIFT_LEFT;
+            }
+            if (accept(lexer, '=')) return TOKEN_LESS_EQUAL;
+            return TOKEN_LESS;
+        case '>':
+            if (accept(lexer, '>')) {
+                if (accept(lexer, '=')) return TOKEN_SHIFT_RIGHT_ASSIGN;
+                return TOKEN_SHIFT_RIGHT;
+            }
+            if (accept(lexer, '=')) return TOKEN_GREATER_EQUAL;
+            return TOKEN_GREATER;
+        case '&':
+            if (accept(lexer, '&')) return TOKEN_AND;
+            if (accept(lexer, '=')) return TOKEN_AND_ASSIGN;
+            return TOKEN_BIT_AND;
+        case '|':
+            if (accept(lexer, '|')) return TOKEN_OR;
+            if (accept(lexer, '=')) return TOKEN_OR_ASSIGN;
+            return TOKEN_BIT_OR;
+        case '^':
+            if (accept(lexer, '=')) return TOKEN_XOR_ASSIGN;
+            return TOKEN_BIT_XOR;
+        case '~':
+            return TOKEN_BIT_NOT;
+        case '?':
+            if (accept(lexer, '.')) return TOKEN_SAFE_ACCESS;
+            if (accept(lexer, ':')) return TOKEN_ELVIS;
+            return TOKEN_TYPE_NULLABLE;
+        case '.':
+            // 区间运算符 ..  ..<  ..=
+            if (accept(lexer, '.')) {
+                if (accept(lexer, '<')) return TOKEN_RANGE_TO;
+                if (accept(lexer, '=')) return TOKEN_RANGE_INCL;
+                return TOKEN_RANGE;
+            }
+            return TOKEN_DOT;
+        case ':':
+            if (accept(lexer, ':')) return TOKEN_DOUBLE_COLON;
+            return TOKEN_COLON;
+        case '(': return TOKEN_LPAREN;
+        case ')': return TOKEN_RPAREN;
+        case '{': return TOKEN_LBRACE;
+        case '}': return TOKEN_RBRACE;
+        case '[': return TOKEN_LBRACKET;
+        case ']': return TOKEN_RBRACKET;
+        case ',': return TOKEN_COMMA;
+        case ';': return TOKEN_SEMICOLON;
+        case '#': return TOKEN_HASH;
+        case '@': return TOKEN_AT;
+        case '$': return TOKEN_DOLLAR;
+        default: {
+            // 不可打印的字节按十六进制显示
+            char error[64];
+            unsigned char byte = (unsigned char)current;
+            if (byte < 0x20 || byte >= 0x7F) {
+                snprintf(error, sizeof(error), "未知字符: 0x%02X", byte);
+            } else {
+                snprintf(error, sizeof(error), "未知字符: '%c'", current);
+            }
+            lexer_error(lexer, LEXER_ERROR_INVALID_CHAR, token_offset(lexer) - 1, 0, 0, error);
+            return TOKEN_UNKNOWN;
+        }
+    }
+}
+
+// 跳过空白与注释后切分一个标记
+static Token scan_token(Lexer* lexer) {
     // 跳过空白字符和注释
     skip_whitespace(lexer);
-    if (lexer->current_char == '/' && (lexer->source[lexer->position + 1] == '/' || 
-                                      lexer->source[lexer->position + 1] == '*')) {
+    while (lexer->current_char == '/' && (peek(lexer) == '/' || peek(lexer) == '*')) {
         skip_comment(lexer);
         skip_whitespace(lexer);
     }
     
-    // 检查EOF
-    if (lexer->current_char == '\0') {
-        Token token;
+    // 保证最长的运算符（3个字符）不会跨越窗口边界
+    ensure_lookahead(lexer, 4);
+    
+    Token token;
+    token.symbol = SYMBOL_NONE;
+    
+    // 检查EOF：只看位置，源代码中的 '\0' 字节按未知字符报告
+    if (lexer->position >= lexer->length) {
         token.type = TOKEN_EOF;
-        token.value = NULL;
-        token.line = lexer->line;
-        token.column = lexer->column;
+        token.offset = token_offset(lexer);
+        token.length = 0;
         return token;
     }
     
     // 识别标记
-    Token token;
-    if (isalpha(lexer->current_char) || lexer->current_char == '_') {
-        // 标识符或关键字
-        token = read_identifier(lexer);
-    } else if (isdigit(lexer->current_char)) {
+    if (isalpha((unsigned char)lexer->current_char) || lexer->current_char == '_') {
+        // 标识符或关键字（单独的 '_' 也按标识符处理）
+        return read_identifier(lexer);
+    }
+    if (isdigit((unsigned char)lexer->current_char)) {
         // 数字
-        token = read_number(lexer);
-    } else if (lexer->current_char == '"') {
+        return read_number(lexer);
+    }
+    if (lexer->current_char == '"') {
         // 字符串
-        token = read_string(lexer);
-    } else {
-        // 运算符和标点符号
-        int start_line = lexer->line;
-        int start_column = lexer->column;
-        char current = lexer->current_char;
-        
-        switch (current) {
-            case '+':
-                advance(lexer);
-                if (lexer->current_char == '+') {
-                    advance(lexer);
-                    token.type = TOKEN_INCREMENT;
-                } else if (lexer->current_char == '=') {
-                    advance(lexer);
-                    token.type = TOKEN_PLUS_ASSIGN;
-                } else {
-                    token.type = TOKEN_PLUS;
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '-':
-                advance(lexer);
-                if (lexer->current_char == '-') {
-                    advance(lexer);
-                    token.type = TOKEN_DECREMENT;
-                } 
-                // 处理其他-开头的标记...
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '*':
-                token.type = TOKEN_MULTIPLY;
-                break;
-            case '/':
-                token.type = TOKEN_DIVIDE;
-                break;
-            case '=':
-                advance(lexer);
-                if (lexer->current_char == '=') {
-                    token.type = TOKEN_EQUAL;
-                    advance(lexer);
-                } else {
-                    token.type = TOKEN_ASSIGN;
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '!':
-                advance(lexer);
-                if (lexer->current_char == '=') {
-                    token.type = TOKEN_NOT_EQUAL;
-                    advance(lexer);
-                } else {
-                    token.type = TOKEN_NOT;
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '<':
-                advance(lexer);
-                if (lexer->current_char == '<') {
-                    advance(lexer);
-                    if (lexer->current_char == '=') {
-                        advance(lexer);
-                        token.type = TOKEN_SHIFT_LEFT_ASSIGN;
-                    }
-                    token.type = TOKEN_SHIFT_LEFT;
-                } else {
-                    token.type = TOKEN_LESS;
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '>':
-                advance(lexer);
-                if (lexer->current_char == '=') {
-                    token.type = TOKEN_GREATER_EQUAL;
-                    advance(lexer);
-                } else {
-                    token.type = TOKEN_GREATER;
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            case '(':
-                token.type = TOKEN_LPAREN;
-                break;
-            case ')':
-                token.type = TOKEN_RPAREN;
-                break;
-            case '{':
-                token.type = TOKEN_LBRACE;
-                break;
-            case '}':
-                token.type = TOKEN_RBRACE;
-                break;
-            case '[':
-                token.type = TOKEN_LBRACKET;
-                break;
-            case ']':
-                token.type = TOKEN_RBRACKET;
-                break;
-            case ',':
-                token.type = TOKEN_COMMA;
-                break;
-            case '.':
-                token.type = TOKEN_DOT;
-                break;
-            case ';':
-                token.type = TOKEN_SEMICOLON;
-                break;
-            case ':':
-                token.type = TOKEN_COLON;
-                break;
-            case '#':
-                token.type = TOKEN_HASH;
-                break;
-            case '"':
-                token.type = TOKEN_QUOTE;
-                break;
-            case '@':
-                token.type = TOKEN_AT;
-                break;
-            case '$':
-                token.type = TOKEN_DOLLAR;
-                break;
-            case '_':
-                // 判断是否单独的下划线或标识符的一部分
-                if (!isalpha(peek(lexer)) && !isdigit(peek(lexer)) && peek(lexer) != '_') {
-                    token.type = TOKEN_UNDERSCORE;
-                } else {
-                    // 作为标识符的一部分处理
-                    token = read_identifier(lexer);
-                }
-                token.line = start_line;
-                token.column = start_column;
-                token.value = NULL;
-                return token;
-            default:
-                token.type = TOKEN_UNKNOWN;
-                if (lexer->error_message) {
-                    free(lexer->error_message);
-                }
-                char error[100];
-                sprintf(error, "未知字符: '%c'", current);
-                lexer->error_message = strdup(error);
-                break;
-        }
-        
-        advance(lexer);
-        token.line = start_line;
-        token.column = start_column;
-        token.value = NULL;
+        return read_string(lexer);
     }
     
+    // 运算符和标点符号
+    int start_position = lexer->position;
+    token.type = read_operator(lexer);
+    token.offset = lexer->base + start_position;
+    token.length = lexer->position - start_position;
+    return token;
+}
+
+// 获取下一个标记
+Token get_next_token(Lexer* lexer) {
+    lexer->newline_seen = 0;
+    lexer->error_seen = 0;
+    Token token = scan_token(lexer);
+    token.flags = (lexer->newline_seen ? TOKEN_FLAG_NEWLINE_BEFORE : 0) | (lexer->error_seen ? TOKEN_FLAG_ERROR : 0);
     lexer->current_token = token;
     return token;
 }
 
+// 关键字或类型名的文本（流式模式下关键字标记没有可引用的源代码）
+const char* keyword_text(TokenType type) {
+    for (int i = 0; i < KEYWORD_COUNT; i++) {
+        if (keyword_table[i].type == type) {
+            return keyword_table[i].text;
+        }
+    }
+    return NULL;
+}
+
 // 销毁词法分析器
 void destroy_lexer(Lexer* lexer) {
     if (lexer) {
-        if (lexer->source) {
-            free(lexer->source);
-        }
-        if (lexer->current_token.value) {
-            free(lexer->current_token.value);
-        }
+        destroy_line_table(lexer->lines);
+        free(lexer->window);
+        free(lexer->scratch);
+        free(lexer->input);
         if (lexer->error_message) {
             free(lexer->error_message);
         }
@@ -449,6 +602,84 @@ void destroy_lexer(Lexer* lexer) {
     }
 }
 
+// 已滑出窗口的字节加上窗口中的全部内容即为至今读入的输入
+char* take_lexer_input(Lexer* lexer, int* length) {
+    *length = 0;
+    if (!lexer || !lexer->stream || !lexer->keep_input) return NULL;
+    save_input(lexer, lexer->window, lexer->length);
+    lexer->keep_input = 0;
+    lexer->length = 0;
+    lexer->position = 0;
+    lexer->stream_eof = 1;
+    if (lexer->input_length < 0) return NULL;
+    char* input = lexer->input;
+    *length = lexer->input_length;
+    lexer->input = NULL;
+    lexer->input_length = 0;
+    lexer->input_capacity = 0;
+    return input;
+}
+
+// 一次性将整个源代码切分为连续的标记数组
+TokenArray* tokenize(Lexer* lexer) {
+    TokenArray* array = (TokenArray*)malloc(sizeof(TokenArray));
+    if (!array) return NULL;
+    
+    // 按平均每4个字节一个标记预估容量，减少扩容次数
+    array->capacity = lexer->length / 4 + 16;
+    array->tokens = (Token*)malloc(sizeof(Token) * array->capacity);
+    array->count = 0;
+    array->source = lexer->source;
+    array->gap_size = 0;
+    array->gap_delta = 0;
+    array->error_message = NULL;
+    if (!array->tokens) {
+        free(array);
+        return NULL;
+    }
+    
+    for (;;) {
+        Token token = get_next_token(lexer);
+        if (array->count == array->capacity) {
+            int new_capacity = array->capacity * 2;
+            Token* tokens = (Token*)realloc(array->tokens, sizeof(Token) * new_capacity);
+            if (!tokens) {
+                destroy_token_array(array);
+                return NULL;
+            }
+            array->tokens = tokens;
+            array->capacity = new_capacity;
+        }
+        array->tokens[array->count++] = token;
+        if (token.type == TOKEN_EOF) break;
+    }
+    array->gap_start = array->count;
+    if (lexer->error_message) {
+        array->error_message = strdup(lexer->error_message);
+    }
+    
+    return array;
+}
+
+// 按顺序驻留尚未驻留的标识符
+void intern_token_identifiers(TokenArray* array) {
+    for (int i = 0; i < array->count; i++) {
+        Token* token = &array->tokens[i];
+        if (token->type == TOKEN_IDENTIFIER && token->symbol == SYMBOL_NONE) {
+            token->symbol = intern(array->source + token->offset, token->length);
+        }
+    }
+}
+
+// 销毁标记数组（不释放其引用的源代码）
+void destroy_token_array(TokenArray* array) {
+    if (array) {
+        free(array->tokens);
+        free(array->error_message);
+        free(array);
+    }
+}
+
 // 添加错误处理和位置跟踪
 void handle_error(Lexer* lexer, const char* message) {
     if (lexer->error_message) {
@@ -457,10 +688,35 @@ void handle_error(Lexer* lexer, const char* message) {
     lexer->error_message = strdup(message);
 }
 
-// 获取当前位置
+// 获取输入中某个偏移的行列号（首次调用时才构建行起始偏移表）
+// 流式模式下只保留当前窗口，更早的偏移按窗口起点计算
+void get_offset_position(Lexer* lexer, int offset, int* line, int* column) {
+    if (lexer->stream) {
+        // 窗口之前的行信息在补充输入时累计，窗口内的部分现算
+        int position = offset - lexer->base;
+        if (position < 0) position = 0;
+        if (position > lexer->length) position = lexer->length;
+        size_t last_newline = 0;
+        size_t newlines = lexer->scan->count_newlines(lexer->window, (size_t)position, &last_newline);
+        *line = lexer->base_lines + (int)newlines + 1;
+        *column = newlines ? position - (int)last_newline
+                           : lexer->base + position - lexer->base_line_start + 1;
+        return;
+    }
+    if (!lexer->lines) {
+        lexer->lines = create_line_table(lexer->source, lexer->length);
+        if (!lexer->lines) {
+            *line = 0;
+            *column = 0;
+            return;
+        }
+    }
+    line_table_lookup(lexer->lines, offset, line, column);
+}
+
+// 获取当前位置的行列号
 void get_position(Lexer* lexer, int* line, int* column) {
-    *line = lexer->line;
-    *column = lexer->column;
+    get_offset_position(lexer, lexer->base + lexer->position, line, column);
 }
 
 // 在已有的静态函数声明部分添加
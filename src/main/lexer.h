@@ -3,7 +3,12 @@
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <stdio.h>
+#include <stdint.h>
 #include "token_types.h"
+#include "simd_scan.h"
+#include "interner.h"
+#include "line_table.h"
 
 // 错误类型枚举
 typedef enum {
@@ -16,33 +21,113 @@ typedef enum {
 } LexerErrorType;
 
 // 标记结构
+// 标记不再持有自己的字符串副本，而是以 (偏移, 长度) 引用源代码缓冲区。
+// 对于字符串字面量，该范围不包含两侧的引号。
+// 标记不记录行列号，需要时通过 LineTable 由偏移换算。
+// 流式模式下源代码不会被保留，数字与字符串字面量的文本也会驻留到 symbol 中。
 typedef struct {
-    TokenType type;      // 标记类型
-    char* value;         // 标记值
-    int line;           // 行号
-    int column;         // 列号
-    int length;         // 标记长度
+    uint16_t type;       // 标记类型（TokenType）
+    uint16_t flags;      // TOKEN_FLAG_* 标志位
+    int offset;          // 标记在源代码中的起始偏移
+    int length;          // 标记长度
+    Symbol symbol;       // 标识符驻留后的符号（其他标记为 SYMBOL_NONE）
 } Token;
 
+// 标记之前（上一个标记之后）出现过换行
+#define TOKEN_FLAG_NEWLINE_BEFORE 0x1
+// 切分该标记时发现了词法错误（无效字符、未闭合的字符串；未闭合的块注释记在其后的EOF上）
+#define TOKEN_FLAG_ERROR 0x2
+
+// 标记数组：一次性词法分析的结果，最后一个为 TOKEN_EOF。
+// 增量解析把它当作间隙缓冲区：编辑处留出空隙，之后的标记不必搬动，偏移也只在访问时修正，
+// 因此应通过 token_at 按下标读取标记
+typedef struct {
+    Token* tokens;       // 标记数组
+    int count;           // 标记数量（包含末尾的EOF，不含空隙）
+    int capacity;        // 已分配的容量
+    const char* source;  // 标记所引用的源代码（不拥有）
+    int gap_start;       // 空隙之前的标记数，下标不小于它的标记存放在空隙之后
+    int gap_size;        // 空隙的长度（标记数）
+    int gap_delta;       // 空隙之后的标记的偏移需加上的修正量
+    char* error_message; // 切分时遇到的第一个词法错误（带行列号），没有时为 NULL
+} TokenArray;
+
 // 词法分析器结构
 typedef struct {
-    char* source;          // 源代码
+    const char* source;    // 源代码（借用调用方的缓冲区，不要求以 '\0' 结尾）
+    int length;            // 源代码长度
     int position;          // 当前位置
-    int line;              // 当前行号
-    int column;            // 当前列号
     char current_char;     // 当前字符
     Token current_token;   // 当前标记
-    LexerErrorType error;  // 错误类型
-    char* error_message;   // 错误信息
+    LexerErrorType error;  // 第一个错误的类型
+    char* error_message;   // 第一个错误的信息（词法错误带 "行:列: " 前缀）
+    const ScanOps* scan;   // 批量字符扫描实现
+    LineTable* lines;      // 行起始偏移表（报告位置时才构建）
+    int token_start;       // 正在读取的标记在 source 中的起点（-1 表示没有）
+    int newline_seen;      // 当前标记之前的空白中是否有换行
+    int error_seen;        // 切分当前标记时是否发现了词法错误
+    int intern_identifiers; // 是否在切分时驻留标识符（并行切分的工作线程关闭，由拼接阶段统一驻留）
+    
+    // 流式模式：source 指向固定大小的窗口，耗尽时从 stream 补充
+    FILE* stream;          // 输入流（非流式模式为 NULL）
+    char* window;          // 窗口缓冲区
+    int window_size;       // 窗口容量
+    int base;              // 窗口起点在整个输入中的偏移
+    int stream_eof;        // 输入流是否已读完
+    int base_lines;        // 窗口起点之前的换行符数量
+    int base_line_start;   // 窗口起点所在行的起始偏移
+    char* scratch;         // 跨越窗口边界的标记文本拼接缓冲区
+    int scratch_length;    // 拼接缓冲区中的字节数
+    int scratch_capacity;  // 拼接缓冲区容量
+    int keep_input;        // 是否另存读入的全部字节（供之后的各遍报告行列号），须在切分开始前设置
+    char* input;           // 已滑出窗口的字节；另存失败时为 NULL 且 input_length 为 -1
+    int input_length;
+    int input_capacity;
 } Lexer;
 
+// 流式词法分析器的默认窗口大小
+#define LEXER_DEFAULT_WINDOW_SIZE (64 * 1024)
+
 // 函数原型
-Lexer* create_lexer(const char* source);
+Lexer* create_lexer(const char* source, int length);
+Lexer* create_stream_lexer(FILE* stream, int window_size);
+void seek_lexer(Lexer* lexer, int offset);
 Token get_next_token(Lexer* lexer);
 const char* get_error_message(Lexer* lexer);
 LexerErrorType get_error_type(Lexer* lexer);
 void clear_error(Lexer* lexer);
 void destroy_lexer(Lexer* lexer);
+// 取走流式词法分析器至今读入的全部字节（调用者释放），之后不能再切分标记；
+// 没有设置 keep_input 或内存不足时返回 NULL
+char* take_lexer_input(Lexer* lexer, int* length);
+
+// 一次性将整个源代码切分为标记数组
+TokenArray* tokenize(Lexer* lexer);
+void destroy_token_array(TokenArray* array);
+// 驻留关闭 intern_identifiers 时切分出的标识符（驻留表不是线程安全的，须在主线程中调用）
+void intern_token_identifiers(TokenArray* array);
+
+// 关键字或类型名对应的文本，非关键字返回 NULL
+const char* keyword_text(TokenType type);
+
+// 获取标记的文本（长度为 token->length）：已驻留的标记取符号文本，否则取源代码切片
+static inline const char* token_text(const char* source, const Token* token) {
+    return token->symbol != SYMBOL_NONE ? symbol_name(token->symbol) : source + token->offset;
+}
+
+// 第 index 个标记（跳过空隙并修正偏移）
+static inline Token token_at(const TokenArray* array, int index) {
+    if (index < array->gap_start) {
+        return array->tokens[index];
+    }
+    Token token = array->tokens[index + array->gap_size];
+    token.offset += array->gap_delta;
+    return token;
+}
+
+// 获取当前位置或任意偏移的行列号
+void get_position(Lexer* lexer, int* line, int* column);
+void get_offset_position(Lexer* lexer, int offset, int* line, int* column);
 
 // 辅助函数
 const char* token_type_to_string(TokenType type);
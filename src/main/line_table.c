@@ -0,0 +1,54 @@
+#include "line_table.h"
+#include "simd_scan.h"
+#include <stdlib.h>
+
+// 构建行起始偏移表：先用向量化扫描统计换行符数量，再逐段定位每个换行符
+LineTable* create_line_table(const char* source, int length) {
+    LineTable* table = (LineTable*)malloc(sizeof(LineTable));
+    if (!table) return NULL;
+
+    const ScanOps* scan = select_scan_ops();
+    size_t last_newline = 0;
+    size_t newlines = scan->count_newlines(source, (size_t)length, &last_newline);
+
+    table->line_count = (int)newlines + 1;
+    table->line_starts = (int*)malloc(sizeof(int) * table->line_count);
+    if (!table->line_starts) {
+        free(table);
+        return NULL;
+    }
+
+    table->line_starts[0] = 0;
+    int line = 1;
+    size_t position = 0;
+    while (line < table->line_count) {
+        position += scan->find_newline(source + position, (size_t)length - position);
+        table->line_starts[line++] = (int)position + 1;
+        position++;
+    }
+    return table;
+}
+
+// 将字节偏移转换为行号与列号（均从1开始）
+void line_table_lookup(const LineTable* table, int offset, int* line, int* column) {
+    // 二分查找最后一个起始偏移不大于 offset 的行
+    int low = 0;
+    int high = table->line_count - 1;
+    while (low < high) {
+        int middle = low + (high - low + 1) / 2;
+        if (table->line_starts[middle] <= offset) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    *line = low + 1;
+    *column = offset - table->line_starts[low] + 1;
+}
+
+void destroy_line_table(LineTable* table) {
+    if (table) {
+        free(table->line_starts);
+        free(table);
+    }
+}
@@ -0,0 +1,19 @@
+// 行起始偏移表头文件
+// 标记与AST节点只记录字节偏移；需要报告行列号时（诊断信息、调试信息），
+// 通过一次性构建的行起始偏移表二分查找得到。
+
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+// 行起始偏移表
+typedef struct {
+    int* line_starts;    // 第 i 行（从0计）的起始偏移，严格递增
+    int line_count;      // 行数（至少为1）
+} LineTable;
+
+// 函数原型
+LineTable* create_line_table(const char* source, int length);
+void line_table_lookup(const LineTable* table, int offset, int* line, int* column);
+void destroy_line_table(LineTable* table);
+
+#endif // LINE_TABLE_H
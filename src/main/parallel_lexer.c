@@ -0,0 +1,231 @@
+#include "parallel_lexer.h"
+#include "thread.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 一块输入及其推测切分的结果
+typedef struct {
+    Lexer* lexer;          // 本块专用的词法分析器（共享同一份源代码）
+    int start;             // 块起点（行首）
+    int end;               // 块终点（不含）
+    Token* tokens;         // 起点落在 [start, end) 内的标记
+    int count;
+    int capacity;
+    int next;              // 块之后第一个标记的起点；遇到EOF时为 -1
+    int next_flags;        // 该标记的标志位（换行标志取决于它前面的空白与注释，起点相同也可能不同）
+    int resume;            // 切分该标记之前词法分析器所在的位置（下一块从这里继续才能得到相同的换行标志）
+    int failed;            // 内存分配失败
+} LexChunk;
+
+static int push_token(LexChunk* chunk, Token token) {
+    if (chunk->count == chunk->capacity) {
+        int capacity = chunk->capacity ? chunk->capacity * 2 : 1024;
+        Token* tokens = (Token*)realloc(chunk->tokens, sizeof(Token) * capacity);
+        if (!tokens) {
+            chunk->failed = 1;
+            return 0;
+        }
+        chunk->tokens = tokens;
+        chunk->capacity = capacity;
+    }
+    chunk->tokens[chunk->count++] = token;
+    return 1;
+}
+
+// 标记在源代码中的起点（字符串标记的偏移指向引号之后的内容）
+static int lexeme_start(const Token* token) {
+    return token->type == TOKEN_STRING ? token->offset - 1 : token->offset;
+}
+
+// 切分下一个标记并判断它是否仍属于本块；不属于时记录块之后第一个标记的起点
+static int next_chunk_token(LexChunk* chunk, Token* token) {
+    int before = chunk->lexer->position;
+    *token = get_next_token(chunk->lexer);
+    if (token->type == TOKEN_EOF) {
+        push_token(chunk, *token);
+        chunk->next = -1;
+        return 0;
+    }
+    if (lexeme_start(token) >= chunk->end) {
+        chunk->next = lexeme_start(token);
+        chunk->next_flags = token->flags;
+        chunk->resume = before;
+        return 0;
+    }
+    return 1;
+}
+
+// 工作线程：假设块起点不在字符串或注释内部，推测切分。
+// 收下起点在块内的标记，最后一个标记可以越过块终点
+static void lex_chunk_worker(void* argument) {
+    LexChunk* chunk = (LexChunk*)argument;
+    Token token;
+    // 从块起点前的换行符开始，使第一个标记的换行标志与串行切分一致
+    seek_lexer(chunk->lexer, chunk->start > 0 ? chunk->start - 1 : 0);
+    while (next_chunk_token(chunk, &token)) {
+        if (!push_token(chunk, token)) return;
+    }
+}
+
+// 从上一块实际结束的位置 offset 重新切分本块。
+// 一旦某个标记的起点与推测结果中的标记重合，之后的切分必然相同，直接沿用推测结果
+static void relex_chunk(LexChunk* chunk, int offset) {
+    Token* speculative = chunk->tokens;
+    int speculative_count = chunk->count;
+    int speculative_next = chunk->next;
+    int speculative_flags = chunk->next_flags;
+    chunk->tokens = NULL;
+    chunk->count = 0;
+    chunk->capacity = 0;
+    
+    Token token;
+    int index = 0;
+    seek_lexer(chunk->lexer, offset);
+    while (next_chunk_token(chunk, &token)) {
+        int start = lexeme_start(&token);
+        while (index < speculative_count && lexeme_start(&speculative[index]) < start) {
+            index++;
+        }
+        if (index < speculative_count && lexeme_start(&speculative[index]) == start) {
+            // 重合的标记本身取重新切分的结果（其前面的空白可能不同），其后的沿用推测结果
+            push_token(chunk, token);
+            for (index++; index < speculative_count; index++) {
+                push_token(chunk, speculative[index]);
+            }
+            chunk->next = speculative_next;
+            chunk->next_flags = speculative_flags;
+            break;
+        }
+        if (!push_token(chunk, token)) break;
+    }
+    free(speculative);
+}
+
+// 块内第一个标记的起点与标志位（没有标记时即块之后的第一个标记）
+static int first_token_offset(const LexChunk* chunk) {
+    return chunk->count > 0 ? lexeme_start(&chunk->tokens[0]) : chunk->next;
+}
+
+static int first_token_flags(const LexChunk* chunk) {
+    return chunk->count > 0 ? chunk->tokens[0].flags : chunk->next_flags;
+}
+
+TokenArray* tokenize_parallel(const char* source, int length, int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = cpu_count();
+    }
+    int chunk_count = length / PARALLEL_LEX_MIN_CHUNK;
+    if (chunk_count > thread_count) {
+        chunk_count = thread_count;
+    }
+    if (chunk_count < 2) {
+        Lexer* lexer = create_lexer(source, length);
+        if (!lexer) return NULL;
+        TokenArray* array = tokenize(lexer);
+        destroy_lexer(lexer);
+        return array;
+    }
+    
+    LexChunk* chunks = (LexChunk*)calloc(chunk_count, sizeof(LexChunk));
+    Thread** threads = (Thread**)calloc(chunk_count, sizeof(Thread*));
+    TokenArray* array = NULL;
+    if (!chunks || !threads) goto cleanup;
+    
+    // 在行首处切块，块终点即下一块的起点
+    int start = 0;
+    for (int i = 0; i < chunk_count; i++) {
+        int end = length;
+        if (i < chunk_count - 1) {
+            end = (int)((long long)length * (i + 1) / chunk_count);
+            if (end < start) end = start;
+            const char* newline = (const char*)memchr(source + end, '\n', length - end);
+            end = newline ? (int)(newline - source) + 1 : length;
+        }
+        chunks[i].start = start;
+        chunks[i].end = end;
+        // 词法分析器在主线程创建，工作线程中不做任何全局初始化；标识符留待拼接时按顺序驻留
+        chunks[i].lexer = create_lexer(source, length);
+        if (!chunks[i].lexer) goto cleanup;
+        chunks[i].lexer->intern_identifiers = 0;
+        start = end;
+    }
+    
+    // 第一块在当前线程切分，其余块交给工作线程（线程创建失败时也在当前线程完成）
+    for (int i = 1; i < chunk_count; i++) {
+        threads[i] = create_thread(lex_chunk_worker, &chunks[i]);
+        if (!threads[i]) {
+            lex_chunk_worker(&chunks[i]);
+        }
+    }
+    lex_chunk_worker(&chunks[0]);
+    for (int i = 1; i < chunk_count; i++) {
+        join_thread(threads[i]);
+        threads[i] = NULL;
+    }
+    
+    // 修正阶段：上一块实际结束的位置与本块推测的起点不一致时（本块起点落在字符串或注释中），
+    // 从上一块给出的位置重新切分本块。起点相同而换行标志不同时同样重新切分：块起点落在跨行的
+    // 多行注释中时，推测切分把注释里的换行当作了标记前的空白。遇到EOF的块之后的内容全部丢弃
+    int total = chunks[0].count;
+    int last = 0;
+    for (int i = 1; i < chunk_count && chunks[last].next >= 0; i++) {
+        if (first_token_offset(&chunks[i]) != chunks[last].next ||
+            first_token_flags(&chunks[i]) != chunks[last].next_flags) {
+            relex_chunk(&chunks[i], chunks[last].resume);
+        }
+        total += chunks[i].count;
+        last = i;
+    }
+    for (int i = 0; i <= last; i++) {
+        if (chunks[i].failed) goto cleanup;
+    }
+    
+    array = (TokenArray*)malloc(sizeof(TokenArray));
+    if (!array) goto cleanup;
+    array->tokens = (Token*)malloc(sizeof(Token) * (total > 0 ? total : 1));
+    array->count = 0;
+    array->capacity = total;
+    array->source = source;
+    array->gap_size = 0;
+    array->gap_delta = 0;
+    array->error_message = NULL;
+    if (!array->tokens) {
+        free(array);
+        array = NULL;
+        goto cleanup;
+    }
+    
+    // 按源代码顺序拼接并驻留标识符，得到与串行切分相同的符号编号
+    int lexical_error = 0;
+    for (int i = 0; i <= last; i++) {
+        for (int j = 0; j < chunks[i].count; j++) {
+            Token token = chunks[i].tokens[j];
+            if (token.type == TOKEN_IDENTIFIER) {
+                token.symbol = intern(source + token.offset, token.length);
+            }
+            lexical_error |= token.flags & TOKEN_FLAG_ERROR;
+            array->tokens[array->count++] = token;
+        }
+    }
+    array->gap_start = array->count;
+
+    // 推测切分中的错误可能只是块起点猜错所致，最终标记中仍有错误时才是真正的词法错误。
+    // 这时串行重新切分一遍，取得第一个错误的信息（出错的输入很少，不必在意这点开销）
+    if (lexical_error) {
+        destroy_token_array(array);
+        Lexer* lexer = create_lexer(source, length);
+        array = lexer ? tokenize(lexer) : NULL;
+        destroy_lexer(lexer);
+    }
+    
+cleanup:
+    if (chunks) {
+        for (int i = 0; i < chunk_count; i++) {
+            destroy_lexer(chunks[i].lexer);
+            free(chunks[i].tokens);
+        }
+    }
+    free(chunks);
+    free(threads);
+    return array;
+}
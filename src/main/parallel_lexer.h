@@ -0,0 +1,16 @@
+// 并行词法分析头文件
+// 把大文件按换行切成若干块，由工作线程各自切分标记，再由修正阶段拼接成与串行结果完全一致的标记数组。
+
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include "lexer.h"
+
+// 每块至少这么大才值得启动一个线程
+#define PARALLEL_LEX_MIN_CHUNK (256 * 1024)
+
+// 并行切分 [source, source + length)；thread_count 为 0 时使用全部处理器核心。
+// 输入较小时直接退回串行切分
+TokenArray* tokenize_parallel(const char* source, int length, int thread_count);
+
+#endif // PARALLEL_LEXER_H
@@ -1,20 +1,137 @@
 #include "parser.h"
 #include "lexer.h"
+#include "parallel_lexer.h"
+#include "thread.h"
 #include "ast.h"
+#include "include_graph.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#define PARSER_MAX_LOOKAHEAD 4
+
+// 并行解析时每个工作线程至少分到的标记数，过小时线程开销超过收益
+#define PARALLEL_PARSE_MIN_TOKENS (64 * 1024)
+
+// 类型的最大嵌套深度，以及同时可见的泛型参数个数
+#define PARSER_MAX_TYPE_DEPTH 64
+#define PARSER_MAX_TYPE_PARAMETERS 32
+
+// 表达式解析栈上的帧：尚未规约的运算符，或尚未闭合的括号
+typedef enum {
+    FRAME_BINARY,   // 二元运算符，等待右操作数
+    FRAME_PREFIX,   // 前缀运算符，等待操作数
+    FRAME_GROUP,    // ( 表达式 )
+    FRAME_CALL,     // 被调用者 ( 实参列表 )
+    FRAME_INDEX     // 基址 [ 下标 ]
+} FrameKind;
+
+typedef struct {
+    uint8_t kind;          // FrameKind
+    uint8_t op;            // OperatorType
+    uint8_t right_bp;      // 运算符的右结合力
+    int node_base;         // FRAME_CALL：第一个实参在节点栈中的下标
+    int offset;            // 运算符或括号在源代码中的偏移
+} ExprFrame;
 
 // Define the Parser structure
 struct Parser {
     Lexer* lexer;          // 词法分析器
+    TokenArray* tokens;    // 一次性切分得到的标记数组
+    int position;          // 当前标记在数组中的下标
+    int token_limit;       // 只解析下标小于它的标记，到达后视为EOF（并行解析时划分范围）
+    Token limit_token;     // 到达 token_limit 时返回的EOF标记
     Token current_token;    // 当前标记
     ASTNode* root;         // AST根节点
-    char* error_message;    // 错误信息
+    int lazy_bodies;       // 是否只记录 "{...}" 函数体的标记范围，等到需要时再解析
+    int header_mode;       // 解析头文件：接受C函数原型与没有函数体的函数声明
+    int keep_stream_input; // 流式解析时是否另存读入的全部字节
+    Arena* ast_arena;      // 本次解析的全部AST节点所在的区域分配器
+    char* error_message;    // 错误信息（只保留第一个错误）
+    ParserErrorType error;  // 错误类型
+    // 表达式与语句列表共用的显式栈，嵌套深度只受堆内存限制
+    ExprFrame* frames;
+    int frame_count;
+    int frame_capacity;
+    ASTNode** nodes;
+    int node_count;
+    int node_capacity;
+    // 流式模式下 tokens 为 NULL，标记按需从词法分析器读取，前瞻标记暂存在环形缓冲区中
+    Token lookahead[PARSER_MAX_LOOKAHEAD];
+    int lookahead_head;    // 环形缓冲区中第一个前瞻标记的下标
+    int lookahead_count;   // 已缓存的前瞻标记数量
+    // 当前函数（及外层函数）的泛型参数名，类型中出现这些名字不算未知类型
+    Symbol type_parameters[PARSER_MAX_TYPE_PARAMETERS];
+    int type_parameter_count;
+    int type_depth;        // 正在解析的类型的嵌套深度
+    int split_greater;     // 当前的 ">>" 已被内层泛型参数列表消费了一个 '>'
 };
 
-// 获取下一个标记
+static void report_lexer_error(Parser* parser, const char* message);
+
+// 从流式词法分析器切分一个标记，切分时发现的词法错误立即报告
+static Token read_stream_token(Parser* parser) {
+    Token token = get_next_token(parser->lexer);
+    if ((token.flags & TOKEN_FLAG_ERROR) && parser->lexer->error_message) {
+        report_lexer_error(parser, parser->lexer->error_message);
+    }
+    return token;
+}
+
+// 从词法分析器读取下一个标记（流式模式），到达EOF后不再读取
+static Token next_stream_token(Parser* parser) {
+    if (parser->lookahead_count > 0) {
+        Token token = parser->lookahead[parser->lookahead_head];
+        parser->lookahead_head = (parser->lookahead_head + 1) % PARSER_MAX_LOOKAHEAD;
+        parser->lookahead_count--;
+        return token;
+    }
+    if (parser->current_token.type == TOKEN_EOF) {
+        return parser->current_token;
+    }
+    return read_stream_token(parser);
+}
+
+// 获取下一个标记（停留在末尾的EOF上）
 static void advance(Parser* parser) {
-    parser->current_token = get_next_token(parser->lexer);
+    if (!parser->tokens) {
+        parser->current_token = next_stream_token(parser);
+        return;
+    }
+    if (parser->position < parser->token_limit) {
+        parser->position++;
+    }
+    parser->current_token = parser->position < parser->token_limit ?
+        token_at(parser->tokens, parser->position) : parser->limit_token;
+}
+
+// 向前查看第 n 个标记（n < PARSER_MAX_LOOKAHEAD），越界时返回EOF
+static Token peek_token(Parser* parser, int n) {
+    if (n == 0) {
+        return parser->current_token;
+    }
+    if (!parser->tokens) {
+        while (parser->lookahead_count < n) {
+            int tail = (parser->lookahead_head + parser->lookahead_count) % PARSER_MAX_LOOKAHEAD;
+            if (parser->lookahead_count > 0) {
+                const Token* last = &parser->lookahead[(tail + PARSER_MAX_LOOKAHEAD - 1) % PARSER_MAX_LOOKAHEAD];
+                if (last->type == TOKEN_EOF) {
+                    return *last;
+                }
+            } else if (parser->current_token.type == TOKEN_EOF) {
+                return parser->current_token;
+            }
+            parser->lookahead[tail] = read_stream_token(parser);
+            parser->lookahead_count++;
+        }
+        return parser->lookahead[(parser->lookahead_head + n - 1) % PARSER_MAX_LOOKAHEAD];
+    }
+    int index = parser->position + n;
+    if (index >= parser->token_limit) {
+        return parser->limit_token;
+    }
+    return token_at(parser->tokens, index);
 }
 
 // 检查当前标记类型
@@ -22,161 +139,2398 @@ static int match(Parser* parser, TokenType type) {
     return parser->current_token.type == type;
 }
 
-// 期望并消费一个标记
-static void expect(Parser* parser, TokenType type) {
+// 在源代码偏移 offset 处记录错误信息，行列号由词法分析器按需换算。
+// 出错后继续解析以便恢复，但只保留第一个错误，后续错误往往是它的连锁反应
+static void report_error_at(Parser* parser, int offset, const char* message) {
+    if (parser->error_message) {
+        return;
+    }
+    char buffer[256];
+    int line, column;
+    get_offset_position(parser->lexer, offset, &line, &column);
+    if (line > 0) {
+        snprintf(buffer, sizeof(buffer), "%d:%d: %s", line, column, message);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%s", message);
+    }
+    parser->error = PARSER_ERROR_SYNTAX;
+    parser->error_message = strdup(buffer);
+}
+
+// 在当前标记处记录错误信息
+static void report_error(Parser* parser, const char* message) {
+    report_error_at(parser, parser->current_token.offset, message);
+}
+
+// 报告词法错误：信息已带行列号。词法错误总是先于语法错误报告，后者多半是它的连锁反应
+static void report_lexer_error(Parser* parser, const char* message) {
+    if (parser->error_message) {
+        return;
+    }
+    parser->error = PARSER_ERROR_SYNTAX;
+    parser->error_message = strdup(message);
+}
+
+static void report_memory_error(Parser* parser) {
+    if (parser->error_message) {
+        return;
+    }
+    report_error(parser, "内存分配错误：无法创建AST节点");
+    parser->error = PARSER_ERROR_MEMORY;
+}
+
+// 当前标记为 type 时消费它，返回是否匹配
+static int accept_token(Parser* parser, TokenType type) {
     if (match(parser, type)) {
         advance(parser);
-    } else {
-        // 设置错误信息
-        if (parser->error_message) {
-            free(parser->error_message);
+        return 1;
+    }
+    return 0;
+}
+
+// 当前标记之前是否有换行
+static int newline_before(Parser* parser) {
+    return (parser->current_token.flags & TOKEN_FLAG_NEWLINE_BEFORE) != 0;
+}
+
+// 是否停在人为划分的解析范围末尾（并行分段或增量解析），而不是真正的EOF。
+// 此时 limit_token 保留了范围之后那个标记的标志位，语句仍需以换行与它分隔
+static int at_range_limit(Parser* parser) {
+    return parser->tokens && parser->position >= parser->token_limit &&
+           parser->token_limit < parser->tokens->count - 1;
+}
+
+// 压入节点栈；node 为 NULL 表示创建节点时内存不足
+static int push_node(Parser* parser, ASTNode* node) {
+    if (!node) {
+        report_memory_error(parser);
+        return 0;
+    }
+    if (parser->node_count == parser->node_capacity) {
+        int capacity = parser->node_capacity ? parser->node_capacity * 2 : 256;
+        ASTNode** nodes = (ASTNode**)realloc(parser->nodes, sizeof(ASTNode*) * capacity);
+        if (!nodes) {
+            report_memory_error(parser);
+            return 0;
         }
-        parser->error_message = strdup("语法错误：意外的标记类型");
+        parser->nodes = nodes;
+        parser->node_capacity = capacity;
     }
+    parser->nodes[parser->node_count++] = node;
+    return 1;
 }
 
-void parse_source(Parser* parser, const char* source) {
-    if (!parser || !source) {
-        if (parser) {
-            parser->error_message = strdup("无效的源代码或解析器");
+static int push_frame(Parser* parser, FrameKind kind, OperatorType op, int right_bp, int offset) {
+    if (parser->frame_count == parser->frame_capacity) {
+        int capacity = parser->frame_capacity ? parser->frame_capacity * 2 : 64;
+        ExprFrame* frames = (ExprFrame*)realloc(parser->frames, sizeof(ExprFrame) * capacity);
+        if (!frames) {
+            report_memory_error(parser);
+            return 0;
         }
-        return;
+        parser->frames = frames;
+        parser->frame_capacity = capacity;
+    }
+    ExprFrame* frame = &parser->frames[parser->frame_count++];
+    frame->kind = (uint8_t)kind;
+    frame->op = (uint8_t)op;
+    frame->right_bp = (uint8_t)right_bp;
+    frame->node_base = parser->node_count;
+    frame->offset = offset;
+    return 1;
+}
+
+// 变量声明的起始关键字
+static int is_declaration_keyword(TokenType type) {
+    return type == TOKEN_KEYWORD_VAR || type == TOKEN_KEYWORD_VAL ||
+           type == TOKEN_KEYWORD_CONST || type == TOKEN_KEYWORD_LATEINIT;
+}
+
+// 声明前的修饰符（可见性、tailrec、async 等）
+static int is_modifier(TokenType type) {
+    switch (type) {
+        case TOKEN_KEYWORD_PUBLIC:
+        case TOKEN_KEYWORD_PRIVATE:
+        case TOKEN_KEYWORD_PUB:
+        case TOKEN_KEYWORD_PRIV:
+        case TOKEN_KEYWORD_PROT:
+        case TOKEN_KEYWORD_INTER:
+        case TOKEN_KEYWORD_OPEN:
+        case TOKEN_KEYWORD_FINAL:
+        case TOKEN_KEYWORD_OVERRIDE:
+        case TOKEN_KEYWORD_TAILREC:
+        case TOKEN_KEYWORD_CROSSINLINE:
+        case TOKEN_KEYWORD_ASYNC:
+        case TOKEN_KEYWORD_OPERATOR:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// 跳过修饰符，返回其中记录在AST中的部分（FunctionModifier）
+static unsigned parse_modifiers(Parser* parser) {
+    unsigned modifiers = 0;
+    while (is_modifier((TokenType)parser->current_token.type)) {
+        switch (parser->current_token.type) {
+            case TOKEN_KEYWORD_PUBLIC:
+            case TOKEN_KEYWORD_PUB:
+                modifiers |= MODIFIER_PUBLIC;
+                break;
+            case TOKEN_KEYWORD_TAILREC:
+                modifiers |= MODIFIER_TAILREC;
+                break;
+            case TOKEN_KEYWORD_CROSSINLINE:
+                modifiers |= MODIFIER_CROSSINLINE;
+                break;
+            default:
+                break;
+        }
+        advance(parser);
+    }
+    return modifiers;
+}
+
+// 可以用作名字的关键字：软关键字、内置类型名（如 f32）和 this/super
+static int is_name_keyword(TokenType type) {
+    return (type >= TOKEN_KEYWORD_ANNOTATION && type <= TOKEN_KEYWORD_TYPE) ||
+           (type >= TOKEN_TYPE_INT && type <= TOKEN_TYPE_SLICE) ||
+           type == TOKEN_KEYWORD_THIS || type == TOKEN_KEYWORD_SUPER;
+}
+
+// 预先驻留这些关键字的文本，解析时只需 find_symbol 查找，不会修改驻留表，
+// 因此并行解析的工作线程可以安全地取得它们的符号
+static void intern_keyword_names(void) {
+    for (int type = 0; type <= TOKEN_COMMENT_MULTI; type++) {
+        if (is_name_keyword((TokenType)type)) {
+            intern_cstr(keyword_text((TokenType)type));
+        }
+    }
+}
+
+static ASTNode* parse_statement(Parser* parser);
+static ASTNode* parse_expression(Parser* parser);
+static ASTNode* parse_include(Parser* parser);
+static void skip_directive(Parser* parser);
+static int c_prototype_end(Parser* parser);
+static ASTNode* parse_c_prototype(Parser* parser, int end);
+static void skip_c_declaration(Parser* parser);
+
+// 释放上一次解析留下的词法分析器和标记
+static void reset_parser(Parser* parser) {
+    if (parser->tokens) {
+        destroy_token_array(parser->tokens);
+        parser->tokens = NULL;
     }
-    
-    // 创建词法分析器
     if (parser->lexer) {
         destroy_lexer(parser->lexer);
+        parser->lexer = NULL;
     }
-    parser->lexer = create_lexer(source);
-    
-    // 获取第一个标记
-    advance(parser);
-    
-    // 创建程序根节点
-    ASTNode* program_node = create_ast_node(NODE_PROGRAM);
-    program_node->program.declarations = NULL;
-    program_node->program.declaration_count = 0;
+    parser->position = 0;
+    parser->token_limit = 0;
+    parser->lookahead_head = 0;
+    parser->lookahead_count = 0;
+    parser->frame_count = 0;
+    parser->node_count = 0;
+    clear_parser_error(parser);
     
-    // 解析文件内容直到EOF
+    // 上一次解析得到的AST整体丢弃
+    destroy_arena(parser->ast_arena);
+    parser->root = NULL;
+    parser->ast_arena = create_arena(AST_ARENA_CHUNK_SIZE);
+    intern_keyword_names();
+}
+
+// 头文件只提供声明（定义在C库或源文件中），预编译头也只保存签名与类型，
+// 函数体、初始值与常量都会丢失，因此直接报错
+static void check_header_declaration(Parser* parser, const ASTNode* declaration) {
+    if (declaration->type == NODE_FUNCTION) {
+        if (declaration->function.body || function_body_pending(declaration)) {
+            report_error_at(parser, declaration->offset, "头文件中的函数只能声明，不能有函数体");
+        }
+    } else if (declaration->type == NODE_VARIABLE_DECL) {
+        if (declaration->var_decl.kind == DECL_CONST) {
+            report_error_at(parser, declaration->offset, "头文件中不能定义常量");
+        } else if (declaration->var_decl.initializer) {
+            report_error_at(parser, declaration->offset, "头文件中的变量只能声明，不能有初始值");
+        }
+    }
+}
+
+// 解析顶层声明直到EOF，解析出的声明依次压入节点栈
+static void parse_declarations(Parser* parser) {
     while (parser->current_token.type != TOKEN_EOF) {
-        // 尝试解析函数定义
-        if (match(parser, TOKEN_KEYWORD_FUN)) {
-            ASTNode* func_node = parse_function_definition(parser);
-            if (func_node) {
-                // 添加到程序节点
-                program_node->program.declaration_count++;
-                program_node->program.declarations = realloc(
-                    program_node->program.declarations, 
-                    program_node->program.declaration_count * sizeof(ASTNode*)
-                );
-                program_node->program.declarations[program_node->program.declaration_count - 1] = func_node;
-            }
-        } else if (match(parser, TOKEN_KEYWORD_INCLUDE) || match(parser, TOKEN_HASH)) {
-            // 处理 include 指令 (#include 或 include)
-            advance(parser);
-            // 暂时跳过include指令的处理
-            while (parser->current_token.type != TOKEN_SEMICOLON && 
-                   parser->current_token.type != TOKEN_EOF &&
-                   parser->current_token.type != TOKEN_KEYWORD_FUN) {
-                advance(parser);
-            }
-        } else {
+        ASTNode* declaration = NULL;
+        unsigned modifiers = parse_modifiers(parser);
+        int prototype_end;
+        if (parser->header_mode && (prototype_end = c_prototype_end(parser)) >= 0) {
+            declaration = parse_c_prototype(parser, prototype_end);
+        } else if (match(parser, TOKEN_KEYWORD_FUN)) {
+            declaration = parse_function_definition(parser);
+            if (declaration) declaration->function.modifiers = modifiers;
+        } else if (is_declaration_keyword(parser->current_token.type)) {
+            declaration = parse_statement(parser);
+        } else if (match(parser, TOKEN_KEYWORD_INCLUDE) ||
+                   (match(parser, TOKEN_HASH) && peek_token(parser, 1).type == TOKEN_KEYWORD_INCLUDE)) {
+            declaration = parse_include(parser);
+        } else if (match(parser, TOKEN_HASH)) {
+            // 其他预处理指令（#ifndef、#define 等）目前不做处理
+            skip_directive(parser);
+        } else if (parser->header_mode && !match(parser, TOKEN_EOF)) {
+            skip_c_declaration(parser);
+        } else if (!match(parser, TOKEN_EOF)) {
             // 跳过未识别的标记
             advance(parser);
         }
+        if (declaration && parser->header_mode) {
+            check_header_declaration(parser, declaration);
+        }
+        if (declaration && !push_node(parser, declaration)) {
+            break;
+        }
     }
+}
+
+// 解析整个程序，词法分析器（以及非流式模式下的标记数组）已就绪
+static void parse_program(Parser* parser) {
+    // 顶层声明先收集在节点栈中，解析结束后一次性复制进 arena
+    int base = parser->node_count;
+    parse_declarations(parser);
     
-    parser->root = program_node;
+    // 创建程序根节点
+    parser->root = create_program(parser->ast_arena, &parser->nodes[base], parser->node_count - base);
+    parser->node_count = base;
 }
 
-Parser* create_parser() {
-    Parser* parser = (Parser*)malloc(sizeof(Parser));
-    if (parser) {
-        parser->lexer = NULL;
-        parser->root = NULL;
-        parser->error_message = NULL;
-        parser->current_token.type = TOKEN_UNKNOWN;
-        parser->current_token.value = NULL;
+// 并行解析中的一段：[start, end) 范围内的顶层声明由一个子解析器解析到它自己的区域分配器中
+typedef struct {
+    Parser* parser;
+    int start;
+    int end;
+} ParseChunk;
+
+static void parse_chunk_worker(void* argument) {
+    ParseChunk* chunk = (ParseChunk*)argument;
+    parse_declarations(chunk->parser);
+}
+
+// 括号嵌套深度：花括号与圆括号/方括号分别计数，多余的右括号不计
+typedef struct {
+    int braces;
+    int parens;
+} Nesting;
+
+static void nest(Nesting* nesting, TokenType type) {
+    switch (type) {
+        case TOKEN_LBRACE:   nesting->braces++; break;
+        case TOKEN_RBRACE:   if (nesting->braces > 0) nesting->braces--; break;
+        case TOKEN_LPAREN:
+        case TOKEN_LBRACKET: nesting->parens++; break;
+        case TOKEN_RPAREN:
+        case TOKEN_RBRACKET: if (nesting->parens > 0) nesting->parens--; break;
+        default: break;
     }
-    return parser;
 }
 
-void destroy_parser(Parser* parser) {
-    if (parser) {
-        if (parser->lexer) {
-            destroy_lexer(parser->lexer);
+static int at_top_level(const Nesting* nesting) {
+    return nesting->braces == 0 && nesting->parens == 0;
+}
+
+// 声明连同其前面的修饰符的起点（不越过 floor）
+static int declaration_start(const TokenArray* tokens, int index, int floor) {
+    while (index > floor && is_modifier((TokenType)token_at(tokens, index - 1).type)) {
+        index--;
+    }
+    return index;
+}
+
+// 能够结束一个表达式、类型或语句的标记：其后换行即意味着前面的构造已经完整
+static int ends_construct(TokenType type) {
+    switch (type) {
+        case TOKEN_IDENTIFIER:
+        case TOKEN_NUMBER:
+        case TOKEN_STRING:
+        case TOKEN_KEYWORD_NULL:
+        case TOKEN_KEYWORD_TRUE:
+        case TOKEN_KEYWORD_FALSE:
+        case TOKEN_RPAREN:
+        case TOKEN_RBRACKET:
+        case TOKEN_RBRACE:
+        case TOKEN_SEMICOLON:
+            return 1;
+        default:
+            return is_name_keyword(type);
+    }
+}
+
+// 只有在完整的构造之后另起一行的声明才能作为分界，否则前面悬而未决的语句、
+// 类型（如 "val x :" 之后换行）或出错后的恢复都可能越过它继续读取
+static int starts_line(const TokenArray* tokens, int index) {
+    return index == 0 || ((token_at(tokens, index).flags & TOKEN_FLAG_NEWLINE_BEFORE) != 0 &&
+                          ends_construct((TokenType)token_at(tokens, index - 1).type));
+}
+
+// 预扫描：按括号配对找出括号层级为 0、从新的一行开始的 fun/class（连同其前面的修饰符），
+// 在其中挑选分界点把标记数组按标记数大致均分为 chunk_count 段。返回实际段数，
+// starts[i] 为第 i 段的起点，starts[段数] 为末尾EOF的下标
+static int split_declarations(const TokenArray* tokens, int* starts, int chunk_count) {
+    int last = tokens->count - 1;
+    int count = 1;
+    Nesting nesting = { 0, 0 };
+    starts[0] = 0;
+    for (int i = 0; i < last && count < chunk_count; i++) {
+        TokenType type = (TokenType)token_at(tokens, i).type;
+        nest(&nesting, type);
+        if (at_top_level(&nesting) && (type == TOKEN_KEYWORD_FUN || type == TOKEN_KEYWORD_CLASS) &&
+                   i >= (int)((long long)last * count / chunk_count)) {
+            int start = declaration_start(tokens, i, starts[count - 1]);
+            if (start > starts[count - 1] && starts_line(tokens, start)) {
+                starts[count++] = start;
+            }
+        }
+    }
+    starts[count] = last;
+    return count;
+}
+
+// 把顶层声明分段交给工作线程解析，再按源代码顺序拼接为程序节点。
+// 每段都从某个顶层声明开始，解析结果与串行解析相同；准备阶段失败时返回 0，由调用方串行解析
+static int parse_program_parallel(Parser* parser, int chunk_count) {
+    int* starts = (int*)malloc(sizeof(int) * (chunk_count + 1));
+    ParseChunk* chunks = (ParseChunk*)calloc(chunk_count, sizeof(ParseChunk));
+    Thread** threads = (Thread**)calloc(chunk_count, sizeof(Thread*));
+    int parsed = 0;
+    if (!starts || !chunks || !threads) goto cleanup;
+    
+    chunk_count = split_declarations(parser->tokens, starts, chunk_count);
+    if (chunk_count < 2) goto cleanup;
+    
+    // 子解析器在主线程创建：共享只读的标记数组，各自拥有区域分配器，
+    // 以及一个只用于换算错误位置的词法分析器
+    for (int i = 0; i < chunk_count; i++) {
+        Parser* sub = create_parser();
+        chunks[i].parser = sub;
+        chunks[i].start = starts[i];
+        chunks[i].end = starts[i + 1];
+        if (!sub) goto cleanup;
+        sub->lexer = create_lexer(parser->lexer->source, parser->lexer->length);
+        sub->ast_arena = create_arena(AST_ARENA_CHUNK_SIZE);
+        if (!sub->lexer || !sub->ast_arena) goto cleanup;
+        sub->tokens = parser->tokens;
+        sub->lazy_bodies = parser->lazy_bodies;
+        sub->position = chunks[i].start;
+        sub->token_limit = chunks[i].end;
+        sub->limit_token = token_at(parser->tokens, chunks[i].end);
+        sub->limit_token.type = TOKEN_EOF;
+        sub->current_token = token_at(parser->tokens, chunks[i].start);
+    }
+    
+    // 第一段在当前线程解析，其余段交给工作线程（线程创建失败时也在当前线程完成）
+    for (int i = 1; i < chunk_count; i++) {
+        threads[i] = create_thread(parse_chunk_worker, &chunks[i]);
+        if (!threads[i]) {
+            parse_chunk_worker(&chunks[i]);
         }
-        if (parser->root) {
-            // TODO: 实现AST节点销毁函数
-            // destroy_ast_node(parser->root);
+    }
+    parse_chunk_worker(&chunks[0]);
+    for (int i = 1; i < chunk_count; i++) {
+        join_thread(threads[i]);
+        threads[i] = NULL;
+    }
+    
+    // 各段的节点归入本次解析的区域分配器，错误取源代码中最靠前的一个
+    for (int i = 0; i < chunk_count; i++) {
+        Parser* sub = chunks[i].parser;
+        arena_adopt(parser->ast_arena, sub->ast_arena);
+        sub->ast_arena = NULL;
+        if (sub->error_message && !parser->error_message) {
+            parser->error_message = sub->error_message;
+            parser->error = sub->error;
+            sub->error_message = NULL;
         }
-        if (parser->error_message) {
-            free(parser->error_message);
+    }
+    
+    // 按源代码顺序拼接各段的声明
+    int base = parser->node_count;
+    for (int i = 0; i < chunk_count; i++) {
+        Parser* sub = chunks[i].parser;
+        for (int j = 0; j < sub->node_count; j++) {
+            if (!push_node(parser, sub->nodes[j])) break;
+        }
+    }
+    parser->root = create_program(parser->ast_arena, &parser->nodes[base], parser->node_count - base);
+    parser->node_count = base;
+    parsed = 1;
+    
+cleanup:
+    if (chunks) {
+        for (int i = 0; i < chunk_count; i++) {
+            if (chunks[i].parser) {
+                chunks[i].parser->tokens = NULL;  // 标记数组属于主解析器
+                destroy_parser(chunks[i].parser);
+            }
         }
-        free(parser);
     }
+    free(starts);
+    free(chunks);
+    free(threads);
+    return parsed;
 }
 
-// 实现函数定义、函数调用等语法结构的解析
-ASTNode* parse_function_definition(struct Parser* parser) {
-    if (match(parser, TOKEN_KEYWORD_FUN)) {
-        advance(parser); // 消费'fun'关键字
+void parse_source(Parser* parser, const char* source, int length) {
+    parse_source_parallel(parser, source, length, 0);
+}
 
-        // 期望函数名（标识符）
-        if (!match(parser, TOKEN_IDENTIFIER)) {
-            if (parser->error_message) free(parser->error_message);
-            parser->error_message = strdup("语法错误：期望函数名");
-            return NULL;
+// 解析 source；tokens 为已切分好的标记数组（由解析器接管），为 NULL 时在此切分
+static void parse_tokens(Parser* parser, const char* source, int length, TokenArray* tokens, int thread_count) {
+    if (!parser || !source) {
+        if (parser) {
+            parser->error_message = strdup("无效的源代码或解析器");
         }
-        char* function_name = strdup(parser->current_token.value);
-        advance(parser);
+        destroy_token_array(tokens);
+        return;
+    }
+    
+    // 创建词法分析器并一次性切分出全部标记（大文件分块并行切分）
+    reset_parser(parser);
+    if (!parser->ast_arena) {
+        parser->error_message = strdup("内存分配错误：无法创建AST区域");
+        destroy_token_array(tokens);
+        return;
+    }
+    if (thread_count <= 0) {
+        thread_count = cpu_count();
+    }
+    parser->lexer = create_lexer(source, length);
+    parser->tokens = tokens ? tokens : tokenize_parallel(source, length, thread_count);
+    if (!parser->lexer || !parser->tokens) {
+        parser->error_message = strdup("内存分配错误：无法创建标记数组");
+        return;
+    }
+    parser->token_limit = parser->tokens->count - 1;
+    parser->limit_token = token_at(parser->tokens, parser->token_limit);
+    if (parser->tokens->error_message) {
+        report_lexer_error(parser, parser->tokens->error_message);
+    }
+    
+    // 获取第一个标记
+    parser->current_token = token_at(parser->tokens, 0);
+    int chunk_count = parser->tokens->count / PARALLEL_PARSE_MIN_TOKENS;
+    if (chunk_count > thread_count) {
+        chunk_count = thread_count;
+    }
+    if (chunk_count < 2 || !parse_program_parallel(parser, chunk_count)) {
+        parse_program(parser);
+    }
+}
 
-        // 解析函数参数
-        expect(parser, TOKEN_LPAREN);
-        
-        // 跳过参数列表处理
-        while (!match(parser, TOKEN_RPAREN) && !match(parser, TOKEN_EOF)) {
-            advance(parser);
+void parse_source_parallel(Parser* parser, const char* source, int length, int thread_count) {
+    parse_tokens(parser, source, length, NULL, thread_count);
+}
+
+// 标记在源代码中的终点（字符串字面量的范围不含引号，需计入结束的引号）
+static int token_end(const Token* token) {
+    return token->offset + token->length + (token->type == TOKEN_STRING ? 1 : 0);
+}
+
+// 第一个起始偏移不小于 offset 的标记下标（标记按偏移递增排列）
+static int find_token(const TokenArray* tokens, int offset) {
+    int low = 0;
+    int high = tokens->count - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (token_at(tokens, middle).offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
-        
-        expect(parser, TOKEN_RPAREN);
+    }
+    return low;
+}
 
-        // 解析函数体
-        expect(parser, TOKEN_LBRACE);
-        
-        // 跳过函数体处理
-        while (!match(parser, TOKEN_RBRACE) && !match(parser, TOKEN_EOF)) {
-            advance(parser);
+// 第一个起始标记不小于 token 的顶层声明下标
+static int find_declaration(const ASTNode* program, const TokenArray* tokens, int token) {
+    int low = 0;
+    int high = program->program.declaration_count;
+    int offset = token_at(tokens, token).offset;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (program->program.declarations[middle]->offset < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
-        
-        expect(parser, TOKEN_RBRACE);
+    }
+    return low;
+}
 
-        // 创建函数节点
-        ASTNode* function_node = create_ast_node(NODE_FUNCTION);
-        function_node->type = NODE_FUNCTION;
-        function_node->function.name = function_name;
-        function_node->function.parameters = NULL;
-        function_node->function.param_count = 0;
-        function_node->function.body = NULL;
-        function_node->function.return_type = NULL;
+// 重新切分受编辑影响的标记：从 first 号标记之前的空白开始切分新源代码，
+// 直到新标记与编辑范围之后的某个旧标记在平移后完全一致（标记流重新同步）。
+// 新标记暂存在 relexed 中，返回同步处旧标记的下标，失败或出现词法错误时返回 -1
+static int relex_damaged(Parser* parser, const char* source, int length, int first, int old_edit_end,
+                         int new_edit_end, Token** relexed, int* relexed_count) {
+    const TokenArray* tokens = parser->tokens;
+    int delta = new_edit_end - old_edit_end;
+    int start = 0;
+    if (first > 0) {
+        Token previous = token_at(tokens, first - 1);
+        start = token_end(&previous);
+    }
+    int old_index = find_token(tokens, old_edit_end);
+    int capacity = 64;
+    int count = 0;
+    Token* buffer = (Token*)malloc(sizeof(Token) * capacity);
+    Lexer* lexer = create_lexer(source, length);
+    if (!buffer || !lexer) {
+        free(buffer);
+        destroy_lexer(lexer);
+        return -1;
+    }
+    seek_lexer(lexer, start);
 
-        return function_node;
+    for (;;) {
+        Token token = get_next_token(lexer);
+        if (token.flags & TOKEN_FLAG_ERROR) {
+            // 新的词法错误交给完整解析报告
+            free(buffer);
+            destroy_lexer(lexer);
+            return -1;
+        }
+        if (token.offset >= new_edit_end) {
+            while (old_index < tokens->count - 1 && token_at(tokens, old_index).offset + delta < token.offset) {
+                old_index++;
+            }
+            Token old = token_at(tokens, old_index);
+            if (old.offset + delta == token.offset && old.type == token.type &&
+                old.length == token.length && old.flags == token.flags) {
+                break;
+            }
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            Token* grown = (Token*)realloc(buffer, sizeof(Token) * capacity);
+            if (!grown) {
+                free(buffer);
+                destroy_lexer(lexer);
+                return -1;
+            }
+            buffer = grown;
+        }
+        buffer[count++] = token;
+        if (token.type == TOKEN_EOF) {
+            old_index = tokens->count;
+            break;
+        }
     }
-    return NULL;
+    destroy_lexer(lexer);
+    *relexed = buffer;
+    *relexed_count = count;
+    return old_index;
 }
 
-// 解析语句
-static ASTNode* parse_statement(Parser* parser) {
-    // TODO: 实现语句解析
-    return NULL;
+// 把空隙移到第 index 个标记之前：途经的标记搬到空隙的另一侧，偏移按新的一侧换算
+static void move_token_gap(TokenArray* tokens, int index) {
+    Token* data = tokens->tokens;
+    for (; tokens->gap_start > index; tokens->gap_start--) {
+        Token* token = &data[tokens->gap_start - 1 + tokens->gap_size];
+        *token = data[tokens->gap_start - 1];
+        token->offset -= tokens->gap_delta;
+    }
+    for (; tokens->gap_start < index; tokens->gap_start++) {
+        Token* token = &data[tokens->gap_start];
+        *token = data[tokens->gap_start + tokens->gap_size];
+        token->offset += tokens->gap_delta;
+    }
 }
 
-// 解析表达式
-static ASTNode* parse_expression(Parser* parser) {
-    // TODO: 实现表达式解析
-    return NULL;
+// 用 relexed 中的标记替换 [first, resync)，之后的标记偏移加上 delta。
+// 只搬动上次与本次编辑位置之间的标记，其后的标记留在原处，偏移由 gap_delta 统一修正；
+// 空隙不够大时扩容，此时才整体后移一次
+static int splice_tokens(TokenArray* tokens, int first, int resync, const Token* relexed, int relexed_count,
+                         int delta) {
+    move_token_gap(tokens, first);
+    tokens->gap_size += resync - first;
+    tokens->count -= resync - first;
+    if (tokens->gap_size < relexed_count) {
+        int tail = tokens->count - first;
+        int capacity = (tokens->count + relexed_count) * 2;
+        Token* grown = (Token*)realloc(tokens->tokens, sizeof(Token) * capacity);
+        if (!grown) {
+            return 0;
+        }
+        memmove(&grown[capacity - tail], &grown[first + tokens->gap_size], sizeof(Token) * tail);
+        tokens->tokens = grown;
+        tokens->capacity = capacity;
+        tokens->gap_size = capacity - tail - first;
+    }
+    memcpy(&tokens->tokens[first], relexed, sizeof(Token) * relexed_count);
+    tokens->gap_start = first + relexed_count;
+    tokens->gap_size -= relexed_count;
+    tokens->count += relexed_count;
+    tokens->gap_delta += delta;
+    return 1;
 }
 
-ASTNode* get_ast_root(Parser* parser) {
-    return parser->root;
+// 沿用的声明整体平移：只更新声明自身的偏移与延迟解析的函数体范围，子孙节点的平移记在 shift 中
+static void shift_declaration(ASTNode* declaration, int delta, int token_delta) {
+    declaration->offset += delta;
+    declaration->shift += delta;
+    if (declaration->type == NODE_FUNCTION && function_body_pending(declaration)) {
+        declaration->function.body_start += token_delta;
+        declaration->function.body_end += token_delta;
+    }
+}
+
+// 把声明的 shift 落实到其子孙节点上。延迟解析函数体之前调用：新建节点的偏移取自当前的标记，
+// 已经是平移后的值
+static void settle_shift(Parser* parser, ASTNode* declaration) {
+    int shift = declaration->shift;
+    int base = parser->node_count;
+    if (shift == 0 || !push_node(parser, declaration)) {
+        return;
+    }
+    declaration->shift = 0;
+    while (parser->node_count > base) {
+        ASTNode* node = parser->nodes[--parser->node_count];
+        if (node != declaration) {
+            node->offset += shift;
+        }
+        int children = ast_child_count(node);
+        for (int i = 0; i < children; i++) {
+            ASTNode* child = ast_child(node, i);
+            if (child && !push_node(parser, child)) {
+                break;
+            }
+        }
+    }
+    parser->node_count = base;
+}
+
+// 把被替换的声明的全部节点归还给区域分配器，供之后新建的节点复用。
+// include 节点只归还自身，头文件中的声明由 include 图管理
+static void release_declaration(Parser* parser, ASTNode* declaration) {
+    Arena* arena = parser->ast_arena;
+    int base = parser->node_count;
+    if (!push_node(parser, declaration)) {
+        return;
+    }
+    while (parser->node_count > base) {
+        ASTNode* node = parser->nodes[--parser->node_count];
+        if (node->type != NODE_INCLUDE) {
+            int children = ast_child_count(node);
+            for (int i = 0; i < children; i++) {
+                ASTNode* child = ast_child(node, i);
+                if (child && !push_node(parser, child)) {
+                    parser->node_count = base;
+                    return;
+                }
+            }
+        }
+        switch (node->type) {
+            case NODE_LITERAL:
+                if (node->literal.type == LITERAL_STRING && node->literal.string_value) {
+                    arena_free(arena, node->literal.string_value, strlen(node->literal.string_value) + 1);
+                }
+                break;
+            case NODE_FUNCTION_CALL:
+                arena_free(arena, node->call.arguments, sizeof(ASTNode*) * (size_t)node->call.arg_count);
+                break;
+            case NODE_FUNCTION:
+                arena_free(arena, node->function.parameters, sizeof(ASTNode*) * (size_t)node->function.param_count);
+                break;
+            case NODE_BLOCK:
+                arena_free(arena, node->block.statements, sizeof(ASTNode*) * (size_t)node->block.statement_count);
+                break;
+            case NODE_INCLUDE:
+                if (node->include.filename) {
+                    arena_free(arena, node->include.filename, strlen(node->include.filename) + 1);
+                }
+                break;
+            default:
+                break;
+        }
+        arena_free(arena, node, sizeof(ASTNode));
+    }
+}
+
+void reparse_source(Parser* parser, const char* source, int length, int edit_start, int old_edit_end, int new_edit_end) {
+    if (!parser) {
+        return;
+    }
+    // 只有上一次无错误地解析过内存中的源代码时才能增量解析，否则退回完整解析
+    ASTNode* program = parser->root;
+    TokenArray* tokens = parser->tokens;
+    int old_length = parser->lexer && tokens ? parser->lexer->length : -1;
+    if (!source || !program || program->type != NODE_PROGRAM || !tokens || parser->error_message ||
+        edit_start < 0 || old_edit_end < edit_start || new_edit_end < edit_start || old_edit_end > old_length ||
+        length != old_length + (new_edit_end - old_edit_end)) {
+        parse_source(parser, source, length);
+        return;
+    }
+    int delta = new_edit_end - old_edit_end;
+
+    // 末尾在编辑起点之前的标记不受影响；再多退两个标记，覆盖词法分析器越过标记末尾的前瞻
+    int first = find_token(tokens, edit_start);
+    for (; first > 0; first--) {
+        Token previous = token_at(tokens, first - 1);
+        if (token_end(&previous) < edit_start) {
+            break;
+        }
+    }
+    first = first > 2 ? first - 2 : 0;
+
+    Token* relexed = NULL;
+    int relexed_count = 0;
+    int resync = relex_damaged(parser, source, length, first, old_edit_end, new_edit_end, &relexed, &relexed_count);
+    if (resync < 0) {
+        parse_source(parser, source, length);
+        return;
+    }
+    int token_delta = first + relexed_count - resync;
+
+    // 重新解析的声明 [begin, end)：begin 之前的声明连同其前瞻都只读到未受影响的标记，
+    // end 起的声明位于同步点之后，候选的结束边界稍后在新标记中确认
+    int declaration_count = program->program.declaration_count;
+    ASTNode** declarations = program->program.declarations;
+    int begin = find_declaration(program, tokens, first > PARSER_MAX_LOOKAHEAD ? first - PARSER_MAX_LOOKAHEAD : 0) - 1;
+    int region_start = 0;
+    if (begin < 0) {
+        begin = 0;
+    } else {
+        // 从声明前面的修饰符开始重新解析，否则 tailrec、pub 等修饰符会丢失
+        int floor = begin > 0 ? find_token(tokens, declarations[begin - 1]->offset) + 1 : 0;
+        region_start = declaration_start(tokens, find_token(tokens, declarations[begin]->offset), floor);
+    }
+    int end = resync < tokens->count ? find_declaration(program, tokens, resync) : declaration_count;
+
+    // 在间隙缓冲区中用重新切分的标记替换受影响的标记
+    int splice_failed = !splice_tokens(tokens, first, resync, relexed, relexed_count, delta);
+    free(relexed);
+    if (splice_failed) {
+        parse_source(parser, source, length);
+        return;
+    }
+    int count = tokens->count;
+    tokens->source = source;
+
+    // 词法分析器只用于换算错误位置，换成引用新源代码的一个
+    Lexer* lexer = create_lexer(source, length);
+    if (!lexer) {
+        parse_source(parser, source, length);
+        return;
+    }
+    destroy_lexer(parser->lexer);
+    parser->lexer = lexer;
+
+    // 结束边界是括号深度为0、从新的一行开始的函数声明（与并行解析的分段规则一致），否则继续向后扩展
+    int region_end = count - 1;
+    Nesting nesting = { 0, 0 };
+    int scanned = region_start;
+    for (; end < declaration_count; end++) {
+        ASTNode* declaration = declarations[end];
+        int boundary = find_token(tokens, declaration->offset + delta);
+        for (; scanned < boundary; scanned++) {
+            nest(&nesting, (TokenType)token_at(tokens, scanned).type);
+        }
+        if (at_top_level(&nesting) && declaration->type == NODE_FUNCTION &&
+            starts_line(tokens, declaration_start(tokens, boundary, region_start))) {
+            region_end = boundary;
+            break;
+        }
+    }
+
+    // 被替换的声明的节点归还给区域分配器，重新解析时即可复用
+    for (int i = begin; i < end; i++) {
+        release_declaration(parser, declarations[i]);
+    }
+
+    // 只解析 [region_start, region_end) 中的标记，前后的声明原样沿用
+    parser->position = region_start;
+    parser->token_limit = region_end;
+    parser->limit_token = token_at(tokens, region_end);
+    parser->limit_token.type = TOKEN_EOF;
+    parser->current_token = region_start < region_end ? token_at(tokens, region_start) : parser->limit_token;
+
+    int base = parser->node_count;
+    parse_declarations(parser);
+    int parsed = parser->node_count - base;
+
+    // 在原来的程序节点中拼接声明列表，声明个数不变时就地替换
+    int suffix = declaration_count - end;
+    int new_count = begin + parsed + suffix;
+    ASTNode** list = declarations;
+    if (new_count != declaration_count) {
+        list = new_count > 0 ? (ASTNode**)arena_alloc(parser->ast_arena, sizeof(ASTNode*) * (size_t)new_count) : NULL;
+        if (new_count > 0 && !list) {
+            parser->node_count = base;
+            report_memory_error(parser);
+            return;
+        }
+        if (list) {
+            memcpy(list, declarations, sizeof(ASTNode*) * (size_t)begin);
+            memcpy(list + begin + parsed, declarations + end, sizeof(ASTNode*) * (size_t)suffix);
+        }
+        arena_free(parser->ast_arena, declarations, sizeof(ASTNode*) * (size_t)declaration_count);
+    }
+    if (parsed > 0) {
+        memcpy(list + begin, &parser->nodes[base], sizeof(ASTNode*) * (size_t)parsed);
+    }
+    parser->node_count = base;
+    if (delta != 0 || token_delta != 0) {
+        for (int i = begin + parsed; i < new_count; i++) {
+            shift_declaration(list[i], delta, token_delta);
+        }
+    }
+    program->program.declarations = list;
+    program->program.declaration_count = new_count;
+
+    parser->position = count - 1;
+    parser->token_limit = count - 1;
+    parser->limit_token = token_at(tokens, count - 1);
+    parser->current_token = parser->limit_token;
+}
+
+void parse_stream(Parser* parser, FILE* stream) {
+    if (!parser || !stream) {
+        if (parser) {
+            parser->error_message = strdup("无效的输入流或解析器");
+        }
+        return;
+    }
+    
+    reset_parser(parser);
+    parser->lexer = create_stream_lexer(stream, LEXER_DEFAULT_WINDOW_SIZE);
+    if (!parser->lexer || !parser->ast_arena) {
+        parser->error_message = strdup("内存分配错误：无法创建词法分析器");
+        return;
+    }
+    
+    parser->lexer->keep_input = parser->keep_stream_input;
+    
+    parser->current_token = read_stream_token(parser);
+    parse_program(parser);
+}
+
+void set_keep_stream_input(Parser* parser, int enabled) {
+    if (parser) {
+        parser->keep_stream_input = enabled;
+    }
+}
+
+char* take_stream_input(Parser* parser, int* length) {
+    *length = 0;
+    return parser && parser->lexer ? take_lexer_input(parser->lexer, length) : NULL;
+}
+
+Parser* create_parser() {
+    Parser* parser = (Parser*)malloc(sizeof(Parser));
+    if (parser) {
+        parser->lexer = NULL;
+        parser->tokens = NULL;
+        parser->position = 0;
+        parser->token_limit = 0;
+        parser->root = NULL;
+        parser->lazy_bodies = 1;
+        parser->keep_stream_input = 0;
+        parser->header_mode = 0;
+        parser->ast_arena = NULL;
+        parser->error_message = NULL;
+        parser->error = PARSER_ERROR_NONE;
+        parser->frames = NULL;
+        parser->frame_count = 0;
+        parser->frame_capacity = 0;
+        parser->nodes = NULL;
+        parser->node_count = 0;
+        parser->node_capacity = 0;
+        parser->lookahead_head = 0;
+        parser->lookahead_count = 0;
+        parser->type_parameter_count = 0;
+        parser->type_depth = 0;
+        parser->split_greater = 0;
+        parser->current_token.type = TOKEN_UNKNOWN;
+        parser->current_token.flags = 0;
+        parser->current_token.offset = 0;
+        parser->current_token.length = 0;
+        parser->current_token.symbol = SYMBOL_NONE;
+        parser->limit_token = parser->current_token;
+        parser->limit_token.type = TOKEN_EOF;
+    }
+    return parser;
+}
+
+void destroy_parser(Parser* parser) {
+    if (parser) {
+        if (parser->tokens) {
+            destroy_token_array(parser->tokens);
+        }
+        if (parser->lexer) {
+            destroy_lexer(parser->lexer);
+        }
+        // AST的全部节点随区域分配器一次性释放
+        destroy_arena(parser->ast_arena);
+        if (parser->error_message) {
+            free(parser->error_message);
+        }
+        free(parser->frames);
+        free(parser->nodes);
+        free(parser);
+    }
+}
+
+// 可以用作名字的标记：标识符，以及 is_name_keyword 中的关键字（其文本已预先驻留）
+static Symbol token_name(const Token* token) {
+    if (token->type == TOKEN_IDENTIFIER) {
+        return token->symbol;
+    }
+    if (is_name_keyword((TokenType)token->type)) {
+        const char* text = keyword_text((TokenType)token->type);
+        return find_symbol(text, (int)strlen(text));
+    }
+    return SYMBOL_NONE;
+}
+
+#define PARSER_MAX_TYPE_LENGTH 256
+
+static TypeId parse_type_term(Parser* parser);
+
+// 名字是否为当前可见的泛型参数
+static int is_type_parameter(const Parser* parser, Symbol name) {
+    for (int i = 0; i < parser->type_parameter_count; i++) {
+        if (parser->type_parameters[i] == name) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 消费泛型实参列表的结束符 '>'：">>" 同时结束两层列表，内层只消费其中一半
+static int accept_closing_angle(Parser* parser) {
+    if (match(parser, TOKEN_GREATER)) {
+        advance(parser);
+        return 1;
+    }
+    if (!match(parser, TOKEN_SHIFT_RIGHT)) {
+        return 0;
+    }
+    if (parser->split_greater) {
+        parser->split_greater = 0;
+        advance(parser);
+    } else {
+        parser->split_greater = 1;
+    }
+    return 1;
+}
+
+// 逗号分隔的类型列表，存入 types（最多 capacity 个），返回个数，出错返回 -1
+static int parse_type_list(Parser* parser, TypeId* types, int capacity) {
+    int count = 0;
+    do {
+        if (count == capacity) {
+            report_error(parser, "语法错误：类型参数过多");
+            return -1;
+        }
+        if ((types[count++] = parse_type_term(parser)) == TYPE_NONE) {
+            return -1;
+        }
+    } while (accept_token(parser, TOKEN_COMMA));
+    return count;
+}
+
+// 数组类型的长度：十进制整数字面量，可以带 '_' 分隔与整数后缀（如 4usize）
+static int parse_array_length(Parser* parser, uint64_t* length) {
+    const Token* token = &parser->current_token;
+    if (token->type != TOKEN_NUMBER) {
+        return 0;
+    }
+    const char* text = token_text(parser->lexer->source, token);
+    uint64_t value = 0;
+    int digits = 0;
+    int i = 0;
+    for (; i < token->length && ((text[i] >= '0' && text[i] <= '9') || text[i] == '_'); i++) {
+        if (text[i] == '_') continue;
+        if (value > (UINT64_MAX - 9) / 10) return 0;
+        value = value * 10 + (uint64_t)(text[i] - '0');
+        digits++;
+    }
+    if (digits == 0 || (i < token->length && text[i] != 'i' && text[i] != 'u')) {
+        return 0;
+    }
+    *length = value;
+    advance(parser);
+    return 1;
+}
+
+// 具名类型：基本类型关键字、泛型参数名，或带泛型实参的 名字 "<" 类型列表 ">"
+static TypeId parse_named_type(Parser* parser) {
+    const Token* token = &parser->current_token;
+    int offset = token->offset;
+    Symbol symbol = token_name(token);
+    const char* name;
+    int length;
+    if (symbol != SYMBOL_NONE) {
+        name = symbol_name(symbol);
+        length = symbol_length(symbol);
+    } else if ((name = keyword_text((TokenType)token->type)) != NULL) {
+        length = (int)strlen(name);
+    } else {
+        report_error(parser, "语法错误：期望类型");
+        return TYPE_NONE;
+    }
+    advance(parser);
+
+    if (length == 5 && memcmp(name, "slice", 5) == 0 && accept_token(parser, TOKEN_LPAREN)) {
+        TypeId element = parse_type_term(parser);
+        if (element == TYPE_NONE) {
+            return TYPE_NONE;
+        }
+        if (!accept_token(parser, TOKEN_RPAREN)) {
+            report_error(parser, "语法错误：期望 ')'");
+            return TYPE_NONE;
+        }
+        return slice_type(element);
+    }
+
+    TypeId type = named_type(name, length);
+    if (type == TYPE_NONE) {
+        report_memory_error(parser);
+        return TYPE_NONE;
+    }
+    if (type_kind(type) == TYPE_KIND_NAMED && !is_type_parameter(parser, symbol)) {
+        char message[PARSER_MAX_TYPE_LENGTH];
+        snprintf(message, sizeof(message), "未知的类型: %.*s", length, name);
+        report_error_at(parser, offset, message);
+        return TYPE_NONE;
+    }
+    if (!accept_token(parser, TOKEN_LESS)) {
+        return type;
+    }
+    TypeId arguments[PARSER_MAX_TYPE_PARAMETERS];
+    int count = parse_type_list(parser, arguments, PARSER_MAX_TYPE_PARAMETERS);
+    if (count < 0) {
+        return TYPE_NONE;
+    }
+    if (!accept_closing_angle(parser)) {
+        report_error(parser, "语法错误：期望 '>'");
+        return TYPE_NONE;
+    }
+    return generic_type(type, arguments, count);
+}
+
+// 基本项："(" 类型列表? ")" | "[" 类型 ";" 长度 "]" | "!" | 具名类型
+static TypeId parse_type_primary(Parser* parser) {
+    if (accept_token(parser, TOKEN_LPAREN)) {
+        if (accept_token(parser, TOKEN_RPAREN)) {
+            return TYPE_UNIT;
+        }
+        TypeId elements[PARSER_MAX_TYPE_PARAMETERS];
+        int count = parse_type_list(parser, elements, PARSER_MAX_TYPE_PARAMETERS);
+        if (count < 0) {
+            return TYPE_NONE;
+        }
+        if (!accept_token(parser, TOKEN_RPAREN)) {
+            report_error(parser, "语法错误：期望 ')'");
+            return TYPE_NONE;
+        }
+        // 单个类型加括号只是分组
+        return count == 1 ? elements[0] : tuple_type(elements, count);
+    }
+    if (accept_token(parser, TOKEN_LBRACKET)) {
+        TypeId element = parse_type_term(parser);
+        if (element == TYPE_NONE) {
+            return TYPE_NONE;
+        }
+        uint64_t length = 0;
+        if (!accept_token(parser, TOKEN_SEMICOLON) || !parse_array_length(parser, &length)) {
+            report_error(parser, "语法错误：数组类型应为 [类型; 长度]");
+            return TYPE_NONE;
+        }
+        if (!accept_token(parser, TOKEN_RBRACKET)) {
+            report_error(parser, "语法错误：期望 ']'");
+            return TYPE_NONE;
+        }
+        return array_type(element, length);
+    }
+    if (accept_token(parser, TOKEN_NOT)) {
+        return TYPE_NEVER;
+    }
+    return parse_named_type(parser);
+}
+
+// 类型：基本项之后跟任意个 '?'
+static TypeId parse_type_term(Parser* parser) {
+    if (parser->type_depth >= PARSER_MAX_TYPE_DEPTH) {
+        report_error(parser, "语法错误：类型嵌套过深");
+        return TYPE_NONE;
+    }
+    parser->type_depth++;
+    TypeId type = parse_type_primary(parser);
+    while (type != TYPE_NONE && !parser->split_greater && accept_token(parser, TOKEN_TYPE_NULLABLE)) {
+        type = nullable_type(type);
+    }
+    parser->type_depth--;
+    return type;
+}
+
+// 解析一个完整的类型，由类型驻留表的构造函数逐层构造，失败时返回 TYPE_NONE。
+// 名字必须是已知的类型或泛型参数；类型之后同一行紧跟名字或字面量说明写法有误（如 "u 8"）
+static TypeId parse_type(Parser* parser) {
+    TypeId type = parse_type_term(parser);
+    if (parser->split_greater) {
+        parser->split_greater = 0;
+        if (type != TYPE_NONE) {
+            report_error(parser, "语法错误：类型中多余的 '>'");
+            return TYPE_NONE;
+        }
+    }
+    if (type == TYPE_NONE) {
+        return TYPE_NONE;
+    }
+    const Token* next = &parser->current_token;
+    if (!newline_before(parser) &&
+        (next->type == TOKEN_NUMBER || next->type == TOKEN_STRING || token_name(next) != SYMBOL_NONE ||
+         ((TokenType)next->type >= TOKEN_TYPE_INT && (TokenType)next->type <= TOKEN_TYPE_SLICE))) {
+        report_error(parser, "语法错误：类型之后出现意外的标记");
+        return TYPE_NONE;
+    }
+    return type;
+}
+
+// ---------------------------------------------------------------------------
+// 表达式：单一的优先级爬升（Pratt）循环
+//
+// 二元运算符的结合力取自 scp.ebnf 中各级表达式的优先级，由低到高排列；
+// 位运算、区间、移位与 ?: 在文法中没有单独的层级，按 Kotlin 的习惯插入。
+// 左结合运算符的右结合力比左结合力大 1，右结合的赋值两者相等：
+// 新运算符到来时，先规约栈上右结合力大于其左结合力的运算符。
+// 前缀运算符的右结合力高于所有二元运算符；后缀运算符（成员访问、调用、下标、
+// ++/--、!!）直接作用于栈顶操作数，因此结合得最紧。
+// 运算符与括号都保存在解析器的显式栈上，嵌套再深也不会耗尽调用栈，
+// 每个标记只入栈、出栈各一次，解析时间与表达式长度成线性关系。
+// ---------------------------------------------------------------------------
+
+#define BP_ASSIGN          2
+#define BP_OR              4
+#define BP_AND             6
+#define BP_BIT_OR          8
+#define BP_BIT_XOR        10
+#define BP_BIT_AND        12
+#define BP_EQUALITY       14
+#define BP_RELATIONAL     16
+#define BP_ELVIS          18
+#define BP_SHIFT          20
+#define BP_RANGE          22
+#define BP_ADDITIVE       24
+#define BP_MULTIPLICATIVE 26
+#define BP_PREFIX         28
+
+typedef struct {
+    uint8_t op;          // OperatorType
+    uint8_t left_bp;     // 左结合力，0 表示该标记不是二元运算符
+    uint8_t right_bp;    // 右结合力
+} InfixOperator;
+
+#define LEFT_ASSOC(op, bp)  { op, bp, bp + 1 }
+#define RIGHT_ASSOC(op, bp) { op, bp, bp }
+
+static const InfixOperator infix_operators[TOKEN_COMMENT_MULTI + 1] = {
+    [TOKEN_ASSIGN]             = RIGHT_ASSOC(OP_ASSIGN, BP_ASSIGN),
+    [TOKEN_PLUS_ASSIGN]        = RIGHT_ASSOC(OP_ADD_ASSIGN, BP_ASSIGN),
+    [TOKEN_MINUS_ASSIGN]       = RIGHT_ASSOC(OP_SUB_ASSIGN, BP_ASSIGN),
+    [TOKEN_MULTIPLY_ASSIGN]    = RIGHT_ASSOC(OP_MUL_ASSIGN, BP_ASSIGN),
+    [TOKEN_DIVIDE_ASSIGN]      = RIGHT_ASSOC(OP_DIV_ASSIGN, BP_ASSIGN),
+    [TOKEN_MOD_ASSIGN]         = RIGHT_ASSOC(OP_MOD_ASSIGN, BP_ASSIGN),
+    [TOKEN_AND_ASSIGN]         = RIGHT_ASSOC(OP_AND_ASSIGN, BP_ASSIGN),
+    [TOKEN_OR_ASSIGN]          = RIGHT_ASSOC(OP_OR_ASSIGN, BP_ASSIGN),
+    [TOKEN_XOR_ASSIGN]         = RIGHT_ASSOC(OP_XOR_ASSIGN, BP_ASSIGN),
+    [TOKEN_SHIFT_LEFT_ASSIGN]  = RIGHT_ASSOC(OP_SHIFT_LEFT_ASSIGN, BP_ASSIGN),
+    [TOKEN_SHIFT_RIGHT_ASSIGN] = RIGHT_ASSOC(OP_SHIFT_RIGHT_ASSIGN, BP_ASSIGN),
+    [TOKEN_OR]                 = LEFT_ASSOC(OP_OR, BP_OR),
+    [TOKEN_AND]                = LEFT_ASSOC(OP_AND, BP_AND),
+    [TOKEN_BIT_OR]             = LEFT_ASSOC(OP_BIT_OR, BP_BIT_OR),
+    [TOKEN_BIT_XOR]            = LEFT_ASSOC(OP_BIT_XOR, BP_BIT_XOR),
+    [TOKEN_BIT_AND]            = LEFT_ASSOC(OP_BIT_AND, BP_BIT_AND),
+    [TOKEN_EQUAL]              = LEFT_ASSOC(OP_EQ, BP_EQUALITY),
+    [TOKEN_NOT_EQUAL]          = LEFT_ASSOC(OP_NEQ, BP_EQUALITY),
+    [TOKEN_LESS]               = LEFT_ASSOC(OP_LT, BP_RELATIONAL),
+    [TOKEN_LESS_EQUAL]         = LEFT_ASSOC(OP_LTE, BP_RELATIONAL),
+    [TOKEN_GREATER]            = LEFT_ASSOC(OP_GT, BP_RELATIONAL),
+    [TOKEN_GREATER_EQUAL]      = LEFT_ASSOC(OP_GTE, BP_RELATIONAL),
+    [TOKEN_ELVIS]              = LEFT_ASSOC(OP_ELVIS, BP_ELVIS),
+    [TOKEN_SHIFT_LEFT]         = LEFT_ASSOC(OP_SHIFT_LEFT, BP_SHIFT),
+    [TOKEN_SHIFT_RIGHT]        = LEFT_ASSOC(OP_SHIFT_RIGHT, BP_SHIFT),
+    [TOKEN_RANGE]              = LEFT_ASSOC(OP_RANGE, BP_RANGE),
+    [TOKEN_RANGE_TO]           = LEFT_ASSOC(OP_RANGE_TO, BP_RANGE),
+    [TOKEN_RANGE_INCL]         = LEFT_ASSOC(OP_RANGE_INCL, BP_RANGE),
+    [TOKEN_PLUS]               = LEFT_ASSOC(OP_ADD, BP_ADDITIVE),
+    [TOKEN_MINUS]              = LEFT_ASSOC(OP_SUB, BP_ADDITIVE),
+    [TOKEN_MULTIPLY]           = LEFT_ASSOC(OP_MUL, BP_MULTIPLICATIVE),
+    [TOKEN_DIVIDE]             = LEFT_ASSOC(OP_DIV, BP_MULTIPLICATIVE),
+    [TOKEN_MOD]                = LEFT_ASSOC(OP_MOD, BP_MULTIPLICATIVE),
+};
+
+// 前缀运算符
+static int prefix_operator(TokenType type, OperatorType* op) {
+    switch (type) {
+        case TOKEN_MINUS:     *op = OP_NEG; return 1;
+        case TOKEN_PLUS:      *op = OP_PLUS; return 1;
+        case TOKEN_NOT:       *op = OP_NOT; return 1;
+        case TOKEN_BIT_NOT:   *op = OP_BIT_NOT; return 1;
+        case TOKEN_INCREMENT: *op = OP_PRE_INC; return 1;
+        case TOKEN_DECREMENT: *op = OP_PRE_DEC; return 1;
+        default:              return 0;
+    }
+}
+
+// 规约栈顶的运算符帧：弹出其操作数，压入新建的运算节点
+static int reduce_frame(Parser* parser) {
+    ExprFrame frame = parser->frames[--parser->frame_count];
+    ASTNode* node;
+    if (frame.kind == FRAME_PREFIX) {
+        ASTNode* operand = parser->nodes[--parser->node_count];
+        node = create_unary_op(parser->ast_arena, (OperatorType)frame.op, operand);
+    } else {
+        ASTNode* right = parser->nodes[--parser->node_count];
+        ASTNode* left = parser->nodes[--parser->node_count];
+        node = create_binary_op(parser->ast_arena, (OperatorType)frame.op, left, right);
+    }
+    if (node) {
+        node->offset = frame.offset;
+    }
+    return push_node(parser, node);
+}
+
+// 规约右结合力大于 left_bp 的运算符帧，遇到括号帧即停止（left_bp 为 0 时规约到最近的括号）
+static int reduce_operators(Parser* parser, int frame_base, int left_bp) {
+    while (parser->frame_count > frame_base) {
+        const ExprFrame* top = &parser->frames[parser->frame_count - 1];
+        if (top->kind != FRAME_BINARY && top->kind != FRAME_PREFIX) break;
+        if (top->right_bp <= left_bp) break;
+        if (!reduce_frame(parser)) return 0;
+    }
+    return 1;
+}
+
+// 以后缀运算符包装栈顶操作数
+static int apply_postfix(Parser* parser, OperatorType op, int offset) {
+    ASTNode** top = &parser->nodes[parser->node_count - 1];
+    ASTNode* node = create_unary_op(parser->ast_arena, op, *top);
+    if (!node) {
+        report_memory_error(parser);
+        return 0;
+    }
+    node->offset = offset;
+    *top = node;
+    return 1;
+}
+
+// 闭合函数调用：被调用者位于节点栈 frame->node_base - 1 处，其后为实参。
+// 被调用者为成员访问 a.f(...) 时按方法调用处理，接收者作为第一个实参；a::f(...) 按路径取名
+static int finish_call(Parser* parser, const ExprFrame* frame) {
+    int callee_index = frame->node_base - 1;
+    ASTNode* callee = parser->nodes[callee_index];
+    int first = frame->node_base;
+    Symbol name = SYMBOL_NONE;
+
+    if (callee->type == NODE_VARIABLE) {
+        name = callee->variable.name;
+    } else if (callee->type == NODE_BINARY_OP && callee->binary_op.right &&
+               callee->binary_op.right->type == NODE_VARIABLE &&
+               (callee->binary_op.op == OP_MEMBER || callee->binary_op.op == OP_SAFE_MEMBER ||
+                callee->binary_op.op == OP_SCOPE)) {
+        name = callee->binary_op.right->variable.name;
+        if (callee->binary_op.op != OP_SCOPE) {
+            parser->nodes[callee_index] = callee->binary_op.left;
+            first = callee_index;
+        }
+    }
+    if (name == SYMBOL_NONE) {
+        report_error(parser, "语法错误：该表达式不能被调用");
+        return 0;
+    }
+
+    ASTNode* call = create_function_call(parser->ast_arena, name, &parser->nodes[first], parser->node_count - first);
+    if (call) {
+        call->offset = callee->offset;
+    }
+    parser->node_count = callee_index;
+    return push_node(parser, call);
+}
+
+// 数字字面量：带小数点的为浮点数
+static ASTNode* parse_number(Parser* parser, const Token* token) {
+    char text[64];
+    int length = token->length < (int)sizeof(text) - 1 ? token->length : (int)sizeof(text) - 1;
+    memcpy(text, token_text(parser->lexer->source, token), (size_t)length);
+    text[length] = '\0';
+    if (memchr(text, '.', (size_t)length)) {
+        return create_float_literal(parser->ast_arena, strtod(text, NULL));
+    }
+    return create_int_literal(parser->ast_arena, (long long)strtoull(text, NULL, 10));
+}
+
+// 主表达式：字面量或名字
+static ASTNode* parse_primary(Parser* parser) {
+    Token token = parser->current_token;
+    ASTNode* node;
+    switch (token.type) {
+        case TOKEN_NUMBER:
+            node = parse_number(parser, &token);
+            break;
+        case TOKEN_STRING:
+            node = create_string_literal(parser->ast_arena, token_text(parser->lexer->source, &token), token.length);
+            break;
+        case TOKEN_KEYWORD_TRUE:
+        case TOKEN_KEYWORD_FALSE:
+            node = create_bool_literal(parser->ast_arena, token.type == TOKEN_KEYWORD_TRUE);
+            break;
+        case TOKEN_KEYWORD_NULL:
+            node = create_null_literal(parser->ast_arena);
+            break;
+        default: {
+            Symbol name = token_name(&token);
+            if (name == SYMBOL_NONE) {
+                report_error(parser, "语法错误：期望表达式");
+                return NULL;
+            }
+            node = create_variable(parser->ast_arena, name);
+            break;
+        }
+    }
+    if (!node) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    node->offset = token.offset;
+    advance(parser);
+    return node;
+}
+
+// 解析表达式。括号之外，换行之后的 '(' '[' '++' '--' 以及二元 '+' '-' 不再延续当前表达式
+static ASTNode* parse_expression(Parser* parser) {
+    int frame_base = parser->frame_count;
+    int node_base = parser->node_count;
+    int nesting = 0;          // 本表达式中尚未闭合的括号数
+    int expect_operand = 1;   // 处于前缀位置（等待操作数）还是中缀位置
+
+    for (;;) {
+        Token token = parser->current_token;
+        TokenType type = (TokenType)token.type;
+
+        if (expect_operand) {
+            OperatorType op;
+            if (prefix_operator(type, &op)) {
+                if (!push_frame(parser, FRAME_PREFIX, op, BP_PREFIX, token.offset)) goto fail;
+                advance(parser);
+            } else if (type == TOKEN_LPAREN) {
+                if (!push_frame(parser, FRAME_GROUP, OP_ADD, 0, token.offset)) goto fail;
+                nesting++;
+                advance(parser);
+            } else {
+                if (!push_node(parser, parse_primary(parser))) goto fail;
+                expect_operand = 0;
+            }
+            continue;
+        }
+
+        int line_break = nesting == 0 && (token.flags & TOKEN_FLAG_NEWLINE_BEFORE);
+        switch (type) {
+            case TOKEN_DOT:
+            case TOKEN_SAFE_ACCESS:
+            case TOKEN_DOUBLE_COLON: {
+                OperatorType op = type == TOKEN_DOT ? OP_MEMBER : type == TOKEN_SAFE_ACCESS ? OP_SAFE_MEMBER : OP_SCOPE;
+                advance(parser);
+                Symbol member = token_name(&parser->current_token);
+                if (member == SYMBOL_NONE) {
+                    report_error(parser, "语法错误：期望成员名");
+                    goto fail;
+                }
+                ASTNode* name = create_variable(parser->ast_arena, member);
+                ASTNode** top = &parser->nodes[parser->node_count - 1];
+                ASTNode* node = name ? create_binary_op(parser->ast_arena, op, *top, name) : NULL;
+                if (!node) {
+                    report_memory_error(parser);
+                    goto fail;
+                }
+                name->offset = parser->current_token.offset;
+                node->offset = token.offset;
+                *top = node;
+                advance(parser);
+                continue;
+            }
+            case TOKEN_NOTNULL:
+                if (!apply_postfix(parser, OP_NOT_NULL, token.offset)) goto fail;
+                advance(parser);
+                continue;
+            case TOKEN_INCREMENT:
+            case TOKEN_DECREMENT:
+                if (line_break) goto done;
+                if (!apply_postfix(parser, type == TOKEN_INCREMENT ? OP_POST_INC : OP_POST_DEC, token.offset)) goto fail;
+                advance(parser);
+                continue;
+            case TOKEN_LPAREN:
+                if (line_break) goto done;
+                if (!push_frame(parser, FRAME_CALL, OP_ADD, 0, token.offset)) goto fail;
+                nesting++;
+                advance(parser);
+                if (match(parser, TOKEN_RPAREN)) {
+                    // 无实参的调用
+                    ExprFrame frame = parser->frames[--parser->frame_count];
+                    nesting--;
+                    if (!finish_call(parser, &frame)) goto fail;
+                    advance(parser);
+                } else {
+                    expect_operand = 1;
+                }
+                continue;
+            case TOKEN_LBRACKET:
+                if (line_break) goto done;
+                if (!push_frame(parser, FRAME_INDEX, OP_INDEX, 0, token.offset)) goto fail;
+                nesting++;
+                advance(parser);
+                expect_operand = 1;
+                continue;
+            case TOKEN_RPAREN:
+            case TOKEN_RBRACKET:
+            case TOKEN_COMMA: {
+                // 不属于本表达式的右括号或逗号（如 if 条件的右括号、实参之间的逗号）结束表达式
+                if (nesting == 0) goto done;
+                if (!reduce_operators(parser, frame_base, 0)) goto fail;
+                ExprFrame frame = parser->frames[parser->frame_count - 1];
+                if (type == TOKEN_COMMA) {
+                    if (frame.kind != FRAME_CALL) {
+                        report_error(parser, "语法错误：意外的 ','");
+                        goto fail;
+                    }
+                    advance(parser);
+                    expect_operand = 1;
+                    continue;
+                }
+                if (type == TOKEN_RPAREN && frame.kind == FRAME_INDEX) {
+                    report_error(parser, "语法错误：期望 ']'");
+                    goto fail;
+                }
+                if (type == TOKEN_RBRACKET && frame.kind != FRAME_INDEX) {
+                    report_error(parser, "语法错误：期望 ')'");
+                    goto fail;
+                }
+                parser->frame_count--;
+                nesting--;
+                if (frame.kind == FRAME_CALL) {
+                    if (!finish_call(parser, &frame)) goto fail;
+                } else if (frame.kind == FRAME_INDEX) {
+                    ASTNode* index = parser->nodes[--parser->node_count];
+                    ASTNode* base = parser->nodes[--parser->node_count];
+                    ASTNode* node = create_binary_op(parser->ast_arena, OP_INDEX, base, index);
+                    if (node) {
+                        node->offset = frame.offset;
+                    }
+                    if (!push_node(parser, node)) goto fail;
+                }
+                advance(parser);
+                continue;
+            }
+            default: {
+                if (type > TOKEN_COMMENT_MULTI || infix_operators[type].left_bp == 0) goto done;
+                const InfixOperator* infix = &infix_operators[type];
+                if (line_break && (type == TOKEN_PLUS || type == TOKEN_MINUS)) goto done;
+                if (!reduce_operators(parser, frame_base, infix->left_bp)) goto fail;
+                if (!push_frame(parser, FRAME_BINARY, (OperatorType)infix->op, infix->right_bp, token.offset)) goto fail;
+                advance(parser);
+                expect_operand = 1;
+                continue;
+            }
+        }
+    }
+
+done:
+    if (nesting > 0) {
+        report_error(parser, "语法错误：括号不匹配");
+        goto fail;
+    }
+    if (!reduce_operators(parser, frame_base, 0)) goto fail;
+    return parser->nodes[--parser->node_count];
+
+fail:
+    parser->frame_count = frame_base;
+    parser->node_count = node_base;
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// 语句
+// ---------------------------------------------------------------------------
+
+// 出错后跳到下一条语句的开头：换行或 ';' 之后，或者所在代码块的 '}' 处
+static void synchronize(Parser* parser) {
+    if (!match(parser, TOKEN_RBRACE) && !match(parser, TOKEN_EOF)) {
+        advance(parser);
+    }
+    while (!match(parser, TOKEN_RBRACE) && !match(parser, TOKEN_EOF) && !newline_before(parser)) {
+        if (accept_token(parser, TOKEN_SEMICOLON)) {
+            return;
+        }
+        advance(parser);
+    }
+}
+
+// 简单语句以换行、';'、所在代码块的 '}' 或 if 分支后的 else 结束
+static int end_statement(Parser* parser) {
+    if (accept_token(parser, TOKEN_SEMICOLON) || match(parser, TOKEN_RBRACE) ||
+        match(parser, TOKEN_KEYWORD_ELSE) || (match(parser, TOKEN_EOF) && !at_range_limit(parser)) ||
+        newline_before(parser)) {
+        return 1;
+    }
+    report_error(parser, "语法错误：语句之后应换行或使用 ';'");
+    return 0;
+}
+
+// "(" 表达式 ")"
+static ASTNode* parse_condition(Parser* parser) {
+    if (!accept_token(parser, TOKEN_LPAREN)) {
+        report_error(parser, "语法错误：期望 '('");
+        return NULL;
+    }
+    ASTNode* condition = parse_expression(parser);
+    if (condition && !accept_token(parser, TOKEN_RPAREN)) {
+        report_error(parser, "语法错误：期望 ')'");
+        return NULL;
+    }
+    return condition;
+}
+
+// "{" 语句* "}"
+static ASTNode* parse_block(Parser* parser) {
+    int offset = parser->current_token.offset;
+    if (!accept_token(parser, TOKEN_LBRACE)) {
+        report_error(parser, "语法错误：期望 '{'");
+        return NULL;
+    }
+
+    // 语句先收集在节点栈中，代码块结束时一次性复制进 arena
+    int base = parser->node_count;
+    while (!match(parser, TOKEN_RBRACE) && !match(parser, TOKEN_EOF)) {
+        ASTNode* statement = parse_statement(parser);
+        if (statement && !push_node(parser, statement)) {
+            break;
+        }
+    }
+    if (!accept_token(parser, TOKEN_RBRACE)) {
+        report_error(parser, "语法错误：代码块缺少 '}'");
+    }
+
+    ASTNode* block = create_block(parser->ast_arena, &parser->nodes[base], parser->node_count - base);
+    parser->node_count = base;
+    if (!block) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    block->offset = offset;
+    return block;
+}
+
+// ("var" | "val" | "const" | "lateinit") 名字 (":" 类型)? ("=" 表达式)?
+static ASTNode* parse_variable_declaration(Parser* parser) {
+    DeclKind kind = DECL_VAR;
+    if (accept_token(parser, TOKEN_KEYWORD_LATEINIT)) {
+        if (!accept_token(parser, TOKEN_KEYWORD_VAR) && accept_token(parser, TOKEN_KEYWORD_VAL)) {
+            kind = DECL_VAL;
+        }
+    } else {
+        if (match(parser, TOKEN_KEYWORD_VAL)) {
+            kind = DECL_VAL;
+        } else if (match(parser, TOKEN_KEYWORD_CONST)) {
+            kind = DECL_CONST;
+        }
+        advance(parser);
+    }
+
+    Symbol name = token_name(&parser->current_token);
+    if (name == SYMBOL_NONE) {
+        report_error(parser, "语法错误：期望变量名");
+        return NULL;
+    }
+    advance(parser);
+
+    TypeId type = TYPE_NONE;
+    if (accept_token(parser, TOKEN_COLON) && (type = parse_type(parser)) == TYPE_NONE) {
+        return NULL;
+    }
+    ASTNode* initializer = NULL;
+    if (accept_token(parser, TOKEN_ASSIGN)) {
+        initializer = parse_expression(parser);
+        if (!initializer) {
+            return NULL;
+        }
+    }
+
+    ASTNode* node = create_variable_decl(parser->ast_arena, kind, name, type, initializer);
+    if (!node) {
+        report_memory_error(parser);
+    }
+    return node;
+}
+
+// "if" 条件 语句 ("else" 语句)?
+static ASTNode* parse_if_statement(Parser* parser) {
+    advance(parser);
+    ASTNode* condition = parse_condition(parser);
+    if (!condition) {
+        return NULL;
+    }
+    ASTNode* then_branch = parse_statement(parser);
+    ASTNode* else_branch = NULL;
+    if (accept_token(parser, TOKEN_KEYWORD_ELSE)) {
+        else_branch = parse_statement(parser);
+    }
+    return create_if_statement(parser->ast_arena, condition, then_branch, else_branch);
+}
+
+// "while" 条件 语句
+static ASTNode* parse_while_statement(Parser* parser) {
+    advance(parser);
+    ASTNode* condition = parse_condition(parser);
+    if (!condition) {
+        return NULL;
+    }
+    ASTNode* body = parse_statement(parser);
+    return create_while_statement(parser->ast_arena, condition, body);
+}
+
+// "for" "(" 名字 "in" 表达式 ")" 语句
+static ASTNode* parse_for_statement(Parser* parser) {
+    advance(parser);
+    if (!accept_token(parser, TOKEN_LPAREN)) {
+        report_error(parser, "语法错误：期望 '('");
+        return NULL;
+    }
+    Symbol variable = token_name(&parser->current_token);
+    if (variable == SYMBOL_NONE) {
+        report_error(parser, "语法错误：期望循环变量");
+        return NULL;
+    }
+    advance(parser);
+    if (!accept_token(parser, TOKEN_KEYWORD_IN)) {
+        report_error(parser, "语法错误：期望 'in'");
+        return NULL;
+    }
+    ASTNode* iterable = parse_expression(parser);
+    if (!iterable) {
+        return NULL;
+    }
+    if (!accept_token(parser, TOKEN_RPAREN)) {
+        report_error(parser, "语法错误：期望 ')'");
+        return NULL;
+    }
+    ASTNode* body = parse_statement(parser);
+    return create_for_statement(parser->ast_arena, variable, iterable, body);
+}
+
+// 解析一条语句。出错时跳到下一条语句并返回 NULL，保证总能向前推进；空语句同样返回 NULL
+static ASTNode* parse_statement(Parser* parser) {
+    int offset = parser->current_token.offset;
+    int simple = 1;  // 简单语句需要以换行或 ';' 结束
+    ASTNode* statement;
+
+    switch (parser->current_token.type) {
+        case TOKEN_LBRACE:
+            return parse_block(parser);
+        case TOKEN_SEMICOLON:
+            advance(parser);
+            return NULL;
+        case TOKEN_KEYWORD_VAR:
+        case TOKEN_KEYWORD_VAL:
+        case TOKEN_KEYWORD_CONST:
+        case TOKEN_KEYWORD_LATEINIT:
+            statement = parse_variable_declaration(parser);
+            break;
+        case TOKEN_KEYWORD_IF:
+            statement = parse_if_statement(parser);
+            simple = 0;
+            break;
+        case TOKEN_KEYWORD_WHILE:
+            statement = parse_while_statement(parser);
+            simple = 0;
+            break;
+        case TOKEN_KEYWORD_FOR:
+            statement = parse_for_statement(parser);
+            simple = 0;
+            break;
+        case TOKEN_KEYWORD_BREAK:
+        case TOKEN_KEYWORD_CONTINUE:
+            statement = create_ast_node(parser->ast_arena, match(parser, TOKEN_KEYWORD_BREAK) ? NODE_BREAK : NODE_CONTINUE);
+            advance(parser);
+            if (!statement) {
+                report_memory_error(parser);
+            }
+            break;
+        case TOKEN_KEYWORD_RETURN: {
+            advance(parser);
+            // 同一行上没有表达式时为不带返回值的 return
+            ASTNode* value = NULL;
+            if (!match(parser, TOKEN_SEMICOLON) && !match(parser, TOKEN_RBRACE) &&
+                !match(parser, TOKEN_EOF) && !newline_before(parser)) {
+                value = parse_expression(parser);
+                if (!value) {
+                    statement = NULL;
+                    break;
+                }
+            }
+            statement = create_return(parser->ast_arena, value);
+            if (!statement) {
+                report_memory_error(parser);
+            }
+            break;
+        }
+        default:
+            // 表达式语句保留表达式自身的偏移
+            statement = parse_expression(parser);
+            if (!statement) {
+                synchronize(parser);
+            } else if (!end_statement(parser)) {
+                synchronize(parser);
+            }
+            return statement;
+    }
+
+    if (!statement) {
+        synchronize(parser);
+        return NULL;
+    }
+    statement->offset = offset;
+    if (simple && !end_statement(parser)) {
+        synchronize(parser);
+    }
+    return statement;
+}
+
+// ---------------------------------------------------------------------------
+// 函数定义
+// ---------------------------------------------------------------------------
+
+// 参数定义：名字 ":" 类型 ("=" 默认值)?，以变量声明节点表示
+static ASTNode* parse_parameter(Parser* parser) {
+    int offset = parser->current_token.offset;
+    Symbol name = token_name(&parser->current_token);
+    if (name == SYMBOL_NONE) {
+        report_error(parser, "语法错误：期望参数名");
+        return NULL;
+    }
+    advance(parser);
+    if (!accept_token(parser, TOKEN_COLON)) {
+        report_error(parser, "语法错误：参数缺少类型");
+        return NULL;
+    }
+    TypeId type = parse_type(parser);
+    if (type == TYPE_NONE) {
+        return NULL;
+    }
+    ASTNode* default_value = NULL;
+    if (accept_token(parser, TOKEN_ASSIGN)) {
+        default_value = parse_expression(parser);
+        if (!default_value) {
+            return NULL;
+        }
+    }
+    ASTNode* parameter = create_variable_decl(parser->ast_arena, DECL_PARAMETER, name, type, default_value);
+    if (!parameter) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    parameter->offset = offset;
+    return parameter;
+}
+
+// 泛型参数列表 "<" 名字 (where 约束)? ("," ...)* ">"：记录各参数名供类型解析使用，
+// 约束目前不检查，按尖括号配对跳过
+static void parse_type_parameters(Parser* parser) {
+    int depth = 0;
+    int expect_name = 0;
+    do {
+        if (match(parser, TOKEN_LESS)) {
+            depth++;
+            expect_name = depth == 1;
+        } else if (match(parser, TOKEN_GREATER)) {
+            depth--;
+        } else if (match(parser, TOKEN_SHIFT_RIGHT)) {
+            depth -= 2;
+        } else if (depth == 1 && match(parser, TOKEN_COMMA)) {
+            expect_name = 1;
+        } else if (expect_name) {
+            Symbol name = token_name(&parser->current_token);
+            if (name == SYMBOL_NONE) {
+                report_error(parser, "语法错误：期望泛型参数名");
+            } else if (parser->type_parameter_count == PARSER_MAX_TYPE_PARAMETERS) {
+                report_error(parser, "语法错误：泛型参数过多");
+            } else {
+                parser->type_parameters[parser->type_parameter_count++] = name;
+            }
+            expect_name = 0;
+        }
+        advance(parser);
+    } while (depth > 0 && !match(parser, TOKEN_EOF));
+}
+
+// 延迟解析函数体时恢复函数的泛型参数：重新扫描函数名之后的 "<...>"
+static void restore_type_parameters(Parser* parser, const ASTNode* function) {
+    const TokenArray* tokens = parser->tokens;
+    int body_start = function->function.body_start;
+    int index = find_token(tokens, function->offset);
+    while (index < body_start && token_at(tokens, index).type != TOKEN_KEYWORD_FUN) {
+        index++;
+    }
+    parser->type_parameter_count = 0;
+    if (index + 2 >= body_start || token_at(tokens, index + 2).type != TOKEN_LESS) {
+        return;
+    }
+    parser->position = index + 2;
+    parser->token_limit = body_start;
+    parser->limit_token = token_at(tokens, body_start);
+    parser->limit_token.type = TOKEN_EOF;
+    parser->current_token = token_at(tokens, index + 2);
+    parse_type_parameters(parser);
+}
+
+// 按括号匹配跳过 "{" ... "}"，只记录其标记范围，返回是否找到匹配的 '}'
+static int skip_block(Parser* parser, int* start, int* end) {
+    int position = parser->position;
+    int depth = 0;
+    *start = position;
+    for (; position < parser->token_limit; position++) {
+        TokenType type = (TokenType)token_at(parser->tokens, position).type;
+        if (type == TOKEN_LBRACE) {
+            depth++;
+        } else if (type == TOKEN_RBRACE && --depth == 0) {
+            break;
+        }
+    }
+    parser->position = position;
+    if (position >= parser->token_limit) {
+        parser->current_token = parser->limit_token;
+        report_error(parser, "语法错误：代码块缺少 '}'");
+        return 0;
+    }
+    advance(parser);
+    *end = parser->position;
+    return 1;
+}
+
+// 函数体："{" 语句* "}"，或 "->" 表达式（视为只含一条 return 的代码块）。
+// 延迟模式下 "{...}" 函数体只记录标记范围，返回 NULL，由调用者保存范围；
+// 头文件中的函数声明可以没有函数体
+static ASTNode* parse_function_body(Parser* parser, int* body_start, int* body_end) {
+    if (match(parser, TOKEN_LBRACE)) {
+        if (parser->lazy_bodies && parser->tokens) {
+            skip_block(parser, body_start, body_end);
+            return NULL;
+        }
+        return parse_block(parser);
+    }
+    if (!match(parser, TOKEN_ARROW)) {
+        if (!parser->header_mode) {
+            report_error(parser, "语法错误：期望函数体");
+        }
+        return NULL;
+    }
+    int offset = parser->current_token.offset;
+    advance(parser);
+    ASTNode* value = parse_expression(parser);
+    if (!value) {
+        return NULL;
+    }
+    ASTNode* statement = create_return(parser->ast_arena, value);
+    ASTNode* body = statement ? create_block(parser->ast_arena, &statement, 1) : NULL;
+    if (!body) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    statement->offset = offset;
+    body->offset = offset;
+    return body;
+}
+
+// "fun" 名字 泛型参数? "(" 参数定义列表? ")" (":" 类型)? 函数体
+static ASTNode* parse_function(Parser* parser) {
+    int offset = parser->current_token.offset;
+    advance(parser); // 消费'fun'关键字
+
+    // 期望函数名（标识符）
+    Symbol function_name = token_name(&parser->current_token);
+    if (function_name == SYMBOL_NONE) {
+        report_error(parser, "语法错误：期望函数名");
+        return NULL;
+    }
+    advance(parser);
+    if (match(parser, TOKEN_LESS)) {
+        parse_type_parameters(parser);
+    }
+
+    // 解析函数参数，参数节点暂存在节点栈中
+    if (!accept_token(parser, TOKEN_LPAREN)) {
+        report_error(parser, "语法错误：期望 '('");
+        return NULL;
+    }
+    int base = parser->node_count;
+    if (!match(parser, TOKEN_RPAREN)) {
+        do {
+            if (!push_node(parser, parse_parameter(parser))) {
+                parser->node_count = base;
+                return NULL;
+            }
+        } while (accept_token(parser, TOKEN_COMMA));
+    }
+    if (!accept_token(parser, TOKEN_RPAREN)) {
+        report_error(parser, "语法错误：期望 ')'");
+        parser->node_count = base;
+        return NULL;
+    }
+
+    // 返回类型
+    TypeId return_type = TYPE_NONE;
+    if (accept_token(parser, TOKEN_COLON) && (return_type = parse_type(parser)) == TYPE_NONE) {
+        parser->node_count = base;
+        return NULL;
+    }
+
+    // 解析函数体（其中的语句压在参数之上，解析完毕后已全部弹出）
+    int body_start = 0;
+    int body_end = 0;
+    ASTNode* body = parse_function_body(parser, &body_start, &body_end);
+
+    // 创建函数节点
+    ASTNode* function_node = create_function(parser->ast_arena, function_name, &parser->nodes[base],
+                                             parser->node_count - base, return_type, body);
+    parser->node_count = base;
+    if (!function_node) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    function_node->offset = offset;
+    function_node->function.body_start = body_start;
+    function_node->function.body_end = body_end;
+    return function_node;
+}
+
+// 函数的泛型参数接在外层函数的之后，函数定义结束时恢复
+ASTNode* parse_function_definition(struct Parser* parser) {
+    if (!match(parser, TOKEN_KEYWORD_FUN)) {
+        return NULL;
+    }
+    int outer_type_parameters = parser->type_parameter_count;
+    ASTNode* function = parse_function(parser);
+    parser->type_parameter_count = outer_type_parameters;
+    return function;
+}
+
+ASTNode* get_function_body(Parser* parser, ASTNode* function) {
+    if (!function || function->type != NODE_FUNCTION) {
+        return NULL;
+    }
+    if (!function_body_pending(function) || !parser || !parser->tokens) {
+        return function->function.body;
+    }
+
+    // 把函数体的标记范围当作一段独立的输入来解析，完成后恢复原来的解析位置
+    int position = parser->position;
+    int token_limit = parser->token_limit;
+    Token current_token = parser->current_token;
+    Token limit_token = parser->limit_token;
+    FunctionNode* node = &function->function;
+    int type_parameter_count = parser->type_parameter_count;
+    settle_shift(parser, function);
+    restore_type_parameters(parser, function);
+    parser->position = node->body_start;
+    parser->token_limit = node->body_end;
+    parser->limit_token = token_at(parser->tokens, node->body_end);
+    parser->limit_token.type = TOKEN_EOF;
+    parser->current_token = token_at(parser->tokens, node->body_start);
+
+    node->body = parse_block(parser);
+    node->body_start = 0;
+    node->body_end = 0;
+
+    parser->position = position;
+    parser->token_limit = token_limit;
+    parser->current_token = current_token;
+    parser->limit_token = limit_token;
+    parser->type_parameter_count = type_parameter_count;
+    return node->body;
+}
+
+void set_lazy_function_bodies(Parser* parser, int enabled) {
+    if (parser) {
+        parser->lazy_bodies = enabled;
+    }
+}
+
+// 名字 name 被引用：把同名的顶层函数加入工作栈（每个名字只加入一次）
+static void reach_name(Parser* parser, Symbol name, const int* first, const int* next,
+                       uint8_t* reached, int symbols) {
+    if (name == SYMBOL_NONE || (int)name >= symbols || reached[name]) {
+        return;
+    }
+    reached[name] = 1;
+    ASTNode** declarations = parser->root->program.declarations;
+    for (int i = first[name]; i != 0; i = next[i - 1]) {
+        push_node(parser, declarations[i - 1]);
+    }
+}
+
+void parse_reachable_bodies(Parser* parser, Symbol entry) {
+    ASTNode* root = parser ? parser->root : NULL;
+    if (!root || root->type != NODE_PROGRAM) {
+        return;
+    }
+    int count = root->program.declaration_count;
+    ASTNode** declarations = root->program.declarations;
+
+    // 按名字把顶层函数串成链表：first[符号] 为第一个同名函数的下标加一，next 指向下一个
+    int symbols = symbol_count() + 1;
+    int* first = (int*)calloc((size_t)symbols, sizeof(int));
+    int* next = (int*)malloc(sizeof(int) * (size_t)(count + 1));
+    uint8_t* reached = (uint8_t*)calloc((size_t)symbols, 1);
+    if (!first || !next || !reached) {
+        report_memory_error(parser);
+        free(first);
+        free(next);
+        free(reached);
+        return;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        ASTNode* declaration = declarations[i];
+        if (declaration && declaration->type == NODE_FUNCTION && (int)declaration->function.name < symbols) {
+            next[i] = first[declaration->function.name];
+            first[declaration->function.name] = i + 1;
+        }
+    }
+
+    // 根：入口函数、导出的函数、tailrec 函数与顶层变量的初始化表达式。工作栈复用节点栈，
+    // 解析函数体时压入的语句在其返回前已全部弹出，不会与工作栈混在一起
+    int base = parser->node_count;
+    reach_name(parser, entry, first, next, reached, symbols);
+    for (int i = 0; i < count; i++) {
+        if (!declarations[i]) {
+            continue;
+        }
+        if (declarations[i]->type != NODE_FUNCTION) {
+            push_node(parser, declarations[i]);
+        } else if (declarations[i]->function.modifiers & (MODIFIER_PUBLIC | MODIFIER_TAILREC)) {
+            reach_name(parser, declarations[i]->function.name, first, next, reached, symbols);
+        }
+    }
+    while (parser->node_count > base && parser->error != PARSER_ERROR_MEMORY) {
+        ASTNode* node = parser->nodes[--parser->node_count];
+        if (node->type == NODE_FUNCTION) {
+            get_function_body(parser, node);
+        } else if (node->type == NODE_FUNCTION_CALL) {
+            reach_name(parser, node->call.name, first, next, reached, symbols);
+        } else if (node->type == NODE_VARIABLE) {
+            // 函数也可能作为值被引用
+            reach_name(parser, node->variable.name, first, next, reached, symbols);
+        }
+        int children = ast_child_count(node);
+        for (int i = 0; i < children; i++) {
+            ASTNode* child = ast_child(node, i);
+            if (child && !push_node(parser, child)) {
+                break;
+            }
+        }
+    }
+    parser->node_count = base;
+    free(first);
+    free(next);
+    free(reached);
+}
+
+// ---------------------------------------------------------------------------
+// include 指令与头文件
+// ---------------------------------------------------------------------------
+
+// "#"? "include" 字符串：记录为 include 节点，头文件中的声明由 parse_includes 加载
+static ASTNode* parse_include(Parser* parser) {
+    int offset = parser->current_token.offset;
+    accept_token(parser, TOKEN_HASH);
+    advance(parser); // 跳过 'include'
+    if (!match(parser, TOKEN_STRING)) {
+        report_error(parser, "语法错误：期望头文件名");
+        return NULL;
+    }
+    const Token* token = &parser->current_token;
+    ASTNode* include = create_include(parser->ast_arena, token_text(parser->lexer->source, token), token->length);
+    advance(parser);
+    if (!include) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    include->offset = offset;
+    return include;
+}
+
+// 跳过预处理指令：'#' 及其后同一行内的标记
+static void skip_directive(Parser* parser) {
+    advance(parser);
+    while (!match(parser, TOKEN_EOF) && !newline_before(parser)) {
+        advance(parser);
+    }
+}
+
+// C类型中可能出现的标记：名字、const 和 '*'
+static int is_c_type_token(TokenType type) {
+    return type == TOKEN_IDENTIFIER || is_name_keyword(type) ||
+           type == TOKEN_KEYWORD_CONST || type == TOKEN_MULTIPLY;
+}
+
+// 头文件中的C函数原型：类型 名字 "(" 参数列表 ")" ";"。是则返回末尾 ';' 的下标，否则返回 -1
+static int c_prototype_end(Parser* parser) {
+    const TokenArray* tokens = parser->tokens;
+    int index = parser->position;
+    while (index < parser->token_limit && is_c_type_token((TokenType)token_at(tokens, index).type)) {
+        index++;
+    }
+    // 至少有类型和函数名两个标记，最后一个是函数名
+    if (index - parser->position < 2 || token_at(tokens, index).type != TOKEN_LPAREN) {
+        return -1;
+    }
+    Token name = token_at(tokens, index - 1);
+    if (token_name(&name) == SYMBOL_NONE) {
+        return -1;
+    }
+    int depth = 0;
+    for (; index < parser->token_limit; index++) {
+        TokenType type = (TokenType)token_at(tokens, index).type;
+        if (type == TOKEN_LPAREN) {
+            depth++;
+        } else if (type == TOKEN_RPAREN && --depth == 0) {
+            break;
+        } else if (type == TOKEN_LBRACE || type == TOKEN_RBRACE || type == TOKEN_SEMICOLON) {
+            return -1;
+        }
+    }
+    index++;
+    return index < parser->token_limit && token_at(tokens, index).type == TOKEN_SEMICOLON ? index : -1;
+}
+
+// C类型到SCP类型的映射，表中没有的类型保留C的写法
+static const struct {
+    const char* c_type;
+    const char* scp_type;   // NULL 表示没有值（void）
+} c_types[] = {
+    { "void",               NULL },
+    { "const char*",        "str" },
+    { "char*",              "str" },
+    { "char",               "char" },
+    { "signed char",        "i8" },
+    { "unsigned char",      "u8" },
+    { "short",              "i16" },
+    { "unsigned short",     "u16" },
+    { "int",                "int" },
+    { "unsigned int",       "u32" },
+    { "unsigned",           "u32" },
+    { "long",               "i64" },
+    { "unsigned long",      "u64" },
+    { "long long",          "i64" },
+    { "unsigned long long", "u64" },
+    { "size_t",             "usize" },
+    { "float",              "f32" },
+    { "double",             "f64" },
+    { "bool",               "bool" },
+    { "_Bool",              "bool" },
+};
+
+// C类型中的单词：标识符与关键字，相邻的单词之间需要空格
+static int is_c_word(const Token* token) {
+    return token->type == TOKEN_IDENTIFIER || keyword_text((TokenType)token->type) != NULL;
+}
+
+// 把标记 [from, to) 拼接为C类型（相邻的单词以一个空格分隔，'*' 等标点紧跟在前一个标记之后），
+// 再映射为SCP类型。void 返回 TYPE_NONE；没有对应SCP类型的C类型以其文本作为具名类型
+static TypeId c_type(Parser* parser, int from, int to) {
+    char buffer[PARSER_MAX_TYPE_LENGTH];
+    int size = (int)sizeof(buffer);
+    int length = 0;
+    Token previous = { 0 };
+    for (int i = from; i < to; i++) {
+        Token token = token_at(parser->tokens, i);
+        int separator = i > from && is_c_word(&token) && is_c_word(&previous);
+        if (length + separator + token.length >= size) {
+            report_error_at(parser, token.offset, "语法错误：类型名过长");
+            break;
+        }
+        if (separator) {
+            buffer[length++] = ' ';
+        }
+        memcpy(buffer + length, token_text(parser->lexer->source, &token), (size_t)token.length);
+        length += token.length;
+        previous = token;
+    }
+    buffer[length] = '\0';
+    for (size_t i = 0; i < sizeof(c_types) / sizeof(c_types[0]); i++) {
+        if (strcmp(buffer, c_types[i].c_type) == 0) {
+            const char* scp_type = c_types[i].scp_type;
+            return scp_type ? intern_type_text(scp_type, (int)strlen(scp_type)) : TYPE_NONE;
+        }
+    }
+    return intern_type_text(buffer, length);
+}
+
+// C函数参数 [from, to)：类型 名字?，以变量声明节点表示（省略名字时名字为 SYMBOL_NONE）
+static ASTNode* parse_c_parameter(Parser* parser, int from, int to) {
+    Token last = token_at(parser->tokens, to - 1);
+    Symbol name = SYMBOL_NONE;
+    if (to - from >= 2 && last.type != TOKEN_MULTIPLY) {
+        name = token_name(&last);
+        if (name != SYMBOL_NONE) {
+            to--;
+        }
+    }
+    ASTNode* parameter = create_variable_decl(parser->ast_arena, DECL_PARAMETER, name, c_type(parser, from, to), NULL);
+    if (parameter) {
+        parameter->offset = token_at(parser->tokens, from).offset;
+    }
+    return parameter;
+}
+
+// 把C函数原型转换为没有函数体的函数声明，end 为原型末尾 ';' 的下标
+static ASTNode* parse_c_prototype(Parser* parser, int end) {
+    const TokenArray* tokens = parser->tokens;
+    int offset = parser->current_token.offset;
+    int open = parser->position;
+    while (token_at(tokens, open).type != TOKEN_LPAREN) {
+        open++;
+    }
+    Token name_token = token_at(tokens, open - 1);
+    Symbol name = token_name(&name_token);
+    TypeId return_type = c_type(parser, parser->position, open - 1);
+
+    // 参数以括号层级为 0 的 ',' 分隔，"(void)" 表示没有参数
+    int base = parser->node_count;
+    int close = end - 1;
+    int start = open + 1;
+    Token first = token_at(tokens, start);
+    int no_parameters = close == start ||
+        (close == start + 1 && first.length == 4 &&
+         memcmp(token_text(parser->lexer->source, &first), "void", 4) == 0);
+    int depth = 0;
+    for (int i = start; i <= close && !no_parameters; i++) {
+        Token token = token_at(tokens, i);
+        TokenType type = (TokenType)token.type;
+        if (type == TOKEN_LPAREN) {
+            depth++;
+        } else if (type == TOKEN_RPAREN && i < close) {
+            depth--;
+        } else if (i == close || (type == TOKEN_COMMA && depth == 0)) {
+            if (i == start) {
+                report_error_at(parser, token.offset, "语法错误：期望参数");
+                break;
+            }
+            if (!push_node(parser, parse_c_parameter(parser, start, i))) {
+                break;
+            }
+            start = i + 1;
+        }
+    }
+
+    ASTNode* function = create_function(parser->ast_arena, name, &parser->nodes[base], parser->node_count - base,
+                                        return_type, NULL);
+    parser->node_count = base;
+    parser->position = end;
+    advance(parser);
+    if (!function) {
+        report_memory_error(parser);
+        return NULL;
+    }
+    function->offset = offset;
+    return function;
+}
+
+// 跳过头文件中其他的C声明（typedef、结构体、全局变量等）：
+// 到括号层级为 0 的 ';' 为止，或到 "{...}" 结束、下一条预处理指令之前
+static void skip_c_declaration(Parser* parser) {
+    Nesting nesting = { 0, 0 };
+    do {
+        TokenType type = (TokenType)parser->current_token.type;
+        nest(&nesting, type);
+        advance(parser);
+        if (at_top_level(&nesting) && (type == TOKEN_SEMICOLON || type == TOKEN_RBRACE)) {
+            break;
+        }
+    } while (!match(parser, TOKEN_EOF) && !(match(parser, TOKEN_HASH) && newline_before(parser)));
+    accept_token(parser, TOKEN_SEMICOLON);
+}
+
+ASTNode* parse_header(Parser* parser, const char* source, int length, TokenArray* tokens) {
+    if (!parser) {
+        destroy_token_array(tokens);
+        return NULL;
+    }
+    parser->header_mode = 1;
+    parse_tokens(parser, source, length, tokens, 1);
+    parser->header_mode = 0;
+    return parser->root;
+}
+
+void parse_includes(Parser* parser, const char* source_path, const char* const* include_dirs, int dir_count) {
+    ASTNode* root = parser ? parser->root : NULL;
+    if (!root || root->type != NODE_PROGRAM) {
+        return;
+    }
+    int count = root->program.declaration_count;
+    ASTNode** declarations = root->program.declarations;
+    IncludeGraph* graph = create_include_graph(include_dirs, dir_count);
+    int* headers = (int*)malloc(sizeof(int) * (size_t)(count > 0 ? count : 1));
+    if (!graph || !headers) {
+        report_memory_error(parser);
+        destroy_include_graph(graph);
+        free(headers);
+        return;
+    }
+
+    // 先把全部 include 加入图中再一次性加载，同一层的头文件才能并行读取
+    char* error = NULL;
+    for (int i = 0; i < count; i++) {
+        headers[i] = -1;
+        if (declarations[i] && declarations[i]->type == NODE_INCLUDE) {
+            headers[i] = add_include(graph, source_path, declarations[i]->include.filename, &error);
+            if (error) {
+                report_error_at(parser, declarations[i]->offset, error);
+                free(error);
+                error = NULL;
+            }
+        }
+    }
+    resolve_include_graph(graph, 0);
+
+    // 按源代码顺序展开，头文件的声明挂在第一个（直接或间接）引用它的 include 节点下
+    for (int i = 0; i < count; i++) {
+        if (headers[i] < 0) {
+            continue;
+        }
+        IncludeNode* include = &declarations[i]->include;
+        if (!expand_include(graph, headers[i], parser->ast_arena, declarations[i]->offset,
+                            &include->declarations, &include->declaration_count, &error)) {
+            report_error_at(parser, declarations[i]->offset, error ? error : "内存分配错误：无法加载头文件");
+            free(error);
+            error = NULL;
+        }
+    }
+    destroy_include_graph(graph);
+    free(headers);
+}
+
+ASTNode* get_ast_root(Parser* parser) {
+    return parser->root;
+}
+
+ParserErrorType get_parser_error(Parser* parser) {
+    return parser ? parser->error : PARSER_ERROR_NONE;
+}
+
+const char* get_parser_error_message(Parser* parser) {
+    return parser ? parser->error_message : NULL;
+}
+
+void clear_parser_error(Parser* parser) {
+    if (!parser) return;
+    free(parser->error_message);
+    parser->error_message = NULL;
+    parser->error = PARSER_ERROR_NONE;
 }
\ No newline at end of file
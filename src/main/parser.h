@@ -3,7 +3,9 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <stdio.h>
 #include "ast.h"
+#include "lexer.h"
 
 // Define the Parser structure
 typedef struct Parser Parser;
@@ -20,10 +22,41 @@ typedef enum {
 
 // Function prototypes
 Parser* create_parser();
-void parse_source(Parser* parser, const char* source);
+// 解析 [source, source + length) 中的源代码；解析器只借用该缓冲区
+void parse_source(Parser* parser, const char* source, int length);
+// 同 parse_source，但大文件的顶层声明分段交给 thread_count 个线程并行解析（0 表示按核心数）
+void parse_source_parallel(Parser* parser, const char* source, int length, int thread_count);
+// 增量解析：source 是编辑后的完整源代码，旧源代码 [edit_start, old_edit_end) 被替换为
+// [edit_start, new_edit_end)。只重新切分受影响的标记、重新解析与编辑范围相交的顶层声明，
+// 其余声明的AST原样沿用（其子孙节点的偏移由声明的 shift 统一平移）。被替换的声明的节点归还给
+// 区域分配器复用，之前取得的指向它们的指针随之失效。上一次解析有错误或不是内存中的源代码时退回完整解析
+void reparse_source(Parser* parser, const char* source, int length, int edit_start, int old_edit_end, int new_edit_end);
+// 解析头文件：除SCP声明外还接受C函数原型（类型映射为SCP类型）与没有函数体的函数声明，
+// 跳过预处理指令和其他C声明。tokens 为已切分好的标记（由解析器接管），可为 NULL。返回程序根节点
+ASTNode* parse_header(Parser* parser, const char* source, int length, TokenArray* tokens);
+// 解析程序的 include 图（include_graph.h）并加载全部头文件，声明挂在 include 节点下：
+// 每个 include 节点得到该头文件及其间接 include 的头文件中的声明，同一头文件只出现一次。
+// 头文件先在包含它的文件所在目录中查找，再依次查找 include_dirs。
+// 每次调用按源代码顺序重新展开全部 include，增量解析后再次调用即可
+void parse_includes(Parser* parser, const char* source_path, const char* const* include_dirs, int dir_count);
+// 从输入流中边读取边解析，只占用固定大小的窗口
+void parse_stream(Parser* parser, FILE* stream);
+// 流式解析时另存读入的全部字节（默认关闭），解析后由 take_stream_input 取走（调用者释放），
+// 交给之后的各遍报告行列号；没有开启或内存不足时返回 NULL
+void set_keep_stream_input(Parser* parser, int enabled);
+char* take_stream_input(Parser* parser, int* length);
 void destroy_parser(Parser* parser);
 ASTNode* parse_function_definition(Parser* parser);
 
+// 延迟解析函数体（默认开启，流式模式不支持）：解析时只按括号匹配记录 "{...}" 函数体的标记范围，
+// 函数体中的语法错误也要到构建时才报告
+void set_lazy_function_bodies(Parser* parser, int enabled);
+// 返回函数的函数体，尚未构建时在此解析（不可与同一解析器上的其他调用并发）
+ASTNode* get_function_body(Parser* parser, ASTNode* function);
+// 从入口函数、导出（pub）的函数、tailrec 函数（尾调用检查覆盖所有 tailrec 声明）和顶层变量的
+// 初始化表达式出发，沿调用和引用构建所有可达函数的函数体，不可达的函数体保持未解析，不分配任何节点
+void parse_reachable_bodies(Parser* parser, Symbol entry);
+
 // AST相关函数
 ASTNode* get_ast_root(Parser* parser);
 
@@ -0,0 +1,474 @@
+#include "pch.h"
+#include "parser.h"
+#include "interner.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// 序列化缓冲区：声明记录与字符串表分别增长，写出时拼接在文件头之后
+typedef struct {
+    uint32_t* words;
+    uint32_t word_count;
+    uint32_t word_capacity;
+    char* strings;
+    uint32_t string_bytes;
+    uint32_t string_capacity;
+    uint32_t* string_offsets; // 按符号编号记录已写入的字符串偏移加一，相同的名字与类型只存一份
+    uint32_t symbol_capacity;
+    int failed;            // 内存分配失败
+} PchWriter;
+
+uint64_t hash_bytes(const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 编译器版本与格式版本共同决定记录的含义，任一变化都使旧文件失效
+static uint64_t compiler_hash(void) {
+    static const char version[] = SCP_COMPILER_VERSION;
+    uint32_t format = PCH_FORMAT_VERSION;
+    return hash_bytes(version, sizeof(version) - 1) ^ hash_bytes(&format, sizeof(format));
+}
+
+static void write_word(PchWriter* writer, uint32_t word) {
+    if (writer->word_count == writer->word_capacity) {
+        uint32_t capacity = writer->word_capacity ? writer->word_capacity * 2 : 64;
+        uint32_t* words = (uint32_t*)realloc(writer->words, sizeof(uint32_t) * capacity);
+        if (!words) {
+            writer->failed = 1;
+            return;
+        }
+        writer->words = words;
+        writer->word_capacity = capacity;
+    }
+    writer->words[writer->word_count++] = word;
+}
+
+// 写入字符串并记录其偏移（text 为 NULL 时记录 PCH_NO_STRING）
+static void write_string(PchWriter* writer, const char* text, size_t length) {
+    if (!text) {
+        write_word(writer, PCH_NO_STRING);
+        return;
+    }
+    Symbol symbol = intern(text, (int)length);
+    if (symbol == SYMBOL_NONE) {
+        writer->failed = 1;
+        return;
+    }
+    if (symbol >= writer->symbol_capacity) {
+        uint32_t capacity = (uint32_t)symbol_count() + 1;
+        uint32_t* offsets = (uint32_t*)realloc(writer->string_offsets, sizeof(uint32_t) * capacity);
+        if (!offsets) {
+            writer->failed = 1;
+            return;
+        }
+        memset(offsets + writer->symbol_capacity, 0, sizeof(uint32_t) * (capacity - writer->symbol_capacity));
+        writer->string_offsets = offsets;
+        writer->symbol_capacity = capacity;
+    }
+    if (writer->string_offsets[symbol] != 0) {
+        write_word(writer, writer->string_offsets[symbol] - 1);
+        return;
+    }
+    writer->string_offsets[symbol] = writer->string_bytes + 1;
+    while (writer->string_bytes + length + 1 > writer->string_capacity) {
+        uint32_t capacity = writer->string_capacity ? writer->string_capacity * 2 : 256;
+        char* strings = (char*)realloc(writer->strings, capacity);
+        if (!strings) {
+            writer->failed = 1;
+            return;
+        }
+        writer->strings = strings;
+        writer->string_capacity = capacity;
+    }
+    write_word(writer, writer->string_bytes);
+    memcpy(writer->strings + writer->string_bytes, text, length);
+    writer->strings[writer->string_bytes + length] = '\0';
+    writer->string_bytes += (uint32_t)(length + 1);
+}
+
+static void write_symbol(PchWriter* writer, Symbol symbol) {
+    if (symbol == SYMBOL_NONE) {
+        write_word(writer, PCH_NO_STRING);
+    } else {
+        write_string(writer, symbol_name(symbol), (size_t)symbol_length(symbol));
+    }
+}
+
+// 类型以规范文本保存，读取时由类型驻留表还原；未标注的类型记录 PCH_NO_STRING
+static void write_type(PchWriter* writer, TypeId type) {
+    write_string(writer, type != TYPE_NONE ? type_name(type) : NULL, strlen(type_name(type)));
+}
+
+// 序列化头文件：先写入它 include 的文件名，再写入顶层声明（头文件中只有函数签名与变量的名字和类型）
+static void write_header_contents(PchWriter* writer, const ASTNode* program, PchHeader* header) {
+    for (int i = 0; i < program->program.declaration_count; i++) {
+        const ASTNode* declaration = program->program.declarations[i];
+        if (declaration && declaration->type == NODE_INCLUDE) {
+            const char* filename = declaration->include.filename;
+            write_string(writer, filename, filename ? strlen(filename) : 0);
+            header->include_count++;
+        }
+    }
+    for (int i = 0; i < program->program.declaration_count; i++) {
+        const ASTNode* declaration = program->program.declarations[i];
+        if (!declaration) {
+            continue;
+        }
+        if (declaration->type == NODE_FUNCTION) {
+            const FunctionNode* function = &declaration->function;
+            write_word(writer, NODE_FUNCTION);
+            write_symbol(writer, function->name);
+            write_type(writer, function->return_type);
+            write_word(writer, (uint32_t)function->param_count);
+            for (int j = 0; j < function->param_count; j++) {
+                write_symbol(writer, function->parameters[j]->var_decl.name);
+                write_type(writer, function->parameters[j]->var_decl.type);
+            }
+            header->declaration_count++;
+        } else if (declaration->type == NODE_VARIABLE_DECL) {
+            write_word(writer, NODE_VARIABLE_DECL);
+            write_symbol(writer, declaration->var_decl.name);
+            write_type(writer, declaration->var_decl.type);
+            write_word(writer, declaration->var_decl.kind);
+            header->declaration_count++;
+        }
+    }
+    header->record_words = writer->word_count - header->include_count;
+}
+
+// 顺序读取映像中的声明记录
+typedef struct {
+    const uint32_t* words;
+    uint32_t word_count;
+    uint32_t position;
+    const char* strings;
+    uint32_t string_bytes;
+    int corrupt;           // 记录越界或引用了不存在的字符串
+} PchReader;
+
+static void init_reader(PchReader* reader, const char* image) {
+    const PchHeader* header = (const PchHeader*)image;
+    reader->words = (const uint32_t*)(image + sizeof(PchHeader)) + header->include_count;
+    reader->word_count = header->record_words;
+    reader->position = 0;
+    reader->strings = (const char*)(reader->words + header->record_words);
+    reader->string_bytes = header->string_bytes;
+    reader->corrupt = 0;
+}
+
+static uint32_t read_word(PchReader* reader) {
+    if (reader->position >= reader->word_count) {
+        reader->corrupt = 1;
+        return 0;
+    }
+    return reader->words[reader->position++];
+}
+
+// 读取字符串（没有时返回 NULL）；字符串表以 '\0' 结尾，已在加载时校验
+static const char* read_string(PchReader* reader) {
+    uint32_t offset = read_word(reader);
+    if (offset == PCH_NO_STRING) {
+        return NULL;
+    }
+    if (offset >= reader->string_bytes) {
+        reader->corrupt = 1;
+        return NULL;
+    }
+    return reader->strings + offset;
+}
+
+static Symbol read_symbol(PchReader* reader) {
+    const char* text = read_string(reader);
+    return text ? intern_cstr(text) : SYMBOL_NONE;
+}
+
+static TypeId read_type(PchReader* reader) {
+    const char* text = read_string(reader);
+    return text ? intern_type_text(text, (int)strlen(text)) : TYPE_NONE;
+}
+
+// 走一遍全部记录检查其结构，之后重建声明时不再检查（不驻留符号，可在工作线程中调用）
+static int records_valid(const char* image) {
+    const PchHeader* header = (const PchHeader*)image;
+    PchReader reader;
+    init_reader(&reader, image);
+    for (uint32_t i = 0; i < header->declaration_count && !reader.corrupt; i++) {
+        uint32_t kind = read_word(&reader);
+        if (kind == NODE_FUNCTION) {
+            read_string(&reader);
+            read_string(&reader);
+            uint32_t param_count = read_word(&reader);
+            // 每个参数占两个字，数量不可能超过剩余的记录
+            if (param_count > (reader.word_count - reader.position) / 2) {
+                return 0;
+            }
+            for (uint32_t j = 0; j < param_count * 2; j++) {
+                read_string(&reader);
+            }
+        } else if (kind == NODE_VARIABLE_DECL) {
+            read_string(&reader);
+            read_string(&reader);
+            if (read_word(&reader) > DECL_CONST) {
+                return 0;
+            }
+        } else {
+            return 0;
+        }
+    }
+    return !reader.corrupt && reader.position == reader.word_count;
+}
+
+// 校验预编译头映像是否与头文件内容和当前编译器相符、结构是否完整
+static int pch_matches(const char* image, size_t size, uint64_t content_hash, uint64_t content_length) {
+    if (size < sizeof(PchHeader)) {
+        return 0;
+    }
+    const PchHeader* header = (const PchHeader*)image;
+    if (memcmp(header->magic, "SPCH", 4) != 0 || header->format_version != PCH_FORMAT_VERSION ||
+        header->compiler_hash != compiler_hash() || header->content_hash != content_hash ||
+        header->content_length != content_length) {
+        return 0;
+    }
+    uint64_t words = (uint64_t)header->include_count + header->record_words;
+    if (sizeof(PchHeader) + words * sizeof(uint32_t) + header->string_bytes != size) {
+        return 0;
+    }
+    // 字符串表必须以 '\0' 结尾，读取任何字符串都不会越界
+    if (header->string_bytes > 0 && image[size - 1] != '\0') {
+        return 0;
+    }
+    const uint32_t* includes = (const uint32_t*)(image + sizeof(PchHeader));
+    for (uint32_t i = 0; i < header->include_count; i++) {
+        if (includes[i] >= header->string_bytes) {
+            return 0;
+        }
+    }
+    return records_valid(image);
+}
+
+int pch_include_count(const PchImage* image) {
+    return (int)((const PchHeader*)image->data)->include_count;
+}
+
+const char* pch_include(const PchImage* image, int index) {
+    const PchHeader* header = (const PchHeader*)image->data;
+    const uint32_t* includes = (const uint32_t*)(image->data + sizeof(PchHeader));
+    const char* strings = (const char*)(includes + header->include_count + header->record_words);
+    return strings + includes[index];
+}
+
+int pch_declaration_count(const PchImage* image) {
+    return (int)((const PchHeader*)image->data)->declaration_count;
+}
+
+// 由声明记录重建一个声明节点，内存不足时返回 NULL
+static ASTNode* read_declaration(PchReader* reader, Arena* arena, int offset) {
+    ASTNode* declaration = NULL;
+    if (read_word(reader) == NODE_FUNCTION) {
+        Symbol name = read_symbol(reader);
+        TypeId return_type = read_type(reader);
+        uint32_t param_count = read_word(reader);
+        ASTNode** parameters = (ASTNode**)malloc(sizeof(ASTNode*) * (param_count ? param_count : 1));
+        if (!parameters) {
+            return NULL;
+        }
+        for (uint32_t i = 0; i < param_count; i++) {
+            Symbol parameter_name = read_symbol(reader);
+            parameters[i] = create_variable_decl(arena, DECL_PARAMETER, parameter_name, read_type(reader), NULL);
+            if (!parameters[i]) {
+                free(parameters);
+                return NULL;
+            }
+            parameters[i]->offset = offset;
+        }
+        declaration = create_function(arena, name, parameters, (int)param_count, return_type, NULL);
+        free(parameters);
+    } else {
+        Symbol name = read_symbol(reader);
+        TypeId type = read_type(reader);
+        declaration = create_variable_decl(arena, (DeclKind)read_word(reader), name, type, NULL);
+    }
+    if (declaration) {
+        declaration->offset = offset;
+    }
+    return declaration;
+}
+
+int instantiate_pch(const PchImage* image, Arena* arena, int offset, ASTNode** declarations) {
+    PchReader reader;
+    init_reader(&reader, image->data);
+    int count = pch_declaration_count(image);
+    for (int i = 0; i < count; i++) {
+        declarations[i] = read_declaration(&reader, arena, offset);
+        if (!declarations[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void release_pch_image(PchImage* image) {
+    free(image->data);
+    image->data = NULL;
+    image->size = 0;
+}
+
+// 解析头文件并生成预编译头映像，失败时返回 0 并设置错误信息
+static int build_image(HeaderLoad* load, PchImage* image) {
+    Parser* parser = create_parser();
+    if (!parser) {
+        load->error = strdup("内存分配错误：无法创建解析器");
+        return 0;
+    }
+    TokenArray* tokens = load->tokens;
+    load->tokens = NULL;
+    ASTNode* program = parse_header(parser, load->source->data, (int)load->source->length, tokens);
+    const char* parse_error = get_parser_error_message(parser);
+    if (parse_error || !program) {
+        char message[4096 + 256];
+        snprintf(message, sizeof(message), "%s: %s", load->path, parse_error ? parse_error : "无法解析头文件");
+        load->error = strdup(message);
+        destroy_parser(parser);
+        return 0;
+    }
+
+    PchWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    PchHeader header;
+    memset(&header, 0, sizeof(header));
+    write_header_contents(&writer, program, &header);
+    destroy_parser(parser);
+
+    char* data = NULL;
+    size_t size = sizeof(PchHeader) + (size_t)writer.word_count * sizeof(uint32_t) + writer.string_bytes;
+    if (!writer.failed) {
+        data = (char*)malloc(size);
+    }
+    if (data) {
+        memcpy(header.magic, "SPCH", 4);
+        header.format_version = PCH_FORMAT_VERSION;
+        header.compiler_hash = compiler_hash();
+        header.content_hash = load->content_hash;
+        header.content_length = load->source->length;
+        header.string_bytes = writer.string_bytes;
+        memcpy(data, &header, sizeof(header));
+        memcpy(data + sizeof(header), writer.words, (size_t)writer.word_count * sizeof(uint32_t));
+        memcpy(data + sizeof(header) + (size_t)writer.word_count * sizeof(uint32_t), writer.strings,
+               writer.string_bytes);
+        image->data = data;
+        image->size = size;
+    } else {
+        load->error = strdup("内存分配错误：无法生成预编译头");
+    }
+    free(writer.words);
+    free(writer.strings);
+    free(writer.string_offsets);
+    return data != NULL;
+}
+
+// 先写入临时文件再改名，并发的编译不会读到写了一半的预编译头
+static void save_image(const char* pch_path, const PchImage* image) {
+    char temporary[4096 + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", pch_path);
+    FILE* file = fopen(temporary, "wb");
+    if (!file) {
+        return;
+    }
+    int written = fwrite(image->data, 1, image->size, file) == image->size;
+    if (fclose(file) != 0 || !written) {
+        remove(temporary);
+        return;
+    }
+#ifdef _WIN32
+    remove(pch_path);
+#endif
+    if (rename(temporary, pch_path) != 0) {
+        remove(temporary);
+    }
+}
+
+void load_header_worker(void* argument) {
+    HeaderLoad* load = (HeaderLoad*)argument;
+    char pch_path[4096];
+    snprintf(pch_path, sizeof(pch_path), "%s.pch", load->path);
+
+    load->source = load_source_file(load->path);
+    if (!load->source) {
+        char message[4096 + 64];
+        snprintf(message, sizeof(message), "无法读取头文件: %s", load->path);
+        load->error = strdup(message);
+        return;
+    }
+    load->content_hash = hash_bytes(load->source->data, load->source->length);
+
+    // 已有的预编译头与头文件内容、编译器版本都相符时直接使用
+    if (source_file_exists(pch_path)) {
+        SourceBuffer* file = load_source_file(pch_path);
+        if (file && pch_matches(file->data, file->length, load->content_hash, load->source->length)) {
+            load->image.data = (char*)malloc(file->length);
+            if (load->image.data) {
+                memcpy(load->image.data, file->data, file->length);
+                load->image.size = file->length;
+                load->ready = 1;
+            } else {
+                load->error = strdup("内存分配错误：无法加载预编译头");
+            }
+            destroy_source_buffer(file);
+            destroy_source_buffer(load->source);
+            load->source = NULL;
+            return;
+        }
+        destroy_source_buffer(file);
+    }
+
+    // 需要重新生成：先切分标记，标识符留待主线程驻留
+    Lexer* lexer = create_lexer(load->source->data, (int)load->source->length);
+    if (lexer) {
+        lexer->intern_identifiers = 0;
+        load->tokens = tokenize(lexer);
+        destroy_lexer(lexer);
+    }
+    if (!load->tokens) {
+        load->error = strdup("内存分配错误：无法切分头文件");
+    }
+}
+
+int finish_header_load(HeaderLoad* load, PchImage* image) {
+    if (load->error) {
+        return 0;
+    }
+    if (load->ready) {
+        *image = load->image;
+        load->ready = 0;
+        return 1;
+    }
+    intern_token_identifiers(load->tokens);
+    if (!build_image(load, image)) {
+        return 0;
+    }
+    char pch_path[4096];
+    snprintf(pch_path, sizeof(pch_path), "%s.pch", load->path);
+    save_image(pch_path, image);
+    return 1;
+}
+
+void destroy_header_load(HeaderLoad* load) {
+    if (load->ready) {
+        release_pch_image(&load->image);
+        load->ready = 0;
+    }
+    if (load->tokens) {
+        destroy_token_array(load->tokens);
+        load->tokens = NULL;
+    }
+    destroy_source_buffer(load->source);
+    load->source = NULL;
+    free(load->error);
+    load->error = NULL;
+}
@@ -0,0 +1,77 @@
+// 预编译头文件
+// #include 引用的头文件只在第一次（或内容、编译器版本变化后）解析，其中的声明序列化为
+// 紧凑的二进制文件 <头文件>.pch；之后的编译直接内存映射该文件重建声明，不再切分标记。
+//
+// 文件格式（本机字节序，按 4 字节对齐；换平台后 magic 以外的字段不匹配即重新生成）：
+//   PchHeader
+//   头文件自身 include 的文件名（uint32 数组，共 include_count 个）
+//   声明记录（uint32 数组，共 record_words 个）：
+//     函数     [NODE_FUNCTION, 名字, 返回类型, 参数数量, (参数名, 参数类型)...]
+//     变量声明 [NODE_VARIABLE_DECL, 名字, 类型, 声明种类]
+//   字符串表（以 '\0' 结尾的字符串依次存放，共 string_bytes 字节）
+// 文件名、名字与类型均为字符串表中的偏移，PCH_NO_STRING 表示没有（匿名参数、void 返回值等）。
+// 头文件只能包含声明（带函数体的函数、带初始值的变量与常量在解析时报错），记录因此不含表达式。
+
+#ifndef PCH_H
+#define PCH_H
+
+#include <stdint.h>
+#include "arena.h"
+#include "ast.h"
+#include "lexer.h"
+#include "source.h"
+
+#define SCP_COMPILER_VERSION "0.1.0"
+#define PCH_FORMAT_VERSION 4
+#define PCH_NO_STRING 0xFFFFFFFFu
+
+// 文件头：magic 与两个哈希都匹配时才使用该文件，否则重新生成
+typedef struct {
+    char magic[4];              // "SPCH"
+    uint32_t format_version;    // PCH_FORMAT_VERSION
+    uint64_t compiler_hash;     // 编译器版本与格式版本的哈希
+    uint64_t content_hash;      // 头文件内容的哈希
+    uint64_t content_length;    // 头文件长度
+    uint32_t declaration_count; // 声明数量
+    uint32_t record_words;      // 声明记录的 uint32 数量
+    uint32_t string_bytes;      // 字符串表字节数
+    uint32_t include_count;     // 头文件自身 include 的文件数量
+} PchHeader;
+
+// 已校验的预编译头映像。从映射的 .pch 文件中复制出来，之后文件被改写也不受影响
+typedef struct {
+    char* data;                 // PchHeader 起始的映像（malloc 分配）
+    size_t size;
+} PchImage;
+
+// 头文件的加载任务。load_header_worker 只读取文件、校验预编译头，预编译头无效时切分标记，
+// 不驻留符号，可在工作线程中并行执行；finish_header_load 在主线程中完成其余步骤
+typedef struct {
+    const char* path;           // 头文件路径（借用）
+    PchImage image;             // 有效的预编译头
+    int ready;                  // image 是否可用
+    SourceBuffer* source;       // 预编译头缺失或过期时的头文件内容
+    uint64_t content_hash;
+    TokenArray* tokens;         // 头文件的标记（标识符尚未驻留）
+    char* error;                // 错误信息
+} HeaderLoad;
+
+// 函数原型
+void load_header_worker(void* load);
+// 返回是否成功，成功时 image 移交给调用者；失败时 load->error 为错误信息。之后调用 destroy_header_load
+int finish_header_load(HeaderLoad* load, PchImage* image);
+void destroy_header_load(HeaderLoad* load);
+
+// 映像中 include 的文件名与声明数量
+int pch_include_count(const PchImage* image);
+const char* pch_include(const PchImage* image, int index);
+int pch_declaration_count(const PchImage* image);
+// 由映像重建声明节点写入 declarations（pch_declaration_count 个），偏移统一为 offset。
+// 节点分配在 arena 中，内存不足时返回 0
+int instantiate_pch(const PchImage* image, Arena* arena, int offset, ASTNode** declarations);
+void release_pch_image(PchImage* image);
+
+// 64位 FNV-1a 哈希
+uint64_t hash_bytes(const void* data, size_t length);
+
+#endif // PCH_H
@@ -0,0 +1,335 @@
+#include "simd_scan.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define SCAN_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define SCAN_HAVE_X86 0
+#endif
+
+// ---------------------------------------------------------------------------
+// 标量实现：同时用于不支持SIMD的平台以及SIMD实现处理不足一组的尾部
+// ---------------------------------------------------------------------------
+
+static inline int is_space_byte(unsigned char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+static inline int is_identifier_byte(unsigned char c) {
+    return (unsigned char)((c | 0x20) - 'a') < 26 || (unsigned char)(c - '0') < 10 || c == '_';
+}
+
+static size_t scalar_span_whitespace(const char* text, size_t length) {
+    size_t i = 0;
+    while (i < length && is_space_byte((unsigned char)text[i])) i++;
+    return i;
+}
+
+static size_t scalar_span_identifier(const char* text, size_t length) {
+    size_t i = 0;
+    while (i < length && is_identifier_byte((unsigned char)text[i])) i++;
+    return i;
+}
+
+static size_t scalar_find_newline(const char* text, size_t length) {
+    const char* found = (const char*)memchr(text, '\n', length);
+    return found ? (size_t)(found - text) : length;
+}
+
+static size_t scalar_find_comment_end(const char* text, size_t length) {
+    for (size_t i = 0; i + 1 < length; i++) {
+        if (text[i] == '*' && text[i + 1] == '/') return i;
+    }
+    return length;
+}
+
+static size_t scalar_find_string_special(const char* text, size_t length) {
+    size_t i = 0;
+    while (i < length && text[i] != '"' && text[i] != '\\') i++;
+    return i;
+}
+
+static size_t scalar_count_newlines(const char* text, size_t length, size_t* last_newline) {
+    size_t count = 0;
+    const char* p = text;
+    const char* end = text + length;
+    while ((p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        count++;
+        *last_newline = (size_t)(p - text);
+        p++;
+    }
+    return count;
+}
+
+static const ScanOps scalar_ops = {
+    "scalar",
+    scalar_span_whitespace,
+    scalar_span_identifier,
+    scalar_find_newline,
+    scalar_find_comment_end,
+    scalar_find_string_special,
+    scalar_count_newlines
+};
+
+const ScanOps* scalar_scan_ops(void) {
+    return &scalar_ops;
+}
+
+#if SCAN_HAVE_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 实现：每次处理16字节，字符类别通过比较指令生成位掩码
+// ---------------------------------------------------------------------------
+
+// 无符号范围判断：lo <= x <= hi
+static inline __m128i sse2_in_range(__m128i x, unsigned char lo, unsigned char hi) {
+    __m128i shifted = _mm_sub_epi8(x, _mm_set1_epi8((char)lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8((char)(hi - lo))), shifted);
+}
+
+static inline unsigned sse2_space_mask(__m128i v) {
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i control = sse2_in_range(v, '\t', '\r');
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(space, control));
+}
+
+static inline unsigned sse2_identifier_mask(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i alpha = sse2_in_range(lower, 'a', 'z');
+    __m128i digit = sse2_in_range(v, '0', '9');
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(alpha, digit), underscore));
+}
+
+static size_t sse2_span_whitespace(const char* text, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        unsigned mask = ~sse2_space_mask(_mm_loadu_si128((const __m128i*)(text + i))) & 0xFFFFu;
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scalar_span_whitespace(text + i, length - i);
+}
+
+static size_t sse2_span_identifier(const char* text, size_t length) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        unsigned mask = ~sse2_identifier_mask(_mm_loadu_si128((const __m128i*)(text + i))) & 0xFFFFu;
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scalar_span_identifier(text + i, length - i);
+}
+
+static size_t sse2_find_newline(const char* text, size_t length) {
+    size_t i = 0;
+    __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scalar_find_newline(text + i, length - i);
+}
+
+static size_t sse2_find_comment_end(const char* text, size_t length) {
+    size_t i = 0;
+    __m128i star = _mm_set1_epi8('*');
+    __m128i slash = _mm_set1_epi8('/');
+    // 比较当前位置的 '*' 与后一位置的 '/'，两者同时成立即为 "*/"
+    for (; i + 17 <= length; i += 16) {
+        __m128i current = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i next = _mm_loadu_si128((const __m128i*)(text + i + 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(current, star), _mm_cmpeq_epi8(next, slash)));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scalar_find_comment_end(text + i, length - i);
+}
+
+static size_t sse2_find_string_special(const char* text, size_t length) {
+    size_t i = 0;
+    __m128i quote = _mm_set1_epi8('"');
+    __m128i backslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + scalar_find_string_special(text + i, length - i);
+}
+
+static size_t sse2_count_newlines(const char* text, size_t length, size_t* last_newline) {
+    size_t count = 0;
+    size_t i = 0;
+    __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(text + i));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+        if (mask) {
+            count += (size_t)__builtin_popcount(mask);
+            *last_newline = i + (size_t)(31 - __builtin_clz(mask));
+        }
+    }
+    size_t tail_last = 0;
+    size_t tail = scalar_count_newlines(text + i, length - i, &tail_last);
+    if (tail) *last_newline = i + tail_last;
+    return count + tail;
+}
+
+static const ScanOps sse2_ops = {
+    "sse2",
+    sse2_span_whitespace,
+    sse2_span_identifier,
+    sse2_find_newline,
+    sse2_find_comment_end,
+    sse2_find_string_special,
+    sse2_count_newlines
+};
+
+const ScanOps* sse2_scan_ops(void) {
+    return &sse2_ops;
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 实现：每次处理32字节，仅在运行时检测到AVX2时启用
+// ---------------------------------------------------------------------------
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET static inline __m256i avx2_in_range(__m256i x, unsigned char lo, unsigned char hi) {
+    __m256i shifted = _mm256_sub_epi8(x, _mm256_set1_epi8((char)lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8((char)(hi - lo))), shifted);
+}
+
+AVX2_TARGET static size_t avx2_span_whitespace(const char* text, size_t length) {
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                        avx2_in_range(v, '\t', '\r'));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(space);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + sse2_span_whitespace(text + i, length - i);
+}
+
+AVX2_TARGET static size_t avx2_span_identifier(const char* text, size_t length) {
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i identifier = _mm256_or_si256(
+            _mm256_or_si256(avx2_in_range(lower, 'a', 'z'), avx2_in_range(v, '0', '9')),
+            _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(identifier);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + sse2_span_identifier(text + i, length - i);
+}
+
+AVX2_TARGET static size_t avx2_find_newline(const char* text, size_t length) {
+    size_t i = 0;
+    __m256i newline = _mm256_set1_epi8('\n');
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + sse2_find_newline(text + i, length - i);
+}
+
+AVX2_TARGET static size_t avx2_find_comment_end(const char* text, size_t length) {
+    size_t i = 0;
+    __m256i star = _mm256_set1_epi8('*');
+    __m256i slash = _mm256_set1_epi8('/');
+    for (; i + 33 <= length; i += 32) {
+        __m256i current = _mm256_loadu_si256((const __m256i*)(text + i));
+        __m256i next = _mm256_loadu_si256((const __m256i*)(text + i + 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(current, star), _mm256_cmpeq_epi8(next, slash)));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + sse2_find_comment_end(text + i, length - i);
+}
+
+AVX2_TARGET static size_t avx2_find_string_special(const char* text, size_t length) {
+    size_t i = 0;
+    __m256i quote = _mm256_set1_epi8('"');
+    __m256i backslash = _mm256_set1_epi8('\\');
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)));
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+    }
+    return i + sse2_find_string_special(text + i, length - i);
+}
+
+AVX2_TARGET static size_t avx2_count_newlines(const char* text, size_t length, size_t* last_newline) {
+    size_t count = 0;
+    size_t i = 0;
+    __m256i newline = _mm256_set1_epi8('\n');
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(text + i));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, newline));
+        if (mask) {
+            count += (size_t)__builtin_popcount(mask);
+            *last_newline = i + (size_t)(31 - __builtin_clz(mask));
+        }
+    }
+    size_t tail_last = 0;
+    size_t tail = sse2_count_newlines(text + i, length - i, &tail_last);
+    if (tail) *last_newline = i + tail_last;
+    return count + tail;
+}
+
+static const ScanOps avx2_ops = {
+    "avx2",
+    avx2_span_whitespace,
+    avx2_span_identifier,
+    avx2_find_newline,
+    avx2_find_comment_end,
+    avx2_find_string_special,
+    avx2_count_newlines
+};
+
+const ScanOps* avx2_scan_ops(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &avx2_ops : NULL;
+}
+
+#else
+
+const ScanOps* sse2_scan_ops(void) {
+    return NULL;
+}
+
+const ScanOps* avx2_scan_ops(void) {
+    return NULL;
+}
+
+#endif // SCAN_HAVE_X86
+
+// 选择扫描实现
+const ScanOps* select_scan_ops(void) {
+    const char* forced = getenv("SCP_SCAN");
+    const ScanOps* ops = NULL;
+
+    if (forced) {
+        if (strcmp(forced, "avx2") == 0) {
+            ops = avx2_scan_ops();
+        } else if (strcmp(forced, "sse2") == 0) {
+            ops = sse2_scan_ops();
+        } else if (strcmp(forced, "scalar") == 0) {
+            ops = scalar_scan_ops();
+        }
+        if (ops) return ops;
+    }
+
+    ops = avx2_scan_ops();
+    if (!ops) ops = sse2_scan_ops();
+    if (!ops) ops = scalar_scan_ops();
+    return ops;
+}
@@ -0,0 +1,36 @@
+// 字符批量扫描头文件
+// 为词法分析器提供按 16/32 字节一组扫描空白、标识符、注释与字符串的函数，
+// 运行时根据CPU能力在 AVX2、SSE2 与可移植的标量实现之间选择。
+
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <stddef.h>
+
+// 扫描函数表
+typedef struct {
+    const char* name;    // 实现名称 ("avx2" / "sse2" / "scalar")
+
+    // 返回开头连续空白字符（空格、\t、\n、\v、\f、\r）的数量
+    size_t (*span_whitespace)(const char* text, size_t length);
+    // 返回开头连续标识符字符（[A-Za-z0-9_]）的数量
+    size_t (*span_identifier)(const char* text, size_t length);
+    // 返回第一个 '\n' 的下标，不存在时返回 length
+    size_t (*find_newline)(const char* text, size_t length);
+    // 返回第一个 "*/" 中 '*' 的下标，不存在时返回 length
+    size_t (*find_comment_end)(const char* text, size_t length);
+    // 返回第一个 '"' 或 '\\' 的下标，不存在时返回 length
+    size_t (*find_string_special)(const char* text, size_t length);
+    // 统计换行符数量，并通过 last_newline 返回最后一个换行符的下标（没有时不修改）
+    size_t (*count_newlines)(const char* text, size_t length, size_t* last_newline);
+} ScanOps;
+
+// 选择当前CPU可用的最快实现；环境变量 SCP_SCAN 可强制指定 "avx2"、"sse2" 或 "scalar"
+const ScanOps* select_scan_ops(void);
+
+// 各实现（不可用时为 NULL）
+const ScanOps* scalar_scan_ops(void);
+const ScanOps* sse2_scan_ops(void);
+const ScanOps* avx2_scan_ops(void);
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,257 @@
+#include "source.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 词法分析器以 int 记录偏移，超出此大小的输入无法处理
+#define SOURCE_MAX_LENGTH ((size_t)INT_MAX)
+
+// 空文件无法映射，统一指向这块静态的空内容
+static const char empty_source[1] = { '\0' };
+
+static SourceBuffer* create_source_buffer(const char* name) {
+    SourceBuffer* source = (SourceBuffer*)malloc(sizeof(SourceBuffer));
+    if (source) {
+        source->data = empty_source;
+        source->length = 0;
+        source->mapped = 0;
+        source->name = strdup(name ? name : "<stdin>");
+    }
+    return source;
+}
+
+SourceBuffer* adopt_source_memory(char* data, size_t length, const char* name) {
+    SourceBuffer* source = data ? create_source_buffer(name) : NULL;
+    if (!source) {
+        free(data);
+        return NULL;
+    }
+    source->data = data;
+    source->length = length;
+    return source;
+}
+
+// 从流中读取全部内容
+SourceBuffer* load_source_stream(FILE* stream, const char* name) {
+    SourceBuffer* source = create_source_buffer(name);
+    if (!source) return NULL;
+
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char* buffer = (char*)malloc(capacity);
+    if (!buffer) {
+        destroy_source_buffer(source);
+        return NULL;
+    }
+
+    for (;;) {
+        if (length == capacity) {
+            char* grown = (char*)realloc(buffer, capacity * 2);
+            if (!grown) {
+                free(buffer);
+                destroy_source_buffer(source);
+                return NULL;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+        size_t read_size = fread(buffer + length, 1, capacity - length, stream);
+        if (read_size == 0) break;
+        length += read_size;
+    }
+
+    if (length > SOURCE_MAX_LENGTH) {
+        fprintf(stderr, "源文件过大: %s\n", source->name);
+        free(buffer);
+        destroy_source_buffer(source);
+        return NULL;
+    }
+
+    source->data = buffer;
+    source->length = length;
+    return source;
+}
+
+#ifdef _WIN32
+
+SourceBuffer* load_source_file(const char* filename) {
+    if (strcmp(filename, "-") == 0) {
+        return load_source_stream(stdin, NULL);
+    }
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "无法打开文件: %s\n", filename);
+        return NULL;
+    }
+
+    // 非磁盘文件（管道、控制台）无法映射，退回到流式读取
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        FILE* stream = fopen(filename, "rb");
+        if (!stream) {
+            fprintf(stderr, "无法打开文件: %s\n", filename);
+            return NULL;
+        }
+        SourceBuffer* source = load_source_stream(stream, filename);
+        fclose(stream);
+        return source;
+    }
+
+    SourceBuffer* source = create_source_buffer(filename);
+    if (!source || size.QuadPart == 0) {
+        CloseHandle(file);
+        return source;
+    }
+    if ((unsigned long long)size.QuadPart > SOURCE_MAX_LENGTH) {
+        fprintf(stderr, "源文件过大: %s\n", filename);
+        CloseHandle(file);
+        destroy_source_buffer(source);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const char* view = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (mapping) CloseHandle(mapping);
+    CloseHandle(file);
+
+    if (!view) {
+        fprintf(stderr, "无法映射文件: %s\n", filename);
+        destroy_source_buffer(source);
+        return NULL;
+    }
+
+    source->data = view;
+    source->length = (size_t)size.QuadPart;
+    source->mapped = 1;
+    return source;
+}
+
+#else
+
+SourceBuffer* load_source_file(const char* filename) {
+    if (strcmp(filename, "-") == 0) {
+        return load_source_stream(stdin, NULL);
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "无法打开文件: %s\n", filename);
+        return NULL;
+    }
+
+    // 管道、FIFO 等不是普通文件，无法映射，退回到流式读取
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        FILE* stream = fdopen(fd, "rb");
+        if (!stream) {
+            close(fd);
+            fprintf(stderr, "无法读取文件: %s\n", filename);
+            return NULL;
+        }
+        SourceBuffer* source = load_source_stream(stream, filename);
+        fclose(stream);
+        return source;
+    }
+
+    SourceBuffer* source = create_source_buffer(filename);
+    if (!source || info.st_size == 0) {
+        close(fd);
+        return source;
+    }
+    if ((unsigned long long)info.st_size > SOURCE_MAX_LENGTH) {
+        fprintf(stderr, "源文件过大: %s\n", filename);
+        close(fd);
+        destroy_source_buffer(source);
+        return NULL;
+    }
+
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        fprintf(stderr, "无法映射文件: %s\n", filename);
+        destroy_source_buffer(source);
+        return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+#endif
+
+    source->data = (const char*)view;
+    source->length = (size_t)info.st_size;
+    source->mapped = 1;
+    return source;
+}
+
+#endif // _WIN32
+
+// 读取普通文件的大小与修改时间（不输出诊断信息），stamp 可为 NULL
+int source_file_stamp(const char* filename, FileStamp* stamp) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &info) ||
+        (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        return 0;
+    }
+    if (stamp) {
+        stamp->size = ((long long)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+        stamp->modified = ((long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    }
+    return 1;
+#else
+    struct stat info;
+    if (stat(filename, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return 0;
+    }
+    if (stamp) {
+        stamp->size = (long long)info.st_size;
+#ifdef __linux__
+        stamp->modified = (long long)info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#else
+        stamp->modified = (long long)info.st_mtime;
+#endif
+    }
+    return 1;
+#endif
+}
+
+int source_file_exists(const char* filename) {
+    return source_file_stamp(filename, NULL);
+}
+
+// 规范化的绝对路径（malloc 分配），失败时返回 NULL
+char* canonical_source_path(const char* filename) {
+#ifdef _WIN32
+    return _fullpath(NULL, filename, 0);
+#else
+    return realpath(filename, NULL);
+#endif
+}
+
+// 释放源代码缓冲区
+void destroy_source_buffer(SourceBuffer* source) {
+    if (!source) return;
+
+    if (source->mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile((LPCVOID)source->data);
+#else
+        munmap((void*)source->data, source->length);
+#endif
+    } else if (source->data != empty_source) {
+        free((void*)source->data);
+    }
+    free(source->name);
+    free(source);
+}
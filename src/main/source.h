@@ -0,0 +1,40 @@
+// 源文件输入层头文件
+// 每个源文件只加载一次：普通文件以只读方式内存映射，管道与标准输入则读入堆缓冲区。
+// 词法分析器、语法分析器等后续阶段都只借用这块缓冲区，不再复制。
+
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// 源代码缓冲区
+typedef struct {
+    const char* data;    // 源代码内容（只读，不保证以 '\0' 结尾）
+    size_t length;       // 内容长度（字节）
+    int mapped;          // 是否为内存映射
+    char* name;          // 文件名（用于诊断信息）
+} SourceBuffer;
+
+// 文件标识：大小与修改时间都不变时认为内容未变
+typedef struct {
+    long long size;
+    long long modified;
+} FileStamp;
+
+// 加载源文件；文件名为 "-" 时读取标准输入。失败时返回 NULL
+SourceBuffer* load_source_file(const char* filename);
+// 从已打开的流中读取全部内容（用于管道等无法映射的输入）
+SourceBuffer* load_source_stream(FILE* stream, const char* name);
+// 接管 malloc 分配的内容作为源代码缓冲区（如流式解析时另存的标准输入）；失败时释放 data 并返回 NULL
+SourceBuffer* adopt_source_memory(char* data, size_t length, const char* name);
+// 普通文件是否存在（不输出诊断信息，用于查找头文件等可选的文件）
+int source_file_exists(const char* filename);
+// 同上，并取得文件的大小与修改时间，用于判断缓存的文件内容是否过期
+int source_file_stamp(const char* filename, FileStamp* stamp);
+// 规范化的绝对路径（调用者释放），同一文件的不同写法得到相同的结果；失败时返回 NULL
+char* canonical_source_path(const char* filename);
+// 释放源代码缓冲区（解除映射或释放内存）
+void destroy_source_buffer(SourceBuffer* source);
+
+#endif // SOURCE_H
@@ -0,0 +1,121 @@
+#include "symbol_table.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SYMBOL_TABLE_INITIAL_CAPACITY 256
+
+// 符号编号是连续分配的小整数，乘以黄金分割常数后取低位：乘以奇数在低位上是一一映射，相邻的编号落在不同的槽位
+static uint32_t slot_index(const SymbolTable* table, Symbol name) {
+    return (uint32_t)(name * 2654435769u) & (table->capacity - 1);
+}
+
+// 名字所在的槽位；名字不在表中时返回应插入的空槽位
+static ScopeSlot* find_slot(const SymbolTable* table, Symbol name) {
+    uint32_t mask = table->capacity - 1;
+    uint32_t index = slot_index(table, name);
+    while (table->slots[index].name != SYMBOL_NONE && table->slots[index].name != name) {
+        index = (index + 1) & mask;
+    }
+    return &table->slots[index];
+}
+
+// 负载超过 3/4 时扩容为两倍并重新散列
+static int grow_slots(SymbolTable* table) {
+    ScopeSlot* old_slots = table->slots;
+    uint32_t old_capacity = table->capacity;
+    ScopeSlot* slots = (ScopeSlot*)calloc((size_t)old_capacity * 2, sizeof(ScopeSlot));
+    if (!slots) return 0;
+    table->slots = slots;
+    table->capacity = old_capacity * 2;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i].name != SYMBOL_NONE) {
+            *find_slot(table, old_slots[i].name) = old_slots[i];
+        }
+    }
+    free(old_slots);
+    return 1;
+}
+
+SymbolTable* create_symbol_table(void) {
+    SymbolTable* table = (SymbolTable*)calloc(1, sizeof(SymbolTable));
+    if (!table) return NULL;
+    table->capacity = SYMBOL_TABLE_INITIAL_CAPACITY;
+    table->slots = (ScopeSlot*)calloc(table->capacity, sizeof(ScopeSlot));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+void destroy_symbol_table(SymbolTable* table) {
+    if (!table) return;
+    free(table->slots);
+    free(table->undo);
+    free(table->marks);
+    free(table);
+}
+
+int enter_scope(SymbolTable* table) {
+    if (table->depth == table->mark_capacity) {
+        uint32_t capacity = table->mark_capacity ? table->mark_capacity * 2 : 16;
+        uint32_t* marks = (uint32_t*)realloc(table->marks, sizeof(uint32_t) * capacity);
+        if (!marks) return 0;
+        table->marks = marks;
+        table->mark_capacity = capacity;
+    }
+    table->marks[table->depth++] = table->undo_count;
+    return 1;
+}
+
+void leave_scope(SymbolTable* table) {
+    if (table->depth == 0) return;
+    uint32_t mark = table->marks[--table->depth];
+    // 逆序恢复：同一作用域中重复绑定同一名字时，最终回到进入作用域之前的值
+    while (table->undo_count > mark) {
+        const ScopeUndo* entry = &table->undo[--table->undo_count];
+        ScopeSlot* slot = find_slot(table, entry->name);
+        slot->binding = entry->binding;
+        slot->depth = entry->depth;
+    }
+}
+
+int bind_symbol(SymbolTable* table, Symbol name, Binding binding) {
+    if (name == SYMBOL_NONE) return 1;
+    if (table->undo_count == table->undo_capacity) {
+        uint32_t capacity = table->undo_capacity ? table->undo_capacity * 2 : 256;
+        ScopeUndo* undo = (ScopeUndo*)realloc(table->undo, sizeof(ScopeUndo) * capacity);
+        if (!undo) return 0;
+        table->undo = undo;
+        table->undo_capacity = capacity;
+    }
+    ScopeSlot* slot = find_slot(table, name);
+    if (slot->name == SYMBOL_NONE) {
+        if ((table->used + 1) * 4 > table->capacity * 3) {
+            if (!grow_slots(table)) return 0;
+            slot = find_slot(table, name);
+        }
+        slot->name = name;
+        slot->binding = BINDING_NONE;
+        slot->depth = 0;
+        table->used++;
+    }
+    ScopeUndo* entry = &table->undo[table->undo_count++];
+    entry->name = name;
+    entry->binding = slot->binding;
+    entry->depth = slot->depth;
+    slot->binding = binding;
+    slot->depth = table->depth;
+    return 1;
+}
+
+Binding lookup_symbol(const SymbolTable* table, Symbol name) {
+    if (name == SYMBOL_NONE) return BINDING_NONE;
+    return find_slot(table, name)->binding;
+}
+
+int declared_in_scope(const SymbolTable* table, Symbol name) {
+    if (name == SYMBOL_NONE) return 0;
+    const ScopeSlot* slot = find_slot(table, name);
+    return slot->binding != BINDING_NONE && slot->depth == table->depth;
+}
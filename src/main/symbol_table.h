@@ -0,0 +1,60 @@
+// 作用域符号表头文件
+// 以驻留后的符号为键的开放寻址哈希表，每个名字只占一个槽位，槽位中保存当前可见的绑定。
+// 绑定时把被遮蔽的旧绑定记入撤销日志，离开作用域时按日志逆序恢复，
+// 因此进入、离开一个作用域的代价只与其中声明的名字数量成正比，与表的大小无关。
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <stdint.h>
+#include "interner.h"
+
+// 绑定的含义由调用方决定（语义分析中为声明节点的编号），0 表示未绑定
+typedef uint32_t Binding;
+
+#define BINDING_NONE ((Binding)0)
+
+// 哈希表槽位：名字一旦插入便不再删除，离开作用域只把绑定恢复为外层的值
+typedef struct {
+    Symbol name;         // SYMBOL_NONE 表示空槽位
+    Binding binding;     // 当前可见的绑定
+    uint32_t depth;      // 当前绑定所在的作用域深度
+} ScopeSlot;
+
+// 撤销日志项：记录名字而不是槽位下标，表扩容重新散列后仍然有效
+typedef struct {
+    Symbol name;
+    Binding binding;     // 被遮蔽的绑定
+    uint32_t depth;
+} ScopeUndo;
+
+typedef struct {
+    ScopeSlot* slots;
+    uint32_t capacity;   // 槽位数量，始终为2的幂
+    uint32_t used;       // 已插入的名字数量
+
+    ScopeUndo* undo;     // 撤销日志
+    uint32_t undo_count;
+    uint32_t undo_capacity;
+
+    uint32_t* marks;     // 每层作用域进入时的日志长度
+    uint32_t depth;      // 当前作用域深度，全局作用域为 0
+    uint32_t mark_capacity;
+} SymbolTable;
+
+// 函数原型
+SymbolTable* create_symbol_table(void);
+void destroy_symbol_table(SymbolTable* table);
+
+// 进入、离开作用域；全局作用域不能离开。内存不足时返回 0
+int enter_scope(SymbolTable* table);
+void leave_scope(SymbolTable* table);
+
+// 在当前作用域中绑定名字（遮蔽外层的同名绑定）。内存不足时返回 0
+int bind_symbol(SymbolTable* table, Symbol name, Binding binding);
+// 名字当前可见的绑定，未绑定时返回 BINDING_NONE
+Binding lookup_symbol(const SymbolTable* table, Symbol name);
+// 名字是否已在当前作用域中绑定
+int declared_in_scope(const SymbolTable* table, Symbol name);
+
+#endif // SYMBOL_TABLE_H
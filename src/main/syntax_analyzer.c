@@ -1,24 +1,327 @@
 #include "syntax_analyzer.h"
+#include "lexer.h"
+#include "line_table.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// Define the SyntaxAnalyzer structure
-struct SyntaxAnalyzer {
-    char* analyzed_syntax;
-};
+// 扫描到某个节点时才执行的作用域操作。操作按前序位置嵌套压栈，栈顶的触发位置总是最小的
+typedef enum {
+    ACTION_LEAVE,        // 离开作用域（子树结束处）
+    ACTION_BIND,         // 绑定变量声明（声明之后才可见，初始化表达式中仍指向外层的同名变量）
+    ACTION_ENTER_BIND,   // 进入 for 循环体的作用域并绑定循环变量
+    ACTION_SKIP          // 跳过不参与名字解析的子树（成员名）
+} ActionKind;
 
-void analyze_syntax(SyntaxAnalyzer* analyzer, const char* tokens) {
-    // Implement syntax analysis logic here
-    analyzer->analyzed_syntax = strdup(tokens);
-    // Add logic to analyze syntax trees and perform checks
+typedef struct {
+    NodeId trigger;      // 扫描到该编号时执行
+    uint32_t kind;       // ActionKind
+    NodeId node;         // 要绑定的声明节点，或跳过后继续扫描的编号
+} ScopeAction;
+
+typedef struct {
+    SyntaxAnalyzer* analyzer;
+    FlatAST* ast;
+    const char* source;
+    int length;
+    LineTable* lines;    // 报告第一个错误时才构建
+    ScopeAction* actions;
+    int action_count;
+    int action_capacity;
+    int error_offset;    // 已记录的错误所在的偏移
+    int out_of_memory;
+} Analysis;
+
+// 记录错误：只保留源代码中最靠前的一条的文本，其余只计数（全局声明先于函数体登记，发现顺序不是源代码顺序）
+static void report_error(Analysis* analysis, NodeId id, const char* message, Symbol name) {
+    SyntaxAnalyzer* analyzer = analysis->analyzer;
+    analyzer->error_count++;
+    int offset = id != NODE_NONE ? analysis->ast->offsets[id] : -1;
+    if (analyzer->error_message && (offset < 0 || offset >= analysis->error_offset)) {
+        return;
+    }
+    free(analyzer->error_message);
+    analyzer->error_message = NULL;
+    analysis->error_offset = offset;
+    char text[256];
+    if (name != SYMBOL_NONE) {
+        snprintf(text, sizeof(text), "%s: %.*s", message, symbol_length(name), symbol_name(name));
+    } else {
+        snprintf(text, sizeof(text), "%s", message);
+    }
+    if (analysis->source && !analysis->lines) {
+        analysis->lines = create_line_table(analysis->source, analysis->length);
+    }
+    char buffer[320];
+    if (analysis->lines && id != NODE_NONE) {
+        int line, column;
+        line_table_lookup(analysis->lines, offset, &line, &column);
+        snprintf(buffer, sizeof(buffer), "%d:%d: %s", line, column, text);
+    } else {
+        snprintf(buffer, sizeof(buffer), "%s", text);
+    }
+    analyzer->error_message = strdup(buffer);
+}
+
+static void report_memory_error(Analysis* analysis) {
+    if (!analysis->out_of_memory) {
+        analysis->out_of_memory = 1;
+        report_error(analysis, NODE_NONE, "内存分配错误：语义分析无法继续", SYMBOL_NONE);
+    }
+}
+
+static void push_action(Analysis* analysis, NodeId trigger, ActionKind kind, NodeId node) {
+    if (analysis->action_count == analysis->action_capacity) {
+        int capacity = analysis->action_capacity ? analysis->action_capacity * 2 : 64;
+        ScopeAction* actions = (ScopeAction*)realloc(analysis->actions, sizeof(ScopeAction) * capacity);
+        if (!actions) {
+            report_memory_error(analysis);
+            return;
+        }
+        analysis->actions = actions;
+        analysis->action_capacity = capacity;
+    }
+    ScopeAction* action = &analysis->actions[analysis->action_count++];
+    action->trigger = trigger;
+    action->kind = (uint32_t)kind;
+    action->node = node;
+}
+
+static void bind_declaration(Analysis* analysis, NodeId declaration) {
+    if (!bind_symbol(analysis->analyzer->symbols, flat_name(analysis->ast, declaration), declaration)) {
+        report_memory_error(analysis);
+    }
+}
+
+// 不需要声明的名字：this、super 以及用作类型转换的内置类型名（如 i64(x)）
+static int is_implicit_name(Symbol name) {
+    const char* text = symbol_name(name);
+    int length = symbol_length(name);
+    if ((length == 4 && memcmp(text, "this", 4) == 0) || (length == 5 && memcmp(text, "super", 5) == 0)) {
+        return 1;
+    }
+    for (int type = TOKEN_TYPE_INT; type <= TOKEN_TYPE_SLICE; type++) {
+        const char* keyword = keyword_text((TokenType)type);
+        if (keyword && (int)strlen(keyword) == length && memcmp(keyword, text, (size_t)length) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 登记一个全局声明。源文件中的同名声明是重复声明；头文件中的声明只在名字尚未被定义时登记，
+// 这样源文件可以给出头文件所声明函数的定义，多个头文件也可以重复声明同一函数
+static void hoist_declaration(Analysis* analysis, NodeId id, int from_header) {
+    ASTNodeType kind = flat_kind(analysis->ast, id);
+    if (kind != NODE_FUNCTION && kind != NODE_VARIABLE_DECL) {
+        return;
+    }
+    Symbol name = flat_name(analysis->ast, id);
+    if (lookup_symbol(analysis->analyzer->symbols, name) != BINDING_NONE) {
+        if (!from_header) {
+            report_error(analysis, id, "重复声明", name);
+        }
+        return;
+    }
+    bind_declaration(analysis, id);
+}
+
+// 全局作用域中的名字在整个翻译单元内可见，与声明的先后无关
+static void hoist_globals(Analysis* analysis) {
+    const FlatAST* ast = analysis->ast;
+    int count = flat_child_count(ast, FLAT_AST_ROOT);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < count; i++) {
+            NodeId child = flat_child(ast, FLAT_AST_ROOT, i);
+            if (child == NODE_NONE) continue;
+            if (flat_kind(ast, child) != NODE_INCLUDE) {
+                if (pass == 0) hoist_declaration(analysis, child, 0);
+            } else if (pass == 1) {
+                int declaration_count = flat_child_count(ast, child);
+                for (int j = 0; j < declaration_count; j++) {
+                    NodeId declaration = flat_child(ast, child, j);
+                    if (declaration != NODE_NONE) hoist_declaration(analysis, declaration, 1);
+                }
+            }
+        }
+    }
+}
+
+static void resolve_name(Analysis* analysis, NodeId id, const char* message) {
+    Symbol name = flat_name(analysis->ast, id);
+    Binding binding = lookup_symbol(analysis->analyzer->symbols, name);
+    if (binding != BINDING_NONE) {
+        analysis->ast->bindings[id] = binding;
+    } else if (name != SYMBOL_NONE && !is_implicit_name(name)) {
+        report_error(analysis, id, message, name);
+    }
 }
 
-SyntaxAnalyzer* create_syntax_analyzer() {
-    SyntaxAnalyzer* analyzer = (SyntaxAnalyzer*)malloc(sizeof(SyntaxAnalyzer));
-    // Initialize fields here
+// 前序线性扫描：节点按源代码顺序排列，作用域的开闭由操作栈在子树边界处触发，不需要递归
+static void resolve_names(Analysis* analysis) {
+    FlatAST* ast = analysis->ast;
+    SymbolTable* symbols = analysis->analyzer->symbols;
+    NodeId function_body = NODE_NONE;
+    NodeId id = 1;
+    while (id < ast->count && !analysis->out_of_memory) {
+        if (analysis->action_count > 0 && analysis->actions[analysis->action_count - 1].trigger <= id) {
+            ScopeAction action = analysis->actions[--analysis->action_count];
+            switch ((ActionKind)action.kind) {
+                case ACTION_LEAVE:
+                    leave_scope(symbols);
+                    break;
+                case ACTION_ENTER_BIND:
+                    if (!enter_scope(symbols)) report_memory_error(analysis);
+                    bind_declaration(analysis, action.node);
+                    break;
+                case ACTION_BIND:
+                    bind_declaration(analysis, action.node);
+                    break;
+                case ACTION_SKIP:
+                    id = action.node;
+                    break;
+            }
+            continue;
+        }
+
+        const uint32_t* record = flat_record(ast, id);
+        switch (flat_kind(ast, id)) {
+            case NODE_FUNCTION:
+                // 参数与函数体最外层的代码块共用一个作用域；未解析的函数体（NODE_NONE）不可达，无需分析
+                function_body = record[2];
+                if (!enter_scope(symbols)) report_memory_error(analysis);
+                push_action(analysis, ast->ends[id], ACTION_LEAVE, NODE_NONE);
+                break;
+            case NODE_BLOCK:
+                if (id != function_body) {
+                    if (!enter_scope(symbols)) report_memory_error(analysis);
+                    push_action(analysis, ast->ends[id], ACTION_LEAVE, NODE_NONE);
+                }
+                break;
+            case NODE_VARIABLE_DECL:
+                // 全局变量已预先登记
+                if (symbols->depth > 0) {
+                    Symbol name = flat_name(ast, id);
+                    if (declared_in_scope(symbols, name)) {
+                        report_error(analysis, id, "重复声明", name);
+                    } else {
+                        push_action(analysis, ast->ends[id], ACTION_BIND, id);
+                    }
+                }
+                break;
+            case NODE_FOR_STATEMENT: {
+                // 循环变量只在循环体中可见
+                NodeId iterable = record[1];
+                push_action(analysis, ast->ends[id], ACTION_LEAVE, NODE_NONE);
+                push_action(analysis, iterable != NODE_NONE ? ast->ends[iterable] : id + 1, ACTION_ENTER_BIND, id);
+                break;
+            }
+            case NODE_BINARY_OP:
+                if (record[0] == OP_SCOPE) {
+                    // A::B 的两侧都是类型或成员名
+                    id = ast->ends[id];
+                    continue;
+                }
+                if ((record[0] == OP_MEMBER || record[0] == OP_SAFE_MEMBER) && record[2] != NODE_NONE) {
+                    push_action(analysis, record[2], ACTION_SKIP, ast->ends[record[2]]);
+                }
+                break;
+            case NODE_VARIABLE:
+                resolve_name(analysis, id, "未定义的变量");
+                break;
+            case NODE_FUNCTION_CALL:
+                resolve_name(analysis, id, "未定义的函数");
+                break;
+            default:
+                break;
+        }
+        id++;
+    }
+}
+
+// 数值类型：整数、浮点数与 char，以及动态类型 int、flo
+static int numeric_type(TypeId type) {
+    return (type >= TYPE_CHAR && type <= TYPE_F128) || type == TYPE_INT || type == TYPE_FLO;
+}
+
+// 自增自减的操作数必须是数值类型的变量。变量的类型取标注的类型，未标注时取字面量初始值的类型；
+// 初始值不是字面量时要到代码生成推断出类型后才能检查
+static void check_increments(Analysis* analysis) {
+    const FlatAST* ast = analysis->ast;
+    for (NodeId id = FLAT_AST_ROOT; id < ast->count; id++) {
+        if (flat_kind(ast, id) != NODE_UNARY_OP) continue;
+        const uint32_t* record = flat_record(ast, id);
+        OperatorType op = (OperatorType)record[0];
+        NodeId operand = record[1];
+        if ((op != OP_PRE_INC && op != OP_PRE_DEC && op != OP_POST_INC && op != OP_POST_DEC) || operand == NODE_NONE) {
+            continue;
+        }
+        if (flat_kind(ast, operand) != NODE_VARIABLE) {
+            report_error(analysis, operand, "自增自减的操作数必须是变量", SYMBOL_NONE);
+            continue;
+        }
+        NodeId declaration = ast->bindings[operand];
+        if (declaration == NODE_NONE || flat_kind(ast, declaration) == NODE_FOR_STATEMENT) {
+            continue;   // 未定义的名字已经报告过；循环变量是整数
+        }
+        int numeric = 0;
+        if (flat_kind(ast, declaration) == NODE_VARIABLE_DECL) {
+            const uint32_t* declared = flat_record(ast, declaration);
+            NodeId initializer = declared[2];
+            if (declared[1] != TYPE_NONE) {
+                numeric = numeric_type(declared[1]);
+            } else if (initializer == NODE_NONE || flat_kind(ast, initializer) != NODE_LITERAL) {
+                numeric = 1;
+            } else {
+                LiteralType literal = flat_literal(ast, initializer)->type;
+                numeric = literal == LITERAL_INT || literal == LITERAL_FLOAT;
+            }
+        }
+        if (!numeric) {
+            report_error(analysis, operand, "自增自减的操作数必须是数值类型的变量", flat_name(ast, operand));
+        }
+    }
+}
+
+SyntaxAnalyzer* create_syntax_analyzer(void) {
+    SyntaxAnalyzer* analyzer = (SyntaxAnalyzer*)calloc(1, sizeof(SyntaxAnalyzer));
     return analyzer;
 }
 
+int analyze_syntax(SyntaxAnalyzer* analyzer, FlatAST* ast, const char* source, int length) {
+    if (!analyzer || !ast) return 0;
+    free(analyzer->error_message);
+    analyzer->error_message = NULL;
+    analyzer->error_count = 0;
+    destroy_symbol_table(analyzer->symbols);
+    analyzer->symbols = create_symbol_table();
+
+    Analysis analysis = { analyzer, ast, source, length, NULL, NULL, 0, 0, 0, 0 };
+    free(ast->bindings);
+    ast->bindings = (NodeId*)calloc(ast->count, sizeof(NodeId));
+    if (!analyzer->symbols || !ast->bindings) {
+        report_memory_error(&analysis);
+        return analyzer->error_count;
+    }
+
+    if (ast->count > FLAT_AST_ROOT) {
+        hoist_globals(&analysis);
+        resolve_names(&analysis);
+        check_increments(&analysis);
+    }
+
+    free(analysis.actions);
+    destroy_line_table(analysis.lines);
+    return analyzer->error_count;
+}
+
+const char* get_analyzer_error_message(SyntaxAnalyzer* analyzer) {
+    return analyzer ? analyzer->error_message : NULL;
+}
+
 void destroy_syntax_analyzer(SyntaxAnalyzer* analyzer) {
+    if (!analyzer) return;
+    destroy_symbol_table(analyzer->symbols);
+    free(analyzer->error_message);
     free(analyzer);
-}
\ No newline at end of file
+}
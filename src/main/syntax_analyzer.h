@@ -1,16 +1,27 @@
-// Header file for SCP Language Syntax Analyzer
+// 语义分析器头文件
+// 在扁平AST上做名字解析：全局的函数与变量（含 include 的头文件中的声明）先整体登记，
+// 再按前序线性扫描一遍，进入函数、代码块和 for 循环时开新作用域。
+// 每个变量引用和函数调用解析到的声明节点写入 FlatAST.bindings，之后的各遍不必再按名字查找。
+// 名字解析之后还检查自增自减的操作数是数值类型的变量。
 
 #ifndef SYNTAX_ANALYZER_H
 #define SYNTAX_ANALYZER_H
 
-// Define the SyntaxAnalyzer structure
+#include "flat_ast.h"
+#include "symbol_table.h"
+
 typedef struct {
-    char* analyzed_syntax;
+    SymbolTable* symbols;  // 作用域符号表
+    int error_count;       // 发现的错误数量（遇到错误后继续分析）
+    char* error_message;   // 第一个错误的信息
 } SyntaxAnalyzer;
 
-// Function prototypes
-SyntaxAnalyzer* create_syntax_analyzer();
-void analyze_syntax(SyntaxAnalyzer* analyzer, const char* tokens);
+// 函数原型
+SyntaxAnalyzer* create_syntax_analyzer(void);
+// 解析 ast 中的名字；source 用于在错误信息中报告行列号，可以为 NULL（如从标准输入读取）。
+// 返回发现的错误数量
+int analyze_syntax(SyntaxAnalyzer* analyzer, FlatAST* ast, const char* source, int length);
+const char* get_analyzer_error_message(SyntaxAnalyzer* analyzer);
 void destroy_syntax_analyzer(SyntaxAnalyzer* analyzer);
 
-#endif // SYNTAX_ANALYZER_H
\ No newline at end of file
+#endif // SYNTAX_ANALYZER_H
@@ -0,0 +1,138 @@
+#include "tail_call.h"
+#include "call_graph.h"
+#include "line_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    TailCalls* result;
+    const FlatAST* ast;
+    const CallGraph* graph;
+    const char* source;
+    int length;
+    LineTable* lines;        // 报告第一个错误时才构建
+    uint8_t* tail;           // 节点是否位于尾位置
+} Analysis;
+
+// 只保留第一条错误的文本（函数按源代码顺序检查），其余只计数
+static void report_error(Analysis* analysis, NodeId id, Symbol name) {
+    TailCalls* result = analysis->result;
+    if (result->error_count++ > 0) return;
+    char buffer[320];
+    int offset = analysis->ast->offsets[id];
+    if (analysis->source && !analysis->lines) {
+        analysis->lines = create_line_table(analysis->source, analysis->length);
+    }
+    if (analysis->lines) {
+        int line, column;
+        line_table_lookup(analysis->lines, offset, &line, &column);
+        snprintf(buffer, sizeof(buffer), "%d:%d: tailrec 函数中的递归调用不在尾位置: %.*s",
+                 line, column, symbol_length(name), symbol_name(name));
+    } else {
+        snprintf(buffer, sizeof(buffer), "tailrec 函数中的递归调用不在尾位置: %.*s",
+                 symbol_length(name), symbol_name(name));
+    }
+    result->error_message = strdup(buffer);
+}
+
+// 函数是否不返回值：未标注返回类型（或标注为 ()）且没有带值的 return
+static int returns_nothing(const FlatAST* ast, NodeId function) {
+    const uint32_t* record = flat_record(ast, function);
+    if (record[1] != TYPE_NONE && record[1] != TYPE_UNIT) return 0;
+    for (NodeId id = function + 1; id < ast->ends[function]; id++) {
+        if (flat_kind(ast, id) == NODE_RETURN && flat_record(ast, id)[0] != NODE_NONE) return 0;
+    }
+    return 1;
+}
+
+// 前序扫描一个 tailrec 函数：父节点先于子节点，尾位置自上而下传递
+static void check_function(Analysis* analysis, uint32_t index) {
+    const FlatAST* ast = analysis->ast;
+    const CallGraph* graph = analysis->graph;
+    NodeId function = graph->functions[index];
+    NodeId body = flat_record(ast, function)[2];
+    if (body == NODE_NONE) return;
+    uint8_t* tail = analysis->tail;
+    tail[body] = (uint8_t)returns_nothing(ast, function);
+
+    for (NodeId id = body; id < ast->ends[body]; id++) {
+        const uint32_t* record = flat_record(ast, id);
+        switch (flat_kind(ast, id)) {
+            case NODE_RETURN:
+                if (record[0] != NODE_NONE) tail[record[0]] = 1;
+                break;
+            case NODE_BLOCK: {
+                uint32_t count = record[0];
+                if (count > 0 && tail[id]) tail[record[count]] = 1;
+                // 调用语句之后紧跟不带值的 return
+                for (uint32_t i = 1; i < count; i++) {
+                    NodeId statement = record[i];
+                    NodeId next = record[i + 1];
+                    if (flat_kind(ast, statement) == NODE_FUNCTION_CALL && flat_kind(ast, next) == NODE_RETURN &&
+                        flat_record(ast, next)[0] == NODE_NONE) {
+                        tail[statement] = 1;
+                    }
+                }
+                break;
+            }
+            case NODE_IF_STATEMENT:
+                if (tail[id]) {
+                    if (record[1] != NODE_NONE) tail[record[1]] = 1;
+                    if (record[2] != NODE_NONE) tail[record[2]] = 1;
+                }
+                break;
+            case NODE_FUNCTION_CALL: {
+                NodeId callee = flat_binding(ast, id);
+                if (callee == NODE_NONE || flat_kind(ast, callee) != NODE_FUNCTION) break;
+                int callee_index = call_graph_index(graph, callee);
+                if (callee_index < 0 || graph->components[callee_index] != graph->components[index]) break;
+                if (!tail[id]) {
+                    report_error(analysis, id, flat_name(ast, id));
+                } else {
+                    analysis->result->kinds[id] = (uint8_t)(callee == function ? TAIL_CALL_LOOP : TAIL_CALL_MUSTTAIL);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+TailCalls* analyze_tail_calls(const FlatAST* ast, const char* source, int length) {
+    if (!ast) return NULL;
+    TailCalls* result = (TailCalls*)calloc(1, sizeof(TailCalls));
+    if (!result) return NULL;
+    result->count = ast->count;
+    result->kinds = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    Analysis analysis = { result, ast, NULL, source, length, NULL, NULL };
+    analysis.tail = (uint8_t*)calloc(ast->count, sizeof(uint8_t));
+    CallGraph* graph = build_call_graph(ast);
+    analysis.graph = graph;
+    if (!result->kinds || !analysis.tail || !graph) {
+        free(analysis.tail);
+        destroy_call_graph(graph);
+        destroy_tail_calls(result);
+        return NULL;
+    }
+
+    // 只有位于递归环上的 tailrec 函数需要检查
+    for (uint32_t i = 0; i < graph->function_count; i++) {
+        if ((flat_record(ast, graph->functions[i])[4] & MODIFIER_TAILREC) && graph->recursive[i]) {
+            check_function(&analysis, i);
+        }
+    }
+
+    free(analysis.tail);
+    destroy_line_table(analysis.lines);
+    destroy_call_graph(graph);
+    return result;
+}
+
+void destroy_tail_calls(TailCalls* tail_calls) {
+    if (!tail_calls) return;
+    free(tail_calls->kinds);
+    free(tail_calls->error_message);
+    free(tail_calls);
+}
@@ -0,0 +1,36 @@
+// 尾调用分析头文件
+// 检查 tailrec 函数：函数体中对自身以及对同一递归环（调用图的强连通分量）中其他函数的调用
+// 都必须位于尾位置，否则报告错误。分析结果交给代码生成器：尾位置上的自调用改写为跳回函数入口的循环，
+// 对同一递归环中其他函数的尾调用生成 musttail 调用，两者都不增加调用栈的深度；
+// musttail 要求调用者与被调函数的签名相同，不同时代码生成报告错误，不退化为普通调用。
+// 尾位置：return 的表达式；不返回值的函数中，函数体最后一条语句（沿末尾的 if 分支向内），
+// 以及紧跟着不带值的 return 的调用语句。
+
+#ifndef TAIL_CALL_H
+#define TAIL_CALL_H
+
+#include "flat_ast.h"
+
+typedef enum {
+    TAIL_CALL_NONE,      // 普通调用
+    TAIL_CALL_LOOP,      // tailrec 函数尾位置上的自调用：改写为循环
+    TAIL_CALL_MUSTTAIL   // tailrec 函数尾位置上对同一递归环中其他函数的调用
+} TailCallKind;
+
+typedef struct {
+    uint8_t* kinds;        // 每个节点的 TailCallKind（只对 NODE_FUNCTION_CALL 有意义）
+    uint32_t count;        // 节点数量
+    int error_count;
+    char* error_message;   // 第一个错误的信息
+} TailCalls;
+
+// 函数原型
+// source 用于在错误信息中报告行列号，可以为 NULL。内存不足时返回 NULL
+TailCalls* analyze_tail_calls(const FlatAST* ast, const char* source, int length);
+void destroy_tail_calls(TailCalls* tail_calls);
+
+static inline TailCallKind tail_call_kind(const TailCalls* tail_calls, NodeId id) {
+    return tail_calls && id < tail_calls->count ? (TailCallKind)tail_calls->kinds[id] : TAIL_CALL_NONE;
+}
+
+#endif // TAIL_CALL_H
@@ -0,0 +1,94 @@
+#include "thread.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+struct Thread {
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFunction function;
+    void* argument;
+};
+
+#ifdef _WIN32
+static DWORD WINAPI thread_entry(LPVOID data) {
+    Thread* thread = (Thread*)data;
+    thread->function(thread->argument);
+    return 0;
+}
+#else
+static void* thread_entry(void* data) {
+    Thread* thread = (Thread*)data;
+    thread->function(thread->argument);
+    return NULL;
+}
+#endif
+
+// 创建并启动线程
+Thread* create_thread(ThreadFunction function, void* argument) {
+    Thread* thread = (Thread*)malloc(sizeof(Thread));
+    if (!thread) return NULL;
+    thread->function = function;
+    thread->argument = argument;
+
+#ifdef _WIN32
+    thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+    if (!thread->handle) {
+        free(thread);
+        return NULL;
+    }
+#else
+    if (pthread_create(&thread->handle, NULL, thread_entry, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+#endif
+    return thread;
+}
+
+// 等待线程结束
+void join_thread(Thread* thread) {
+    if (!thread) return;
+#ifdef _WIN32
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    free(thread);
+}
+
+void lock_mutex(Mutex* mutex) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive((PSRWLOCK)mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void unlock_mutex(Mutex* mutex) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive((PSRWLOCK)mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
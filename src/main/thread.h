@@ -0,0 +1,36 @@
+// 线程封装头文件
+// 在 POSIX 上使用 pthreads，在 Windows 上使用 Win32 线程，对外只暴露创建、等待与互斥锁。
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+typedef struct Thread Thread;
+
+// 互斥锁，可以用 MUTEX_INITIALIZER 静态初始化，进程内的共享表无需单独的初始化步骤
+#ifdef _WIN32
+typedef struct { void* lock; } Mutex;   // 与 SRWLOCK 布局相同
+#define MUTEX_INITIALIZER { 0 }
+#else
+typedef pthread_mutex_t Mutex;
+#define MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#endif
+
+// 线程入口函数
+typedef void (*ThreadFunction)(void* argument);
+
+// 创建并启动线程，失败时返回 NULL
+Thread* create_thread(ThreadFunction function, void* argument);
+// 等待线程结束并释放其资源
+void join_thread(Thread* thread);
+
+void lock_mutex(Mutex* mutex);
+void unlock_mutex(Mutex* mutex);
+
+// 可用的处理器核心数（至少为1）
+int cpu_count(void);
+
+#endif // THREAD_H
@@ -0,0 +1,575 @@
+#include "type_interner.h"
+#include "arena.h"
+#include "thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TYPE_TABLE_INITIAL_CAPACITY 256    // 哈希表初始槽数（2的幂）
+#define TYPE_TABLE_ARENA_CHUNK_SIZE (64 * 1024)
+#define TYPE_TEXT_MAX_DEPTH 256            // 类型文本的最大嵌套层数，更深的文本整体作为具名类型
+
+// 类型条目：种类与组成部分共同构成哈希的键
+typedef struct {
+    uint8_t kind;          // TypeKind
+    uint32_t hash;         // 缓存的哈希值，扩容时无需重新计算
+    TypeId element;        // 元素类型或泛型的基础类型
+    uint32_t count;        // 元组元素或类型实参的数量
+    uint32_t operands;     // 元组元素或类型实参在 operands 中的起点
+    uint64_t length;       // 数组长度
+    const char* name;      // 规范文本（位于区域分配器中）
+    uint32_t name_length;
+} TypeEntry;
+
+// 类型表结构：开放寻址哈希表 + 按编号排列的条目数组 + 变长的组成部分 + 存放文本的区域分配器
+typedef struct {
+    TypeId* slots;         // 哈希槽，存放类型编号（0 表示空槽）
+    uint32_t slot_mask;    // 槽数 - 1
+    TypeEntry* entries;    // 条目数组，下标即类型编号（0 号保留）
+    uint32_t count;
+    uint32_t capacity;
+    TypeId* operands;
+    uint32_t operand_count;
+    uint32_t operand_capacity;
+    Arena* names;
+} TypeTable;
+
+// 查找或构造类型时的键；具名类型以 name 区分，其余类型的 name 由组成部分推导，不参与比较
+typedef struct {
+    TypeKind kind;
+    TypeId element;
+    const TypeId* operands;
+    uint32_t count;
+    uint64_t length;
+    const char* name;
+    uint32_t name_length;
+} TypeKey;
+
+static TypeTable* table = NULL;
+static Mutex table_lock = MUTEX_INITIALIZER;
+
+// 基本类型的文本，下标为类型编号
+static const char* const primitive_names[TYPE_PRIMITIVE_END] = {
+    [TYPE_UNIT] = "()",   [TYPE_NEVER] = "never", [TYPE_NULL] = "null",
+    [TYPE_BOOL] = "bool", [TYPE_CHAR] = "char",
+    [TYPE_I8] = "i8",     [TYPE_U8] = "u8",       [TYPE_I16] = "i16",   [TYPE_U16] = "u16",
+    [TYPE_I32] = "i32",   [TYPE_U32] = "u32",     [TYPE_I64] = "i64",   [TYPE_U64] = "u64",
+    [TYPE_I128] = "i128", [TYPE_U128] = "u128",   [TYPE_ISIZE] = "isize", [TYPE_USIZE] = "usize",
+    [TYPE_F32] = "f32",   [TYPE_F64] = "f64",     [TYPE_F128] = "f128",
+    [TYPE_STR] = "str",   [TYPE_STRING] = "String",
+    [TYPE_INT] = "int",   [TYPE_FLO] = "flo",     [TYPE_OBJ] = "obj",
+};
+
+// FNV-1a 哈希
+static uint32_t hash_step(uint32_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_key(const TypeKey* key) {
+    uint32_t hash = 2166136261u;
+    uint32_t kind = (uint32_t)key->kind;
+    hash = hash_step(hash, &kind, sizeof(kind));
+    hash = hash_step(hash, &key->element, sizeof(key->element));
+    hash = hash_step(hash, &key->length, sizeof(key->length));
+    hash = hash_step(hash, key->operands, sizeof(TypeId) * key->count);
+    if (key->kind == TYPE_KIND_NAMED || key->kind == TYPE_KIND_PRIMITIVE) {
+        hash = hash_step(hash, key->name, key->name_length);
+    }
+    return hash;
+}
+
+static int key_matches(const TypeTable* types, const TypeEntry* entry, const TypeKey* key) {
+    if (entry->kind != key->kind || entry->element != key->element || entry->length != key->length ||
+        entry->count != key->count) {
+        return 0;
+    }
+    if (key->count > 0 && memcmp(types->operands + entry->operands, key->operands, sizeof(TypeId) * key->count) != 0) {
+        return 0;
+    }
+    if (key->kind == TYPE_KIND_NAMED || key->kind == TYPE_KIND_PRIMITIVE) {
+        return entry->name_length == key->name_length && memcmp(entry->name, key->name, key->name_length) == 0;
+    }
+    return 1;
+}
+
+// 线性探测查找：返回类型所在或应插入的槽位
+static uint32_t probe(const TypeTable* types, const TypeKey* key, uint32_t hash) {
+    uint32_t index = hash & types->slot_mask;
+    for (;;) {
+        TypeId id = types->slots[index];
+        if (id == TYPE_NONE) return index;
+        const TypeEntry* entry = &types->entries[id];
+        if (entry->hash == hash && key_matches(types, entry, key)) {
+            return index;
+        }
+        index = (index + 1) & types->slot_mask;
+    }
+}
+
+// 槽数翻倍并重新放置所有类型
+static int grow_slots(TypeTable* types) {
+    uint32_t new_size = (types->slot_mask + 1) * 2;
+    TypeId* slots = (TypeId*)calloc(new_size, sizeof(TypeId));
+    if (!slots) return 0;
+
+    uint32_t mask = new_size - 1;
+    for (uint32_t id = 1; id < types->count; id++) {
+        uint32_t index = types->entries[id].hash & mask;
+        while (slots[index]) index = (index + 1) & mask;
+        slots[index] = id;
+    }
+    free(types->slots);
+    types->slots = slots;
+    types->slot_mask = mask;
+    return 1;
+}
+
+// 拼接规范文本用的缓冲区
+typedef struct {
+    char* text;
+    size_t length;
+    size_t capacity;
+    int failed;
+} TextBuilder;
+
+static void append_text(TextBuilder* builder, const char* text, size_t length) {
+    if (builder->failed) return;
+    if (builder->length + length + 1 > builder->capacity) {
+        size_t capacity = builder->capacity ? builder->capacity : 64;
+        while (builder->length + length + 1 > capacity) capacity *= 2;
+        char* grown = (char*)realloc(builder->text, capacity);
+        if (!grown) {
+            builder->failed = 1;
+            return;
+        }
+        builder->text = grown;
+        builder->capacity = capacity;
+    }
+    memcpy(builder->text + builder->length, text, length);
+    builder->length += length;
+    builder->text[builder->length] = '\0';
+}
+
+static void append_type(TextBuilder* builder, const TypeTable* types, TypeId type) {
+    append_text(builder, types->entries[type].name, types->entries[type].name_length);
+}
+
+// 由组成部分拼出类型的规范文本
+static void build_name(TextBuilder* builder, const TypeTable* types, const TypeKey* key) {
+    switch (key->kind) {
+        case TYPE_KIND_TUPLE:
+            append_text(builder, "(", 1);
+            for (uint32_t i = 0; i < key->count; i++) {
+                if (i > 0) append_text(builder, ",", 1);
+                append_type(builder, types, key->operands[i]);
+            }
+            append_text(builder, ")", 1);
+            break;
+        case TYPE_KIND_ARRAY: {
+            char length[32];
+            int digits = snprintf(length, sizeof(length), ";%llu]", (unsigned long long)key->length);
+            append_text(builder, "[", 1);
+            append_type(builder, types, key->element);
+            append_text(builder, length, (size_t)digits);
+            break;
+        }
+        case TYPE_KIND_SLICE:
+            append_text(builder, "slice(", 6);
+            append_type(builder, types, key->element);
+            append_text(builder, ")", 1);
+            break;
+        case TYPE_KIND_NULLABLE:
+            append_type(builder, types, key->element);
+            append_text(builder, "?", 1);
+            break;
+        case TYPE_KIND_GENERIC:
+            append_type(builder, types, key->element);
+            append_text(builder, "<", 1);
+            for (uint32_t i = 0; i < key->count; i++) {
+                if (i > 0) append_text(builder, ",", 1);
+                append_type(builder, types, key->operands[i]);
+            }
+            append_text(builder, ">", 1);
+            break;
+        default:
+            append_text(builder, key->name, key->name_length);
+            break;
+    }
+}
+
+// 查找结构相同的类型，不存在时构造一个（调用方持有 table_lock）
+static TypeId intern_key(TypeTable* types, const TypeKey* key) {
+    uint32_t hash = hash_key(key);
+    uint32_t index = probe(types, key, hash);
+    if (types->slots[index]) return types->slots[index];
+
+    // 保持装载因子不超过 1/2
+    if ((types->count + 1) * 2 > types->slot_mask + 1) {
+        if (!grow_slots(types)) return TYPE_NONE;
+        index = probe(types, key, hash);
+    }
+    if (types->count == types->capacity) {
+        uint32_t capacity = types->capacity * 2;
+        TypeEntry* entries = (TypeEntry*)realloc(types->entries, sizeof(TypeEntry) * capacity);
+        if (!entries) return TYPE_NONE;
+        types->entries = entries;
+        types->capacity = capacity;
+    }
+    if (types->operand_count + key->count > types->operand_capacity) {
+        uint32_t capacity = types->operand_capacity ? types->operand_capacity : 64;
+        while (capacity < types->operand_count + key->count) capacity *= 2;
+        TypeId* operands = (TypeId*)realloc(types->operands, sizeof(TypeId) * capacity);
+        if (!operands) return TYPE_NONE;
+        types->operands = operands;
+        types->operand_capacity = capacity;
+    }
+
+    TextBuilder builder = { NULL, 0, 0, 0 };
+    build_name(&builder, types, key);
+    const char* name = builder.failed ? NULL : arena_strndup(types->names, builder.text ? builder.text : "", builder.length);
+    free(builder.text);
+    if (!name) return TYPE_NONE;
+
+    TypeId id = types->count++;
+    TypeEntry* entry = &types->entries[id];
+    entry->kind = (uint8_t)key->kind;
+    entry->hash = hash;
+    entry->element = key->element;
+    entry->count = key->count;
+    entry->operands = types->operand_count;
+    entry->length = key->length;
+    entry->name = name;
+    entry->name_length = (uint32_t)builder.length;
+    if (key->count > 0) {
+        memcpy(types->operands + types->operand_count, key->operands, sizeof(TypeId) * key->count);
+        types->operand_count += key->count;
+    }
+    types->slots[index] = id;
+    return id;
+}
+
+// 首次使用时建表，并按固定编号登记全部基本类型（调用方持有 table_lock）
+static TypeTable* get_table(void) {
+    if (table) return table;
+
+    TypeTable* types = (TypeTable*)calloc(1, sizeof(TypeTable));
+    if (!types) return NULL;
+    types->slots = (TypeId*)calloc(TYPE_TABLE_INITIAL_CAPACITY, sizeof(TypeId));
+    types->slot_mask = TYPE_TABLE_INITIAL_CAPACITY - 1;
+    types->capacity = TYPE_TABLE_INITIAL_CAPACITY / 2;
+    types->entries = (TypeEntry*)malloc(sizeof(TypeEntry) * types->capacity);
+    types->names = create_arena(TYPE_TABLE_ARENA_CHUNK_SIZE);
+    types->count = 1;
+    int ok = types->slots && types->entries && types->names;
+    if (ok) {
+        // 0 号类型保留给 TYPE_NONE
+        memset(&types->entries[0], 0, sizeof(TypeEntry));
+        types->entries[0].name = "";
+        for (TypeId id = TYPE_UNIT; id < TYPE_PRIMITIVE_END && ok; id++) {
+            TypeKey key = { TYPE_KIND_PRIMITIVE, TYPE_NONE, NULL, 0, 0,
+                            primitive_names[id], (uint32_t)strlen(primitive_names[id]) };
+            ok = intern_key(types, &key) == id;
+        }
+    }
+    if (!ok) {
+        free(types->slots);
+        free(types->entries);
+        destroy_arena(types->names);
+        free(types);
+        return NULL;
+    }
+    table = types;
+    return table;
+}
+
+static TypeId make_named(TypeTable* types, const char* name, int length) {
+    for (TypeId id = TYPE_UNIT; id < TYPE_PRIMITIVE_END; id++) {
+        if ((int)strlen(primitive_names[id]) == length && memcmp(primitive_names[id], name, (size_t)length) == 0) {
+            return id;
+        }
+    }
+    TypeKey key = { TYPE_KIND_NAMED, TYPE_NONE, NULL, 0, 0, name, (uint32_t)length };
+    return intern_key(types, &key);
+}
+
+static TypeId make_composite(TypeTable* types, TypeKind kind, TypeId element, const TypeId* operands,
+                             int count, uint64_t length) {
+    if ((kind != TYPE_KIND_TUPLE && element == TYPE_NONE) || count < 0) return TYPE_NONE;
+    for (int i = 0; i < count; i++) {
+        if (operands[i] == TYPE_NONE || operands[i] >= types->count) return TYPE_NONE;
+    }
+    // 可空类型再加 ? 仍是同一类型
+    if (kind == TYPE_KIND_NULLABLE && types->entries[element].kind == TYPE_KIND_NULLABLE) {
+        return element;
+    }
+    TypeKey key = { kind, element, operands, (uint32_t)count, length, NULL, 0 };
+    return intern_key(types, &key);
+}
+
+TypeId named_type(const char* name, int length) {
+    if (!name || length <= 0) return TYPE_NONE;
+    lock_mutex(&table_lock);
+    TypeTable* types = get_table();
+    TypeId type = types ? make_named(types, name, length) : TYPE_NONE;
+    unlock_mutex(&table_lock);
+    return type;
+}
+
+static TypeId locked_composite(TypeKind kind, TypeId element, const TypeId* operands, int count, uint64_t length) {
+    lock_mutex(&table_lock);
+    TypeTable* types = get_table();
+    TypeId type = TYPE_NONE;
+    if (types && element < types->count) {
+        type = make_composite(types, kind, element, operands, count, length);
+    }
+    unlock_mutex(&table_lock);
+    return type;
+}
+
+TypeId tuple_type(const TypeId* elements, int count) {
+    // 空元组即单元类型；与类型文本一致，单个元素的元组就是该元素本身（括号只是分组）
+    if (count == 0) return TYPE_UNIT;
+    if (count == 1) return elements[0];
+    return locked_composite(TYPE_KIND_TUPLE, TYPE_NONE, elements, count, 0);
+}
+
+TypeId array_type(TypeId element, uint64_t length) {
+    return locked_composite(TYPE_KIND_ARRAY, element, NULL, 0, length);
+}
+
+TypeId slice_type(TypeId element) {
+    return locked_composite(TYPE_KIND_SLICE, element, NULL, 0, 0);
+}
+
+TypeId nullable_type(TypeId element) {
+    return locked_composite(TYPE_KIND_NULLABLE, element, NULL, 0, 0);
+}
+
+TypeId generic_type(TypeId base, const TypeId* arguments, int count) {
+    if (count == 0) return base;
+    return locked_composite(TYPE_KIND_GENERIC, base, arguments, count, 0);
+}
+
+// ---------------------------------------------------------------------------
+// 类型文本：语法分析器把类型的各个标记拼接为无空格的文本，预编译头中也以文本保存类型
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    TypeTable* types;
+    const char* text;
+    int length;
+    int position;
+    int depth;
+    int failed;
+} TypeTextParser;
+
+static int peek_char(const TypeTextParser* parser) {
+    return parser->position < parser->length ? (unsigned char)parser->text[parser->position] : '\0';
+}
+
+static int accept_char(TypeTextParser* parser, char c) {
+    if (peek_char(parser) == c) {
+        parser->position++;
+        return 1;
+    }
+    return 0;
+}
+
+static int is_name_start(int c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80;
+}
+
+static int is_name_char(int c) {
+    return is_name_start(c) || (c >= '0' && c <= '9');
+}
+
+static TypeId parse_text_type(TypeTextParser* parser);
+
+// 逗号分隔的类型列表，直到 close 为止
+static int parse_text_list(TypeTextParser* parser, char close, TypeId** list, int* count) {
+    int capacity = 0;
+    *list = NULL;
+    *count = 0;
+    do {
+        TypeId type = parse_text_type(parser);
+        if (parser->failed) return 0;
+        if (*count == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            TypeId* grown = (TypeId*)realloc(*list, sizeof(TypeId) * capacity);
+            if (!grown) return 0;
+            *list = grown;
+        }
+        (*list)[(*count)++] = type;
+    } while (accept_char(parser, ','));
+    return accept_char(parser, close);
+}
+
+// 名字，可以带 . 或 :: 限定
+static void parse_text_name(TypeTextParser* parser) {
+    for (;;) {
+        while (is_name_char(peek_char(parser))) parser->position++;
+        if (parser->position + 1 < parser->length && parser->text[parser->position] == ':' &&
+            parser->text[parser->position + 1] == ':' && parser->position + 2 < parser->length &&
+            is_name_start((unsigned char)parser->text[parser->position + 2])) {
+            parser->position += 2;
+        } else if (peek_char(parser) == '.' && parser->position + 1 < parser->length &&
+                   is_name_start((unsigned char)parser->text[parser->position + 1])) {
+            parser->position++;
+        } else {
+            return;
+        }
+    }
+}
+
+static TypeId parse_text_primary(TypeTextParser* parser) {
+    TypeTable* types = parser->types;
+    int c = peek_char(parser);
+    if (accept_char(parser, '(')) {
+        if (accept_char(parser, ')')) return TYPE_UNIT;
+        TypeId* elements;
+        int count;
+        TypeId type = TYPE_NONE;
+        if (parse_text_list(parser, ')', &elements, &count)) {
+            // 单个类型加括号只是分组
+            type = count == 1 ? elements[0] : make_composite(types, TYPE_KIND_TUPLE, TYPE_NONE, elements, count, 0);
+        }
+        free(elements);
+        return type;
+    }
+    if (accept_char(parser, '[')) {
+        TypeId element = parse_text_type(parser);
+        if (parser->failed || !accept_char(parser, ';')) return TYPE_NONE;
+        uint64_t length = 0;
+        int digits = 0;
+        for (int d = peek_char(parser); (d >= '0' && d <= '9') || d == '_'; d = peek_char(parser)) {
+            if (d != '_') {
+                if (length > (UINT64_MAX - 9) / 10) return TYPE_NONE;
+                length = length * 10 + (uint64_t)(d - '0');
+                digits++;
+            }
+            parser->position++;
+        }
+        // 长度可以带整数后缀（如 4usize）
+        while (is_name_char(peek_char(parser))) parser->position++;
+        if (digits == 0 || !accept_char(parser, ']')) return TYPE_NONE;
+        return make_composite(types, TYPE_KIND_ARRAY, element, NULL, 0, length);
+    }
+    if (accept_char(parser, '!')) {
+        return TYPE_NEVER;
+    }
+    if (!is_name_start(c)) {
+        return TYPE_NONE;
+    }
+    int start = parser->position;
+    parse_text_name(parser);
+    const char* name = parser->text + start;
+    int length = parser->position - start;
+    if (length == 5 && memcmp(name, "slice", 5) == 0 && accept_char(parser, '(')) {
+        TypeId element = parse_text_type(parser);
+        if (parser->failed || !accept_char(parser, ')')) return TYPE_NONE;
+        return make_composite(types, TYPE_KIND_SLICE, element, NULL, 0, 0);
+    }
+    TypeId base = make_named(types, name, length);
+    if (!accept_char(parser, '<')) {
+        return base;
+    }
+    TypeId* arguments;
+    int count;
+    TypeId type = TYPE_NONE;
+    if (parse_text_list(parser, '>', &arguments, &count)) {
+        type = make_composite(types, TYPE_KIND_GENERIC, base, arguments, count, 0);
+    }
+    free(arguments);
+    return type;
+}
+
+static TypeId parse_text_type(TypeTextParser* parser) {
+    if (++parser->depth > TYPE_TEXT_MAX_DEPTH) {
+        parser->failed = 1;
+        return TYPE_NONE;
+    }
+    TypeId type = parse_text_primary(parser);
+    while (type != TYPE_NONE && accept_char(parser, '?')) {
+        type = make_composite(parser->types, TYPE_KIND_NULLABLE, type, NULL, 0, 0);
+    }
+    if (type == TYPE_NONE) parser->failed = 1;
+    parser->depth--;
+    return type;
+}
+
+TypeId intern_type_text(const char* text, int length) {
+    if (!text || length <= 0) return TYPE_NONE;
+    lock_mutex(&table_lock);
+    TypeTable* types = get_table();
+    TypeId type = TYPE_NONE;
+    if (types) {
+        TypeTextParser parser = { types, text, length, 0, 0, 0 };
+        type = parse_text_type(&parser);
+        // 无法识别结构的文本（如头文件中的 C 类型 unsigned char）整体作为具名类型
+        if (parser.failed || parser.position != length) {
+            type = make_named(types, text, length);
+        }
+    }
+    unlock_mutex(&table_lock);
+    return type;
+}
+
+// ---------------------------------------------------------------------------
+// 访问类型
+// ---------------------------------------------------------------------------
+
+static const TypeEntry* type_entry(TypeId type) {
+    return table && type != TYPE_NONE && type < table->count ? &table->entries[type] : NULL;
+}
+
+TypeKind type_kind(TypeId type) {
+    const TypeEntry* entry = type_entry(type);
+    return entry ? (TypeKind)entry->kind : TYPE_KIND_NONE;
+}
+
+TypeId type_element(TypeId type) {
+    const TypeEntry* entry = type_entry(type);
+    return entry ? entry->element : TYPE_NONE;
+}
+
+int type_operand_count(TypeId type) {
+    const TypeEntry* entry = type_entry(type);
+    return entry && entry->kind != TYPE_KIND_NAMED && entry->kind != TYPE_KIND_PRIMITIVE ? (int)entry->count : 0;
+}
+
+TypeId type_operand(TypeId type, int index) {
+    if (index < 0 || index >= type_operand_count(type)) return TYPE_NONE;
+    return table->operands[table->entries[type].operands + (uint32_t)index];
+}
+
+uint64_t type_array_length(TypeId type) {
+    const TypeEntry* entry = type_entry(type);
+    return entry ? entry->length : 0;
+}
+
+const char* type_name(TypeId type) {
+    const TypeEntry* entry = type_entry(type);
+    return entry ? entry->name : "";
+}
+
+int type_count(void) {
+    return table ? (int)table->count - 1 : 0;
+}
+
+void destroy_type_interner(void) {
+    lock_mutex(&table_lock);
+    if (table) {
+        free(table->slots);
+        free(table->entries);
+        free(table->operands);
+        destroy_arena(table->names);
+        free(table);
+        table = NULL;
+    }
+    unlock_mutex(&table_lock);
+}
@@ -0,0 +1,87 @@
+// 类型驻留表头文件
+// 整个进程共享一张类型表：结构相同的类型只存储一次，并对应一个32位类型编号（hash-consing）。
+// 判断两个类型是否相同只需比较编号，类型编号也可以直接作为哈希表的键，
+// 类型检查时不再需要逐层比较类型的结构。基本类型的编号是固定的常量，复合类型由其组成部分的编号构造。
+// 构造类型的函数是线程安全的（并行解析的工作线程也会构造类型）；访问函数只读，
+// 须在构造类型的线程都结束之后使用。
+
+#ifndef TYPE_INTERNER_H
+#define TYPE_INTERNER_H
+
+#include <stdint.h>
+
+// 类型编号，0 表示"无类型"（未标注类型）
+typedef uint32_t TypeId;
+
+#define TYPE_NONE ((TypeId)0)
+
+// 基本类型的固定编号
+enum {
+    TYPE_UNIT = 1,       // ()
+    TYPE_NEVER,          // never（也写作 !）
+    TYPE_NULL,           // null
+    TYPE_BOOL,
+    TYPE_CHAR,
+    TYPE_I8,
+    TYPE_U8,
+    TYPE_I16,
+    TYPE_U16,
+    TYPE_I32,
+    TYPE_U32,
+    TYPE_I64,
+    TYPE_U64,
+    TYPE_I128,
+    TYPE_U128,
+    TYPE_ISIZE,
+    TYPE_USIZE,
+    TYPE_F32,
+    TYPE_F64,
+    TYPE_F128,
+    TYPE_STR,            // 不可变字符串
+    TYPE_STRING,         // 可变字符串 String
+    TYPE_INT,            // 动态类型 int、flo、obj
+    TYPE_FLO,
+    TYPE_OBJ,
+    TYPE_PRIMITIVE_END   // 之后的编号都是复合类型或具名类型
+};
+
+// 类型的种类
+typedef enum {
+    TYPE_KIND_NONE,
+    TYPE_KIND_PRIMITIVE, // 基本类型
+    TYPE_KIND_NAMED,     // 具名类型（类、结构体、类型参数，以及无法识别结构的类型文本）
+    TYPE_KIND_TUPLE,     // (T1, T2, ...)
+    TYPE_KIND_ARRAY,     // [T; N]
+    TYPE_KIND_SLICE,     // slice(T)
+    TYPE_KIND_NULLABLE,  // T?
+    TYPE_KIND_GENERIC    // Name<T1, T2, ...>
+} TypeKind;
+
+// 构造类型（线程安全）；内存不足时返回 TYPE_NONE
+TypeId named_type(const char* name, int length);
+TypeId tuple_type(const TypeId* elements, int count);
+TypeId array_type(TypeId element, uint64_t length);
+TypeId slice_type(TypeId element);
+TypeId nullable_type(TypeId element);   // T?? 与 T? 是同一类型
+TypeId generic_type(TypeId base, const TypeId* arguments, int count);
+// 由类型文本（如 "[i32;4]"、"Map<str,int>?"）构造类型。无法识别结构的文本整体作为一个具名类型，
+// 空文本返回 TYPE_NONE
+TypeId intern_type_text(const char* text, int length);
+
+// 访问类型
+TypeKind type_kind(TypeId type);
+// 数组、切片、可空类型的元素类型，泛型实例化的基础类型；其他类型返回 TYPE_NONE
+TypeId type_element(TypeId type);
+// 元组的元素、泛型实例化的类型实参
+int type_operand_count(TypeId type);
+TypeId type_operand(TypeId type, int index);
+uint64_t type_array_length(TypeId type);
+// 类型的规范文本（无空格），可由 intern_type_text 还原为同一类型；TYPE_NONE 返回空字符串
+const char* type_name(TypeId type);
+// 已构造的类型数量（含基本类型）
+int type_count(void);
+
+// 释放整张类型表，之后的类型编号全部失效
+void destroy_type_interner(void);
+
+#endif // TYPE_INTERNER_H
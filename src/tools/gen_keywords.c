@@ -0,0 +1,183 @@
+// 关键字完美哈希表生成器
+// 在构建时运行：读取 src/main/keywords.def，使用"哈希-位移"算法 (hash and displace)
+// 为全部关键字求出一个最小完美哈希，并将查找表写入指定的头文件。
+// 用法: gen_keywords <输出头文件>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "token_types.h"
+#include "keyword_hash.h"
+
+typedef struct {
+    const char* text;       // 关键字文本
+    const char* type_name;  // 标记类型的枚举名
+    int length;             // 关键字长度
+    uint32_t feature;       // 哈希特征值
+    int bucket;             // 第一级桶编号
+} KeywordSpec;
+
+static KeywordSpec keywords[] = {
+#define KEYWORD(text, type) { text, #type, 0, 0, 0 },
+#include "keywords.def"
+#undef KEYWORD
+};
+
+#define KEYWORD_SPEC_COUNT ((int)(sizeof(keywords) / sizeof(keywords[0])))
+#define MAX_DISPLACEMENT 65535
+
+static int bucket_count;
+static int* bucket_sizes;
+
+// 按桶内关键字数量降序排列桶编号
+static int compare_buckets(const void* a, const void* b) {
+    int left = *(const int*)a;
+    int right = *(const int*)b;
+    if (bucket_sizes[left] != bucket_sizes[right]) {
+        return bucket_sizes[right] - bucket_sizes[left];
+    }
+    return left - right;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "用法: %s <输出头文件>\n", argv[0]);
+        return 1;
+    }
+
+    int count = KEYWORD_SPEC_COUNT;
+    int min_length = 1 << 30;
+    int max_length = 0;
+
+    for (int i = 0; i < count; i++) {
+        keywords[i].length = (int)strlen(keywords[i].text);
+        if (keywords[i].length < 2) {
+            fprintf(stderr, "关键字过短: %s\n", keywords[i].text);
+            return 1;
+        }
+        keywords[i].feature = keyword_feature(keywords[i].text, keywords[i].length);
+        if (keywords[i].length < min_length) min_length = keywords[i].length;
+        if (keywords[i].length > max_length) max_length = keywords[i].length;
+    }
+
+    // 特征值必须互不相同，否则无法构造完美哈希
+    for (int i = 0; i < count; i++) {
+        for (int j = i + 1; j < count; j++) {
+            if (keywords[i].feature == keywords[j].feature) {
+                fprintf(stderr, "关键字特征冲突: %s / %s\n", keywords[i].text, keywords[j].text);
+                return 1;
+            }
+        }
+    }
+
+    // 第一级：把关键字分配到桶中
+    bucket_count = count / 2 + 1;
+    bucket_sizes = (int*)calloc(bucket_count, sizeof(int));
+    int* order = (int*)malloc(sizeof(int) * bucket_count);
+    int* displacements = (int*)calloc(bucket_count, sizeof(int));
+    int* slots = (int*)malloc(sizeof(int) * count);
+    if (!bucket_sizes || !order || !displacements || !slots) {
+        fprintf(stderr, "内存分配错误\n");
+        return 1;
+    }
+    for (int i = 0; i < count; i++) {
+        keywords[i].bucket = (int)(keyword_mix(keywords[i].feature, 0) % (uint32_t)bucket_count);
+        bucket_sizes[keywords[i].bucket]++;
+        slots[i] = -1;
+    }
+    for (int b = 0; b < bucket_count; b++) {
+        order[b] = b;
+    }
+    qsort(order, bucket_count, sizeof(int), compare_buckets);
+
+    // 第二级：从最大的桶开始，为每个桶寻找使其全部关键字落入空槽的位移值
+    int* occupied = (int*)calloc(count, sizeof(int));
+    int members[64];
+    int member_slots[64];
+    for (int k = 0; k < bucket_count; k++) {
+        int b = order[k];
+        if (bucket_sizes[b] == 0) break;
+
+        int member_count = 0;
+        for (int i = 0; i < count; i++) {
+            if (keywords[i].bucket == b && member_count < 64) members[member_count++] = i;
+        }
+
+        int found = 0;
+        for (int d = 1; d <= MAX_DISPLACEMENT && !found; d++) {
+            found = 1;
+            for (int m = 0; m < member_count && found; m++) {
+                int slot = (int)(keyword_mix(keywords[members[m]].feature, (uint32_t)d) % (uint32_t)count);
+                if (occupied[slot]) found = 0;
+                for (int n = 0; n < m && found; n++) {
+                    if (member_slots[n] == slot) found = 0;
+                }
+                member_slots[m] = slot;
+            }
+            if (found) {
+                displacements[b] = d;
+                for (int m = 0; m < member_count; m++) {
+                    occupied[member_slots[m]] = 1;
+                    slots[members[m]] = member_slots[m];
+                }
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "无法为第 %d 个桶找到位移值\n", b);
+            return 1;
+        }
+    }
+
+    int* slot_owner = (int*)malloc(sizeof(int) * count);
+    for (int i = 0; i < count; i++) {
+        slot_owner[slots[i]] = i;
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "无法创建文件: %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "// 关键字最小完美哈希表\n");
+    fprintf(out, "// 由 src/tools/gen_keywords.c 根据 src/main/keywords.def 自动生成，请勿手动修改\n\n");
+    fprintf(out, "#ifndef KEYWORD_TABLE_H\n#define KEYWORD_TABLE_H\n\n");
+    fprintf(out, "#include \"token_types.h\"\n#include \"keyword_hash.h\"\n\n");
+    fprintf(out, "#define KEYWORD_COUNT %d\n", count);
+    fprintf(out, "#define KEYWORD_MIN_LENGTH %d\n", min_length);
+    fprintf(out, "#define KEYWORD_MAX_LENGTH %d\n", max_length);
+    fprintf(out, "#define KEYWORD_BUCKET_COUNT %d\n\n", bucket_count);
+
+    fprintf(out, "typedef struct {\n    const char* text;\n    int length;\n    TokenType type;\n} KeywordEntry;\n\n");
+
+    fprintf(out, "static const uint16_t keyword_displacements[KEYWORD_BUCKET_COUNT] = {");
+    for (int b = 0; b < bucket_count; b++) {
+        fprintf(out, "%s%d", (b % 16 == 0) ? "\n    " : " ", displacements[b]);
+        if (b + 1 < bucket_count) fputc(',', out);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const KeywordEntry keyword_table[KEYWORD_COUNT] = {\n");
+    for (int s = 0; s < count; s++) {
+        const KeywordSpec* spec = &keywords[slot_owner[s]];
+        fprintf(out, "    { \"%s\", %d, %s },\n", spec->text, spec->length, spec->type_name);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// 计算关键字在表中的槽位（调用方需保证长度在 [KEYWORD_MIN_LENGTH, KEYWORD_MAX_LENGTH] 内）\n");
+    fprintf(out, "static inline uint32_t keyword_slot(const char* text, int length) {\n");
+    fprintf(out, "    uint32_t feature = keyword_feature(text, length);\n");
+    fprintf(out, "    uint32_t bucket = keyword_mix(feature, 0) %% KEYWORD_BUCKET_COUNT;\n");
+    fprintf(out, "    return keyword_mix(feature, keyword_displacements[bucket]) %% KEYWORD_COUNT;\n");
+    fprintf(out, "}\n\n");
+    fprintf(out, "#endif // KEYWORD_TABLE_H\n");
+
+    fclose(out);
+    free(bucket_sizes);
+    free(order);
+    free(displacements);
+    free(slots);
+    free(occupied);
+    free(slot_owner);
+    return 0;
+}
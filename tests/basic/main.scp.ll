@@ -1,11 +1,23 @@
 ; 生成的LLVM IR代码
 
-; SCP标准库包含
-@.str = private unnamed_addr constant [12 x i8] c"Hello, scp!\00", align 1
-declare i32 @puts(i8* nocapture) nounwind
+declare void @println(i8*)
+@.str.1 = private unnamed_addr constant [12 x i8] c"Hello, scp!\00", align 1
+@.str.2 = private unnamed_addr constant [6 x i8] c"%lld\0A\00", align 1
+declare i32 @printf(i8*, ...)
 
-; 主函数
 define i32 @main() {
-    %call = call i32 @puts(i8* getelementptr inbounds ([12 x i8], [12 x i8]* @.str, i64 0, i64 0))
-    ret i32 0
+entry:
+  %i.7 = alloca i64
+  %Hello.9 = alloca i8*
+  store i64 0, i64* %i.7
+  %t1 = getelementptr inbounds [12 x i8], [12 x i8]* @.str.1, i64 0, i64 0
+  store i8* %t1, i8** %Hello.9
+  %t2 = getelementptr inbounds [12 x i8], [12 x i8]* @.str.1, i64 0, i64 0
+  call void @println(i8* %t2)
+  %t3 = load i64, i64* %i.7
+  %t4 = add i64 %t3, 1
+  store i64 %t4, i64* %i.7
+  %t5 = getelementptr inbounds [6 x i8], [6 x i8]* @.str.2, i64 0, i64 0
+  %t6 = call i32 (i8*, ...) @printf(i8* %t5, i64 %t4)
+  ret i32 0
 }
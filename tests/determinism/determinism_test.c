@@ -0,0 +1,384 @@
+// 确定性测试
+// 并行词法分析、并行语法分析和增量解析都必须与串行的完整解析得到完全相同的结果：
+//   1. tokenize_parallel 与 tokenize 的标记逐一相同（类型、偏移、长度、标志位、符号），
+//      源代码中含有跨行块注释紧跟运算符的写法，块边界落在注释内部时标志位最容易出错；
+//   2. parse_source_parallel 与 parse_source 压缩后的扁平AST相同；
+//   3. 在随机位置反复编辑（改字面量、增删声明、增删修饰符）后，reparse_source 与重新完整解析的
+//      扁平AST相同，延迟解析与立即解析函数体两种模式都要检查。
+// 全部相同时不输出任何内容并返回 0。
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lexer.h"
+#include "parallel_lexer.h"
+#include "parser.h"
+#include "flat_ast.h"
+
+static unsigned int seed = 20240601;
+static int failures = 0;
+
+static unsigned int next_random(void) {
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+// 可增长的源代码缓冲区
+typedef struct {
+    char* data;
+    int length;
+    int capacity;
+} Text;
+
+static void append_text(Text* text, const char* format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(text->data + text->length, text->capacity - text->length, format, args);
+        va_end(args);
+        if (written >= 0 && written < text->capacity - text->length) {
+            text->length += written;
+            return;
+        }
+        text->capacity = text->capacity ? text->capacity * 2 : 4096;
+        text->data = (char*)realloc(text->data, text->capacity);
+        if (!text->data) {
+            fprintf(stderr, "内存分配失败\n");
+            exit(1);
+        }
+    }
+}
+
+// 一个顶层声明，声明之间以空行分隔（声明内部没有空行，编辑时据此找到声明边界）
+static void append_declaration(Text* text, int index) {
+    switch (next_random() % 8) {
+        case 0:
+            append_text(text, "const K%d: i32 = %u\n\n", index, next_random() % 1000);
+            break;
+        case 1:
+            append_text(text, "var g%d: i64 = %u /* one\n/* two */ - 3\n\n", index, next_random() % 1000);
+            break;
+        case 2:
+            append_text(text, "pub fun p%d(x: i64): i64 { return x * %u + 1 }\n\n", index, next_random() % 100);
+            break;
+        case 3:
+            append_text(text, "tailrec fun t%d(n: i64, acc: i64): i64 {\n"
+                              "    if (n <= 0) return acc\n"
+                              "    return t%d(n - 1, acc + %u)\n"
+                              "}\n\n", index, index, next_random() % 100);
+            break;
+        case 4:
+            append_text(text, "crossinline fun i%d(a: i64, b: i64 = %u): i64 { return a %c b }\n\n",
+                        index, next_random() % 100, "+-*"[next_random() % 3]);
+            break;
+        case 5:
+            append_text(text, "/* block %d\n   spans lines */\n"
+                              "fun f%d(a: i64): i64 {\n"
+                              "    var s: i64 = 0 // line comment\n"
+                              "    for (k in 0..a) { s += k * %u }\n"
+                              "    while (s > 100) { s -= 7 }\n"
+                              "    println(\"text %u\")\n"
+                              "    return s\n"
+                              "}\n\n", index, index, next_random() % 100, next_random() % 100);
+            break;
+        case 6:
+            append_text(text, "fun h%d(x: i64): bool {\n"
+                              "    val y = x /* a\n/* b */ - %u\n"
+                              "    if (y == 2) { return true } else { return !(y < 0) }\n"
+                              "}\n\n", index, next_random() % 100);
+            break;
+        default:
+            append_text(text, "fun m%d() {\n"
+                              "    var i: i32 = %u\n"
+                              "    println(++i)\n"
+                              "    println(\"Hello, \" + \"scp\")\n"
+                              "}\n\n", index, next_random() % 100);
+            break;
+    }
+}
+
+static Text generate_source(int target_length) {
+    Text text = { NULL, 0, 0 };
+    append_text(&text, "#include \"scp.stdio.h\"\n\n");
+    for (int index = 0; text.length < target_length; index++) {
+        append_declaration(&text, index);
+    }
+    append_text(&text, "fun main() {\n    println(\"done\")\n}\n");
+    return text;
+}
+
+static void report(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+    failures++;
+}
+
+// 比较两个标记数组，返回是否相同
+static int same_tokens(const TokenArray* expected, const TokenArray* actual, const char* what) {
+    if (expected->count != actual->count) {
+        report("%s: 标记数量不同 (%d / %d)", what, expected->count, actual->count);
+        return 0;
+    }
+    for (int i = 0; i < expected->count; i++) {
+        const Token* a = &expected->tokens[i];
+        const Token* b = &actual->tokens[i];
+        if (a->type != b->type || a->offset != b->offset || a->length != b->length ||
+            a->flags != b->flags || a->symbol != b->symbol) {
+            report("%s: 第 %d 个标记不同（偏移 %d / %d，标志位 %d / %d）", what, i, a->offset, b->offset, a->flags, b->flags);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int same_literal(const FlatLiteral* a, const FlatLiteral* b) {
+    if (a->type != b->type) return 0;
+    switch (a->type) {
+        case LITERAL_INT:    return a->int_value == b->int_value;
+        case LITERAL_FLOAT:  return memcmp(&a->float_value, &b->float_value, sizeof(double)) == 0;
+        case LITERAL_STRING: return a->string_value == b->string_value;
+        case LITERAL_BOOL:   return a->bool_value == b->bool_value;
+        default:             return 1;
+    }
+}
+
+// 比较两棵扁平AST的全部数组，返回是否相同
+static int same_flat_ast(const FlatAST* expected, const FlatAST* actual, const char* what) {
+    if (!expected || !actual) {
+        report("%s: 压缩AST失败", what);
+        return 0;
+    }
+    if (expected->count != actual->count) {
+        report("%s: 节点数量不同 (%u / %u)", what, expected->count, actual->count);
+        return 0;
+    }
+    for (uint32_t id = 0; id < expected->count; id++) {
+        if (expected->kinds[id] != actual->kinds[id] || expected->offsets[id] != actual->offsets[id] ||
+            expected->ends[id] != actual->ends[id] || expected->data[id] != actual->data[id]) {
+            report("%s: 节点 %u 不同（类型 %d / %d，偏移 %d / %d）", what, id,
+                   expected->kinds[id], actual->kinds[id], expected->offsets[id], actual->offsets[id]);
+            return 0;
+        }
+    }
+    if (expected->extra_count != actual->extra_count ||
+        memcmp(expected->extra, actual->extra, sizeof(uint32_t) * expected->extra_count) != 0) {
+        report("%s: 节点记录不同", what);
+        return 0;
+    }
+    if (expected->literal_count != actual->literal_count) {
+        report("%s: 字面量数量不同 (%u / %u)", what, expected->literal_count, actual->literal_count);
+        return 0;
+    }
+    for (uint32_t i = 0; i < expected->literal_count; i++) {
+        if (!same_literal(&expected->literals[i], &actual->literals[i])) {
+            report("%s: 第 %u 个字面量不同", what, i);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// 完整解析 source，lazy 时只构建从 main 可达的函数体，返回扁平AST
+static FlatAST* parse_flat(const char* source, int length, int lazy, int thread_count, const char* what) {
+    Parser* parser = create_parser();
+    set_lazy_function_bodies(parser, lazy);
+    if (thread_count > 0) {
+        parse_source_parallel(parser, source, length, thread_count);
+    } else {
+        parse_source(parser, source, length);
+    }
+    if (lazy) {
+        parse_reachable_bodies(parser, intern("main", 4));
+    }
+    if (get_parser_error(parser) != PARSER_ERROR_NONE) {
+        report("%s: 解析失败：%s", what, get_parser_error_message(parser));
+    }
+    FlatAST* ast = flatten_ast(get_ast_root(parser));
+    destroy_parser(parser);
+    return ast;
+}
+
+static void test_parallel_lexer(void) {
+    Text text = generate_source(4 << 20);
+    Lexer* lexer = create_lexer(text.data, text.length);
+    TokenArray* expected = tokenize(lexer);
+    for (int threads = 2; threads <= 16; threads++) {
+        char what[64];
+        snprintf(what, sizeof(what), "并行词法分析（%d 个线程）", threads);
+        TokenArray* actual = tokenize_parallel(text.data, text.length, threads);
+        if (!actual) {
+            report("%s: 切分失败", what);
+            continue;
+        }
+        same_tokens(expected, actual, what);
+        destroy_token_array(actual);
+    }
+    destroy_token_array(expected);
+    destroy_lexer(lexer);
+    free(text.data);
+}
+
+static void test_parallel_parser(void) {
+    Text text = generate_source(2 << 20);
+    FlatAST* expected = parse_flat(text.data, text.length, 0, 0, "串行语法分析");
+    for (int threads = 2; threads <= 8; threads *= 2) {
+        char what[64];
+        snprintf(what, sizeof(what), "并行语法分析（%d 个线程）", threads);
+        FlatAST* actual = parse_flat(text.data, text.length, 0, threads, what);
+        same_flat_ast(expected, actual, what);
+        destroy_flat_ast(actual);
+    }
+    destroy_flat_ast(expected);
+    free(text.data);
+}
+
+// 一次编辑：把 [start, end) 替换为 replacement
+typedef struct {
+    int start;
+    int end;
+    char replacement[256];
+} Edit;
+
+static int is_identifier_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// 从 from 起查找 pattern，找不到时从头查找；返回偏移，没有时返回 -1
+static int find_from(const Text* text, int from, const char* pattern) {
+    int length = (int)strlen(pattern);
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = pass ? 0 : from; i + length <= text->length; i++) {
+            if (memcmp(text->data + i, pattern, length) == 0) return i;
+        }
+    }
+    return -1;
+}
+
+// 随机挑选一次保持程序合法的编辑
+static int choose_edit(const Text* text, Edit* edit) {
+    int from = (int)(next_random() % (unsigned int)text->length);
+    int kind = (int)(next_random() % 6);
+    if (kind == 0 || kind == 1) {
+        // 改写一个整数字面量（kind 1 专门改 tailrec 函数体中的字面量，重新解析时修饰符不能丢）
+        if (kind == 1) {
+            int position = find_from(text, from, "tailrec fun");
+            if (position < 0) return 0;
+            from = position;
+        }
+        for (int i = from; i < text->length; i++) {
+            if (text->data[i] >= '0' && text->data[i] <= '9' && i > 0 && !is_identifier_char(text->data[i - 1])) {
+                int end = i;
+                while (end < text->length && text->data[end] >= '0' && text->data[end] <= '9') end++;
+                edit->start = i;
+                edit->end = end;
+                snprintf(edit->replacement, sizeof(edit->replacement), "%u", next_random() % 100000);
+                return 1;
+            }
+        }
+        return 0;
+    }
+    if (kind == 2) {
+        // 在声明边界插入一个新声明
+        int position = find_from(text, from, "\n\n");
+        if (position < 0) return 0;
+        Text declaration = { NULL, 0, 0 };
+        append_declaration(&declaration, 100000 + (int)(next_random() % 1000));
+        edit->start = edit->end = position + 2;
+        snprintf(edit->replacement, sizeof(edit->replacement), "%s", declaration.data);
+        free(declaration.data);
+        return 1;
+    }
+    if (kind == 3) {
+        // 删除一个声明（连同其后的空行）
+        int position = find_from(text, from, "\n\n");
+        if (position < 0) return 0;
+        int next = find_from(text, position + 2, "\n\n");
+        if (next <= position) return 0;
+        edit->start = position + 2;
+        edit->end = next + 2;
+        edit->replacement[0] = '\0';
+        return 1;
+    }
+    if (kind == 4) {
+        // 去掉一个修饰符
+        static const char* modifiers[] = { "tailrec ", "pub ", "crossinline " };
+        const char* modifier = modifiers[next_random() % 3];
+        int position = find_from(text, from, modifier);
+        if (position < 0) return 0;
+        edit->start = position;
+        edit->end = position + (int)strlen(modifier);
+        edit->replacement[0] = '\0';
+        return 1;
+    }
+    // 给普通函数加上 pub
+    int position = find_from(text, from, "\nfun ");
+    if (position < 0) return 0;
+    edit->start = edit->end = position + 1;
+    snprintf(edit->replacement, sizeof(edit->replacement), "pub ");
+    return 1;
+}
+
+static Text apply_edit(const Text* text, const Edit* edit) {
+    int inserted = (int)strlen(edit->replacement);
+    Text result;
+    result.length = text->length - (edit->end - edit->start) + inserted;
+    result.capacity = result.length + 1;
+    result.data = (char*)malloc(result.capacity);
+    if (!result.data) {
+        fprintf(stderr, "内存分配失败\n");
+        exit(1);
+    }
+    memcpy(result.data, text->data, edit->start);
+    memcpy(result.data + edit->start, edit->replacement, inserted);
+    memcpy(result.data + edit->start + inserted, text->data + edit->end, text->length - edit->end);
+    result.data[result.length] = '\0';
+    return result;
+}
+
+static void test_reparse(int lazy) {
+    Text text = generate_source(64 * 1024);
+    Parser* parser = create_parser();
+    set_lazy_function_bodies(parser, lazy);
+    parse_source(parser, text.data, text.length);
+    for (int step = 0; step < 300; step++) {
+        Edit edit;
+        if (!choose_edit(&text, &edit)) continue;
+        Text edited = apply_edit(&text, &edit);
+        reparse_source(parser, edited.data, edited.length, edit.start, edit.end,
+                       edit.start + (int)strlen(edit.replacement));
+        if (lazy) {
+            parse_reachable_bodies(parser, intern("main", 4));
+        }
+        char what[96];
+        snprintf(what, sizeof(what), "增量解析（%s，第 %d 次编辑，偏移 %d）", lazy ? "延迟解析" : "立即解析", step, edit.start);
+        if (get_parser_error(parser) != PARSER_ERROR_NONE) {
+            report("%s: 解析失败：%s", what, get_parser_error_message(parser));
+        }
+        FlatAST* actual = flatten_ast(get_ast_root(parser));
+        FlatAST* expected = parse_flat(edited.data, edited.length, lazy, 0, what);
+        int same = same_flat_ast(expected, actual, what);
+        destroy_flat_ast(actual);
+        destroy_flat_ast(expected);
+        free(text.data);
+        text = edited;
+        if (!same) break;
+    }
+    destroy_parser(parser);
+    free(text.data);
+}
+
+int main(void) {
+    test_parallel_lexer();
+    test_parallel_parser();
+    test_reparse(1);
+    test_reparse(0);
+    if (failures > 0) {
+        fprintf(stderr, "确定性测试失败：%d 处不一致\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1 @@
+fun helper(): i64 { return 1 }
@@ -0,0 +1,2 @@
+fun helper(): i64
+const SIZE: i64 = 3
@@ -0,0 +1,7 @@
+long long LIMIT = 7;
+long long hits = 0;
+
+long long twice(long long x) {
+    hits++;
+    return 2 * x;
+}
@@ -0,0 +1 @@
+val LIMIT: i64 = 10
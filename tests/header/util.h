@@ -0,0 +1,4 @@
+// 头文件只声明，定义在 header.c 中
+fun twice(x: i64): i64
+val LIMIT: i64
+var hits: i64
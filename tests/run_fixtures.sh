@@ -0,0 +1,94 @@
+#!/bin/sh
+# 编译测试用例并检查结果
+# 用法: run_fixtures.sh <编译器> <输出目录>
+# tests/<分类>/<名字>.scp 为一个用例，同名的附加文件决定检查的内容：
+#   <名字>.flags  编译选项（一行）
+#   <名字>.err    编译必须失败，错误输出中要依次包含其中每一行；不引用同目录中头文件的用例
+#                 还要从标准输入再编译一次，错误信息（含行列号）必须相同
+#   <名字>.ir     生成的 LLVM IR 中要包含其中每一行；以 "! " 开头的行不能出现
+#   <名字>.out    链接运行时库后运行程序，标准输出必须与之完全相同
+#   <名字>.c      运行时一同链接的C源文件（提供头文件中声明的函数与变量）
+# 没有 .err、.ir、.out 的 .scp 文件不是用例。
+
+COMPILER=$1
+OUTPUT=$2
+CC=${CC:-gcc}
+LLC=${LLC:-llc}
+RUNTIME=src/lib/scp_stdio.c
+
+mkdir -p "$OUTPUT"
+failures=0
+count=0
+
+fail() {
+    echo "失败: $1: $2"
+    failures=$((failures + 1))
+}
+
+for source in tests/*/*.scp; do
+    base=${source%.scp}
+    [ -f "$base.err" ] || [ -f "$base.ir" ] || [ -f "$base.out" ] || continue
+    count=$((count + 1))
+    name=$(echo "$base" | sed 's|^tests/||; s|/|_|g')
+    ir="$OUTPUT/$name.ll"
+    flags=
+    [ -f "$base.flags" ] && flags=$(cat "$base.flags")
+    rm -f "$ir"
+
+    # shellcheck disable=SC2086
+    "$COMPILER" $flags "$source" "$ir" > "$OUTPUT/$name.log" 2>&1
+    status=$?
+
+    if [ -f "$base.err" ]; then
+        if [ $status -eq 0 ]; then
+            fail "$source" "期望编译失败"
+            continue
+        fi
+        while IFS= read -r line; do
+            grep -qF -- "$line" "$OUTPUT/$name.log" || fail "$source" "错误输出中没有: $line"
+        done < "$base.err"
+        local_header=
+        for header in $(sed -n 's/^#include "\(.*\)"/\1/p' "$source"); do
+            [ -f "$(dirname "$source")/$header" ] && local_header=1
+        done
+        [ -n "$local_header" ] && continue
+        # shellcheck disable=SC2086
+        "$COMPILER" $flags - "$OUTPUT/$name.stdin.ll" < "$source" > "$OUTPUT/$name.stdin.log" 2>&1 &&
+            fail "$source" "从标准输入编译时期望失败"
+        while IFS= read -r line; do
+            grep -qF -- "$line" "$OUTPUT/$name.stdin.log" || fail "$source" "从标准输入编译时错误输出中没有: $line"
+        done < "$base.err"
+        continue
+    fi
+    if [ $status -ne 0 ]; then
+        fail "$source" "编译失败: $(cat "$OUTPUT/$name.log")"
+        continue
+    fi
+
+    if [ -f "$base.ir" ]; then
+        while IFS= read -r line; do
+            case $line in
+                "! "*) grep -qF -- "${line#! }" "$ir" && fail "$source" "IR 中不应出现: ${line#! }" ;;
+                *) grep -qF -- "$line" "$ir" || fail "$source" "IR 中没有: $line" ;;
+            esac
+        done < "$base.ir"
+    fi
+
+    if [ -f "$base.out" ]; then
+        extra=
+        [ -f "$base.c" ] && extra="$base.c"
+        if ! "$LLC" -relocation-model=pic -filetype=obj "$ir" -o "$OUTPUT/$name.o" ||
+           ! "$CC" "$OUTPUT/$name.o" $extra "$RUNTIME" -o "$OUTPUT/$name"; then
+            fail "$source" "无法生成可执行文件"
+            continue
+        fi
+        "$OUTPUT/$name" > "$OUTPUT/$name.actual"
+        cmp -s "$OUTPUT/$name.actual" "$base.out" || fail "$source" "输出不同: $(diff "$base.out" "$OUTPUT/$name.actual")"
+    fi
+done
+
+if [ $failures -ne 0 ]; then
+    echo "$count 个用例中 $failures 处失败"
+    exit 1
+fi
+echo "$count 个用例全部通过"